@@ -2,6 +2,8 @@
 #include "testDx.h"
 #endif
 #include "testStdlib.h"
+#include "testHash.h"
+#include "testGeometry.h"
 
 int main()
 {
@@ -9,5 +11,7 @@ int main()
 	testDx();
 #endif
 	testStdlib();
+	testHash();
+	testGeometry();
 	return 0;
 }
\ No newline at end of file
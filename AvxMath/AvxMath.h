@@ -10,6 +10,11 @@
 #define _AM_FMA3_INTRINSICS_ 1
 #endif
 
+// GCC and clang define __F16C__ when enabled, VC++ doesn't; all CPUs with AVX2 support F16C
+#if !defined(_AM_F16C_INTRINSICS_) && ( defined(__F16C__) || ( defined(_MSC_VER) && defined(_AM_AVX2_INTRINSICS_) ) )
+#define _AM_F16C_INTRINSICS_ 1
+#endif
+
 #ifdef _MSC_VER
 #define _AM_CALL_  __vectorcall
 #else
@@ -30,9 +35,28 @@ namespace AvxMath
 }
 
 #include "AvxMathMisc.h"
+#include "AvxMathCounters.h"
 #include "AvxMathMem.h"
+#include "AvxMathConvert.h"
 #include "AvxMathTrig.h"
+#include "AvxMathExp.h"
 #include "AvxMathVector.h"
 #include "AvxMathPredicates.h"
+#include "AvxMathHashMap.h"
+#include "AvxMathSpatialHash.h"
+#include "AvxMathSort.h"
+#include "AvxMathSoa.h"
+#include "AvxMathRobust.h"
+#include "AvxMathDoubleDouble.h"
+#include "AvxMathRay.h"
+#include "AvxMathClosestPoint.h"
+#include "AvxMathBvh.h"
+#include "AvxMathKdTree.h"
+#include "AvxMathCulling.h"
+#include "AvxMathPolyline.h"
+#include "AvxMathMesh.h"
+#include "AvxMathNurbs.h"
+#include "AvxMathSlice.h"
 #include "AvxMathMatrix.h"
-#include "AvxMathQuaternion.h"
\ No newline at end of file
+#include "AvxMathQuaternion.h"
+#include "AvxMathPipeline.h"
\ No newline at end of file
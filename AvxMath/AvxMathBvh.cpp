@@ -0,0 +1,703 @@
+#include "AvxMath.h"
+#include "AvxMathParallel.h"
+#include <algorithm>
+#include <mutex>
+#include <cmath>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace AvxMath
+{
+	namespace
+	{
+		// Count of bins per axis for the binned SAH
+		constexpr size_t binsCount = 16;
+		// Ranges with more triangles are always split
+		constexpr size_t maxLeafTriangles = 16;
+		// Below that depth the builder uses median splits, this limits the size of the traversal stacks
+		constexpr size_t maxDepth = 48;
+		constexpr size_t traversalStackSize = 256;
+		// Subtrees smaller than that are built on the same thread as their parent
+		constexpr size_t minParallelTriangles = 1 << 14;
+		// Ranges larger than that are binned on multiple threads
+		constexpr size_t minParallelBinning = 1 << 18;
+
+		inline size_t blocksCount( size_t triangles )
+		{
+			return ( triangles + 3 ) / 4;
+		}
+
+		// Axis-aligned bounding box in registers
+		struct Aabb
+		{
+			__m256d min, max;
+
+			static Aabb empty()
+			{
+				return Aabb{ _mm256_set1_pd( g_misc.infinity ), _mm256_set1_pd( -g_misc.infinity ) };
+			}
+			void add( __m256d pt )
+			{
+				min = _mm256_min_pd( min, pt );
+				max = _mm256_max_pd( max, pt );
+			}
+			void add( const Aabb& box )
+			{
+				min = _mm256_min_pd( min, box.min );
+				max = _mm256_max_pd( max, box.max );
+			}
+			// Half of the surface area, 0 for empty boxes
+			double area() const
+			{
+				alignas( 32 ) double size[ 4 ];
+				_mm256_store_pd( size, _mm256_max_pd( _mm256_sub_pd( max, min ), _mm256_setzero_pd() ) );
+				return size[ 0 ] * size[ 1 ] + size[ 1 ] * size[ 2 ] + size[ 2 ] * size[ 0 ];
+			}
+		};
+
+		struct alignas( 32 ) TriangleBox
+		{
+			double min[ 4 ], max[ 4 ];
+			Aabb load() const { return Aabb{ _mm256_load_pd( min ), _mm256_load_pd( max ) }; }
+			__m256d centroid() const
+			{
+				return _mm256_mul_pd( _mm256_add_pd( _mm256_load_pd( min ), _mm256_load_pd( max ) ), broadcast( g_misc.oneHalf ) );
+			}
+		};
+
+		// Range of triangles in the build order, with the bounding box of the triangles, and the bounding box of their centroids
+		struct Range
+		{
+			size_t begin, end;
+			Aabb box, centroids;
+			size_t size() const { return end - begin; }
+		};
+
+		// The range, with the result of the split evaluation
+		struct Candidate
+		{
+			Range range;
+			bool leaf;
+			Range left, right;
+		};
+
+		struct Bin
+		{
+			Aabb box, centroids;
+			size_t count;
+
+			void clear()
+			{
+				box = Aabb::empty();
+				centroids = Aabb::empty();
+				count = 0;
+			}
+			void add( const Bin& that )
+			{
+				box.add( that.box );
+				centroids.add( that.centroids );
+				count += that.count;
+			}
+		};
+
+		// Bins for the 3 axes
+		struct Bins
+		{
+			Bin bins[ 3 ][ binsCount ];
+			void clear()
+			{
+				for( auto& axis : bins )
+					for( Bin& b : axis )
+						b.clear();
+			}
+		};
+	}
+
+	class TriangleBvh::Builder
+	{
+		const double* const xyz;
+		const uint32_t* const indices;
+		std::vector<TriangleBox> boxes;
+		std::vector<uint32_t> order;
+		const size_t topLevels;
+
+		struct Output
+		{
+			std::vector<Node> nodes;
+			std::vector<Block> blocks;
+		};
+
+		// Bin index of the triangle on the axis. The value is clamped before the conversion to integer;
+		// the order of std::max arguments maps NaN centroids of degenerate triangles to the bin 0.
+		static size_t binIndex( const TriangleBox& box, size_t axis, const double* origin, const double* scale )
+		{
+			const double c = ( box.min[ axis ] + box.max[ axis ] ) * 0.5;
+			const double f = ( c - origin[ axis ] ) * scale[ axis ];
+			return (size_t)std::min( std::max( 0.0, f ), (double)( binsCount - 1 ) );
+		}
+
+		void binRange( size_t begin, size_t end, const double* origin, const double* scale, Bins& result ) const
+		{
+			for( size_t i = begin; i < end; i++ )
+			{
+				const TriangleBox& tb = boxes[ order[ i ] ];
+				const Aabb box = tb.load();
+				const __m256d centroid = tb.centroid();
+				for( size_t axis = 0; axis < 3; axis++ )
+				{
+					Bin& bin = result.bins[ axis ][ binIndex( tb, axis, origin, scale ) ];
+					bin.box.add( box );
+					bin.centroids.add( centroid );
+					bin.count++;
+				}
+			}
+		}
+
+		Range makeRange( size_t begin, size_t end ) const
+		{
+			Range r{ begin, end, Aabb::empty(), Aabb::empty() };
+			for( size_t i = begin; i < end; i++ )
+			{
+				r.box.add( boxes[ order[ i ] ].load() );
+				r.centroids.add( boxes[ order[ i ] ].centroid() );
+			}
+			return r;
+		}
+
+		// Split the range by the median of the centroids, on the axis with the largest extent
+		void splitMedian( Candidate& c, size_t axis )
+		{
+			const Range& r = c.range;
+			const size_t mid = r.begin + r.size() / 2;
+			std::nth_element( order.begin() + r.begin, order.begin() + mid, order.begin() + r.end, [ this, axis ]( uint32_t a, uint32_t b )
+			{
+				return boxes[ a ].min[ axis ] + boxes[ a ].max[ axis ] < boxes[ b ].min[ axis ] + boxes[ b ].max[ axis ];
+			} );
+			c.left = makeRange( r.begin, mid );
+			c.right = makeRange( mid, r.end );
+			c.leaf = false;
+		}
+
+		// Decide whether the range should be a leaf, otherwise partition the triangles into 2 halves
+		void evaluate( Candidate& c, size_t depth, bool alone )
+		{
+			const Range& r = c.range;
+			const size_t n = r.size();
+			c.leaf = true;
+			if( n <= 4 )
+				return;
+
+			alignas( 32 ) double origin[ 4 ], extent[ 4 ];
+			_mm256_store_pd( origin, r.centroids.min );
+			_mm256_store_pd( extent, _mm256_sub_pd( r.centroids.max, r.centroids.min ) );
+			const size_t largestAxis = ( extent[ 0 ] >= extent[ 1 ] && extent[ 0 ] >= extent[ 2 ] ) ? 0 : ( extent[ 1 ] >= extent[ 2 ] ? 1 : 2 );
+
+			if( depth >= maxDepth )
+			{
+				splitMedian( c, largestAxis );
+				return;
+			}
+			if( !( extent[ largestAxis ] > 0 ) )
+			{
+				// All centroids are the same
+				if( n > maxLeafTriangles )
+					splitMedian( c, largestAxis );
+				return;
+			}
+
+			double scale[ 3 ];
+			for( size_t axis = 0; axis < 3; axis++ )
+				scale[ axis ] = extent[ axis ] > 0 ? (double)binsCount * ( 1 - 0x1p-20 ) / extent[ axis ] : 0.0;
+
+			Bins bins;
+			bins.clear();
+			if( alone && n >= minParallelBinning )
+			{
+				std::mutex mutex;
+				parallelFor( n, minParallelBinning / 4, [ & ]( size_t begin, size_t end )
+				{
+					Bins local;
+					local.clear();
+					binRange( r.begin + begin, r.begin + end, origin, scale, local );
+					std::lock_guard<std::mutex> lock( mutex );
+					for( size_t axis = 0; axis < 3; axis++ )
+						for( size_t i = 0; i < binsCount; i++ )
+							bins.bins[ axis ][ i ].add( local.bins[ axis ][ i ] );
+				} );
+			}
+			else
+				binRange( r.begin, r.end, origin, scale, bins );
+
+			// Sweep the bins, find the split with the lowest cost.
+			// The cost unit is 1 node or 1 block of 4 triangles, both are tested with a few AVX instructions.
+			const double parentArea = r.box.area();
+			const double invArea = parentArea > 0 ? 1.0 / parentArea : 0.0;
+			double bestCost = g_misc.infinity;
+			size_t bestAxis = 0, bestSplit = 0;
+			for( size_t axis = 0; axis < 3; axis++ )
+			{
+				const Bin* axisBins = bins.bins[ axis ];
+				double rightArea[ binsCount ];
+				size_t rightCount[ binsCount ];
+				Bin acc;
+				acc.clear();
+				for( size_t i = binsCount - 1; i > 0; i-- )
+				{
+					acc.add( axisBins[ i ] );
+					rightArea[ i ] = acc.box.area();
+					rightCount[ i ] = acc.count;
+				}
+				acc.clear();
+				for( size_t i = 1; i < binsCount; i++ )
+				{
+					acc.add( axisBins[ i - 1 ] );
+					if( 0 == acc.count || 0 == rightCount[ i ] )
+						continue;
+					const double cost = 1.0 + ( acc.box.area() * (double)blocksCount( acc.count ) + rightArea[ i ] * (double)blocksCount( rightCount[ i ] ) ) * invArea;
+					if( cost < bestCost )
+					{
+						bestCost = cost;
+						bestAxis = axis;
+						bestSplit = i;
+					}
+				}
+			}
+
+			if( bestCost == g_misc.infinity )
+			{
+				// All centroids are in the same bin on every axis, only possible with extremely uneven distribution
+				if( n > maxLeafTriangles )
+					splitMedian( c, largestAxis );
+				return;
+			}
+			if( n <= maxLeafTriangles && (double)blocksCount( n ) <= bestCost )
+				return;
+
+			// Partition the triangles, compute bounding boxes of the halves from the bins
+			const auto it = std::partition( order.begin() + r.begin, order.begin() + r.end, [ & ]( uint32_t i )
+			{
+				return binIndex( boxes[ i ], bestAxis, origin, scale ) < bestSplit;
+			} );
+			const size_t mid = (size_t)( it - order.begin() );
+
+			Bin left, right;
+			left.clear();
+			right.clear();
+			for( size_t i = 0; i < binsCount; i++ )
+				( i < bestSplit ? left : right ).add( bins.bins[ bestAxis ][ i ] );
+			assert( mid == r.begin + left.count );
+			c.left = Range{ r.begin, mid, left.box, left.centroids };
+			c.right = Range{ mid, r.end, right.box, right.centroids };
+			c.leaf = false;
+		}
+
+		void makeLeaf( Output& out, const Range& r, Node& node, size_t slot ) const
+		{
+			node.child[ slot ] = (uint32_t)out.blocks.size();
+			node.blocks[ slot ] = (uint32_t)blocksCount( r.size() );
+			for( size_t i = r.begin; i < r.end; i += 4 )
+			{
+				Block& block = out.blocks.emplace_back();
+				for( auto& c : block.coords )
+					std::fill_n( c, 4, g_misc.quietNaN );
+				std::fill_n( block.triangles, 4, UINT32_MAX );
+
+				for( size_t j = 0; j < 4 && i + j < r.end; j++ )
+				{
+					const uint32_t tri = order[ i + j ];
+					block.triangles[ j ] = tri;
+					for( size_t v = 0; v < 3; v++ )
+					{
+						const double* pos = xyz + (size_t)indices[ (size_t)tri * 3 + v ] * 3;
+						for( size_t k = 0; k < 3; k++ )
+							block.coords[ v * 3 + k ][ j ] = pos[ k ];
+					}
+				}
+			}
+		}
+
+		static void initNode( Node& node )
+		{
+			for( size_t i = 0; i < 6; i++ )
+				std::fill_n( node.bounds[ i ], 4, ( i & 1 ) ? -g_misc.infinity : g_misc.infinity );
+			std::fill_n( node.child, 4, UINT32_MAX );
+			std::fill_n( node.blocks, 4, 0 );
+		}
+
+		static void setBounds( Node& node, size_t slot, const Aabb& box )
+		{
+			alignas( 32 ) double lo[ 4 ], hi[ 4 ];
+			_mm256_store_pd( lo, box.min );
+			_mm256_store_pd( hi, box.max );
+			for( size_t axis = 0; axis < 3; axis++ )
+			{
+				node.bounds[ axis * 2 ][ slot ] = lo[ axis ];
+				node.bounds[ axis * 2 + 1 ][ slot ] = hi[ axis ];
+			}
+		}
+
+		// Move the subtree to the end of the output, return index of the root of the subtree
+		static uint32_t append( Output& dest, Output& src )
+		{
+			const uint32_t nodeOffset = (uint32_t)dest.nodes.size();
+			const uint32_t blockOffset = (uint32_t)dest.blocks.size();
+			for( Node& n : src.nodes )
+				for( size_t i = 0; i < 4; i++ )
+				{
+					if( 0 != n.blocks[ i ] )
+						n.child[ i ] += blockOffset;
+					else if( UINT32_MAX != n.child[ i ] )
+						n.child[ i ] += nodeOffset;
+				}
+			dest.nodes.insert( dest.nodes.end(), src.nodes.begin(), src.nodes.end() );
+			dest.blocks.insert( dest.blocks.end(), src.blocks.begin(), src.blocks.end() );
+			src = Output{};
+			return nodeOffset;
+		}
+
+		// Build the node for the evaluated range which needs to be split, return index of the node
+		uint32_t buildInner( Output& out, const Candidate& parent, size_t depth, size_t levels )
+		{
+			const bool alone = levels == topLevels;
+
+			// Collapse up to 2 levels of the binary tree into the 4-wide node, splitting the children with the largest area first
+			Candidate children[ 4 ];
+			children[ 0 ].range = parent.left;
+			children[ 1 ].range = parent.right;
+			evaluate( children[ 0 ], depth + 1, alone );
+			evaluate( children[ 1 ], depth + 1, alone );
+			size_t count = 2;
+			while( count < 4 )
+			{
+				size_t best = SIZE_MAX;
+				double bestArea = -1;
+				for( size_t i = 0; i < count; i++ )
+					if( !children[ i ].leaf && children[ i ].range.box.area() > bestArea )
+					{
+						bestArea = children[ i ].range.box.area();
+						best = i;
+					}
+				if( best == SIZE_MAX )
+					break;
+				const Candidate c = children[ best ];
+				children[ best ].range = c.left;
+				children[ count ].range = c.right;
+				evaluate( children[ best ], depth + 1, alone );
+				evaluate( children[ count ], depth + 1, alone );
+				count++;
+			}
+
+			const uint32_t result = (uint32_t)out.nodes.size();
+			initNode( out.nodes.emplace_back() );
+			size_t inner[ 4 ];
+			size_t innerCount = 0;
+			for( size_t i = 0; i < count; i++ )
+			{
+				setBounds( out.nodes[ result ], i, children[ i ].range.box );
+				if( children[ i ].leaf )
+					makeLeaf( out, children[ i ].range, out.nodes[ result ], i );
+				else
+					inner[ innerCount++ ] = i;
+			}
+
+			if( levels > 0 && innerCount > 1 && parent.range.size() >= minParallelTriangles )
+			{
+				// Build the subtrees on different threads, each one into a separate output
+				Output subtrees[ 4 ];
+				parallelInvoke( innerCount, [ & ]( size_t i )
+				{
+					buildInner( subtrees[ i ], children[ inner[ i ] ], depth + 1, levels - 1 );
+				} );
+				for( size_t i = 0; i < innerCount; i++ )
+					out.nodes[ result ].child[ inner[ i ] ] = append( out, subtrees[ i ] );
+			}
+			else
+			{
+				for( size_t i = 0; i < innerCount; i++ )
+				{
+					const uint32_t child = buildInner( out, children[ inner[ i ] ], depth + 1, levels );
+					out.nodes[ result ].child[ inner[ i ] ] = child;
+				}
+			}
+			return result;
+		}
+
+		static size_t parallelLevels( size_t triangles, bool parallel )
+		{
+			if( !parallel )
+				return 0;
+			// Every level multiplies count of the threads by up to 4
+			const size_t threads = parallelThreads( triangles, minParallelTriangles );
+			size_t levels = 0;
+			while( ( (size_t)1 << ( levels * 2 ) ) < threads )
+				levels++;
+			return levels;
+		}
+
+	public:
+		Builder( const double* xyz, const uint32_t* indices, size_t triangles, bool parallel ) :
+			xyz( xyz ), indices( indices ), topLevels( parallelLevels( triangles, parallel ) )
+		{
+			boxes.resize( triangles );
+			order.resize( triangles );
+			parallelFor( triangles, parallel ? minParallelTriangles : triangles, [ & ]( size_t begin, size_t end )
+			{
+				for( size_t i = begin; i < end; i++ )
+				{
+					Aabb box = Aabb::empty();
+					for( size_t v = 0; v < 3; v++ )
+						box.add( loadDouble3( xyz + (size_t)indices[ i * 3 + v ] * 3 ) );
+					_mm256_store_pd( boxes[ i ].min, box.min );
+					_mm256_store_pd( boxes[ i ].max, box.max );
+					order[ i ] = (uint32_t)i;
+				}
+			} );
+		}
+
+		void build( std::vector<Node>& nodes, std::vector<Block>& blocks )
+		{
+			Output out;
+			out.nodes.reserve( order.size() / 8 + 1 );
+			out.blocks.reserve( order.size() / 3 + 1 );
+
+			Candidate root;
+			root.range = makeRange( 0, order.size() );
+			evaluate( root, 0, true );
+			if( root.leaf )
+			{
+				Node& node = out.nodes.emplace_back();
+				initNode( node );
+				setBounds( node, 0, root.range.box );
+				makeLeaf( out, root.range, node, 0 );
+			}
+			else
+				buildInner( out, root, 0, topLevels );
+
+			nodes.swap( out.nodes );
+			blocks.swap( out.blocks );
+		}
+	};
+
+	void TriangleBvh::build( const double* xyz, const uint32_t* indices, size_t triangles, bool parallel )
+	{
+		m_nodes.clear();
+		m_blocks.clear();
+		m_triangles = triangles;
+		if( 0 == triangles )
+			return;
+		assert( triangles < UINT32_MAX );
+
+		Builder builder{ xyz, indices, triangles, parallel };
+		builder.build( m_nodes, m_blocks );
+	}
+
+	namespace
+	{
+		struct StackEntry
+		{
+			// Node index for inner nodes, first block for leaves
+			uint32_t child;
+			// Count of blocks for leaves, 0 for inner nodes
+			uint32_t blocks;
+			// Distance to the bounding box, the entry is skipped when it's further than the best result found so far
+			double distance;
+		};
+
+		// Push the children selected by the mask to the stack, the closest one on the top
+		inline void pushSorted( StackEntry* stack, size_t& sp, const uint32_t* child, const uint32_t* blocks, __m256d distance, int mask )
+		{
+			alignas( 32 ) double dist[ 4 ];
+			_mm256_store_pd( dist, distance );
+			if( 0 == ( mask & ( mask - 1 ) ) )
+			{
+				// A single child, no need to sort
+				assert( sp < traversalStackSize );
+				const size_t i = lowestBit( (uint32_t)mask );
+				stack[ sp++ ] = StackEntry{ child[ i ], blocks[ i ], dist[ i ] };
+				return;
+			}
+			StackEntry local[ 4 ];
+			size_t count = 0;
+			for( ; 0 != mask; mask &= mask - 1 )
+			{
+				const size_t i = lowestBit( (uint32_t)mask );
+				StackEntry e{ child[ i ], blocks[ i ], dist[ i ] };
+				// Insertion sort, descending
+				size_t j = count++;
+				for( ; j > 0 && local[ j - 1 ].distance < e.distance; j-- )
+					local[ j ] = local[ j - 1 ];
+				local[ j ] = e;
+			}
+			assert( sp + count <= traversalStackSize );
+			for( size_t i = 0; i < count; i++ )
+				stack[ sp++ ] = local[ i ];
+		}
+	}
+
+	template<bool anyHit>
+	bool TriangleBvh::traceRay( __m256d origin, __m256d dir, double tMax, BvhRayHit* hit ) const
+	{
+		if( m_nodes.empty() )
+			return false;
+
+		alignas( 32 ) double o[ 4 ], inv[ 4 ];
+		_mm256_store_pd( o, origin );
+		_mm256_store_pd( inv, _mm256_div_pd( broadcast( g_misc.one ), dir ) );
+		// For negative directions, the near plane is the max of the box
+		const size_t sx = std::signbit( inv[ 0 ] ) ? 1 : 0;
+		const size_t sy = std::signbit( inv[ 1 ] ) ? 1 : 0;
+		const size_t sz = std::signbit( inv[ 2 ] ) ? 1 : 0;
+		const __m256d ox = _mm256_set1_pd( o[ 0 ] ), oy = _mm256_set1_pd( o[ 1 ] ), oz = _mm256_set1_pd( o[ 2 ] );
+		const __m256d ix = _mm256_set1_pd( inv[ 0 ] ), iy = _mm256_set1_pd( inv[ 1 ] ), iz = _mm256_set1_pd( inv[ 2 ] );
+		// Scale the far distances by 1 + 2 * gamma( 3 ) to make the slab test conservative, Ize, "Robust BVH Ray Traversal", JCGT 2013
+		const __m256d robust = _mm256_set1_pd( 1.0 + 0x1p-50 );
+		const __m256d zero = _mm256_setzero_pd();
+		const __m256d inf = broadcast( g_misc.infinity );
+
+		StackEntry stack[ traversalStackSize ];
+		size_t sp = 0;
+		stack[ sp++ ] = StackEntry{ 0, 0, 0.0 };
+		double best = tMax;
+		bool found = false;
+
+		while( sp > 0 )
+		{
+			const StackEntry e = stack[ --sp ];
+			if( e.distance > best )
+				continue;
+
+			if( 0 != e.blocks )
+			{
+				for( uint32_t b = e.child; b < e.child + e.blocks; b++ )
+				{
+					const Block& block = m_blocks[ b ];
+					const RayHit4 h = intersectRayTriangles( origin, dir, block.vertex( 0 ), block.vertex( 1 ), block.vertex( 2 ), best );
+					int mask = _mm256_movemask_pd( h.mask );
+					if( 0 == mask )
+						continue;
+					if constexpr( anyHit )
+						return true;
+
+					alignas( 32 ) double t[ 4 ], u[ 4 ], v[ 4 ];
+					_mm256_store_pd( t, h.t );
+					_mm256_store_pd( u, h.u );
+					_mm256_store_pd( v, h.v );
+					for( ; 0 != mask; mask &= mask - 1 )
+					{
+						const size_t i = lowestBit( (uint32_t)mask );
+						if( found && t[ i ] >= best )
+							continue;
+						best = t[ i ];
+						found = true;
+						*hit = BvhRayHit{ t[ i ], u[ i ], v[ i ], block.triangles[ i ] };
+					}
+				}
+				continue;
+			}
+
+			// Slab test of the 4 children. The order of min / max arguments discards NaNs, which happen for 0 * INF.
+			const Node& node = m_nodes[ e.child ];
+			const __m256d nearX = _mm256_mul_pd( _mm256_sub_pd( _mm256_load_pd( node.bounds[ sx ] ), ox ), ix );
+			const __m256d nearY = _mm256_mul_pd( _mm256_sub_pd( _mm256_load_pd( node.bounds[ 2 + sy ] ), oy ), iy );
+			const __m256d nearZ = _mm256_mul_pd( _mm256_sub_pd( _mm256_load_pd( node.bounds[ 4 + sz ] ), oz ), iz );
+			const __m256d farX = _mm256_mul_pd( _mm256_sub_pd( _mm256_load_pd( node.bounds[ 1 - sx ] ), ox ), ix );
+			const __m256d farY = _mm256_mul_pd( _mm256_sub_pd( _mm256_load_pd( node.bounds[ 3 - sy ] ), oy ), iy );
+			const __m256d farZ = _mm256_mul_pd( _mm256_sub_pd( _mm256_load_pd( node.bounds[ 5 - sz ] ), oz ), iz );
+
+			const __m256d tNear = _mm256_max_pd( nearX, _mm256_max_pd( nearY, _mm256_max_pd( nearZ, zero ) ) );
+			__m256d tFar = _mm256_min_pd( farX, _mm256_min_pd( farY, _mm256_min_pd( farZ, inf ) ) );
+			tFar = _mm256_min_pd( _mm256_mul_pd( tFar, robust ), _mm256_set1_pd( best ) );
+			const int mask = _mm256_movemask_pd( _mm256_cmp_pd( tNear, tFar, _CMP_LE_OQ ) );
+			if( 0 != mask )
+				pushSorted( stack, sp, node.child, node.blocks, tNear, mask );
+		}
+		return found;
+	}
+
+	bool TriangleBvh::intersect( __m256d origin, __m256d dir, double tMax, BvhRayHit& hit ) const
+	{
+		return traceRay<false>( origin, dir, tMax, &hit );
+	}
+
+	bool TriangleBvh::intersectAny( __m256d origin, __m256d dir, double tMax ) const
+	{
+		return traceRay<true>( origin, dir, tMax, nullptr );
+	}
+
+	bool TriangleBvh::closestPoint( __m256d pos, double maxDistance, BvhClosestPoint& result ) const
+	{
+		if( m_nodes.empty() || !( maxDistance >= 0 ) )
+			return false;
+
+		pos = _mm256_blend_pd( pos, _mm256_setzero_pd(), 0b1000 );
+		const __m256d px = vectorSplatX( pos ), py = vectorSplatY( pos ), pz = vectorSplatZ( pos );
+		const __m256d zero = _mm256_setzero_pd();
+
+		StackEntry stack[ traversalStackSize ];
+		size_t sp = 0;
+		stack[ sp++ ] = StackEntry{ 0, 0, 0.0 };
+		double best = maxDistance * maxDistance;
+		bool found = false;
+
+		while( sp > 0 )
+		{
+			const StackEntry e = stack[ --sp ];
+			if( e.distance > best )
+				continue;
+
+			if( 0 != e.blocks )
+			{
+				for( uint32_t b = e.child; b < e.child + e.blocks; b++ )
+				{
+					const Block& block = m_blocks[ b ];
+					const TriangleClosestPoint4 cp = closestPointOnTriangles( pos, block.vertex( 0 ), block.vertex( 1 ), block.vertex( 2 ) );
+					// The unused lanes have NaN distances and never pass the test
+					const __m256d bestVec = _mm256_set1_pd( best );
+					int mask = _mm256_movemask_pd( found ? _mm256_cmp_pd( cp.distanceSquared, bestVec, _CMP_LT_OQ ) : _mm256_cmp_pd( cp.distanceSquared, bestVec, _CMP_LE_OQ ) );
+					if( 0 == mask )
+						continue;
+
+					alignas( 32 ) double distSq[ 4 ];
+					_mm256_store_pd( distSq, cp.distanceSquared );
+					size_t i = lowestBit( (uint32_t)mask );
+					for( mask &= mask - 1; 0 != mask; mask &= mask - 1 )
+					{
+						const size_t j = lowestBit( (uint32_t)mask );
+						if( distSq[ j ] < distSq[ i ] )
+							i = j;
+					}
+					alignas( 32 ) double x[ 4 ], y[ 4 ], z[ 4 ], u[ 4 ], v[ 4 ];
+					_mm256_store_pd( x, cp.point.x );
+					_mm256_store_pd( y, cp.point.y );
+					_mm256_store_pd( z, cp.point.z );
+					_mm256_store_pd( u, cp.u );
+					_mm256_store_pd( v, cp.v );
+					best = distSq[ i ];
+					found = true;
+					result = BvhClosestPoint{ _mm256_setr_pd( x[ i ], y[ i ], z[ i ], 0 ), best, u[ i ], v[ i ], block.triangles[ i ] };
+				}
+				continue;
+			}
+
+			// Squared distances to the 4 boxes; the unused slots have infinite distance
+			const Node& node = m_nodes[ e.child ];
+			const auto axis = [ &node, zero ]( size_t i, __m256d p )
+			{
+				const __m256d below = _mm256_sub_pd( _mm256_load_pd( node.bounds[ i * 2 ] ), p );
+				const __m256d above = _mm256_sub_pd( p, _mm256_load_pd( node.bounds[ i * 2 + 1 ] ) );
+				return _mm256_max_pd( _mm256_max_pd( below, above ), zero );
+			};
+			const __m256d dx = axis( 0, px );
+			const __m256d dy = axis( 1, py );
+			const __m256d dz = axis( 2, pz );
+			__m256d distSq = _mm256_mul_pd( dx, dx );
+			distSq = vectorMultiplyAdd( dy, dy, distSq );
+			distSq = vectorMultiplyAdd( dz, dz, distSq );
+			const int mask = _mm256_movemask_pd( _mm256_cmp_pd( distSq, _mm256_set1_pd( best ), _CMP_LE_OQ ) );
+			if( 0 != mask )
+				pushSorted( stack, sp, node.child, node.blocks, distSq, mask );
+		}
+		return found;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+// Bounding volume hierarchy of triangle meshes, for ray casting and closest point queries
+#pragma once
+#include <vector>
+
+namespace AvxMath
+{
+	// Closest intersection of a ray with the mesh
+	struct BvhRayHit
+	{
+		// Distance along the ray in units of the ray direction
+		double t;
+		// Barycentric coordinates of the intersection, the point is v0 * ( 1 - u - v ) + v1 * u + v2 * v
+		double u, v;
+		// Index of the triangle in the source mesh
+		uint32_t triangle;
+	};
+
+	// Point on the mesh closest to the query position
+	struct BvhClosestPoint
+	{
+		// The closest point, W lane is 0.0
+		__m256d point;
+		double distanceSquared;
+		// Barycentric coordinates of the point, same as in BvhRayHit
+		double u, v;
+		// Index of the triangle in the source mesh
+		uint32_t triangle;
+	};
+
+	// 4-wide BVH of triangles, built with binned surface area heuristic.
+	// Bounding boxes of the 4 children of every node are stored in SoA layout, a single AVX slab test handles all of them.
+	// Leaves contain blocks of 4 triangles, also in SoA layout.
+	class TriangleBvh
+	{
+	public:
+		// Build the BVH for the indexed triangle mesh. xyz has 3 doubles per vertex, indices has 3 integers per triangle.
+		// With parallel = true, large meshes are built on all hardware threads. Replaces the previous content of the BVH.
+		void build( const double* xyz, const uint32_t* indices, size_t triangles, bool parallel = false );
+
+		// Count of triangles in the BVH
+		size_t size() const { return m_triangles; }
+		// Count of nodes in the BVH
+		size_t nodeCount() const { return m_nodes.size(); }
+
+		// Find the closest intersection of the ray with the mesh, with 0 <= t <= tMax. Returns false if the ray misses the mesh.
+		// The ray / triangle tests are Moller-Trumbore, from both sides of the triangles.
+		bool intersect( __m256d origin, __m256d dir, double tMax, BvhRayHit& hit ) const;
+
+		// True if the ray intersects any triangle with 0 <= t <= tMax; faster than intersect, stops at the first intersection found.
+		bool intersectAny( __m256d origin, __m256d dir, double tMax ) const;
+
+		// Find the point on the mesh closest to the position, within maxDistance. Returns false if there're no triangles within maxDistance.
+		// Smaller maxDistance makes the query faster.
+		bool closestPoint( __m256d pos, double maxDistance, BvhClosestPoint& result ) const;
+
+	private:
+		struct alignas( 32 ) Node
+		{
+			// Bounding boxes of the children: minX, maxX, minY, maxY, minZ, maxZ. Unused slots have min = +INF and max = -INF.
+			double bounds[ 6 ][ 4 ];
+			// For inner children, index of the node; for leaves, index of the first block of triangles
+			uint32_t child[ 4 ];
+			// Count of the triangle blocks for leaves, 0 for inner nodes and unused slots
+			uint32_t blocks[ 4 ];
+		};
+
+		struct alignas( 32 ) Block
+		{
+			// v0.x, v0.y, v0.z, v1.x, v1.y, v1.z, v2.x, v2.y, v2.z. Unused lanes contain NaN.
+			double coords[ 9 ][ 4 ];
+			// Indices of the triangles in the source mesh, unused lanes have UINT32_MAX
+			uint32_t triangles[ 4 ];
+
+			Vector3x4 vertex( size_t v ) const
+			{
+				return Vector3x4{ _mm256_load_pd( coords[ v * 3 ] ), _mm256_load_pd( coords[ v * 3 + 1 ] ), _mm256_load_pd( coords[ v * 3 + 2 ] ) };
+			}
+		};
+
+		std::vector<Node> m_nodes;
+		std::vector<Block> m_blocks;
+		size_t m_triangles = 0;
+
+		class Builder;
+		template<bool anyHit>
+		bool traceRay( __m256d origin, __m256d dir, double tMax, BvhRayHit* hit ) const;
+	};
+}
\ No newline at end of file
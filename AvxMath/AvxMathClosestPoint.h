@@ -0,0 +1,124 @@
+// Closest points on triangles, 4 at a time
+#pragma once
+
+namespace AvxMath
+{
+	// Result of 4 closest point queries. u and v are barycentric coordinates of the closest point,
+	// same as for the ray intersections the point is v0 * ( 1 - u - v ) + v1 * u + v2 * v
+	struct TriangleClosestPoint4
+	{
+		Vector3x4 point;
+		__m256d distanceSquared;
+		__m256d u, v;
+	};
+
+	// Lane i of the output has the point on triangle i closest to the position i.
+	// Christer Ericson, "Real-Time Collision Detection", 5.1.5, with the Voronoi regions classified with masks instead of branches.
+	// Degenerate triangles are handled as the longest of their 3 edges. Lanes with NaN coordinates produce NaN distances.
+	inline TriangleClosestPoint4 _AM_CALL_ closestPointOnTriangle4( const Vector3x4& p, const Vector3x4& a, const Vector3x4& b, const Vector3x4& c )
+	{
+		const Vector3x4 ab = vector3x4Subtract( b, a );
+		const Vector3x4 ac = vector3x4Subtract( c, a );
+		const Vector3x4 ap = vector3x4Subtract( p, a );
+		const Vector3x4 bp = vector3x4Subtract( p, b );
+		const Vector3x4 cp = vector3x4Subtract( p, c );
+		const __m256d d1 = vector3x4Dot( ab, ap );
+		const __m256d d2 = vector3x4Dot( ac, ap );
+		const __m256d d3 = vector3x4Dot( ab, bp );
+		const __m256d d4 = vector3x4Dot( ac, bp );
+		const __m256d d5 = vector3x4Dot( ab, cp );
+		const __m256d d6 = vector3x4Dot( ac, cp );
+		const __m256d va = _mm256_sub_pd( _mm256_mul_pd( d3, d6 ), _mm256_mul_pd( d5, d4 ) );
+		const __m256d vb = _mm256_sub_pd( _mm256_mul_pd( d5, d2 ), _mm256_mul_pd( d1, d6 ) );
+		const __m256d vc = _mm256_sub_pd( _mm256_mul_pd( d1, d4 ), _mm256_mul_pd( d3, d2 ) );
+
+		// The weights of the 3 vertices are wa / den, wb / den, wc / den; select the numerators and the denominator for every region, then divide once.
+		// Start with the face region, then test the rest in the reverse order of the scalar version, so the earlier tests take precedence.
+		const __m256d zero = _mm256_setzero_pd();
+		const __m256d one = broadcast( g_misc.one );
+		__m256d wa = va, wb = vb, wc = vc;
+		__m256d den = _mm256_add_pd( _mm256_add_pd( va, vb ), vc );
+		const auto select = [ & ]( __m256d mask, __m256d a, __m256d b, __m256d c, __m256d d )
+		{
+			wa = _mm256_blendv_pd( wa, a, mask );
+			wb = _mm256_blendv_pd( wb, b, mask );
+			wc = _mm256_blendv_pd( wc, c, mask );
+			den = _mm256_blendv_pd( den, d, mask );
+		};
+		const auto le = []( __m256d x, __m256d y ) { return _mm256_cmp_pd( x, y, _CMP_LE_OQ ); };
+
+		// Edge BC
+		const __m256d d43 = _mm256_sub_pd( d4, d3 );
+		const __m256d d56 = _mm256_sub_pd( d5, d6 );
+		__m256d mask = _mm256_and_pd( le( va, zero ), _mm256_and_pd( le( zero, d43 ), le( zero, d56 ) ) );
+		select( mask, zero, d56, d43, _mm256_add_pd( d43, d56 ) );
+		// Edge AC
+		mask = _mm256_and_pd( le( vb, zero ), _mm256_and_pd( le( zero, d2 ), le( d6, zero ) ) );
+		select( mask, vectorNegate( d6 ), zero, d2, _mm256_sub_pd( d2, d6 ) );
+		// Vertex C
+		mask = _mm256_and_pd( le( zero, d6 ), le( d5, d6 ) );
+		select( mask, zero, zero, one, one );
+		// Edge AB
+		mask = _mm256_and_pd( le( vc, zero ), _mm256_and_pd( le( zero, d1 ), le( d3, zero ) ) );
+		select( mask, vectorNegate( d3 ), d1, zero, _mm256_sub_pd( d1, d3 ) );
+		// Vertex B
+		mask = _mm256_and_pd( le( zero, d3 ), le( d4, d3 ) );
+		select( mask, zero, one, zero, one );
+		// Vertex A
+		mask = _mm256_and_pd( le( d1, zero ), le( d2, zero ) );
+		select( mask, one, zero, zero, one );
+
+		// Degenerate triangles result in 0 / 0, use the closest point on the longest edge instead
+		const __m256d degenerate = _mm256_cmp_pd( den, zero, _CMP_EQ_OQ );
+		if( !_mm256_testz_pd( degenerate, degenerate ) )
+		{
+			const Vector3x4 bc = vector3x4Subtract( c, b );
+			const __m256d lab = vector3x4Dot( ab, ab );
+			const __m256d lac = vector3x4Dot( ac, ac );
+			const __m256d lbc = vector3x4Dot( bc, bc );
+			// Numerators of the position on the edge, clamped into [ 0 .. length ]
+			const __m256d tab = _mm256_min_pd( _mm256_max_pd( d1, zero ), lab );
+			const __m256d tac = _mm256_min_pd( _mm256_max_pd( d2, zero ), lac );
+			const __m256d tbc = _mm256_min_pd( _mm256_max_pd( vector3x4Dot( bc, bp ), zero ), lbc );
+
+			// Edge AB unless another one is longer
+			__m256d ea = _mm256_sub_pd( lab, tab ), eb = tab, ec = zero, len = lab;
+			mask = _mm256_cmp_pd( lac, len, _CMP_GT_OQ );
+			ea = _mm256_blendv_pd( ea, _mm256_sub_pd( lac, tac ), mask );
+			eb = _mm256_blendv_pd( eb, zero, mask );
+			ec = _mm256_blendv_pd( ec, tac, mask );
+			len = _mm256_max_pd( len, lac );
+			mask = _mm256_cmp_pd( lbc, len, _CMP_GT_OQ );
+			ea = _mm256_blendv_pd( ea, zero, mask );
+			eb = _mm256_blendv_pd( eb, _mm256_sub_pd( lbc, tbc ), mask );
+			ec = _mm256_blendv_pd( ec, tbc, mask );
+			len = _mm256_max_pd( len, lbc );
+
+			// When all 3 vertices are equal, the closest point is vertex A
+			const __m256d single = _mm256_cmp_pd( len, zero, _CMP_EQ_OQ );
+			ea = _mm256_blendv_pd( ea, one, single );
+			len = _mm256_blendv_pd( len, one, single );
+			select( degenerate, ea, eb, ec, len );
+		}
+
+		const __m256d inv = _mm256_div_pd( one, den );
+		wa = _mm256_mul_pd( wa, inv );
+		wb = _mm256_mul_pd( wb, inv );
+		wc = _mm256_mul_pd( wc, inv );
+
+		// Interpolating the vertices with the weights makes the results exact for the vertex regions, and keeps the edge regions on the edges
+		TriangleClosestPoint4 res;
+		res.point = vector3x4MultiplyAdd( c, wc, vector3x4MultiplyAdd( b, wb, vector3x4Scale( a, wa ) ) );
+		const Vector3x4 diff = vector3x4Subtract( res.point, p );
+		res.distanceSquared = vector3x4Dot( diff, diff );
+		res.u = wb;
+		res.v = wc;
+		return res;
+	}
+
+	// Closest points on 4 triangles to 1 position
+	inline TriangleClosestPoint4 _AM_CALL_ closestPointOnTriangles( __m256d p, const Vector3x4& a, const Vector3x4& b, const Vector3x4& c )
+	{
+		return closestPointOnTriangle4( vector3x4Splat( p ), a, b, c );
+	}
+}
\ No newline at end of file
@@ -0,0 +1,402 @@
+#include "AvxMath.h"
+#include "AvxMathParallel.h"
+#include <atomic>
+#include <string.h>
+
+namespace AvxMath
+{
+	// These functions are limited by the memory bandwidth; 16 numbers per iteration, the remainder is converted one number at a time
+	void arrayFloatToDouble( const float* rsi, double* rdi, size_t length )
+	{
+		const float* const rsiEnd = rsi + ( length & ~(size_t)15 );
+		for( ; rsi < rsiEnd; rsi += 16, rdi += 16 )
+		{
+			const __m128 a = _mm_loadu_ps( rsi );
+			const __m128 b = _mm_loadu_ps( rsi + 4 );
+			const __m128 c = _mm_loadu_ps( rsi + 8 );
+			const __m128 d = _mm_loadu_ps( rsi + 12 );
+			_mm256_storeu_pd( rdi, _mm256_cvtps_pd( a ) );
+			_mm256_storeu_pd( rdi + 4, _mm256_cvtps_pd( b ) );
+			_mm256_storeu_pd( rdi + 8, _mm256_cvtps_pd( c ) );
+			_mm256_storeu_pd( rdi + 12, _mm256_cvtps_pd( d ) );
+		}
+		for( size_t i = 0; i < ( length & 15 ); i++ )
+			rdi[ i ] = rsi[ i ];
+	}
+
+	void arrayDoubleToFloat( const double* rsi, float* rdi, size_t length )
+	{
+		const double* const rsiEnd = rsi + ( length & ~(size_t)15 );
+		for( ; rsi < rsiEnd; rsi += 16, rdi += 16 )
+		{
+			const __m128 a = _mm256_cvtpd_ps( _mm256_loadu_pd( rsi ) );
+			const __m128 b = _mm256_cvtpd_ps( _mm256_loadu_pd( rsi + 4 ) );
+			const __m128 c = _mm256_cvtpd_ps( _mm256_loadu_pd( rsi + 8 ) );
+			const __m128 d = _mm256_cvtpd_ps( _mm256_loadu_pd( rsi + 12 ) );
+			_mm_storeu_ps( rdi, a );
+			_mm_storeu_ps( rdi + 4, b );
+			_mm_storeu_ps( rdi + 8, c );
+			_mm_storeu_ps( rdi + 12, d );
+		}
+		for( size_t i = 0; i < ( length & 15 ); i++ )
+			rdi[ i ] = (float)rsi[ i ];
+	}
+
+#if _AM_F16C_INTRINSICS_
+	namespace
+	{
+		inline __m256d halfToDouble( uint16_t h )
+		{
+			return _mm256_cvtps_pd( _mm_cvtph_ps( _mm_cvtsi32_si128( h ) ) );
+		}
+
+		inline __m128i doubleToHalf( __m256d v )
+		{
+			return _mm_cvtps_ph( _mm256_cvtpd_ps( v ), _MM_FROUND_TO_NEAREST_INT );
+		}
+	}
+
+	void arrayHalfToDouble( const uint16_t* rsi, double* rdi, size_t length )
+	{
+		const uint16_t* const rsiEnd = rsi + ( length & ~(size_t)15 );
+		for( ; rsi < rsiEnd; rsi += 16, rdi += 16 )
+		{
+			const __m256 a = _mm256_cvtph_ps( _mm_loadu_si128( ( const __m128i* )rsi ) );
+			const __m256 b = _mm256_cvtph_ps( _mm_loadu_si128( ( const __m128i* )( rsi + 8 ) ) );
+			_mm256_storeu_pd( rdi, _mm256_cvtps_pd( _mm256_castps256_ps128( a ) ) );
+			_mm256_storeu_pd( rdi + 4, _mm256_cvtps_pd( _mm256_extractf128_ps( a, 1 ) ) );
+			_mm256_storeu_pd( rdi + 8, _mm256_cvtps_pd( _mm256_castps256_ps128( b ) ) );
+			_mm256_storeu_pd( rdi + 12, _mm256_cvtps_pd( _mm256_extractf128_ps( b, 1 ) ) );
+		}
+		for( size_t i = 0; i < ( length & 15 ); i++ )
+			rdi[ i ] = _mm256_cvtsd_f64( halfToDouble( rsi[ i ] ) );
+	}
+
+	void arrayDoubleToHalf( const double* rsi, uint16_t* rdi, size_t length )
+	{
+		const double* const rsiEnd = rsi + ( length & ~(size_t)15 );
+		for( ; rsi < rsiEnd; rsi += 16, rdi += 16 )
+		{
+			const __m128i a = doubleToHalf( _mm256_loadu_pd( rsi ) );
+			const __m128i b = doubleToHalf( _mm256_loadu_pd( rsi + 4 ) );
+			const __m128i c = doubleToHalf( _mm256_loadu_pd( rsi + 8 ) );
+			const __m128i d = doubleToHalf( _mm256_loadu_pd( rsi + 12 ) );
+			_mm_storeu_si128( ( __m128i* )rdi, _mm_unpacklo_epi64( a, b ) );
+			_mm_storeu_si128( ( __m128i* )( rdi + 8 ), _mm_unpacklo_epi64( c, d ) );
+		}
+		for( size_t i = 0; i < ( length & 15 ); i++ )
+			rdi[ i ] = (uint16_t)_mm_extract_epi16( doubleToHalf( _mm256_set1_pd( rsi[ i ] ) ), 0 );
+	}
+#endif
+
+	namespace
+	{
+		// When running multithreaded, each thread gets at least that many points
+		constexpr size_t minParallelChunk = 1 << 16;
+
+		// The quantization processes blocks of 12 numbers, 6 2D points or 4 3D points, in 3 AVX vectors.
+		// The 3D origin repeats every 3 numbers, every vector of the block needs a different rotation of it.
+		struct QuantizeConstants
+		{
+			__m256d origin[ 3 ];
+			__m256d scale;
+
+			QuantizeConstants( __m128d origin2, double scale ) : scale( _mm256_set1_pd( scale ) )
+			{
+				origin[ 0 ] = origin[ 1 ] = origin[ 2 ] = dup2( origin2 );
+			}
+
+			QuantizeConstants( __m256d origin3, double scale ) : scale( _mm256_set1_pd( scale ) )
+			{
+				alignas( 32 ) double o[ 4 ];
+				_mm256_store_pd( o, origin3 );
+				origin[ 0 ] = _mm256_setr_pd( o[ 0 ], o[ 1 ], o[ 2 ], o[ 0 ] );
+				origin[ 1 ] = _mm256_setr_pd( o[ 1 ], o[ 2 ], o[ 0 ], o[ 1 ] );
+				origin[ 2 ] = _mm256_setr_pd( o[ 2 ], o[ 0 ], o[ 1 ], o[ 2 ] );
+			}
+		};
+
+		// Range of the integer types, as FP64 numbers; the upper limit of int64 is the largest FP64 number below 2^63.
+		// The numbers with magnitude up to the fast limit are converted without the checks.
+		template<class I>
+		struct IntegerRange;
+		template<>
+		struct IntegerRange<int32_t>
+		{
+			static constexpr double lower = -0x1p31;
+			static constexpr double upper = 0x1p31 - 1;
+			static constexpr double fast = 0x1p31 - 1;
+		};
+		template<>
+		struct IntegerRange<int64_t>
+		{
+			static constexpr double lower = -0x1p63;
+			static constexpr double upper = 0x1p63 - 1024;
+			static constexpr double fast = 0x1p51;
+		};
+
+		// Convert 4 integral numbers in [ -2^63 .. 2^63 ) range to int64
+		inline __m256i convertInt64( __m256d v )
+		{
+#if _AM_AVX2_INTRINSICS_
+			// AVX2 has no such instruction. The numbers are integral, shift the mantissa by the distance between the exponent and 52.
+			// Shifts by more than 63 bits, including the negative counts, produce 0: one of these 2 shifts is always 0.
+			const __m256i bits = _mm256_castpd_si256( v );
+			const __m256i exponent = _mm256_and_si256( _mm256_srli_epi64( bits, 52 ), _mm256_set1_epi64x( 0x7FF ) );
+			__m256i mantissa = _mm256_and_si256( bits, _mm256_set1_epi64x( 0xFFFFFFFFFFFFFll ) );
+			mantissa = _mm256_or_si256( mantissa, _mm256_set1_epi64x( 0x10000000000000ll ) );
+			const __m256i bias = _mm256_set1_epi64x( 1023 + 52 );
+			const __m256i left = _mm256_sllv_epi64( mantissa, _mm256_sub_epi64( exponent, bias ) );
+			const __m256i right = _mm256_srlv_epi64( mantissa, _mm256_sub_epi64( bias, exponent ) );
+			const __m256i abs = _mm256_or_si256( left, right );
+			// Negate where the sign bit is set: ( abs ^ -1 ) - -1
+			const __m256i negative = _mm256_cmpgt_epi64( _mm256_setzero_si256(), bits );
+			return _mm256_sub_epi64( _mm256_xor_si256( abs, negative ), negative );
+#else
+			const __m128d low = low2( v );
+			const __m128d high = high2( v );
+			return _mm256_setr_epi64x( _mm_cvtsd_si64( low ), _mm_cvtsd_si64( _mm_unpackhi_pd( low, low ) ),
+				_mm_cvtsd_si64( high ), _mm_cvtsd_si64( _mm_unpackhi_pd( high, high ) ) );
+#endif
+		}
+
+		// Convert 4 int64 numbers to FP64, rounding to nearest
+		inline __m256d convertDouble( __m256i v )
+		{
+#if _AM_AVX2_INTRINSICS_
+			// Split into the high 16 bits and the low 48 bits, make FP64 numbers with these bits in the mantissa, then add the two.
+			// The high part: 3 * 2^67 + signed high bits * 2^48, the low part: 2^52 + low bits; the subtraction is exact, the addition rounds once.
+			__m256i high = _mm256_srai_epi32( v, 16 );
+			high = _mm256_blend_epi16( high, _mm256_setzero_si256(), 0x33 );
+			high = _mm256_add_epi64( high, _mm256_castpd_si256( _mm256_set1_pd( 0x3p67 ) ) );
+			const __m256i low = _mm256_blend_epi16( v, _mm256_castpd_si256( _mm256_set1_pd( 0x1p52 ) ), 0x88 );
+			const __m256d h = _mm256_sub_pd( _mm256_castsi256_pd( high ), _mm256_set1_pd( 0x3p67 + 0x1p52 ) );
+			return _mm256_add_pd( h, _mm256_castsi256_pd( low ) );
+#else
+			const __m128i low = _mm256_castsi256_si128( v );
+			const __m128i high = _mm256_extractf128_si256( v, 1 );
+			return _mm256_setr_pd( (double)_mm_cvtsi128_si64( low ), (double)_mm_extract_epi64( low, 1 ),
+				(double)_mm_cvtsi128_si64( high ), (double)_mm_extract_epi64( high, 1 ) );
+#endif
+		}
+
+		inline void storeIntegers( int32_t* rdi, __m256d v, __m256d )
+		{
+			_mm_storeu_si128( ( __m128i* )rdi, _mm256_cvtpd_epi32( v ) );
+		}
+
+		inline void storeSmallIntegers( int32_t* rdi, __m256d v )
+		{
+			_mm_storeu_si128( ( __m128i* )rdi, _mm256_cvtpd_epi32( v ) );
+		}
+
+		// Integral numbers with magnitude up to 2^51: adding 1.5 * 2^52 is exact and places the number in the low bits of the mantissa
+		inline void storeSmallIntegers( int64_t* rdi, __m256d v )
+		{
+			const __m256d magic = _mm256_set1_pd( 0x1.8p52 );
+			const __m256d m = _mm256_add_pd( v, magic );
+#if _AM_AVX2_INTRINSICS_
+			_mm256_storeu_si256( ( __m256i* )rdi, _mm256_sub_epi64( _mm256_castpd_si256( m ), _mm256_castpd_si256( magic ) ) );
+#else
+			const __m128i mi = _mm_castpd_si128( low2( magic ) );
+			_mm_storeu_si128( ( __m128i* )rdi, _mm_sub_epi64( _mm_castpd_si128( low2( m ) ), mi ) );
+			_mm_storeu_si128( ( __m128i* )( rdi + 2 ), _mm_sub_epi64( _mm_castpd_si128( high2( m ) ), mi ) );
+#endif
+		}
+
+		// The too large numbers were clamped to the largest FP64 below 2^63, replace them with INT64_MAX
+		inline void storeIntegers( int64_t* rdi, __m256d v, __m256d tooLarge )
+		{
+			__m256d res = _mm256_castsi256_pd( convertInt64( v ) );
+			res = _mm256_blendv_pd( res, _mm256_castsi256_pd( _mm256_set1_epi64x( INT64_MAX ) ), tooLarge );
+			_mm256_storeu_si256( ( __m256i* )rdi, _mm256_castpd_si256( res ) );
+		}
+
+		inline __m256d loadIntegers( const int32_t* rsi )
+		{
+			return _mm256_cvtepi32_pd( _mm_loadu_si128( ( const __m128i* )rsi ) );
+		}
+
+		inline __m256d loadIntegers( const int64_t* rsi )
+		{
+			return convertDouble( _mm256_loadu_si256( ( const __m256i* )rsi ) );
+		}
+
+		// Quantize 4 rounded numbers, clamping them to the range; return the bitmap of the overflowed ones
+		template<class I>
+		inline uint32_t quantizeClamped( __m256d r, I* rdi )
+		{
+			const __m256d lower = _mm256_set1_pd( IntegerRange<I>::lower );
+			const __m256d upper = _mm256_set1_pd( IntegerRange<I>::upper );
+			const __m256d inRange = _mm256_and_pd( _mm256_cmp_pd( r, lower, _CMP_GE_OQ ), _mm256_cmp_pd( r, upper, _CMP_LE_OQ ) );
+			const __m256d tooLarge = _mm256_cmp_pd( r, upper, _CMP_GT_OQ );
+
+			// NaN to zero, then clamp
+			r = _mm256_and_pd( r, _mm256_cmp_pd( r, r, _CMP_ORD_Q ) );
+			r = _mm256_min_pd( _mm256_max_pd( r, lower ), upper );
+			storeIntegers( rdi, r, tooLarge );
+			return (uint32_t)_mm256_movemask_pd( inRange ) ^ 0b1111;
+		}
+
+		inline __m256d quantizeRound( const double* rsi, __m256d origin, __m256d scale )
+		{
+			const __m256d r = _mm256_mul_pd( _mm256_sub_pd( _mm256_loadu_pd( rsi ), origin ), scale );
+			return _mm256_round_pd( r, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC );
+		}
+
+		// Quantize 12 numbers, return the bitmap of the overflowed ones
+		template<class I>
+		inline uint32_t quantizeBlock( const double* rsi, const QuantizeConstants& c, I* rdi )
+		{
+			const __m256d r0 = quantizeRound( rsi, c.origin[ 0 ], c.scale );
+			const __m256d r1 = quantizeRound( rsi + 4, c.origin[ 1 ], c.scale );
+			const __m256d r2 = quantizeRound( rsi + 8, c.origin[ 2 ], c.scale );
+
+			// Usually, all 12 numbers are well within the range
+			const __m256d signBit = broadcast( g_misc.negativeZero );
+			const __m256d fast = _mm256_set1_pd( IntegerRange<I>::fast );
+			__m256d small = _mm256_cmp_pd( _mm256_andnot_pd( signBit, r0 ), fast, _CMP_LE_OQ );
+			small = _mm256_and_pd( small, _mm256_cmp_pd( _mm256_andnot_pd( signBit, r1 ), fast, _CMP_LE_OQ ) );
+			small = _mm256_and_pd( small, _mm256_cmp_pd( _mm256_andnot_pd( signBit, r2 ), fast, _CMP_LE_OQ ) );
+			if( 0b1111 == _mm256_movemask_pd( small ) )
+			{
+				storeSmallIntegers( rdi, r0 );
+				storeSmallIntegers( rdi + 4, r1 );
+				storeSmallIntegers( rdi + 8, r2 );
+				return 0;
+			}
+
+			uint32_t res = quantizeClamped( r0, rdi );
+			res |= quantizeClamped( r1, rdi + 4 ) << 4;
+			res |= quantizeClamped( r2, rdi + 8 ) << 8;
+			return res;
+		}
+
+		// Split the bitmap of the overflowed numbers into the bytes of the points, return count of the points with any bits set
+		template<size_t dims>
+		inline size_t overflowPoints( uint32_t bits, size_t points, uint8_t* overflow )
+		{
+			constexpr uint32_t pointMask = ( 1u << dims ) - 1;
+			size_t res = 0;
+			for( size_t i = 0; i < points; i++, bits >>= dims )
+			{
+				const uint32_t b = bits & pointMask;
+				res += ( 0 != b ) ? 1 : 0;
+				if( nullptr != overflow )
+					overflow[ i ] = (uint8_t)b;
+			}
+			return res;
+		}
+
+		template<size_t dims, class I>
+		size_t quantizeSpan( const double* rsi, size_t count, const QuantizeConstants& c, I* rdi, uint8_t* overflow )
+		{
+			constexpr size_t blockPoints = 12 / dims;
+			size_t res = 0;
+			for( ; count >= blockPoints; count -= blockPoints, rsi += 12, rdi += 12 )
+			{
+				const uint32_t bits = quantizeBlock( rsi, c, rdi );
+				if( 0 != bits )
+					res += overflowPoints<dims>( bits, blockPoints, overflow );
+				else if( nullptr != overflow )
+					memset( overflow, 0, blockPoints );
+				if( nullptr != overflow )
+					overflow += blockPoints;
+			}
+			if( 0 == count )
+				return res;
+
+			// The remainder goes through local buffers, the unused numbers are zeros
+			double source[ 12 ] = {};
+			I dest[ 12 ];
+			memcpy( source, rsi, count * dims * sizeof( double ) );
+			const uint32_t bits = quantizeBlock( source, c, dest );
+			memcpy( rdi, dest, count * dims * sizeof( I ) );
+			return res + overflowPoints<dims>( bits, count, overflow );
+		}
+
+		template<size_t dims, class I>
+		void dequantizeSpan( const I* rsi, size_t count, const QuantizeConstants& c, __m256d invScale, double* rdi )
+		{
+			constexpr size_t blockPoints = 12 / dims;
+			for( ; count >= blockPoints; count -= blockPoints, rsi += 12, rdi += 12 )
+			{
+				_mm256_storeu_pd( rdi, vectorMultiplyAdd( loadIntegers( rsi ), invScale, c.origin[ 0 ] ) );
+				_mm256_storeu_pd( rdi + 4, vectorMultiplyAdd( loadIntegers( rsi + 4 ), invScale, c.origin[ 1 ] ) );
+				_mm256_storeu_pd( rdi + 8, vectorMultiplyAdd( loadIntegers( rsi + 8 ), invScale, c.origin[ 2 ] ) );
+			}
+			if( 0 == count )
+				return;
+			I source[ 12 ] = {};
+			double dest[ 12 ];
+			memcpy( source, rsi, count * dims * sizeof( I ) );
+			dequantizeSpan<dims>( source, blockPoints, c, invScale, dest );
+			memcpy( rdi, dest, count * dims * sizeof( double ) );
+		}
+
+		template<size_t dims, class I, class Origin>
+		size_t quantize( const double* rsi, size_t count, Origin origin, double scale, I* rdi, uint8_t* overflow, bool parallel )
+		{
+			const QuantizeConstants c{ origin, scale };
+			if( !parallel )
+				return quantizeSpan<dims>( rsi, count, c, rdi, overflow );
+
+			// The chunks start at the points, the rotations of the origin are the same for every chunk
+			std::atomic<size_t> res{ 0 };
+			parallelFor( count, minParallelChunk, [ & ]( size_t begin, size_t end )
+			{
+				const size_t n = quantizeSpan<dims>( rsi + begin * dims, end - begin, c, rdi + begin * dims, ( nullptr != overflow ) ? overflow + begin : nullptr );
+				if( 0 != n )
+					res += n;
+			} );
+			return res;
+		}
+
+		template<size_t dims, class I, class Origin>
+		void dequantize( const I* rsi, size_t count, Origin origin, double scale, double* rdi, bool parallel )
+		{
+			const QuantizeConstants c{ origin, scale };
+			const __m256d invScale = _mm256_set1_pd( 1.0 / scale );
+			if( !parallel )
+				return dequantizeSpan<dims>( rsi, count, c, invScale, rdi );
+			parallelFor( count, minParallelChunk, [ & ]( size_t begin, size_t end )
+			{
+				dequantizeSpan<dims>( rsi + begin * dims, end - begin, c, invScale, rdi + begin * dims );
+			} );
+		}
+	}
+
+	size_t array2Quantize( const double* rsi, size_t count, __m128d origin, double scale, int32_t* rdi, uint8_t* overflow, bool parallel )
+	{
+		return quantize<2>( rsi, count, origin, scale, rdi, overflow, parallel );
+	}
+	size_t array2Quantize( const double* rsi, size_t count, __m128d origin, double scale, int64_t* rdi, uint8_t* overflow, bool parallel )
+	{
+		return quantize<2>( rsi, count, origin, scale, rdi, overflow, parallel );
+	}
+	size_t array3Quantize( const double* rsi, size_t count, __m256d origin, double scale, int32_t* rdi, uint8_t* overflow, bool parallel )
+	{
+		return quantize<3>( rsi, count, origin, scale, rdi, overflow, parallel );
+	}
+	size_t array3Quantize( const double* rsi, size_t count, __m256d origin, double scale, int64_t* rdi, uint8_t* overflow, bool parallel )
+	{
+		return quantize<3>( rsi, count, origin, scale, rdi, overflow, parallel );
+	}
+
+	void array2Dequantize( const int32_t* rsi, size_t count, __m128d origin, double scale, double* rdi, bool parallel )
+	{
+		dequantize<2>( rsi, count, origin, scale, rdi, parallel );
+	}
+	void array2Dequantize( const int64_t* rsi, size_t count, __m128d origin, double scale, double* rdi, bool parallel )
+	{
+		dequantize<2>( rsi, count, origin, scale, rdi, parallel );
+	}
+	void array3Dequantize( const int32_t* rsi, size_t count, __m256d origin, double scale, double* rdi, bool parallel )
+	{
+		dequantize<3>( rsi, count, origin, scale, rdi, parallel );
+	}
+	void array3Dequantize( const int64_t* rsi, size_t count, __m256d origin, double scale, double* rdi, bool parallel )
+	{
+		dequantize<3>( rsi, count, origin, scale, rdi, parallel );
+	}
+}
\ No newline at end of file
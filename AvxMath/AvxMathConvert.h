@@ -0,0 +1,35 @@
+// Batch conversions between FP64 and the smaller floating point formats.
+// To convert while loading or storing 3D and 4D vectors, see loadFloat3, loadVector3x4 and the pipelines.
+#pragma once
+
+namespace AvxMath
+{
+	// Convert FP32 numbers to FP64, exactly
+	void arrayFloatToDouble( const float* rsi, double* rdi, size_t length );
+	// Convert FP64 numbers to FP32, rounding to nearest; the numbers outside of the FP32 range become infinities
+	void arrayDoubleToFloat( const double* rsi, float* rdi, size_t length );
+
+#if _AM_F16C_INTRINSICS_
+	// Convert FP16 numbers to FP64, exactly; the uint16_t elements are bits of the FP16 numbers
+	void arrayHalfToDouble( const uint16_t* rsi, double* rdi, size_t length );
+	// Convert FP64 numbers to FP16, rounding twice like storeHalf4; the numbers outside of the FP16 range become infinities
+	void arrayDoubleToHalf( const double* rsi, uint16_t* rdi, size_t length );
+#endif
+
+	// ==== Quantization to integer coordinates ====
+	// The arrays have count points, 2 or 3 numbers per point. The integer coordinates are round( ( value - origin ) * scale ), rounding to nearest even like lround.
+	// The components outside of the range of the integer type are clamped to the limits of that type, NaN become 0.
+	// The optional overflow array receives a byte per point, with bit #i set when the component #i was outside of the range or NaN.
+	// Returns count of the points with at least 1 such component. With parallel = true, large arrays are split across the hardware threads.
+
+	size_t array2Quantize( const double* rsi, size_t count, __m128d origin, double scale, int32_t* rdi, uint8_t* overflow = nullptr, bool parallel = false );
+	size_t array2Quantize( const double* rsi, size_t count, __m128d origin, double scale, int64_t* rdi, uint8_t* overflow = nullptr, bool parallel = false );
+	size_t array3Quantize( const double* rsi, size_t count, __m256d origin, double scale, int32_t* rdi, uint8_t* overflow = nullptr, bool parallel = false );
+	size_t array3Quantize( const double* rsi, size_t count, __m256d origin, double scale, int64_t* rdi, uint8_t* overflow = nullptr, bool parallel = false );
+
+	// Inverse of the quantization, value = integer * ( 1 / scale ) + origin
+	void array2Dequantize( const int32_t* rsi, size_t count, __m128d origin, double scale, double* rdi, bool parallel = false );
+	void array2Dequantize( const int64_t* rsi, size_t count, __m128d origin, double scale, double* rdi, bool parallel = false );
+	void array3Dequantize( const int32_t* rsi, size_t count, __m256d origin, double scale, double* rdi, bool parallel = false );
+	void array3Dequantize( const int64_t* rsi, size_t count, __m256d origin, double scale, double* rdi, bool parallel = false );
+}
\ No newline at end of file
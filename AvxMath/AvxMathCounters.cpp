@@ -0,0 +1,107 @@
+#include "AvxMath.h"
+#if _AM_COUNTERS_
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#endif
+
+namespace AvxMath
+{
+#if _AM_COUNTERS_
+	namespace
+	{
+		// Counters of the running threads, and the totals of the threads which exited
+		struct Registry
+		{
+			std::mutex mutex;
+			std::vector<details::ThreadCounters*> threads;
+			uint64_t exited[ countersCount ] = {};
+		};
+
+		// Never destroyed: the threads of the pool, and other threads the program didn't join, may exit after the static objects are destroyed
+		Registry& registry()
+		{
+			static Registry& r = *new Registry;
+			return r;
+		}
+
+		// Registers the counters of the thread on the first use, adds them to the totals when the thread exits
+		struct ThreadEntry
+		{
+			details::ThreadCounters counters;
+
+			ThreadEntry()
+			{
+				for( auto& v : counters.values )
+					v.store( 0, std::memory_order_relaxed );
+				Registry& r = registry();
+				std::lock_guard<std::mutex> lock{ r.mutex };
+				r.threads.push_back( &counters );
+			}
+
+			~ThreadEntry()
+			{
+				Registry& r = registry();
+				std::lock_guard<std::mutex> lock{ r.mutex };
+				for( size_t i = 0; i < countersCount; i++ )
+					r.exited[ i ] += counters.values[ i ].load( std::memory_order_relaxed );
+				r.threads.erase( std::find( r.threads.begin(), r.threads.end(), &counters ) );
+			}
+		};
+
+		void addValues( CounterValues& result, const details::ThreadCounters& counters )
+		{
+			for( size_t i = 0; i < countersCount; i++ )
+				result.values[ i ] += counters.values[ i ].load( std::memory_order_relaxed );
+		}
+	}
+
+	details::ThreadCounters& details::threadCounters()
+	{
+		thread_local ThreadEntry entry;
+		return entry.counters;
+	}
+
+	CounterValues countersSnapshot()
+	{
+		Registry& r = registry();
+		std::lock_guard<std::mutex> lock{ r.mutex };
+		CounterValues result;
+		for( size_t i = 0; i < countersCount; i++ )
+			result.values[ i ] = r.exited[ i ];
+		for( const details::ThreadCounters* counters : r.threads )
+			addValues( result, *counters );
+		return result;
+	}
+
+	CounterValues threadCountersSnapshot()
+	{
+		CounterValues result;
+		addValues( result, details::threadCounters() );
+		return result;
+	}
+
+	void countersReset()
+	{
+		Registry& r = registry();
+		std::lock_guard<std::mutex> lock{ r.mutex };
+		for( uint64_t& v : r.exited )
+			v = 0;
+		for( details::ThreadCounters* counters : r.threads )
+			for( auto& v : counters->values )
+				v.store( 0, std::memory_order_relaxed );
+	}
+#else
+	CounterValues countersSnapshot()
+	{
+		return CounterValues{};
+	}
+
+	CounterValues threadCountersSnapshot()
+	{
+		return CounterValues{};
+	}
+
+	void countersReset() { }
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+// Optional counters of the slow and degenerate code paths, to find out whether unusual input data is the cause of performance problems.
+// Disabled by default. To enable, define _AM_COUNTERS_ to 1 for both the library and the code which includes AvxMath.h; without that macro, the counting compiles to nothing.
+#pragma once
+#if _AM_COUNTERS_
+#include <atomic>
+#endif
+
+namespace AvxMath
+{
+	enum struct eCounter : uint8_t
+	{
+		// vector2Normalize, vector3Normalize, vector4Normalize and quaternionNormalize got a vector of zero length, or with NaN coordinates
+		NormalizeZero,
+		// The normalize functions got a vector of infinite length
+		NormalizeInfinite,
+		// Angles of the trigonometric functions where the range reduction loses precision: magnitude above 2^19 * pi, infinities and NaN. Counted per lane.
+		AngleOutOfRange,
+		// Queries of the robust predicates which fell back to the exact arithmetic
+		RobustExact,
+	};
+	constexpr size_t countersCount = 4;
+
+	// Values of all counters, indexed by eCounter
+	struct CounterValues
+	{
+		uint64_t values[ countersCount ] = {};
+
+		uint64_t operator[]( eCounter c ) const { return values[ (size_t)c ]; }
+	};
+
+#if _AM_COUNTERS_
+	constexpr bool countersEnabled = true;
+#else
+	constexpr bool countersEnabled = false;
+#endif
+
+	// Sum of the counters of all threads, including the threads which already exited. All zeros when the counters are disabled.
+	CounterValues countersSnapshot();
+	// Counters of the calling thread
+	CounterValues threadCountersSnapshot();
+	// Reset the counters of all threads; the increments which happen on other threads at the same time may survive the reset
+	void countersReset();
+
+#if _AM_COUNTERS_
+	namespace details
+	{
+		// Only the owner thread increments these values, the atomics make it safe to read them from other threads
+		struct ThreadCounters
+		{
+			std::atomic<uint64_t> values[ countersCount ];
+		};
+
+		ThreadCounters& threadCounters();
+	}
+
+	// Increment the counter of the calling thread, without locked instructions
+	inline void countEvent( eCounter c, uint64_t count = 1 )
+	{
+		std::atomic<uint64_t>& v = details::threadCounters().values[ (size_t)c ];
+		v.store( v.load( std::memory_order_relaxed ) + count, std::memory_order_relaxed );
+	}
+#else
+	inline void countEvent( eCounter, uint64_t = 1 ) { }
+#endif
+
+	// Increment the counter by count of the lanes with the sign bit set in the mask
+	inline void countLanes( eCounter c, __m256d mask )
+	{
+		if constexpr( countersEnabled )
+		{
+			const uint32_t bits = (uint32_t)_mm256_movemask_pd( mask );
+			if( 0 != bits )
+				countEvent( c, ( bits & 1 ) + ( ( bits >> 1 ) & 1 ) + ( ( bits >> 2 ) & 1 ) + ( bits >> 3 ) );
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include "AvxMath.h"
+#include <string.h>
+
+namespace AvxMath
+{
+	Frustum frustumFromPlanes( const __m256d* planes )
+	{
+		Frustum f;
+		for( size_t i = 0; i < 6; i++ )
+		{
+			const __m256d p = planeNormalize( planes[ i ] );
+			_mm256_store_pd( f.planes[ i ], p );
+			_mm256_store_pd( f.absNormals[ i ], _mm256_blend_pd( vectorAbs( p ), _mm256_setzero_pd(), 0b1000 ) );
+		}
+		return f;
+	}
+
+	Frustum frustumFromMatrix( const Matrix4x4& m )
+	{
+		// The rows of the matrix compute x, y, z, w of the clip space; x >= -w is the same as dot( r0 + r3, pos ) >= 0, and so on
+		__m256d planes[ 6 ];
+		planes[ 0 ] = _mm256_add_pd( m.r3, m.r0 );
+		planes[ 1 ] = _mm256_sub_pd( m.r3, m.r0 );
+		planes[ 2 ] = _mm256_add_pd( m.r3, m.r1 );
+		planes[ 3 ] = _mm256_sub_pd( m.r3, m.r1 );
+		planes[ 4 ] = m.r2;
+		planes[ 5 ] = _mm256_sub_pd( m.r3, m.r2 );
+		return frustumFromPlanes( planes );
+	}
+
+	namespace
+	{
+		// Lookup table to compact indices of the visible objects, for every 4-bit mask of the visible lanes
+		struct CompactTable
+		{
+			alignas( 16 ) uint32_t indices[ 16 ][ 4 ];
+			uint8_t counts[ 16 ];
+
+			// The argument has index of the object in every lane
+			CompactTable( const uint32_t* laneObjects )
+			{
+				for( uint32_t mask = 0; mask < 16; mask++ )
+				{
+					uint32_t objects[ 4 ];
+					uint32_t count = 0;
+					for( uint32_t obj = 0; obj < 4; obj++ )
+						for( uint32_t lane = 0; lane < 4; lane++ )
+							if( laneObjects[ lane ] == obj && 0 != ( mask & ( 1u << lane ) ) )
+								objects[ count++ ] = obj;
+					for( uint32_t i = 0; i < 4; i++ )
+						indices[ mask ][ i ] = i < count ? objects[ i ] : 0;
+					counts[ mask ] = (uint8_t)count;
+				}
+			}
+
+			// Write indices of the visible objects; this writes 4 integers regardless of the mask, the output must have space for them
+			size_t store( uint32_t* rdi, uint32_t first, int mask ) const
+			{
+				const __m128i i = _mm_load_si128( ( const __m128i* )indices[ mask ] );
+				_mm_storeu_si128( ( __m128i* )rdi, _mm_add_epi32( i, _mm_set1_epi32( (int)first ) ) );
+				return counts[ mask ];
+			}
+
+			// Write indices of the visible objects, for the last incomplete batch
+			size_t storePartial( uint32_t* rdi, uint32_t first, int mask ) const
+			{
+				const size_t count = counts[ mask ];
+				for( size_t i = 0; i < count; i++ )
+					rdi[ i ] = first + indices[ mask ][ i ];
+				return count;
+			}
+		};
+
+		// Boxes are loaded into the lanes in the order 0, 2, 1, 3
+		const uint32_t boxLanes[ 4 ] = { 0, 2, 1, 3 };
+		const CompactTable boxesTable{ boxLanes };
+		const uint32_t sphereLanes[ 4 ] = { 0, 1, 2, 3 };
+		const CompactTable spheresTable{ sphereLanes };
+
+		// Load 4 boxes, 24 doubles, and test them against the frustum
+		inline int testBoxes( const Frustum& frustum, const double* rsi )
+		{
+			// Lanes of these vectors are min0, max0, min1, max1, and min2, max2, min3, max3
+			const Vector3x4 a = loadVector3x4( rsi );
+			const Vector3x4 b = loadVector3x4( rsi + 12 );
+			// Lanes are boxes 0, 2, 1, 3
+			const Vector3x4 min{ _mm256_unpacklo_pd( a.x, b.x ), _mm256_unpacklo_pd( a.y, b.y ), _mm256_unpacklo_pd( a.z, b.z ) };
+			const Vector3x4 max{ _mm256_unpackhi_pd( a.x, b.x ), _mm256_unpackhi_pd( a.y, b.y ), _mm256_unpackhi_pd( a.z, b.z ) };
+
+			const __m256d half = broadcast( g_misc.oneHalf );
+			const Vector3x4 center = vector3x4Scale( vector3x4Add( min, max ), half );
+			const Vector3x4 extent = vector3x4Scale( vector3x4Subtract( max, min ), half );
+			return _mm256_movemask_pd( frustumBoxesVisible( frustum, center, extent ) );
+		}
+
+		// Load 4 spheres, 16 doubles, and test them against the frustum
+		inline int testSpheres( const Frustum& frustum, const double* rsi )
+		{
+			Matrix4x4 m;
+			m.r0 = _mm256_loadu_pd( rsi );
+			m.r1 = _mm256_loadu_pd( rsi + 4 );
+			m.r2 = _mm256_loadu_pd( rsi + 8 );
+			m.r3 = _mm256_loadu_pd( rsi + 12 );
+			matrixTranspose( m );
+			return _mm256_movemask_pd( frustumSpheresVisible( frustum, Vector3x4{ m.r0, m.r1, m.r2 }, m.r3 ) );
+		}
+	}
+
+	size_t frustumCullBoxes( const Frustum& frustum, const double* boxes, size_t count, uint32_t* visible )
+	{
+		assert( count < UINT32_MAX );
+		uint32_t* const begin = visible;
+		// The compacting stores may alias anything, a local copy of the frustum allows to keep the planes in registers
+		const Frustum f = frustum;
+		const size_t countAligned = count & ~(size_t)3;
+		const double* rsi = boxes;
+		for( size_t i = 0; i < countAligned; i += 4, rsi += 24 )
+			visible += boxesTable.store( visible, (uint32_t)i, testBoxes( f, rsi ) );
+
+		const size_t rem = count - countAligned;
+		if( 0 != rem )
+		{
+			// Copy the remainder to the local buffer, padding with zeros
+			double buffer[ 24 ] = {};
+			memcpy( buffer, rsi, rem * 6 * sizeof( double ) );
+			// Lanes of the first rem boxes, in the 0, 2, 1, 3 order
+			const int lanes = ( 1 == rem ) ? 0b0001 : ( ( 2 == rem ) ? 0b0101 : 0b0111 );
+			visible += boxesTable.storePartial( visible, (uint32_t)countAligned, testBoxes( f, buffer ) & lanes );
+		}
+		return (size_t)( visible - begin );
+	}
+
+	size_t frustumCullSpheres( const Frustum& frustum, const double* spheres, size_t count, uint32_t* visible )
+	{
+		assert( count < UINT32_MAX );
+		uint32_t* const begin = visible;
+		// The compacting stores may alias anything, a local copy of the frustum allows to keep the planes in registers
+		const Frustum f = frustum;
+		const size_t countAligned = count & ~(size_t)3;
+		const double* rsi = spheres;
+		for( size_t i = 0; i < countAligned; i += 4, rsi += 16 )
+			visible += spheresTable.store( visible, (uint32_t)i, testSpheres( f, rsi ) );
+
+		const size_t rem = count - countAligned;
+		if( 0 != rem )
+		{
+			double buffer[ 16 ] = {};
+			memcpy( buffer, rsi, rem * 4 * sizeof( double ) );
+			const int mask = testSpheres( f, buffer ) & (int)( ( 1u << rem ) - 1 );
+			visible += spheresTable.storePartial( visible, (uint32_t)countAligned, mask );
+		}
+		return (size_t)( visible - begin );
+	}
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+// Planes, and culling of bounding boxes and spheres against view frustums
+#pragma once
+
+namespace AvxMath
+{
+	// Normalize the plane [ a, b, c, d ] so the length of the normal is 1.0. For a plane with zero normal, returns zero vector.
+	inline __m256d planeNormalize( __m256d plane )
+	{
+		const __m128d lsq = vector3Dot2( plane, plane );
+		if( _mm_cvtsd_f64( lsq ) > 0 )
+			return _mm256_div_pd( plane, dup2( _mm_sqrt_pd( lsq ) ) );
+		return _mm256_setzero_pd();
+	}
+
+	// Normalized plane which contains the 3 points. Looking from the positive side of the plane, the points are counter-clockwise.
+	inline __m256d planeFromPoints( __m256d a, __m256d b, __m256d c )
+	{
+		const __m256d n = vector3Normalize( vector3Cross( _mm256_sub_pd( b, a ), _mm256_sub_pd( c, a ) ) );
+		const __m256d d = vectorNegate( vector3Dot( n, a ) );
+		return _mm256_blend_pd( n, d, 0b1000 );
+	}
+
+	// Compute a * x + b * y + c * z + d, the signed distance from the point to the normalized plane, broadcast to all 4 lanes
+	inline __m256d planeDotCoord( __m256d plane, __m256d point )
+	{
+		return vector4Dot( plane, vector3Homogeneous( point ) );
+	}
+
+	// View frustum for culling, the intersection of the positive half-spaces of 6 planes
+	struct alignas( 32 ) Frustum
+	{
+		// Normalized planes [ a, b, c, d ], in the order left, right, bottom, top, near, far
+		double planes[ 6 ][ 4 ];
+		// Absolute values of the plane normals, for the box tests
+		double absNormals[ 6 ][ 4 ];
+	};
+
+	// Make the frustum from 6 planes, the normals must point inside. The planes don't need to be normalized.
+	Frustum frustumFromPlanes( const __m256d* planes );
+
+	// Extract the frustum from the view * projection matrix, Gribb, Hartmann, "Fast Extraction of Viewing Frustum Planes from the World-View-Projection Matrix".
+	// The matrix should transform with vector4Transform, and map the visible volume into -w <= x <= w, -w <= y <= w, 0 <= z <= w.
+	Frustum frustumFromMatrix( const Matrix4x4& viewProj );
+
+	// Test 4 bounding boxes against the frustum, returns mask of the visible ones.
+	// The test is conservative: a box is culled when it's completely outside one of the planes, boxes near the corners of the frustum may be visible while outside.
+	// Boxes with NaN coordinates are visible.
+	inline __m256d _AM_CALL_ frustumBoxesVisible( const Frustum& frustum, const Vector3x4& center, const Vector3x4& extent )
+	{
+		__m256d visible = _mm256_castsi256_pd( _mm256_set1_epi32( -1 ) );
+		for( size_t i = 0; i < 6; i++ )
+		{
+			const double* p = frustum.planes[ i ];
+			const double* n = frustum.absNormals[ i ];
+			// Distance from the center to the plane, plus the projection of the extent on the normal; 2 shorter dependency chains
+			__m256d dist = vectorMultiplyAdd( center.x, _mm256_set1_pd( p[ 0 ] ), _mm256_set1_pd( p[ 3 ] ) );
+			__m256d radius = _mm256_mul_pd( extent.x, _mm256_set1_pd( n[ 0 ] ) );
+			dist = vectorMultiplyAdd( center.y, _mm256_set1_pd( p[ 1 ] ), dist );
+			radius = vectorMultiplyAdd( extent.y, _mm256_set1_pd( n[ 1 ] ), radius );
+			dist = vectorMultiplyAdd( center.z, _mm256_set1_pd( p[ 2 ] ), dist );
+			radius = vectorMultiplyAdd( extent.z, _mm256_set1_pd( n[ 2 ] ), radius );
+			dist = _mm256_add_pd( dist, radius );
+			// Compare for dist >= 0 but we want NAN to result in TRUE, same as vector4InBounds
+			visible = _mm256_and_pd( visible, _mm256_cmp_pd( dist, _mm256_setzero_pd(), _CMP_NLT_UQ ) );
+		}
+		return visible;
+	}
+
+	// Test 4 bounding spheres against the frustum, returns mask of the visible ones.
+	// Same as boxes, spheres near the corners of the frustum may be visible while outside. Spheres with NaN coordinates are visible.
+	inline __m256d _AM_CALL_ frustumSpheresVisible( const Frustum& frustum, const Vector3x4& center, __m256d radius )
+	{
+		__m256d visible = _mm256_castsi256_pd( _mm256_set1_epi32( -1 ) );
+		for( size_t i = 0; i < 6; i++ )
+		{
+			const double* p = frustum.planes[ i ];
+			__m256d dist = vectorMultiplyAdd( center.x, _mm256_set1_pd( p[ 0 ] ), _mm256_set1_pd( p[ 3 ] ) );
+			dist = vectorMultiplyAdd( center.y, _mm256_set1_pd( p[ 1 ] ), dist );
+			dist = vectorMultiplyAdd( center.z, _mm256_set1_pd( p[ 2 ] ), dist );
+			visible = _mm256_and_pd( visible, _mm256_cmp_pd( _mm256_add_pd( dist, radius ), _mm256_setzero_pd(), _CMP_NLT_UQ ) );
+		}
+		return visible;
+	}
+
+	// Cull an array of axis-aligned bounding boxes, 6 doubles per box: min.xyz, max.xyz.
+	// Writes indices of the visible boxes in ascending order, returns the count of them. The output buffer must have space for count indices.
+	size_t frustumCullBoxes( const Frustum& frustum, const double* boxes, size_t count, uint32_t* visible );
+
+	// Cull an array of bounding spheres, 4 doubles per sphere: center.xyz, radius.
+	// Writes indices of the visible spheres in ascending order, returns the count of them. The output buffer must have space for count indices.
+	size_t frustumCullSpheres( const Frustum& frustum, const double* spheres, size_t count, uint32_t* visible );
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "AvxMath.h"
+
+namespace AvxMath
+{
+	namespace
+	{
+		// Compensated accumulator, Ogita, Rump, Oishi, "Accurate Sum and Dot Product", 2005.
+		// The rounding errors of the running sum are accumulated separately, the result is about as accurate as if computed in double-double precision.
+		// This is much cheaper than ddAdd on every step, the latency of the dependency chain is a single addition.
+		struct Accumulator
+		{
+			__m256d sum = _mm256_setzero_pd();
+			__m256d err = _mm256_setzero_pd();
+
+			void add( __m256d x )
+			{
+				__m256d e;
+				sum = twoSum( sum, x, e );
+				err = _mm256_add_pd( err, e );
+			}
+
+			// Add the exact product, hi + lo
+			void add( __m256d hi, __m256d lo )
+			{
+				__m256d e;
+				sum = twoSum( sum, hi, e );
+				err = _mm256_add_pd( err, _mm256_add_pd( e, lo ) );
+			}
+
+			DoubleDouble4 result() const
+			{
+				// After cancellations, the error term can exceed the sum
+				return ddFromSum( sum, err );
+			}
+		};
+
+		// Combine the 2 accumulators, then the 4 lanes
+		inline DoubleDouble4 finish( const Accumulator& a, const Accumulator& b )
+		{
+			return ddHorizontalSum( ddAdd( a.result(), b.result() ) );
+		}
+	}
+
+	DoubleDouble4 ddSum( const double* a, size_t length )
+	{
+		// 2 independent accumulators to hide the latency of the additions
+		Accumulator acc0, acc1;
+		const double* const end = a + length;
+		for( ; a + 8 <= end; a += 8 )
+		{
+			acc0.add( _mm256_loadu_pd( a ) );
+			acc1.add( _mm256_loadu_pd( a + 4 ) );
+		}
+		if( a + 4 <= end )
+		{
+			acc0.add( _mm256_loadu_pd( a ) );
+			a += 4;
+		}
+		if( a < end )
+			acc1.add( loadPartial( a, end - a ) );
+		return finish( acc0, acc1 );
+	}
+
+	DoubleDouble4 ddDot( const double* a, const double* b, size_t length )
+	{
+		Accumulator acc0, acc1;
+		__m256d hi, lo;
+		size_t i = 0;
+		for( ; i + 8 <= length; i += 8 )
+		{
+			hi = twoProduct( _mm256_loadu_pd( a + i ), _mm256_loadu_pd( b + i ), lo );
+			acc0.add( hi, lo );
+			hi = twoProduct( _mm256_loadu_pd( a + i + 4 ), _mm256_loadu_pd( b + i + 4 ), lo );
+			acc1.add( hi, lo );
+		}
+		if( i + 4 <= length )
+		{
+			hi = twoProduct( _mm256_loadu_pd( a + i ), _mm256_loadu_pd( b + i ), lo );
+			acc0.add( hi, lo );
+			i += 4;
+		}
+		if( i < length )
+		{
+			hi = twoProduct( loadPartial( a + i, length - i ), loadPartial( b + i, length - i ), lo );
+			acc1.add( hi, lo );
+		}
+		return finish( acc0, acc1 );
+	}
+}
\ No newline at end of file
@@ -0,0 +1,245 @@
+// Double-double arithmetic: 4 numbers with about 106 bits of mantissa, in 2 AVX registers
+#pragma once
+
+namespace AvxMath
+{
+	// 4 double-double numbers, the value of lane i is hi[ i ] + lo[ i ]. Normalized numbers have |lo| <= ulp( hi ) / 2.
+	// The algorithms are from the QD library, Hida, Li, Bailey, "Library for Double-Double and Quad-Double Arithmetic", 2007.
+	// They don't handle overflow nor NaN in the low parts; infinity and NaN inputs produce NaN in most cases.
+	struct DoubleDouble4
+	{
+		__m256d hi, lo;
+	};
+
+	// ==== Error-free transforms ====
+
+	// a + b = sum + err exactly
+	inline __m256d _AM_CALL_ twoSum( __m256d a, __m256d b, __m256d& err )
+	{
+		const __m256d s = _mm256_add_pd( a, b );
+		const __m256d bv = _mm256_sub_pd( s, a );
+		const __m256d av = _mm256_sub_pd( s, bv );
+		err = _mm256_add_pd( _mm256_sub_pd( a, av ), _mm256_sub_pd( b, bv ) );
+		return s;
+	}
+
+	// a + b = sum + err exactly, requires |a| >= |b| or a == 0
+	inline __m256d _AM_CALL_ fastTwoSum( __m256d a, __m256d b, __m256d& err )
+	{
+		const __m256d s = _mm256_add_pd( a, b );
+		err = _mm256_sub_pd( b, _mm256_sub_pd( s, a ) );
+		return s;
+	}
+
+	// a * b = product + err exactly, unless the product underflows
+	inline __m256d _AM_CALL_ twoProduct( __m256d a, __m256d b, __m256d& err )
+	{
+		const __m256d p = _mm256_mul_pd( a, b );
+#if _AM_FMA3_INTRINSICS_ || defined( __FMA__ )
+		err = _mm256_fmsub_pd( a, b, p );
+#else
+		// Dekker's algorithm, split both numbers into 26-bit halves which can be multiplied without rounding.
+		// Without FMA in the instruction set, the compiler can't contract these multiplications.
+		const __m256d splitter = _mm256_set1_pd( 134217729.0 ); // 2^27 + 1
+		__m256d t = _mm256_mul_pd( splitter, a );
+		const __m256d ahi = _mm256_sub_pd( t, _mm256_sub_pd( t, a ) );
+		const __m256d alo = _mm256_sub_pd( a, ahi );
+		t = _mm256_mul_pd( splitter, b );
+		const __m256d bhi = _mm256_sub_pd( t, _mm256_sub_pd( t, b ) );
+		const __m256d blo = _mm256_sub_pd( b, bhi );
+		err = _mm256_sub_pd( _mm256_mul_pd( ahi, bhi ), p );
+		err = _mm256_add_pd( err, _mm256_mul_pd( alo, bhi ) );
+		err = _mm256_add_pd( err, _mm256_mul_pd( ahi, blo ) );
+		err = _mm256_add_pd( err, _mm256_mul_pd( alo, blo ) );
+#endif
+		return p;
+	}
+
+	// ==== Conversions ====
+
+	inline DoubleDouble4 _AM_CALL_ ddFromDouble( __m256d a )
+	{
+		return DoubleDouble4{ a, _mm256_setzero_pd() };
+	}
+
+	// Round to the nearest FP64 numbers
+	inline __m256d _AM_CALL_ ddToDouble( DoubleDouble4 a )
+	{
+		return _mm256_add_pd( a.hi, a.lo );
+	}
+
+	// Exact sum of 2 FP64 vectors
+	inline DoubleDouble4 _AM_CALL_ ddFromSum( __m256d a, __m256d b )
+	{
+		DoubleDouble4 r;
+		r.hi = twoSum( a, b, r.lo );
+		return r;
+	}
+
+	// Exact product of 2 FP64 vectors
+	inline DoubleDouble4 _AM_CALL_ ddFromProduct( __m256d a, __m256d b )
+	{
+		DoubleDouble4 r;
+		r.hi = twoProduct( a, b, r.lo );
+		return r;
+	}
+
+	// Load 4 numbers from 2 arrays with high and low parts
+	inline DoubleDouble4 ddLoad( const double* hi, const double* lo )
+	{
+		return DoubleDouble4{ _mm256_loadu_pd( hi ), _mm256_loadu_pd( lo ) };
+	}
+
+	inline void _AM_CALL_ ddStore( double* hi, double* lo, DoubleDouble4 a )
+	{
+		_mm256_storeu_pd( hi, a.hi );
+		_mm256_storeu_pd( lo, a.lo );
+	}
+
+	// ==== Arithmetic ====
+
+	inline DoubleDouble4 _AM_CALL_ ddNegate( DoubleDouble4 a )
+	{
+		return DoubleDouble4{ vectorNegate( a.hi ), vectorNegate( a.lo ) };
+	}
+
+	// Relative error under 2 * 2^-106
+	inline DoubleDouble4 _AM_CALL_ ddAdd( DoubleDouble4 a, DoubleDouble4 b )
+	{
+		__m256d e, f;
+		__m256d s = twoSum( a.hi, b.hi, e );
+		const __m256d t = twoSum( a.lo, b.lo, f );
+		e = _mm256_add_pd( e, t );
+		s = fastTwoSum( s, e, e );
+		e = _mm256_add_pd( e, f );
+		DoubleDouble4 r;
+		r.hi = fastTwoSum( s, e, r.lo );
+		return r;
+	}
+
+	inline DoubleDouble4 _AM_CALL_ ddAdd( DoubleDouble4 a, __m256d b )
+	{
+		__m256d e;
+		const __m256d s = twoSum( a.hi, b, e );
+		e = _mm256_add_pd( e, a.lo );
+		DoubleDouble4 r;
+		r.hi = fastTwoSum( s, e, r.lo );
+		return r;
+	}
+
+	inline DoubleDouble4 _AM_CALL_ ddSubtract( DoubleDouble4 a, DoubleDouble4 b )
+	{
+		return ddAdd( a, ddNegate( b ) );
+	}
+
+	inline DoubleDouble4 _AM_CALL_ ddSubtract( DoubleDouble4 a, __m256d b )
+	{
+		return ddAdd( a, vectorNegate( b ) );
+	}
+
+	// Relative error under 4 * 2^-106
+	inline DoubleDouble4 _AM_CALL_ ddMultiply( DoubleDouble4 a, DoubleDouble4 b )
+	{
+		__m256d e;
+		const __m256d p = twoProduct( a.hi, b.hi, e );
+		e = vectorMultiplyAdd( a.hi, b.lo, e );
+		e = vectorMultiplyAdd( a.lo, b.hi, e );
+		DoubleDouble4 r;
+		r.hi = fastTwoSum( p, e, r.lo );
+		return r;
+	}
+
+	inline DoubleDouble4 _AM_CALL_ ddMultiply( DoubleDouble4 a, __m256d b )
+	{
+		__m256d e;
+		const __m256d p = twoProduct( a.hi, b, e );
+		e = vectorMultiplyAdd( a.lo, b, e );
+		DoubleDouble4 r;
+		r.hi = fastTwoSum( p, e, r.lo );
+		return r;
+	}
+
+	// a * b + c, the product is not rounded to double-double before the addition
+	inline DoubleDouble4 _AM_CALL_ ddMultiplyAdd( DoubleDouble4 a, DoubleDouble4 b, DoubleDouble4 c )
+	{
+		__m256d e;
+		const __m256d p = twoProduct( a.hi, b.hi, e );
+		e = vectorMultiplyAdd( a.hi, b.lo, e );
+		e = vectorMultiplyAdd( a.lo, b.hi, e );
+		return ddAdd( DoubleDouble4{ p, e }, c );
+	}
+
+	inline DoubleDouble4 _AM_CALL_ ddMultiplyAdd( __m256d a, __m256d b, DoubleDouble4 c )
+	{
+		return ddAdd( ddFromProduct( a, b ), c );
+	}
+
+	// Long division: 3 quotient digits of 53 bits, the divisions are replaced with multiplications by the reciprocal of b.hi
+	inline DoubleDouble4 _AM_CALL_ ddDivide( DoubleDouble4 a, DoubleDouble4 b )
+	{
+		const __m256d inv = _mm256_div_pd( broadcast( g_misc.one ), b.hi );
+		const __m256d q1 = _mm256_mul_pd( a.hi, inv );
+		DoubleDouble4 r = ddSubtract( a, ddMultiply( b, q1 ) );
+		const __m256d q2 = _mm256_mul_pd( r.hi, inv );
+		r = ddSubtract( r, ddMultiply( b, q2 ) );
+		const __m256d q3 = _mm256_mul_pd( r.hi, inv );
+		DoubleDouble4 q;
+		q.hi = fastTwoSum( q1, q2, q.lo );
+		return ddAdd( q, q3 );
+	}
+
+	inline DoubleDouble4 _AM_CALL_ ddDivide( DoubleDouble4 a, __m256d b )
+	{
+		return ddDivide( a, ddFromDouble( b ) );
+	}
+
+	// One Newton-Raphson step from the FP64 square root: sqrt( a ) = s + ( a - s^2 ) / ( 2 s ).
+	// Returns 0 for zero input, NaN for negative inputs, and the FP64 square root for infinity.
+	inline DoubleDouble4 _AM_CALL_ ddSqrt( DoubleDouble4 a )
+	{
+		const __m256d s = _mm256_sqrt_pd( a.hi );
+		__m256d e;
+		const __m256d sq = twoProduct( s, s, e );
+		// a - s^2, the first subtraction is exact because s^2 is within 1 ULP of a.hi
+		__m256d rem = _mm256_sub_pd( a.hi, sq );
+		rem = _mm256_add_pd( _mm256_sub_pd( rem, e ), a.lo );
+		__m256d corr = _mm256_div_pd( rem, _mm256_add_pd( s, s ) );
+		// Zero and infinity produce NaN in the correction
+		const __m256d finite = _mm256_and_pd( _mm256_cmp_pd( a.hi, _mm256_setzero_pd(), _CMP_GT_OQ ), _mm256_cmp_pd( a.hi, broadcast( g_misc.infinity ), _CMP_LT_OQ ) );
+		corr = _mm256_and_pd( corr, finite );
+		DoubleDouble4 r;
+		r.hi = fastTwoSum( s, corr, r.lo );
+		r.lo = _mm256_and_pd( r.lo, finite );
+		return r;
+	}
+
+	inline DoubleDouble4 _AM_CALL_ ddAbs( DoubleDouble4 a )
+	{
+		// The sign of the number is the sign of the high part
+		const __m256d neg = _mm256_and_pd( a.hi, broadcast( g_misc.negativeZero ) );
+		return DoubleDouble4{ _mm256_xor_pd( a.hi, neg ), _mm256_xor_pd( a.lo, neg ) };
+	}
+
+	// Sum of the 4 lanes, broadcasted into all lanes
+	inline DoubleDouble4 _AM_CALL_ ddHorizontalSum( DoubleDouble4 a )
+	{
+		a = ddAdd( a, DoubleDouble4{ _mm256_permute2f128_pd( a.hi, a.hi, 0x01 ), _mm256_permute2f128_pd( a.lo, a.lo, 0x01 ) } );
+		return ddAdd( a, DoubleDouble4{ _mm256_permute_pd( a.hi, 0b0101 ), _mm256_permute_pd( a.lo, 0b0101 ) } );
+	}
+
+	// Dot products of 3D vectors in SoA layout, for 4 pairs of vectors
+	inline DoubleDouble4 _AM_CALL_ ddDot3( const DoubleDouble4* a, const DoubleDouble4* b )
+	{
+		DoubleDouble4 r = ddMultiply( a[ 0 ], b[ 0 ] );
+		r = ddMultiplyAdd( a[ 1 ], b[ 1 ], r );
+		return ddMultiplyAdd( a[ 2 ], b[ 2 ], r );
+	}
+
+	// ==== Arrays ====
+
+	// Sum of the FP64 array, accumulated in double-double precision; the result is broadcasted into all lanes
+	DoubleDouble4 ddSum( const double* a, size_t length );
+
+	// Dot product of 2 FP64 arrays, the products are exact and accumulated in double-double precision; the result is broadcasted into all lanes
+	DoubleDouble4 ddDot( const double* a, const double* b, size_t length );
+}
\ No newline at end of file
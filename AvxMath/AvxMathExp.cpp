@@ -0,0 +1,298 @@
+﻿#include "AvxMath.h"
+
+namespace AvxMath
+{
+	// We want these magic numbers placed at adjacent memory addresses, that's why the structure
+	alignas( 64 ) static const struct
+	{
+		const double log2e = 1.44269504088896338700e+00;
+		// Cody-Waite range reduction; the high part has 32 significant bits, n * ln2hi is exact for |n| < 2^21
+		const double negLn2hi = -6.93147180369123816490e-01;
+		const double negLn2lo = -1.90821492927058770002e-10;
+		const double ln2 = 6.93147180559945286227e-01;
+		const double sqrt2 = 1.41421356237309514547e+00;
+		const double two = 2;
+		// Adding that number to an integer-valued double makes the lowest bits of the mantissa equal to the integer plus the exponent bias
+		const double exponentMagic = 4503599627370496.0 + 1023.0;
+		// The inputs are clamped into this range, the values outside of the range already saturate to INF, or 0
+		const double expMin = -746;
+		const double expMax = 710;
+		// For |x| above 20, tanh( x ) rounds to +-1.0
+		const double tanhMax = 20;
+		// The fast [ 7 / 6 ] Padé approximation of tanh reaches 1.0 at this point, and decreases after that
+		const double tanhFastMax = 4.64437070925217;
+	}
+	g_exp;
+
+	// Minimax polynomials approximating ( e^r - 1 - r ) / r^2 on [ -ln(2)/2, +ln(2)/2 ], minimizing relative error of e^r - 1
+	template<bool fast>
+	struct ExpCoefficients;
+
+	// Relative error 2.1E-17
+	template<>
+	struct ExpCoefficients<false>
+	{
+		static constexpr size_t count = 10;
+		static constexpr double values[ count ] =
+		{
+			+5.00000000000000666e-01,
+			+1.66666666666666963e-01,
+			+4.16666666665624977e-02,
+			+8.33333333329324896e-03,
+			+1.38888889361512137e-03,
+			+1.98412699868460600e-04,
+			+2.48014997874487604e-05,
+			+2.75571169691857357e-06,
+			+2.76282164570165615e-07,
+			+2.51613453370788626e-08,
+		};
+	};
+
+	// Relative error 1.2E-7
+	template<>
+	struct ExpCoefficients<true>
+	{
+		static constexpr size_t count = 5;
+		static constexpr double values[ count ] =
+		{
+			+4.99998210175989999e-01,
+			+1.66665772497442577e-01,
+			+4.17263086832086114e-02,
+			+8.36314817803680138e-03,
+			+9.94134364735734704e-04,
+		};
+	};
+
+	// Minimax polynomials approximating ( atanh( s ) - s ) / s^3 as functions of s^2, for |s| <= ( sqrt(2) - 1 ) / ( sqrt(2) + 1 ), minimizing relative error of atanh
+	template<bool fast>
+	struct LogCoefficients;
+
+	// Relative error 1.2E-18
+	template<>
+	struct LogCoefficients<false>
+	{
+		static constexpr size_t count = 7;
+		static constexpr double values[ count ] =
+		{
+			+3.33333333333336701e-01,
+			+1.99999999997081873e-01,
+			+1.42857143710075435e-01,
+			+1.11110993054155935e-01,
+			+9.09178120126455519e-02,
+			+7.65704945204083998e-02,
+			+7.39773723111913639e-02,
+		};
+	};
+
+	// Relative error 1.5E-7
+	template<>
+	struct LogCoefficients<true>
+	{
+		static constexpr size_t count = 2;
+		static constexpr double values[ count ] =
+		{
+			+3.33278110069442912e-01,
+			+2.06009972920961959e-01,
+		};
+	};
+
+	// Evaluate polynomial with the coefficients from memory, c[ 0 ] + c[ 1 ] * x + c[ 2 ] * x^2 + ...
+	template<size_t count>
+	inline __m256d evalPolynomial( __m256d x, const double* c )
+	{
+		__m256d vec = broadcast( c[ count - 1 ] );
+		for( size_t i = count - 1; i > 0; i-- )
+			vec = vectorMultiplyAdd( vec, x, broadcast( c[ i - 1 ] ) );
+		return vec;
+	}
+
+	// Compute 2^n for integer-valued n in [ -1022 .. +1023 ] interval
+	inline __m256d exp2Integer( __m256d n )
+	{
+		__m256i bits = _mm256_castpd_si256( _mm256_add_pd( n, broadcast( g_exp.exponentMagic ) ) );
+#if _AM_AVX2_INTRINSICS_
+		bits = _mm256_slli_epi64( bits, 52 );
+#else
+		__m128i low = _mm_slli_epi64( _mm256_castsi256_si128( bits ), 52 );
+		__m128i high = _mm_slli_epi64( _mm256_extractf128_si256( bits, 1 ), 52 );
+		bits = _mm256_insertf128_si256( _mm256_castsi128_si256( low ), high, 1 );
+#endif
+		return _mm256_castsi256_pd( bits );
+	}
+
+	// Reduce x = n * ln( 2 ) + r, where |r| <= ln(2)/2, and compute e^r - 1
+	template<bool fast>
+	inline __m256d expm1Reduced( __m256d x, __m256d& n )
+	{
+		using Coefficients = ExpCoefficients<fast>;
+
+		n = _mm256_mul_pd( x, broadcast( g_exp.log2e ) );
+		n = _mm256_round_pd( n, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC );
+		__m256d r = vectorMultiplyAdd( n, broadcast( g_exp.negLn2hi ), x );
+		r = vectorMultiplyAdd( n, broadcast( g_exp.negLn2lo ), r );
+
+		const __m256d p = evalPolynomial<Coefficients::count>( r, Coefficients::values );
+		const __m256d r2 = _mm256_mul_pd( r, r );
+		return vectorMultiplyAdd( r2, p, r );
+	}
+
+	// e^x, splitting the scale into 2 multipliers to support both overflow and gradual underflow
+	template<bool fast>
+	inline __m256d expImpl( __m256d x )
+	{
+		x = _mm256_max_pd( broadcast( g_exp.expMin ), x );
+		x = _mm256_min_pd( broadcast( g_exp.expMax ), x );
+
+		__m256d n;
+		const __m256d em1 = expm1Reduced<fast>( x, n );
+		const __m256d one = broadcast( g_misc.one );
+		__m256d res = _mm256_add_pd( em1, one );
+
+		const __m256d n1 = _mm256_round_pd( _mm256_mul_pd( n, broadcast( g_misc.oneHalf ) ), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC );
+		const __m256d n2 = _mm256_sub_pd( n, n1 );
+		res = _mm256_mul_pd( res, exp2Integer( n1 ) );
+		return _mm256_mul_pd( res, exp2Integer( n2 ) );
+	}
+
+	// e^x - 1 for x in [ -40 .. 0 ] interval
+	template<bool fast>
+	inline __m256d expm1Negative( __m256d x )
+	{
+		__m256d n;
+		const __m256d em1 = expm1Reduced<fast>( x, n );
+		// e^x - 1 = 2^n * ( e^r - 1 ) + ( 2^n - 1 ), the last expression is exact
+		const __m256d scale = exp2Integer( n );
+		const __m256d sm1 = _mm256_sub_pd( scale, broadcast( g_misc.one ) );
+		return vectorMultiplyAdd( scale, em1, sm1 );
+	}
+
+	// ln( 1 + x ) for x in [ 0 .. 1 ] interval
+	template<bool fast>
+	inline __m256d log1pUnit( __m256d x )
+	{
+		using Coefficients = LogCoefficients<fast>;
+
+		const __m256d one = broadcast( g_misc.one );
+		const __m256d y = _mm256_add_pd( x, one );
+		// Rounding error of the above addition, exact
+		const __m256d err = _mm256_sub_pd( x, _mm256_sub_pd( y, one ) );
+
+		// When y > sqrt( 2 ), compute ln( y ) = ln( 2 ) + ln( y / 2 ) instead, to keep the argument of atanh small
+		const __m256d big = _mm256_cmp_pd( y, broadcast( g_exp.sqrt2 ), _CMP_GT_OQ );
+		const __m256d m = _mm256_blendv_pd( one, broadcast( g_exp.two ), big );
+
+		// ln( y / m ) = 2 * atanh( s ), where s = ( y - m ) / ( y + m )
+		const __m256d s = _mm256_div_pd( _mm256_sub_pd( y, m ), _mm256_add_pd( y, m ) );
+		const __m256d t = _mm256_mul_pd( s, s );
+		const __m256d p = evalPolynomial<Coefficients::count>( t, Coefficients::values );
+		const __m256d s2 = _mm256_add_pd( s, s );
+
+		// ln( 1 + x ) = ln( y ) + err / y, approximately; the fast version skips the division, y is close to 1.0 when the correction matters
+		__m256d res = _mm256_mul_pd( _mm256_mul_pd( s2, t ), p );
+		if constexpr( fast )
+			res = _mm256_add_pd( res, err );
+		else
+			res = _mm256_add_pd( res, _mm256_div_pd( err, y ) );
+		res = _mm256_add_pd( res, s2 );
+		return _mm256_add_pd( res, _mm256_and_pd( big, broadcast( g_exp.ln2 ) ) );
+	}
+
+	__m256d _AM_CALL_ vectorExp( __m256d x )
+	{
+		return expImpl<false>( x );
+	}
+
+	__m256d _AM_CALL_ vectorTanH( __m256d x )
+	{
+		const __m256d neg0 = broadcast( g_misc.negativeZero );
+		const __m256d sign = _mm256_and_pd( x, neg0 );
+		__m256d ax = _mm256_andnot_pd( neg0, x );
+		ax = _mm256_min_pd( broadcast( g_exp.tanhMax ), ax );
+
+		// tanh( |x| ) = -expm1( -2 |x| ) / ( expm1( -2 |x| ) + 2 )
+		const __m256d y = vectorNegate( _mm256_add_pd( ax, ax ) );
+		const __m256d e = expm1Negative<false>( y );
+		const __m256d res = _mm256_div_pd( vectorNegate( e ), _mm256_add_pd( e, broadcast( g_exp.two ) ) );
+		return _mm256_xor_pd( res, sign );
+	}
+
+	static const struct TanhConstants
+	{
+		const double _600 = 600;
+		const double _270 = 270;
+		const double _70 = 70;
+		const double _11 = 11;
+		const double last = 1.0 / 24.0;
+	}
+	g_tanh;
+
+	__m256d _AM_CALL_ vectorTanHFast( __m256d x )
+	{
+		// https://math.stackexchange.com/a/107666/467444
+
+		// Past the point where the approximation reaches 1.0, it decreases; these lanes are replaced with exactly +-1.0. NAN values fail the comparison and are kept.
+		const __m256d neg0 = broadcast( g_misc.negativeZero );
+		const __m256d saturated = _mm256_cmp_pd( _mm256_andnot_pd( neg0, x ), broadcast( g_exp.tanhFastMax ), _CMP_GE_OQ );
+		const __m256d signedOne = _mm256_or_pd( broadcast( g_misc.one ), _mm256_and_pd( x, neg0 ) );
+
+		const __m256d _600 = broadcast( g_tanh._600 );
+		const __m256d x2 = _mm256_mul_pd( x, x );		// x^2
+
+		__m256d b = broadcast( g_tanh._270 );
+		__m256d den = vectorMultiplyAdd( x2, b, _600 );	// 600 + 270 * x^2
+
+		const __m256d x4 = _mm256_mul_pd( x2, x2 );	// x^4
+		__m256d num = _mm256_add_pd( x4, _600 );	// x^4 + 600
+
+		const __m256d x6 = _mm256_mul_pd( x4, x2 );	// x^6
+		b = broadcast( g_tanh._11 );
+		den = vectorMultiplyAdd( x4, b, den );	// 600 + 270 * x^2 + 11 * x^4
+
+		b = broadcast( g_tanh._70 );
+		num = vectorMultiplyAdd( x2, b, num );	// x^4 + 70 * x^2 + 600
+
+		b = broadcast( g_tanh.last );
+		den = vectorMultiplyAdd( x6, b, den );	// 600 + 270 * x^2 + 11 * x^4 + (1/24)*x^6
+		num = _mm256_mul_pd( num, x );	// x * ( x^4 + 70 * x^2 + 600 )
+
+		return _mm256_blendv_pd( _mm256_div_pd( num, den ), signedOne, saturated );
+	}
+
+	__m256d _AM_CALL_ vectorSigmoid( __m256d x )
+	{
+		// For x >= 0, 1 / ( 1 + e^-x ); for x < 0, e^x / ( 1 + e^x ); both use e^-|x| which is within ( 0 .. 1 ]
+		const __m256d neg0 = broadcast( g_misc.negativeZero );
+		const __m256d one = broadcast( g_misc.one );
+		const __m256d e = expImpl<false>( _mm256_or_pd( x, neg0 ) );
+		const __m256d num = _mm256_blendv_pd( one, e, x );
+		return _mm256_div_pd( num, _mm256_add_pd( e, one ) );
+	}
+
+	__m256d _AM_CALL_ vectorSigmoidFast( __m256d x )
+	{
+		// sigmoid( x ) = 0.5 + 0.5 * tanh( x / 2 )
+		const __m256d half = broadcast( g_misc.oneHalf );
+		const __m256d t = vectorTanHFast( _mm256_mul_pd( x, half ) );
+		return vectorMultiplyAdd( t, half, half );
+	}
+
+	template<bool fast>
+	inline __m256d softplusImpl( __m256d x )
+	{
+		// softplus( x ) = max( x, 0 ) + ln( 1 + e^-|x| )
+		const __m256d neg0 = broadcast( g_misc.negativeZero );
+		const __m256d e = expImpl<fast>( _mm256_or_pd( x, neg0 ) );
+		const __m256d l = log1pUnit<fast>( e );
+		return _mm256_add_pd( _mm256_max_pd( _mm256_setzero_pd(), x ), l );
+	}
+
+	__m256d _AM_CALL_ vectorSoftplus( __m256d x )
+	{
+		return softplusImpl<false>( x );
+	}
+
+	__m256d _AM_CALL_ vectorSoftplusFast( __m256d x )
+	{
+		return softplusImpl<true>( x );
+	}
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+// Exponent, and the functions built on top of it: hyperbolic tangent, logistic sigmoid, softplus
+#pragma once
+
+namespace AvxMath
+{
+	// Compute e^x for 4 numbers. The relative error is within 2 ULP.
+	// Overflows into +INF above 709.78, gradually underflows into denormals and then zero below -708.4
+	__m256d _AM_CALL_ vectorExp( __m256d x );
+
+	// The full-precision versions of the functions below are built on the exponent and logarithm kernels, relative errors are within 3 ULP.
+	// The fast versions use low-degree polynomials instead, relative error of them is within 1.5E-7 unless specified otherwise.
+
+	// Hyperbolic tangent, saturates to exactly +-1.0 for |x| above 20
+	__m256d _AM_CALL_ vectorTanH( __m256d x );
+	// A low-precision approximation of hyperbolic tangent, absolute error is within 3.6E-4; saturates to exactly +-1.0 for |x| above 4.644
+	__m256d _AM_CALL_ vectorTanHFast( __m256d x );
+
+	// Logistic sigmoid, 1 / ( 1 + e^-x )
+	__m256d _AM_CALL_ vectorSigmoid( __m256d x );
+	// A low-precision approximation of logistic sigmoid, computed from vectorTanHFast; absolute error is within 1.8E-4
+	__m256d _AM_CALL_ vectorSigmoidFast( __m256d x );
+
+	// Softplus, ln( 1 + e^x )
+	__m256d _AM_CALL_ vectorSoftplus( __m256d x );
+	// A low-precision approximation of softplus, relative error is within 2E-7
+	__m256d _AM_CALL_ vectorSoftplusFast( __m256d x );
+}
\ No newline at end of file
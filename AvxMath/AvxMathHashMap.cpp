@@ -0,0 +1,184 @@
+#include "AvxMath.h"
+#include <algorithm>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace AvxMath
+{
+	// Adding +0.0 converts -0.0 into +0.0 and keeps other numbers intact; vector3Equal treats them as equal so they need equal hashes.
+	// Also set W to 0.0, the keys are stored with that lane.
+	static inline __m256d normalizeKey( __m256d key )
+	{
+		const __m256d zero = _mm256_setzero_pd();
+		key = _mm256_add_pd( key, zero );
+		return _mm256_blend_pd( key, zero, 0b1000 );
+	}
+
+	// The tag is the higher half of the hash, the lower half selects the bucket. Zero tag marks empty slots.
+	static inline uint32_t makeTag( uint64_t hash )
+	{
+		return (uint32_t)( hash >> 32 ) | 1;
+	}
+
+	// Compare 8 tags in the bucket with the value, return bitmap of the equal ones
+	static inline uint32_t compareTags( const uint32_t* tags, uint32_t tag )
+	{
+#if _AM_AVX2_INTRINSICS_
+		__m256i v = _mm256_load_si256( (const __m256i*)tags );
+		v = _mm256_cmpeq_epi32( v, _mm256_set1_epi32( (int)tag ) );
+		return (uint32_t)_mm256_movemask_ps( _mm256_castsi256_ps( v ) );
+#else
+		const __m128i t = _mm_set1_epi32( (int)tag );
+		__m128i low = _mm_load_si128( (const __m128i*)tags );
+		__m128i high = _mm_load_si128( (const __m128i*)( tags + 4 ) );
+		low = _mm_cmpeq_epi32( low, t );
+		high = _mm_cmpeq_epi32( high, t );
+		return (uint32_t)_mm_movemask_ps( _mm_castsi128_ps( low ) ) | ( (uint32_t)_mm_movemask_ps( _mm_castsi128_ps( high ) ) << 4 );
+#endif
+	}
+
+	Vector3HashSet::Vector3HashSet( size_t capacity )
+	{
+		reserve( capacity );
+	}
+
+	// Keep the load factor under 75%, i.e. up to 6 keys per bucket
+	void Vector3HashSet::reserve( size_t capacity )
+	{
+		size_t buckets = std::max( m_buckets.size(), (size_t)4 );
+		while( buckets * 6 < capacity )
+			buckets *= 2;
+		if( buckets != m_buckets.size() )
+			rehash( buckets );
+		m_keys.reserve( capacity );
+	}
+
+	void Vector3HashSet::clear()
+	{
+		m_keys.clear();
+		for( Bucket& b : m_buckets )
+			b = Bucket{};
+	}
+
+	void Vector3HashSet::rehash( size_t bucketsCount )
+	{
+		m_buckets.clear();
+		m_buckets.resize( bucketsCount );
+		m_mask = bucketsCount - 1;
+
+		// The keys are unique, place them into the first empty slots without comparing
+		for( uint32_t i = 0; i < (uint32_t)m_keys.size(); i++ )
+		{
+			const uint64_t hash = vector3Hash64( key( i ) );
+			for( size_t b = hash & m_mask; ; b = ( b + 1 ) & m_mask )
+			{
+				Bucket& bucket = m_buckets[ b ];
+				const uint32_t empty = compareTags( bucket.tags, 0 );
+				if( 0 == empty )
+					continue;
+				const uint32_t slot = lowestBit( empty );
+				bucket.tags[ slot ] = makeTag( hash );
+				bucket.indices[ slot ] = i;
+				break;
+			}
+		}
+	}
+
+	uint32_t Vector3HashSet::find( __m256d key ) const
+	{
+		if( m_keys.empty() )
+			return UINT32_MAX;
+		key = normalizeKey( key );
+		const uint64_t hash = vector3Hash64( key );
+		const uint32_t tag = makeTag( hash );
+
+		for( size_t b = hash & m_mask; ; b = ( b + 1 ) & m_mask )
+		{
+			const Bucket& bucket = m_buckets[ b ];
+			for( uint32_t matches = compareTags( bucket.tags, tag ); 0 != matches; matches &= matches - 1 )
+			{
+				const uint32_t idx = bucket.indices[ lowestBit( matches ) ];
+				if( vector3Equal( this->key( idx ), key ) )
+					return idx;
+			}
+			// The slots are never removed, an empty slot terminates the probe sequence
+			if( 0 != compareTags( bucket.tags, 0 ) )
+				return UINT32_MAX;
+		}
+	}
+
+	uint32_t Vector3HashSet::insertHashed( __m256d key, uint64_t hash )
+	{
+		const uint32_t tag = makeTag( hash );
+		for( size_t b = hash & m_mask; ; b = ( b + 1 ) & m_mask )
+		{
+			Bucket& bucket = m_buckets[ b ];
+			for( uint32_t matches = compareTags( bucket.tags, tag ); 0 != matches; matches &= matches - 1 )
+			{
+				const uint32_t idx = bucket.indices[ lowestBit( matches ) ];
+				if( vector3Equal( this->key( idx ), key ) )
+					return idx;
+			}
+
+			const uint32_t empty = compareTags( bucket.tags, 0 );
+			if( 0 == empty )
+				continue;
+
+			const uint32_t slot = lowestBit( empty );
+			const uint32_t idx = (uint32_t)m_keys.size();
+			bucket.tags[ slot ] = tag;
+			bucket.indices[ slot ] = idx;
+			m_keys.emplace_back();
+			_mm256_store_pd( &m_keys.back().x, key );
+			return idx;
+		}
+	}
+
+	uint32_t Vector3HashSet::insert( __m256d key )
+	{
+		if( m_keys.size() >= m_buckets.size() * 6 )
+			rehash( m_buckets.size() * 2 );
+		key = normalizeKey( key );
+		return insertHashed( key, vector3Hash64( key ) );
+	}
+
+	void Vector3HashSet::insert( const double* xyz, size_t length, uint32_t* indices )
+	{
+		constexpr size_t blockSize = 16;
+		__m256d keys[ blockSize ];
+		uint64_t hashes[ blockSize ];
+
+		for( size_t i = 0; i < length; i += blockSize )
+		{
+			const size_t count = std::min( length - i, blockSize );
+			// Make sure the block won't trigger rehash in the middle, the hashes are mapped to buckets in advance
+			if( m_keys.size() + count > m_buckets.size() * 6 )
+				reserve( std::max( m_keys.size() + count, m_keys.size() * 2 ) );
+
+			// Compute hashes of the complete block, and prefetch the buckets
+			for( size_t j = 0; j < count; j++ )
+			{
+				keys[ j ] = normalizeKey( loadDouble3( xyz + ( i + j ) * 3 ) );
+				hashes[ j ] = vector3Hash64( keys[ j ] );
+				_mm_prefetch( (const char*)&m_buckets[ hashes[ j ] & m_mask ], _MM_HINT_T0 );
+			}
+
+			for( size_t j = 0; j < count; j++ )
+				indices[ i + j ] = insertHashed( keys[ j ], hashes[ j ] );
+		}
+	}
+
+	size_t weldVertices( const double* xyz, size_t length, double* uniqueXyz, uint32_t* indices )
+	{
+		// Meshes from STL files have every vertex repeated about 6 times; the set grows if there are more unique vertices
+		Vector3HashSet set{ length / 4 };
+		set.insert( xyz, length, indices );
+
+		// Every unique vertex was loaded before it's stored, the output may be the same array as the input
+		const size_t count = set.size();
+		for( size_t i = 0; i < count; i++ )
+			storeDouble3( uniqueXyz + i * 3, set.key( (uint32_t)i ) );
+		return count;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+// Hash containers keyed on 3D vectors, and vertex welding built on top of them
+#pragma once
+#include <vector>
+
+namespace AvxMath
+{
+	// Open addressing hash set of 3D vectors, assigns sequential indices to the unique keys.
+	// The keys are compared with vector3Equal, i.e. -0.0 equals +0.0 and NaN keys are never found.
+	// The table is an array of 64-byte buckets, each bucket has 8 slots with 32-bit tags from the hash, and the 32-bit indices of the keys.
+	// Probing a bucket compares the 8 tags at once, the keys are only loaded for the matching tags.
+	class Vector3HashSet
+	{
+	public:
+		// Create an empty set, optionally reserve space for the specified count of unique keys
+		Vector3HashSet( size_t capacity = 0 );
+
+		// Count of unique keys in the set
+		size_t size() const { return m_keys.size(); }
+
+		// Get the key by index, W lane of the result is 0.0
+		__m256d key( uint32_t index ) const { return _mm256_load_pd( &m_keys[ index ].x ); }
+
+		// Find the key, return its index, or UINT32_MAX if not found
+		uint32_t find( __m256d key ) const;
+
+		// Find or insert the key, return index of the key. When the key was inserted, the index equals to the previous size of the set.
+		uint32_t insert( __m256d key );
+
+		// Insert 3D vectors from the array of length * 3 doubles, write length indices.
+		// Hashes a block of keys at once and prefetches their buckets, faster than inserting them one by one.
+		void insert( const double* xyz, size_t length, uint32_t* indices );
+
+		// Reserve space for the specified count of unique keys
+		void reserve( size_t capacity );
+
+		// Remove all keys, keep the memory
+		void clear();
+
+	private:
+		struct alignas( 32 ) Key
+		{
+			double x, y, z, w;
+		};
+
+		struct alignas( 64 ) Bucket
+		{
+			uint32_t tags[ 8 ];
+			uint32_t indices[ 8 ];
+		};
+
+		std::vector<Bucket> m_buckets;
+		std::vector<Key> m_keys;
+		size_t m_mask = 0;
+
+		void rehash( size_t bucketsCount );
+		uint32_t insertHashed( __m256d key, uint64_t hash );
+	};
+
+	// Hash map from 3D vectors to the values of type V
+	template<class V>
+	class Vector3HashMap
+	{
+		Vector3HashSet m_set;
+		std::vector<V> m_values;
+
+	public:
+		Vector3HashMap( size_t capacity = 0 ) : m_set( capacity )
+		{
+			m_values.reserve( capacity );
+		}
+
+		size_t size() const { return m_values.size(); }
+
+		// Find the value, return nullptr if not found
+		V* find( __m256d key )
+		{
+			const uint32_t i = m_set.find( key );
+			return ( i != UINT32_MAX ) ? &m_values[ i ] : nullptr;
+		}
+		const V* find( __m256d key ) const
+		{
+			const uint32_t i = m_set.find( key );
+			return ( i != UINT32_MAX ) ? &m_values[ i ] : nullptr;
+		}
+
+		// Find the value, insert a default-constructed one if not found
+		V& operator[]( __m256d key )
+		{
+			const uint32_t i = m_set.insert( key );
+			if( i == m_values.size() )
+				m_values.emplace_back();
+			return m_values[ i ];
+		}
+
+		// Get key and value by index, the indices are sequential in the order of insertion
+		__m256d key( uint32_t index ) const { return m_set.key( index ); }
+		V& value( uint32_t index ) { return m_values[ index ]; }
+		const V& value( uint32_t index ) const { return m_values[ index ]; }
+
+		void clear()
+		{
+			m_set.clear();
+			m_values.clear();
+		}
+	};
+
+	// Deduplicate the vertices, the input array has length * 3 doubles.
+	// Writes the unique vertices into the output array in the order of their first occurrence, and indices into that array for every input vertex.
+	// The output vertices may be the same array as the input. Returns count of the unique vertices.
+	size_t weldVertices( const double* xyz, size_t length, double* uniqueXyz, uint32_t* indices );
+}
\ No newline at end of file
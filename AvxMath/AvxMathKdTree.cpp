@@ -0,0 +1,492 @@
+#include "AvxMath.h"
+#include "AvxMathParallel.h"
+#include <algorithm>
+
+namespace AvxMath
+{
+	namespace
+	{
+		// Ranges with more points are split, the leaves have 8 to 16 points
+		constexpr size_t maxLeafPoints = 16;
+		// Subtrees smaller than that are built on the same thread as their parent
+		constexpr size_t minParallelPoints = 1 << 16;
+		// When running multithreaded, each thread gets at least that many queries
+		constexpr size_t minParallelQueries = 1 << 10;
+
+		// Point in the build order
+		struct alignas( 32 ) BuildPoint
+		{
+			double xyz[ 3 ];
+			uint32_t index;
+
+			__m256d load() const
+			{
+				return _mm256_blend_pd( _mm256_load_pd( xyz ), _mm256_setzero_pd(), 0b1000 );
+			}
+		};
+
+		// Squared distances from the position to the 4 points of the block
+		inline __m256d distancesSquared4( const double ( &coords )[ 3 ][ 4 ], const __m256d* pos )
+		{
+			const __m256d dx = _mm256_sub_pd( _mm256_load_pd( coords[ 0 ] ), pos[ 0 ] );
+			const __m256d dy = _mm256_sub_pd( _mm256_load_pd( coords[ 1 ] ), pos[ 1 ] );
+			const __m256d dz = _mm256_sub_pd( _mm256_load_pd( coords[ 2 ] ), pos[ 2 ] );
+			__m256d res = _mm256_mul_pd( dx, dx );
+			res = vectorMultiplyAdd( dy, dy, res );
+			return vectorMultiplyAdd( dz, dz, res );
+		}
+
+		// Spread the lower 21 bits of the integer, inserting 2 zero bits after each of them
+		inline uint64_t spreadBits( uint64_t v )
+		{
+			v &= 0x1FFFFF;
+			v = ( v | ( v << 32 ) ) & 0x1F00000000FFFFull;
+			v = ( v | ( v << 16 ) ) & 0x1F0000FF0000FFull;
+			v = ( v | ( v << 8 ) ) & 0x100F00F00F00F00Full;
+			v = ( v | ( v << 4 ) ) & 0x10C30C30C30C30C3ull;
+			v = ( v | ( v << 2 ) ) & 0x1249249249249249ull;
+			return v;
+		}
+
+		// Permutation of the query positions, in the order of Morton curve
+		std::vector<uint32_t> mortonOrder( const double* xyz, size_t count )
+		{
+			__m256d min = _mm256_set1_pd( g_misc.infinity ), max = _mm256_set1_pd( -g_misc.infinity );
+			for( size_t i = 0; i < count; i++ )
+			{
+				const __m256d p = loadDouble3( xyz + i * 3 );
+				min = _mm256_min_pd( p, min );
+				max = _mm256_max_pd( p, max );
+			}
+			const __m256d keyMax = _mm256_set1_pd( (double)0x1FFFFF );
+			const __m256d scale = _mm256_div_pd( keyMax, _mm256_max_pd( _mm256_sub_pd( max, min ), _mm256_set1_pd( 1E-300 ) ) );
+
+			std::vector<std::pair<uint64_t, uint32_t>> keys( count );
+			for( size_t i = 0; i < count; i++ )
+			{
+				// The order of min / max operands maps NaN coordinates to zero
+				__m256d f = _mm256_mul_pd( _mm256_sub_pd( loadDouble3( xyz + i * 3 ), min ), scale );
+				f = _mm256_min_pd( _mm256_max_pd( f, _mm256_setzero_pd() ), keyMax );
+				alignas( 16 ) int32_t iv[ 4 ];
+				_mm_store_si128( (__m128i*)iv, _mm256_cvttpd_epi32( f ) );
+				const uint64_t key = spreadBits( (uint32_t)iv[ 0 ] ) | ( spreadBits( (uint32_t)iv[ 1 ] ) << 1 ) | ( spreadBits( (uint32_t)iv[ 2 ] ) << 2 );
+				keys[ i ] = std::make_pair( key, (uint32_t)i );
+			}
+			std::sort( keys.begin(), keys.end() );
+
+			std::vector<uint32_t> order( count );
+			for( size_t i = 0; i < count; i++ )
+				order[ i ] = keys[ i ].second;
+			return order;
+		}
+
+		inline void storePosition( double* dest, __m256d pos )
+		{
+			alignas( 32 ) double tmp[ 4 ];
+			_mm256_store_pd( tmp, pos );
+			dest[ 0 ] = tmp[ 0 ];
+			dest[ 1 ] = tmp[ 1 ];
+			dest[ 2 ] = tmp[ 2 ];
+		}
+	}
+
+	class KdTree::Builder
+	{
+		std::vector<BuildPoint> points;
+		const size_t topLevels;
+
+		struct Output
+		{
+			std::vector<Node> nodes;
+			std::vector<Block> blocks;
+		};
+
+		// Widest side of the bounding box of the points
+		size_t splitAxis( size_t begin, size_t end ) const
+		{
+			__m256d min = points[ begin ].load(), max = min;
+			for( size_t i = begin + 1; i < end; i++ )
+			{
+				const __m256d p = points[ i ].load();
+				min = _mm256_min_pd( min, p );
+				max = _mm256_max_pd( max, p );
+			}
+			alignas( 32 ) double size[ 4 ];
+			_mm256_store_pd( size, _mm256_sub_pd( max, min ) );
+			if( size[ 0 ] >= size[ 1 ] && size[ 0 ] >= size[ 2 ] )
+				return 0;
+			return size[ 1 ] >= size[ 2 ] ? 1 : 2;
+		}
+
+		void makeLeaf( Output& out, size_t begin, size_t end, size_t node ) const
+		{
+			out.nodes[ node ].split = 0;
+			out.nodes[ node ].child = (uint32_t)out.blocks.size();
+			out.nodes[ node ].axis = 4 + (uint32_t)( ( end - begin + 3 ) / 4 );
+			for( size_t i = begin; i < end; i += 4 )
+			{
+				Block& block = out.blocks.emplace_back();
+				for( size_t lane = 0; lane < 4; lane++ )
+				{
+					const bool used = i + lane < end;
+					for( size_t c = 0; c < 3; c++ )
+						block.coords[ c ][ lane ] = used ? points[ i + lane ].xyz[ c ] : g_misc.quietNaN;
+					block.indices[ lane ] = used ? points[ i + lane ].index : UINT32_MAX;
+				}
+			}
+		}
+
+		// Append the subtree built into a separate output, returns index of its root node
+		static uint32_t append( Output& out, const Output& subtree )
+		{
+			const uint32_t nodeOffset = (uint32_t)out.nodes.size();
+			const uint32_t blockOffset = (uint32_t)out.blocks.size();
+			for( Node n : subtree.nodes )
+			{
+				n.child += ( n.axis >= 4 ) ? blockOffset : nodeOffset;
+				out.nodes.push_back( n );
+			}
+			out.blocks.insert( out.blocks.end(), subtree.blocks.begin(), subtree.blocks.end() );
+			return nodeOffset;
+		}
+
+		void buildNode( Output& out, size_t begin, size_t end, size_t levels )
+		{
+			const size_t node = out.nodes.size();
+			out.nodes.emplace_back();
+			if( end - begin <= maxLeafPoints )
+			{
+				makeLeaf( out, begin, end, node );
+				return;
+			}
+
+			// Median split, the points on the left side have coordinates <= split, on the right side >= split
+			const size_t axis = splitAxis( begin, end );
+			const size_t mid = begin + ( end - begin ) / 2;
+			std::nth_element( points.begin() + begin, points.begin() + mid, points.begin() + end,
+				[ axis ]( const BuildPoint& a, const BuildPoint& b ) { return a.xyz[ axis ] < b.xyz[ axis ]; } );
+			out.nodes[ node ].split = points[ mid ].xyz[ axis ];
+			out.nodes[ node ].axis = (uint32_t)axis;
+
+			if( levels > 0 && end - begin >= minParallelPoints )
+			{
+				// Build both subtrees on different threads, each one into a separate output
+				Output subtrees[ 2 ];
+				parallelInvoke( 2, [ & ]( size_t i )
+				{
+					if( 0 == i )
+						buildNode( subtrees[ 0 ], begin, mid, levels - 1 );
+					else
+						buildNode( subtrees[ 1 ], mid, end, levels - 1 );
+				} );
+				append( out, subtrees[ 0 ] );
+				out.nodes[ node ].child = append( out, subtrees[ 1 ] );
+			}
+			else
+			{
+				buildNode( out, begin, mid, levels );
+				out.nodes[ node ].child = (uint32_t)out.nodes.size();
+				buildNode( out, mid, end, levels );
+			}
+		}
+
+		static size_t parallelLevels( size_t count, bool parallel )
+		{
+			if( !parallel )
+				return 0;
+			// Every level doubles count of the threads
+			const size_t threads = parallelThreads( count, minParallelPoints );
+			size_t levels = 0;
+			while( ( (size_t)1 << levels ) < threads )
+				levels++;
+			return levels;
+		}
+
+	public:
+		Builder( const double* xyz, size_t count, bool parallel ) :
+			points( count ), topLevels( parallelLevels( count, parallel ) )
+		{
+			parallelFor( count, parallel ? minParallelPoints : count, [ & ]( size_t begin, size_t end )
+			{
+				for( size_t i = begin; i < end; i++ )
+				{
+					BuildPoint& p = points[ i ];
+					p.xyz[ 0 ] = xyz[ i * 3 ];
+					p.xyz[ 1 ] = xyz[ i * 3 + 1 ];
+					p.xyz[ 2 ] = xyz[ i * 3 + 2 ];
+					p.index = (uint32_t)i;
+				}
+			} );
+		}
+
+		void build( std::vector<Node>& nodes, std::vector<Block>& blocks )
+		{
+			Output out;
+			out.nodes.reserve( points.size() / 4 );
+			out.blocks.reserve( points.size() / 3 + 1 );
+			buildNode( out, 0, points.size(), topLevels );
+			nodes.swap( out.nodes );
+			blocks.swap( out.blocks );
+		}
+	};
+
+	void KdTree::build( const double* xyz, size_t count, bool parallel )
+	{
+		m_nodes.clear();
+		m_blocks.clear();
+		m_count = count;
+		if( 0 == count )
+			return;
+		assert( count < UINT32_MAX );
+
+		Builder builder{ xyz, count, parallel };
+		builder.build( m_nodes, m_blocks );
+	}
+
+	// Depth-first traversal, the closer child first. The offsets are the distances from the position to the cell along the 3 axes,
+	// the squared distance to the cell is updated incrementally, Arya and Mount, "Algorithms for fast vector quantization", 1993.
+	template<class Visitor>
+	void KdTree::traverse( uint32_t node, double distSq, double* offsets, const __m256d* pos, Visitor& visitor ) const
+	{
+		const Node& n = m_nodes[ node ];
+		if( n.axis >= 4 )
+		{
+			visitor.leaf( &m_blocks[ n.child ], n.axis - 4, n.child, pos );
+			return;
+		}
+
+		const double diff = visitor.position[ n.axis ] - n.split;
+		const bool leftFirst = diff < 0;
+		traverse( leftFirst ? node + 1 : n.child, distSq, offsets, pos, visitor );
+
+		const double old = offsets[ n.axis ];
+		const double farDistSq = distSq - old * old + diff * diff;
+		if( !( farDistSq <= visitor.bound ) )
+			return;
+		offsets[ n.axis ] = diff;
+		traverse( leftFirst ? n.child : node + 1, farDistSq, offsets, pos, visitor );
+		offsets[ n.axis ] = old;
+	}
+
+	// Sorted list of the nearest points found so far
+	struct KdTree::Neighbours
+	{
+		double position[ 3 ];
+		// Squared distance of the k-th point when the list is full, otherwise squared max.distance; the traversal skips cells further than that
+		double bound;
+		const double maxDistSq;
+		const size_t k;
+		size_t count = 0;
+		// Squared distances, and locations of the points: block * 4 + lane
+		double* const distances;
+		uint32_t* const slots;
+
+		Neighbours( size_t k, double maxDistance, double* distances, uint32_t* slots ) :
+			bound( maxDistance * maxDistance ), maxDistSq( maxDistance * maxDistance ), k( k ), distances( distances ), slots( slots )
+		{ }
+
+		void reset( __m256d pos )
+		{
+			storePosition( position, pos );
+			count = 0;
+			bound = maxDistSq;
+		}
+
+		void insert( double distSq, uint32_t slot )
+		{
+			if( count == k && !( distSq < distances[ k - 1 ] ) )
+				return;
+			size_t i = count < k ? count++ : k - 1;
+			for( ; i > 0 && distances[ i - 1 ] > distSq; i-- )
+			{
+				distances[ i ] = distances[ i - 1 ];
+				slots[ i ] = slots[ i - 1 ];
+			}
+			distances[ i ] = distSq;
+			slots[ i ] = slot;
+			if( count == k )
+				bound = distances[ k - 1 ];
+		}
+
+		void leaf( const Block* blocks, uint32_t blocksCount, uint32_t firstBlock, const __m256d* pos )
+		{
+			for( uint32_t i = 0; i < blocksCount; i++ )
+			{
+				const __m256d dist = distancesSquared4( blocks[ i ].coords, pos );
+				uint32_t mask = (uint32_t)_mm256_movemask_pd( _mm256_cmp_pd( dist, _mm256_set1_pd( bound ), _CMP_LE_OQ ) );
+				if( 0 == mask )
+					continue;
+				alignas( 32 ) double d[ 4 ];
+				_mm256_store_pd( d, dist );
+				for( ; 0 != mask; mask &= mask - 1 )
+				{
+					const uint32_t lane = lowestBit( mask );
+					insert( d[ lane ], ( firstBlock + i ) * 4 + lane );
+				}
+			}
+		}
+	};
+
+	// Unordered list of the points within the radius
+	struct KdTree::RadiusCollector
+	{
+		double position[ 3 ];
+		double bound;
+		std::vector<uint32_t>& indices;
+		std::vector<double>* distances;
+
+		void leaf( const Block* blocks, uint32_t blocksCount, uint32_t, const __m256d* pos )
+		{
+			const __m256d b = _mm256_set1_pd( bound );
+			for( uint32_t i = 0; i < blocksCount; i++ )
+			{
+				const __m256d dist = distancesSquared4( blocks[ i ].coords, pos );
+				uint32_t mask = (uint32_t)_mm256_movemask_pd( _mm256_cmp_pd( dist, b, _CMP_LE_OQ ) );
+				if( 0 == mask )
+					continue;
+				alignas( 32 ) double d[ 4 ];
+				_mm256_store_pd( d, dist );
+				for( ; 0 != mask; mask &= mask - 1 )
+				{
+					const uint32_t lane = lowestBit( mask );
+					indices.push_back( blocks[ i ].indices[ lane ] );
+					if( nullptr != distances )
+						distances->push_back( d[ lane ] );
+				}
+			}
+		}
+	};
+
+	size_t KdTree::nearest( __m256d pos, size_t k, uint32_t* indices, double* distancesSquared, double maxDistance ) const
+	{
+		if( 0 == k || m_nodes.empty() || !( maxDistance >= 0 ) )
+			return 0;
+
+		// Small k use the stack for the temporary buffer
+		uint32_t stackSlots[ 64 ];
+		std::vector<uint32_t> heapSlots;
+		uint32_t* slots = stackSlots;
+		if( k > 64 )
+		{
+			heapSlots.resize( k );
+			slots = heapSlots.data();
+		}
+		Neighbours nb{ k, maxDistance, distancesSquared, slots };
+		nb.reset( pos );
+		const __m256d p[ 3 ] = { vectorSplatX( pos ), vectorSplatY( pos ), vectorSplatZ( pos ) };
+		double offsets[ 3 ] = { 0, 0, 0 };
+		traverse( 0, 0.0, offsets, p, nb );
+
+		for( size_t i = 0; i < nb.count; i++ )
+			indices[ i ] = m_blocks[ slots[ i ] / 4 ].indices[ slots[ i ] % 4 ];
+		return nb.count;
+	}
+
+	size_t KdTree::radiusSearch( __m256d pos, double radius, std::vector<uint32_t>& indices, std::vector<double>* distancesSquared ) const
+	{
+		if( m_nodes.empty() || !( radius >= 0 ) )
+			return 0;
+
+		const size_t initial = indices.size();
+		RadiusCollector rc{ {}, radius * radius, indices, distancesSquared };
+		storePosition( rc.position, pos );
+		const __m256d p[ 3 ] = { vectorSplatX( pos ), vectorSplatY( pos ), vectorSplatZ( pos ) };
+		double offsets[ 3 ] = { 0, 0, 0 };
+		traverse( 0, 0.0, offsets, p, rc );
+		return indices.size() - initial;
+	}
+
+	void KdTree::nearest( const double* xyz, size_t count, size_t k, uint32_t* indices, double* distancesSquared, double maxDistance, bool parallel ) const
+	{
+		if( 0 == count || 0 == k )
+			return;
+		if( m_nodes.empty() || !( maxDistance >= 0 ) )
+		{
+			std::fill_n( indices, count * k, UINT32_MAX );
+			std::fill_n( distancesSquared, count * k, g_misc.infinity );
+			return;
+		}
+		// Consecutive queries in Morton order visit mostly the same nodes and blocks, they're likely to be in the cache
+		const std::vector<uint32_t> order = mortonOrder( xyz, count );
+
+		parallelFor( count, parallel ? minParallelQueries : count, [ & ]( size_t begin, size_t end )
+		{
+			std::vector<double> distances( k );
+			std::vector<uint32_t> slots( k );
+			Neighbours nb{ k, maxDistance, distances.data(), slots.data() };
+
+			for( size_t i = begin; i < end; i++ )
+			{
+				const size_t query = order[ i ];
+				const __m256d pos = loadDouble3( xyz + query * 3 );
+				nb.reset( pos );
+				const __m256d p[ 3 ] = { vectorSplatX( pos ), vectorSplatY( pos ), vectorSplatZ( pos ) };
+				double offsets[ 3 ] = { 0, 0, 0 };
+				traverse( 0, 0.0, offsets, p, nb );
+
+				const size_t found = nb.count;
+				uint32_t* const destIndices = indices + query * k;
+				double* const destDistances = distancesSquared + query * k;
+				for( size_t j = 0; j < found; j++ )
+				{
+					destIndices[ j ] = m_blocks[ slots[ j ] / 4 ].indices[ slots[ j ] % 4 ];
+					destDistances[ j ] = distances[ j ];
+				}
+				std::fill( destIndices + found, destIndices + k, UINT32_MAX );
+				std::fill( destDistances + found, destDistances + k, g_misc.infinity );
+			}
+		} );
+	}
+
+	void KdTree::radiusSearch( const double* xyz, size_t count, double radius, std::vector<size_t>& offsets, std::vector<uint32_t>& indices, bool parallel ) const
+	{
+		offsets.assign( count + 1, 0 );
+		indices.clear();
+		if( 0 == count || m_nodes.empty() || !( radius >= 0 ) )
+			return;
+		const std::vector<uint32_t> order = mortonOrder( xyz, count );
+
+		// The queries run in Morton order, each chunk collects the results into a local vector.
+		// Then the results are copied into the output, in the original order of the queries.
+		const size_t chunks = parallelThreads( count, parallel ? minParallelQueries : count );
+		const size_t chunkLength = ( count + chunks - 1 ) / chunks;
+		std::vector<std::vector<uint32_t>> chunkResults( chunks );
+		// For every query, start of the results in the local vector of the chunk
+		std::vector<size_t> localOffsets( count );
+
+		parallelInvoke( chunks, [ & ]( size_t chunk )
+		{
+			const size_t begin = chunk * chunkLength;
+			const size_t end = std::min( count, begin + chunkLength );
+			RadiusCollector rc{ {}, radius * radius, chunkResults[ chunk ], nullptr };
+			for( size_t i = begin; i < end; i++ )
+			{
+				const size_t query = order[ i ];
+				const __m256d pos = loadDouble3( xyz + query * 3 );
+				storePosition( rc.position, pos );
+				const __m256d p[ 3 ] = { vectorSplatX( pos ), vectorSplatY( pos ), vectorSplatZ( pos ) };
+				double cellOffsets[ 3 ] = { 0, 0, 0 };
+				localOffsets[ query ] = rc.indices.size();
+				traverse( 0, 0.0, cellOffsets, p, rc );
+				offsets[ query + 1 ] = rc.indices.size() - localOffsets[ query ];
+			}
+		} );
+
+		for( size_t i = 0; i < count; i++ )
+			offsets[ i + 1 ] += offsets[ i ];
+		indices.resize( offsets[ count ] );
+
+		parallelInvoke( chunks, [ & ]( size_t chunk )
+		{
+			const size_t begin = chunk * chunkLength;
+			const size_t end = std::min( count, begin + chunkLength );
+			const uint32_t* const source = chunkResults[ chunk ].data();
+			for( size_t i = begin; i < end; i++ )
+			{
+				const size_t query = order[ i ];
+				const uint32_t* const first = source + localOffsets[ query ];
+				std::copy( first, first + ( offsets[ query + 1 ] - offsets[ query ] ), indices.begin() + offsets[ query ] );
+			}
+		} );
+	}
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+// K-d tree of 3D points, for k nearest neighbours and radius queries
+#pragma once
+#include <vector>
+
+namespace AvxMath
+{
+	// Balanced k-d tree with median splits on the widest side of the bounding box of the points.
+	// Leaves contain 8 to 16 points, stored in SoA layout in blocks of 4 points, the distances are computed 4 points at a time.
+	class KdTree
+	{
+	public:
+		// Build the tree for the points, xyz has 3 doubles per point. With parallel = true, large clouds are built on all hardware threads.
+		// The tree keeps a copy of the coordinates. Replaces the previous content of the tree.
+		void build( const double* xyz, size_t count, bool parallel = false );
+
+		// Count of points in the tree
+		size_t size() const { return m_count; }
+
+		// Find up to k points closest to the position, within maxDistance; returns count of the points found.
+		// The output arrays receive indices of the points in the source array and squared distances, sorted by distance.
+		size_t nearest( __m256d pos, size_t k, uint32_t* indices, double* distancesSquared, double maxDistance = g_misc.infinity ) const;
+
+		// Find all points within the radius, including the points exactly at that distance; returns count of the points found.
+		// The indices are appended to the vector in no particular order; distancesSquared is optional, when provided it's appended with the squared distances.
+		size_t radiusSearch( __m256d pos, double radius, std::vector<uint32_t>& indices, std::vector<double>* distancesSquared = nullptr ) const;
+
+		// Find k nearest neighbours for count query positions, xyz has 3 doubles per position.
+		// The results are written to indices and distancesSquared, k per query; when less than k points are found, the rest of them are UINT32_MAX and +INF.
+		// The queries are processed in the order of a space-filling curve, this saves cache misses in the tree traversal.
+		void nearest( const double* xyz, size_t count, size_t k, uint32_t* indices, double* distancesSquared, double maxDistance = g_misc.infinity, bool parallel = false ) const;
+
+		// Find all points within the radius, for count query positions. The results are in compressed sparse rows:
+		// the points of the query #i are indices[ offsets[ i ] .. offsets[ i + 1 ] ), offsets has count + 1 elements.
+		// The offsets are size_t because the total count of the results may exceed 4G even though the point indices fit in 32 bits.
+		void radiusSearch( const double* xyz, size_t count, double radius, std::vector<size_t>& offsets, std::vector<uint32_t>& indices, bool parallel = false ) const;
+
+	private:
+		struct Node
+		{
+			// For inner nodes, the coordinate of the splitting plane
+			double split;
+			// For inner nodes, index of the right child; the left child immediately follows the node.
+			// For leaves, index of the first block of the points.
+			uint32_t child;
+			// For inner nodes, the axis 0-2; for leaves, 4 + count of the blocks
+			uint32_t axis;
+		};
+
+		struct alignas( 32 ) Block
+		{
+			// x[ 4 ], y[ 4 ], z[ 4 ], unused lanes contain NaN
+			double coords[ 3 ][ 4 ];
+			// Indices of the points in the source array, unused lanes have UINT32_MAX
+			uint32_t indices[ 4 ];
+		};
+
+		std::vector<Node> m_nodes;
+		std::vector<Block> m_blocks;
+		size_t m_count = 0;
+
+		class Builder;
+		struct Neighbours;
+		struct RadiusCollector;
+		template<class Visitor>
+		void traverse( uint32_t node, double distSq, double* offsets, const __m256d* pos, Visitor& visitor ) const;
+	};
+}
\ No newline at end of file
@@ -30,6 +30,68 @@ namespace AvxMath
 		return _mm256_storeu_pd( rdi, vec );
 	}
 
+	// Load 3D vector from 3 floats, set W to 0.0
+	inline __m256d loadFloat3( const float* rsi )
+	{
+		const __m128 xy = _mm_castsi128_ps( _mm_loadl_epi64( ( const __m128i* )rsi ) );
+		return _mm256_cvtps_pd( _mm_movelh_ps( xy, _mm_load_ss( rsi + 2 ) ) );
+	}
+
+	// Load 4D vector from 4 floats
+	inline __m256d loadFloat4( const float* rsi )
+	{
+		return _mm256_cvtps_pd( _mm_loadu_ps( rsi ) );
+	}
+
+	// Store 3D vector as 3 floats, rounding to nearest
+	inline void storeFloat3( float* rdi, __m256d vec )
+	{
+		const __m128 f = _mm256_cvtpd_ps( vec );
+		_mm_storel_epi64( ( __m128i* )rdi, _mm_castps_si128( f ) );
+		_mm_store_ss( rdi + 2, _mm_movehl_ps( f, f ) );
+	}
+
+	// Store 4D vector as 4 floats, rounding to nearest
+	inline void storeFloat4( float* rdi, __m256d vec )
+	{
+		_mm_storeu_ps( rdi, _mm256_cvtpd_ps( vec ) );
+	}
+
+#if _AM_F16C_INTRINSICS_
+	// Load 4D vector from 4 FP16 numbers
+	inline __m256d loadHalf4( const uint16_t* rsi )
+	{
+		return _mm256_cvtps_pd( _mm_cvtph_ps( _mm_loadl_epi64( ( const __m128i* )rsi ) ) );
+	}
+
+	// Store 4D vector as 4 FP16 numbers. Rounds twice, first to FP32 then to FP16; very rarely, the result differs by 1 ULP from the correctly rounded one.
+	inline void storeHalf4( uint16_t* rdi, __m256d vec )
+	{
+		_mm_storel_epi64( ( __m128i* )rdi, _mm_cvtps_ph( _mm256_cvtpd_ps( vec ), _MM_FROUND_TO_NEAREST_INT ) );
+	}
+#endif
+
+	// Make a mask with the first count lanes set, for the partial loads and stores
+	inline __m256i partialMask( size_t count )
+	{
+		assert( count <= 4 );
+		const __m256d lanes = _mm256_setr_pd( 0, 1, 2, 3 );
+		const __m256d cmp = _mm256_cmp_pd( lanes, _mm256_set1_pd( (double)(int)count ), _CMP_LT_OQ );
+		return _mm256_castpd_si256( cmp );
+	}
+
+	// Load first count elements of the vector, set the rest of the lanes to 0.0. Doesn't access memory past the count elements.
+	inline __m256d loadPartial( const double* rsi, size_t count )
+	{
+		return _mm256_maskload_pd( rsi, partialMask( count ) );
+	}
+
+	// Store first count lanes of the vector
+	inline void storePartial( double* rdi, __m256d vec, size_t count )
+	{
+		_mm256_maskstore_pd( rdi, partialMask( count ), vec );
+	}
+
 	// Load 4x4 matrix
 	inline Matrix4x4 loadMatrix( const double* rsi )
 	{
@@ -0,0 +1,159 @@
+#include "AvxMath.h"
+#include "AvxMathParallel.h"
+#include <string.h>
+
+namespace AvxMath
+{
+	namespace
+	{
+		// When running multithreaded, each thread gets at least that many triangles or vertices
+		constexpr size_t minParallelChunk = 1 << 14;
+
+		// Transpose 4 vectors into SoA layout, the W lanes are ignored
+		inline Vector3x4 transposeToSoa( __m256d p0, __m256d p1, __m256d p2, __m256d p3 )
+		{
+			const __m256d xz01 = _mm256_unpacklo_pd( p0, p1 ); // x0, x1, z0, z1
+			const __m256d yw01 = _mm256_unpackhi_pd( p0, p1 ); // y0, y1, w0, w1
+			const __m256d xz23 = _mm256_unpacklo_pd( p2, p3 );
+			const __m256d yw23 = _mm256_unpackhi_pd( p2, p3 );
+			return Vector3x4{ _mm256_permute2f128_pd( xz01, xz23, 0x20 ), _mm256_permute2f128_pd( yw01, yw23, 0x20 ), _mm256_permute2f128_pd( xz01, xz23, 0x31 ) };
+		}
+
+		// Load 4 vertices of the mesh, and transpose into SoA layout.
+		// The fast version loads 4 doubles per vertex, for the last vertex of the mesh that would read past the end of the array.
+		template<bool fast>
+		inline Vector3x4 gatherVertices( const double* xyz, uint32_t i0, uint32_t i1, uint32_t i2, uint32_t i3 )
+		{
+			if( fast )
+				return transposeToSoa( _mm256_loadu_pd( xyz + (size_t)i0 * 3 ), _mm256_loadu_pd( xyz + (size_t)i1 * 3 ), _mm256_loadu_pd( xyz + (size_t)i2 * 3 ), _mm256_loadu_pd( xyz + (size_t)i3 * 3 ) );
+			return transposeToSoa( loadDouble3( xyz + (size_t)i0 * 3 ), loadDouble3( xyz + (size_t)i1 * 3 ), loadDouble3( xyz + (size_t)i2 * 3 ), loadDouble3( xyz + (size_t)i3 * 3 ) );
+		}
+
+		// Cross products of the edges of 4 triangles, 12 indices
+		template<bool fast>
+		inline Vector3x4 faceNormals( const double* xyz, const uint32_t* tri )
+		{
+			const Vector3x4 a = gatherVertices<fast>( xyz, tri[ 0 ], tri[ 3 ], tri[ 6 ], tri[ 9 ] );
+			const Vector3x4 b = gatherVertices<fast>( xyz, tri[ 1 ], tri[ 4 ], tri[ 7 ], tri[ 10 ] );
+			const Vector3x4 c = gatherVertices<fast>( xyz, tri[ 2 ], tri[ 5 ], tri[ 8 ], tri[ 11 ] );
+			return vector3x4Cross( vector3x4Subtract( b, a ), vector3x4Subtract( c, a ) );
+		}
+
+		// Normalize 4 vectors, zero vectors stay zero
+		inline Vector3x4 normalize4( const Vector3x4& v )
+		{
+			const __m256d lsq = vector3x4Dot( v, v );
+			__m256d mul = _mm256_div_pd( broadcast( g_misc.one ), _mm256_sqrt_pd( lsq ) );
+			mul = _mm256_and_pd( mul, _mm256_cmp_pd( lsq, _mm256_setzero_pd(), _CMP_GT_OQ ) );
+			return vector3x4Scale( v, mul );
+		}
+		// Compute face normals of the blocks of 4 triangles, write 4 doubles per triangle
+		void faceNormalsSpan( const double* xyz, uint32_t lastVertex, const uint32_t* tri, double* rdi, size_t blocks )
+		{
+			const __m128i last = _mm_set1_epi32( (int)lastVertex );
+			for( size_t i = 0; i < blocks; i++, tri += 12, rdi += 16 )
+			{
+				const __m128i i0 = _mm_loadu_si128( ( const __m128i* )tri );
+				const __m128i i1 = _mm_loadu_si128( ( const __m128i* )( tri + 4 ) );
+				const __m128i i2 = _mm_loadu_si128( ( const __m128i* )( tri + 8 ) );
+				__m128i eq = _mm_or_si128( _mm_cmpeq_epi32( i0, last ), _mm_cmpeq_epi32( i1, last ) );
+				eq = _mm_or_si128( eq, _mm_cmpeq_epi32( i2, last ) );
+				const Vector3x4 n = _mm_testz_si128( eq, eq ) ? faceNormals<true>( xyz, tri ) : faceNormals<false>( xyz, tri );
+
+				// Transpose into 4 vectors with W = 0
+				const __m256d xy02 = _mm256_unpacklo_pd( n.x, n.y ); // x0, y0, x2, y2
+				const __m256d xy13 = _mm256_unpackhi_pd( n.x, n.y );
+				const __m256d zw02 = _mm256_unpacklo_pd( n.z, _mm256_setzero_pd() );
+				const __m256d zw13 = _mm256_unpackhi_pd( n.z, _mm256_setzero_pd() );
+				_mm256_storeu_pd( rdi, _mm256_permute2f128_pd( xy02, zw02, 0x20 ) );
+				_mm256_storeu_pd( rdi + 4, _mm256_permute2f128_pd( xy13, zw13, 0x20 ) );
+				_mm256_storeu_pd( rdi + 8, _mm256_permute2f128_pd( xy02, zw02, 0x31 ) );
+				_mm256_storeu_pd( rdi + 12, _mm256_permute2f128_pd( xy13, zw13, 0x31 ) );
+			}
+		}
+
+		// Sum face normals of the triangles adjacent to the vertices [ begin .. end ), normalize 4 vertices at a time
+		void vertexNormalsSpan( const double* faces, const uint32_t* offsets, const uint32_t* adjacent, size_t begin, size_t end, double* normals )
+		{
+			for( size_t i = begin; i < end; i += 4 )
+			{
+				const size_t count = std::min( end - i, (size_t)4 );
+				__m256d acc[ 4 ];
+				for( size_t v = 0; v < 4; v++ )
+				{
+					acc[ v ] = _mm256_setzero_pd();
+					if( v < count )
+						for( uint32_t j = offsets[ i + v ]; j < offsets[ i + v + 1 ]; j++ )
+							acc[ v ] = _mm256_add_pd( acc[ v ], _mm256_loadu_pd( faces + (size_t)adjacent[ j ] * 4 ) );
+				}
+
+				const Vector3x4 n = normalize4( transposeToSoa( acc[ 0 ], acc[ 1 ], acc[ 2 ], acc[ 3 ] ) );
+				if( 4 == count )
+					storeVector3x4( normals + i * 3, n );
+				else
+				{
+					double buffer[ 12 ];
+					storeVector3x4( buffer, n );
+					memcpy( normals + i * 3, buffer, count * 3 * sizeof( double ) );
+				}
+			}
+		}
+	}
+
+	void MeshNormals::build( const uint32_t* indices, size_t triangles, size_t vertices )
+	{
+		assert( triangles < UINT32_MAX / 3 && vertices < UINT32_MAX );
+		m_triangles = triangles;
+		m_vertices = vertices;
+
+		const size_t padded = ( triangles + 3 ) & ~(size_t)3;
+		m_indices.assign( padded * 3, 0 );
+		std::copy( indices, indices + triangles * 3, m_indices.begin() );
+		m_faceNormals.resize( padded * 4 );
+
+		// Counting sort of the triangle references by vertex
+		m_offsets.assign( vertices + 1, 0 );
+		for( size_t i = 0; i < triangles * 3; i++ )
+		{
+			assert( indices[ i ] < vertices );
+			m_offsets[ indices[ i ] + 1 ]++;
+		}
+		for( size_t i = 0; i < vertices; i++ )
+			m_offsets[ i + 1 ] += m_offsets[ i ];
+
+		// Triangles which reference the same vertex more than once have zero area, the duplicate references don't affect the sums
+		m_adjacent.resize( triangles * 3 );
+		std::vector<uint32_t> pos{ m_offsets.begin(), m_offsets.end() - 1 };
+		for( size_t i = 0; i < triangles * 3; i++ )
+			m_adjacent[ pos[ indices[ i ] ]++ ] = (uint32_t)( i / 3 );
+	}
+
+	void MeshNormals::compute( const double* xyz, double* normals, bool parallel )
+	{
+		// Pass 1: cross products of the triangle edges, the padding triangles are [ 0, 0, 0 ] and produce zeros.
+		// Chunks of parallelFor are aligned by 16 elements, the blocks of 4 triangles don't cross chunk boundaries.
+		const size_t padded = m_indices.size() / 3;
+		const uint32_t* const indices = m_indices.data();
+		double* const faces = m_faceNormals.data();
+		const uint32_t lastVertex = (uint32_t)( m_vertices - 1 );
+		parallelFor( padded, parallel ? minParallelChunk : padded, [ = ]( size_t begin, size_t end )
+		{
+			faceNormalsSpan( xyz, lastVertex, indices + begin * 3, faces + begin * 4, ( end - begin ) / 4 );
+		} );
+
+		// Pass 2: every vertex sums the adjacent triangles, the order of the summation is fixed so the result doesn't depend on the threads
+		const uint32_t* const offsets = m_offsets.data();
+		const uint32_t* const adjacent = m_adjacent.data();
+		parallelFor( m_vertices, parallel ? minParallelChunk : m_vertices, [ = ]( size_t begin, size_t end )
+		{
+			vertexNormalsSpan( faces, offsets, adjacent, begin, end, normals );
+		} );
+	}
+
+	void meshVertexNormals( const double* xyz, size_t vertices, const uint32_t* indices, size_t triangles, double* normals, bool parallel )
+	{
+		MeshNormals mn;
+		mn.build( indices, triangles, vertices );
+		mn.compute( xyz, normals, parallel );
+	}
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+// Batch processing of indexed triangle meshes
+#pragma once
+#include <vector>
+
+namespace AvxMath
+{
+	// Smooth vertex normals of an indexed triangle mesh, for meshes which deform while keeping the same topology.
+	// build() computes the list of adjacent triangles for every vertex. compute() then runs 2 passes, neither has write conflicts between threads:
+	// cross products 4 triangles at a time, then every vertex gathers the normals of the adjacent triangles, and they are normalized 4 vertices at a time.
+	class MeshNormals
+	{
+	public:
+		// Prepare for the mesh with the specified count of vertices; indices has 3 integers per triangle. Replaces the previous content of the object.
+		void build( const uint32_t* indices, size_t triangles, size_t vertices );
+
+		// Count of vertices and triangles in the mesh
+		size_t vertexCount() const { return m_vertices; }
+		size_t triangleCount() const { return m_triangles; }
+
+		// Compute unit normals of all vertices, the average of the adjacent triangle normals weighted by the area of the triangles.
+		// xyz has 3 doubles per vertex, normals receives 3 doubles per vertex. Vertices without adjacent triangles of non-zero area get zero normals.
+		// The triangles are counter-clockwise when looking from the side of the normal.
+		// The result doesn't depend on the parallel flag. The method uses internal buffers, calling it concurrently on the same object is not allowed.
+		void compute( const double* xyz, double* normals, bool parallel = false );
+
+	private:
+		// Copy of the indices, padded with zeros to a multiple of 4 triangles
+		std::vector<uint32_t> m_indices;
+		// For every vertex, the adjacent triangles are in m_adjacent[ m_offsets[ i ] .. m_offsets[ i + 1 ] ), in ascending order
+		std::vector<uint32_t> m_offsets;
+		std::vector<uint32_t> m_adjacent;
+		// Cross products of the triangle edges, 4 doubles per triangle with W = 0.0; the length of them is 2 * area of the triangle
+		std::vector<double> m_faceNormals;
+		size_t m_triangles = 0;
+		size_t m_vertices = 0;
+	};
+
+	// Compute smooth vertex normals of the mesh, same as MeshNormals::build followed by compute.
+	void meshVertexNormals( const double* xyz, size_t vertices, const uint32_t* indices, size_t triangles, double* normals, bool parallel = false );
+}
\ No newline at end of file
@@ -87,6 +87,22 @@ namespace AvxMath
 #endif
 	}
 
+	// a * b - c * d, the result is antisymmetric, i.e. swapping the products negates the result exactly.
+	// With FMA3 that's Kahan's algorithm, the error is under 1.5 ULP and the sign is always correct.
+	// Without FMA in the instruction set, 2 multiplications and a subtraction; when the compiler targets FMA, this uses Kahan's algorithm
+	// even without _AM_FMA3_INTRINSICS_, because the compiler may fuse the plain version into FMA, which breaks the antisymmetry.
+	inline __m256d vectorDifferenceOfProducts( __m256d a, __m256d b, __m256d c, __m256d d )
+	{
+#if _AM_FMA3_INTRINSICS_ || defined( __FMA__ )
+		const __m256d cd = _mm256_mul_pd( c, d );
+		const __m256d err = _mm256_fnmadd_pd( c, d, cd );
+		const __m256d res = _mm256_fmsub_pd( a, b, cd );
+		return _mm256_add_pd( res, err );
+#else
+		return _mm256_sub_pd( _mm256_mul_pd( a, b ), _mm256_mul_pd( c, d ) );
+#endif
+	}
+
 	// Test whether the components of the 4D vector are within set bounds, i.e. -bounds <= vec <= bounds
 	inline bool vector4InBounds( __m256d vec, __m256d bounds )
 	{
@@ -251,8 +267,29 @@ namespace AvxMath
 		return _mm_cvtsd_si32( v );
 	}
 
-	// A low-precision approximation of hyperbolic tangent
-	__m256d _AM_CALL_ vectorTanH( __m256d vec );
+	// Index of the lowest set bit, the argument must not be zero
+	inline uint32_t lowestBit( uint32_t mask )
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward( &index, mask );
+		return index;
+#else
+		return (uint32_t)__builtin_ctz( mask );
+#endif
+	}
+
+	// Index of the lowest set bit of the 64-bit integer, the argument must not be zero
+	inline uint32_t lowestBit( uint64_t mask )
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward64( &index, mask );
+		return index;
+#else
+		return (uint32_t)__builtin_ctzll( mask );
+#endif
+	}
 
 	constexpr double g_pi = 3.141592653589793238;
 
@@ -0,0 +1,582 @@
+#include "AvxMath.h"
+#include "AvxMathParallel.h"
+#include <algorithm>
+#include <string.h>
+
+namespace AvxMath
+{
+	namespace
+	{
+		// When running multithreaded, each thread gets at least that many points to evaluate
+		constexpr size_t minParallelChunk = 1 << 12;
+
+		// 4 points in homogeneous coordinates: x * w, y * w, z * w, w
+		struct Homogeneous4
+		{
+			__m256d x, y, z, w;
+		};
+
+		inline Homogeneous4 homogeneousZero()
+		{
+			const __m256d z = _mm256_setzero_pd();
+			return Homogeneous4{ z, z, z, z };
+		}
+
+		// Compute a + b * s
+		inline Homogeneous4 homogeneousMultiplyAdd( const Homogeneous4& a, const Homogeneous4& b, __m256d s )
+		{
+			return Homogeneous4{ vectorMultiplyAdd( b.x, s, a.x ), vectorMultiplyAdd( b.y, s, a.y ), vectorMultiplyAdd( b.z, s, a.z ), vectorMultiplyAdd( b.w, s, a.w ) };
+		}
+
+		inline Homogeneous4 homogeneousSubtract( const Homogeneous4& a, const Homogeneous4& b )
+		{
+			return Homogeneous4{ _mm256_sub_pd( a.x, b.x ), _mm256_sub_pd( a.y, b.y ), _mm256_sub_pd( a.z, b.z ), _mm256_sub_pd( a.w, b.w ) };
+		}
+
+		inline Homogeneous4 homogeneousScale( const Homogeneous4& a, __m256d s )
+		{
+			return Homogeneous4{ _mm256_mul_pd( a.x, s ), _mm256_mul_pd( a.y, s ), _mm256_mul_pd( a.z, s ), _mm256_mul_pd( a.w, s ) };
+		}
+
+		// Broadcast a homogeneous point from 4 doubles
+		inline Homogeneous4 homogeneousSplat( const double* rsi )
+		{
+			return Homogeneous4{ _mm256_broadcast_sd( rsi ), _mm256_broadcast_sd( rsi + 1 ), _mm256_broadcast_sd( rsi + 2 ), _mm256_broadcast_sd( rsi + 3 ) };
+		}
+
+		// Load 4 homogeneous points from separate addresses, transposing into SoA layout
+		inline Homogeneous4 homogeneousLoad( const double* p0, const double* p1, const double* p2, const double* p3 )
+		{
+			const __m256d t0 = _mm256_insertf128_pd( _mm256_castpd128_pd256( _mm_loadu_pd( p0 ) ), _mm_loadu_pd( p2 ), 1 );         // x0, y0, x2, y2
+			const __m256d t1 = _mm256_insertf128_pd( _mm256_castpd128_pd256( _mm_loadu_pd( p0 + 2 ) ), _mm_loadu_pd( p2 + 2 ), 1 ); // z0, w0, z2, w2
+			const __m256d t2 = _mm256_insertf128_pd( _mm256_castpd128_pd256( _mm_loadu_pd( p1 ) ), _mm_loadu_pd( p3 ), 1 );         // x1, y1, x3, y3
+			const __m256d t3 = _mm256_insertf128_pd( _mm256_castpd128_pd256( _mm_loadu_pd( p1 + 2 ) ), _mm_loadu_pd( p3 + 2 ), 1 ); // z1, w1, z3, w3
+			return Homogeneous4{ _mm256_unpacklo_pd( t0, t2 ), _mm256_unpackhi_pd( t0, t2 ), _mm256_unpacklo_pd( t1, t3 ), _mm256_unpackhi_pd( t1, t3 ) };
+		}
+
+		inline Vector3x4 cartesian( const Homogeneous4& a )
+		{
+			return Vector3x4{ a.x, a.y, a.z };
+		}
+
+		// Compute a - b * s, the terms of the quotient rule
+		inline Vector3x4 quotientTerm( const Vector3x4& a, const Vector3x4& b, __m256d s )
+		{
+			return vector3x4Subtract( a, vector3x4Scale( b, s ) );
+		}
+
+		// Control points in homogeneous coordinates, 4 doubles per point
+		std::vector<double> homogeneousPoints( const double* points, const double* weights, size_t count )
+		{
+			std::vector<double> res( count * 4 );
+			for( size_t i = 0; i < count; i++ )
+			{
+				const double w = ( nullptr != weights ) ? weights[ i ] : 1.0;
+				res[ i * 4 ] = points[ i * 3 ] * w;
+				res[ i * 4 + 1 ] = points[ i * 3 + 1 ] * w;
+				res[ i * 4 + 2 ] = points[ i * 3 + 2 ] * w;
+				res[ i * 4 + 3 ] = w;
+			}
+			return res;
+		}
+
+		// Derivatives of the curve up to the order, from the derivatives of the homogeneous curve; the quotient rule for the rational curves
+		inline void curveDerivatives( const Homogeneous4* a, uint32_t order, bool rational, Vector3x4* c )
+		{
+			if( !rational )
+			{
+				for( uint32_t k = 0; k <= order; k++ )
+					c[ k ] = cartesian( a[ k ] );
+				return;
+			}
+			const __m256d inv = _mm256_div_pd( _mm256_set1_pd( 1.0 ), a[ 0 ].w );
+			c[ 0 ] = vector3x4Scale( cartesian( a[ 0 ] ), inv );
+			if( order >= 1 )
+				c[ 1 ] = vector3x4Scale( quotientTerm( cartesian( a[ 1 ] ), c[ 0 ], a[ 1 ].w ), inv );
+			if( order >= 2 )
+			{
+				Vector3x4 r = quotientTerm( cartesian( a[ 2 ] ), c[ 1 ], _mm256_add_pd( a[ 1 ].w, a[ 1 ].w ) );
+				c[ 2 ] = vector3x4Scale( quotientTerm( r, c[ 0 ], a[ 2 ].w ), inv );
+			}
+		}
+
+		// Store count <= 4 points
+		inline void storePoints( double* rdi, const Vector3x4& v, size_t count )
+		{
+			if( 4 == count )
+			{
+				storeVector3x4( rdi, v );
+				return;
+			}
+			double buffer[ 12 ];
+			storeVector3x4( buffer, v );
+			memcpy( rdi, buffer, count * 3 * sizeof( double ) );
+		}
+
+		// Load count <= 4 parameter values, repeating the last one in the unused lanes
+		inline __m256d loadParameters( const double* rsi, size_t count )
+		{
+			if( 4 == count )
+				return _mm256_loadu_pd( rsi );
+			double buffer[ 4 ];
+			for( size_t i = 0; i < 4; i++ )
+				buffer[ i ] = rsi[ std::min( i, count - 1 ) ];
+			return _mm256_loadu_pd( buffer );
+		}
+
+		// Index of the knot span which contains the parameter, in [ p .. count - 1 ] range.
+		// For valid knot vectors these spans have non-zero length, knots[ span ] < knots[ span + 1 ].
+		inline size_t findSpan( const double* knots, size_t count, uint32_t p, double t )
+		{
+			return std::upper_bound( knots + p + 1, knots + count, t ) - knots - 1;
+		}
+
+		inline __m256d gatherKnots( const double* knots, const size_t* spans, ptrdiff_t offset )
+		{
+			return _mm256_setr_pd( knots[ spans[ 0 ] + offset ], knots[ spans[ 1 ] + offset ], knots[ spans[ 2 ] + offset ], knots[ spans[ 3 ] + offset ] );
+		}
+
+		// ders[ k ][ i ] is the k-th derivative of the basis function N[ span - p + i ]
+		using BasisDerivatives = __m256d[ 3 ][ nurbsMaxDegree + 1 ];
+
+		// Non-zero basis functions of degree p and their derivatives up to the order, for 4 parameter values in possibly different spans.
+		// Piegl and Tiller, "The NURBS Book", algorithm A2.3.
+		void basisFunctions4( const double* knots, uint32_t p, const size_t* spans, __m256d u, uint32_t order, BasisDerivatives& ders )
+		{
+			const __m256d zero = _mm256_setzero_pd();
+			// The upper triangle has the basis functions of degrees 0 .. p, the lower one has the knot differences
+			__m256d ndu[ nurbsMaxDegree + 1 ][ nurbsMaxDegree + 1 ];
+			__m256d left[ nurbsMaxDegree + 1 ], right[ nurbsMaxDegree + 1 ];
+			ndu[ 0 ][ 0 ] = _mm256_set1_pd( 1.0 );
+			for( uint32_t j = 1; j <= p; j++ )
+			{
+				left[ j ] = _mm256_sub_pd( u, gatherKnots( knots, spans, 1 - (ptrdiff_t)j ) );
+				right[ j ] = _mm256_sub_pd( gatherKnots( knots, spans, j ), u );
+				__m256d saved = zero;
+				for( uint32_t r = 0; r < j; r++ )
+				{
+					ndu[ j ][ r ] = _mm256_add_pd( right[ r + 1 ], left[ j - r ] );
+					const __m256d temp = _mm256_div_pd( ndu[ r ][ j - 1 ], ndu[ j ][ r ] );
+					ndu[ r ][ j ] = vectorMultiplyAdd( right[ r + 1 ], temp, saved );
+					saved = _mm256_mul_pd( left[ j - r ], temp );
+				}
+				ndu[ j ][ j ] = saved;
+			}
+			for( uint32_t j = 0; j <= p; j++ )
+				ders[ 0 ][ j ] = ndu[ j ][ p ];
+
+			// Derivatives above the degree are zero
+			for( uint32_t k = p + 1; k <= order; k++ )
+				for( uint32_t j = 0; j <= p; j++ )
+					ders[ k ][ j ] = zero;
+			const int n = (int)std::min( order, p );
+			if( 0 == n )
+				return;
+
+			// Coefficients of the derivatives, the rows a[ s1 ] and a[ s2 ] alternate
+			__m256d a[ 2 ][ 3 ];
+			for( int r = 0; r <= (int)p; r++ )
+			{
+				int s1 = 0, s2 = 1;
+				a[ 0 ][ 0 ] = _mm256_set1_pd( 1.0 );
+				for( int k = 1; k <= n; k++ )
+				{
+					__m256d d = zero;
+					const int rk = r - k, pk = (int)p - k;
+					if( r >= k )
+					{
+						a[ s2 ][ 0 ] = _mm256_div_pd( a[ s1 ][ 0 ], ndu[ pk + 1 ][ rk ] );
+						d = _mm256_mul_pd( a[ s2 ][ 0 ], ndu[ rk ][ pk ] );
+					}
+					const int j1 = ( rk >= -1 ) ? 1 : -rk;
+					const int j2 = ( r - 1 <= pk ) ? k - 1 : (int)p - r;
+					for( int j = j1; j <= j2; j++ )
+					{
+						a[ s2 ][ j ] = _mm256_div_pd( _mm256_sub_pd( a[ s1 ][ j ], a[ s1 ][ j - 1 ] ), ndu[ pk + 1 ][ rk + j ] );
+						d = vectorMultiplyAdd( a[ s2 ][ j ], ndu[ rk + j ][ pk ], d );
+					}
+					if( r <= pk )
+					{
+						a[ s2 ][ k ] = _mm256_div_pd( _mm256_sub_pd( zero, a[ s1 ][ k - 1 ] ), ndu[ pk + 1 ][ r ] );
+						d = vectorMultiplyAdd( a[ s2 ][ k ], ndu[ r ][ pk ], d );
+					}
+					ders[ k ][ r ] = d;
+					std::swap( s1, s2 );
+				}
+			}
+
+			// Multiply by p! / ( p - k )!
+			double factor = p;
+			for( int k = 1; k <= n; k++ )
+			{
+				const __m256d f = _mm256_set1_pd( factor );
+				for( uint32_t j = 0; j <= p; j++ )
+					ders[ k ][ j ] = _mm256_mul_pd( ders[ k ][ j ], f );
+				factor *= (double)( (int)p - k );
+			}
+		}
+
+		// Weighted sums of p + 1 homogeneous control points, for the basis functions and their derivatives up to the order.
+		// hom has 4 doubles per control point, the lanes may have different spans.
+		inline void combine( const double* hom, const size_t* spans, uint32_t p, const BasisDerivatives& basis, uint32_t order, Homogeneous4* result )
+		{
+			for( uint32_t k = 0; k <= order; k++ )
+				result[ k ] = homogeneousZero();
+
+			if( spans[ 0 ] == spans[ 1 ] && spans[ 0 ] == spans[ 2 ] && spans[ 0 ] == spans[ 3 ] )
+			{
+				// Common case for dense sampling, all 4 parameters are in the same span, broadcasting the control points
+				const double* rsi = hom + ( spans[ 0 ] - p ) * 4;
+				for( uint32_t i = 0; i <= p; i++, rsi += 4 )
+				{
+					const Homogeneous4 pt = homogeneousSplat( rsi );
+					for( uint32_t k = 0; k <= order; k++ )
+						result[ k ] = homogeneousMultiplyAdd( result[ k ], pt, basis[ k ][ i ] );
+				}
+				return;
+			}
+
+			const double* r0 = hom + ( spans[ 0 ] - p ) * 4;
+			const double* r1 = hom + ( spans[ 1 ] - p ) * 4;
+			const double* r2 = hom + ( spans[ 2 ] - p ) * 4;
+			const double* r3 = hom + ( spans[ 3 ] - p ) * 4;
+			for( uint32_t i = 0; i <= p; i++ )
+			{
+				const Homogeneous4 pt = homogeneousLoad( r0 + i * 4, r1 + i * 4, r2 + i * 4, r3 + i * 4 );
+				for( uint32_t k = 0; k <= order; k++ )
+					result[ k ] = homogeneousMultiplyAdd( result[ k ], pt, basis[ k ][ i ] );
+			}
+		}
+
+		inline uint32_t derivativesOrder( const void* d1, const void* d2 )
+		{
+			return ( nullptr != d2 ) ? 2 : ( ( nullptr != d1 ) ? 1 : 0 );
+		}
+
+		void curveSpan( const NurbsCurve& curve, const double* hom, const double* t, size_t begin, size_t end, double* position, double* d1, double* d2 )
+		{
+			const uint32_t p = curve.degree;
+			const uint32_t order = derivativesOrder( d1, d2 );
+			const bool rational = nullptr != curve.weights;
+			BasisDerivatives basis;
+			for( size_t i = begin; i < end; i += 4 )
+			{
+				const size_t count = std::min( end - i, (size_t)4 );
+				const __m256d u = loadParameters( t + i, count );
+				size_t spans[ 4 ];
+				for( size_t j = 0; j < 4; j++ )
+					spans[ j ] = findSpan( curve.knots, curve.count, p, t[ i + std::min( j, count - 1 ) ] );
+
+				basisFunctions4( curve.knots, p, spans, u, order, basis );
+				Homogeneous4 a[ 3 ];
+				combine( hom, spans, p, basis, order, a );
+				Vector3x4 c[ 3 ];
+				curveDerivatives( a, order, rational, c );
+
+				storePoints( position + i * 3, c[ 0 ], count );
+				if( nullptr != d1 )
+					storePoints( d1 + i * 3, c[ 1 ], count );
+				if( nullptr != d2 )
+					storePoints( d2 + i * 3, c[ 2 ], count );
+			}
+		}
+
+		// Evaluates rows of the surface grid. The basis functions along U are computed once, the control net is first reduced to 1D curves for every V value.
+		class GridEvaluator
+		{
+			const NurbsSurface& surface;
+			const bool rational;
+			const uint32_t order;
+			const double* const u;
+			const size_t countU;
+			std::vector<double> hom;
+
+			struct alignas( 32 ) BlockU
+			{
+				BasisDerivatives basis;
+				size_t spans[ 4 ];
+			};
+			std::vector<BlockU> blocksU;
+
+		public:
+			GridEvaluator( const NurbsSurface& surface, const double* u, size_t countU, uint32_t order ) :
+				surface( surface ), rational( nullptr != surface.weights ), order( order ), u( u ), countU( countU )
+			{
+				hom = homogeneousPoints( surface.points, surface.weights, surface.countU * surface.countV );
+				blocksU.resize( ( countU + 3 ) / 4 );
+				for( size_t b = 0; b < blocksU.size(); b++ )
+				{
+					const size_t i = b * 4;
+					const size_t count = std::min( countU - i, (size_t)4 );
+					BlockU& block = blocksU[ b ];
+					for( size_t j = 0; j < 4; j++ )
+						block.spans[ j ] = findSpan( surface.knotsU, surface.countU, surface.degreeU, u[ i + std::min( j, count - 1 ) ] );
+					basisFunctions4( surface.knotsU, surface.degreeU, block.spans, loadParameters( u + i, count ), order, block.basis );
+				}
+			}
+
+			// Size of the temporary buffer for evaluateRow, in doubles
+			size_t bufferSize() const
+			{
+				return ( order + 1 ) * surface.countU * 4;
+			}
+
+			// Evaluate a row of the grid for the parameter v; the output pointers are for that row, with countU points
+			void evaluateRow( double v, const SurfaceGrid& out, double* buffer ) const
+			{
+				const uint32_t p = surface.degreeU, q = surface.degreeV;
+				const size_t cu = surface.countU;
+
+				// Reduce the control net to the homogeneous control points of the curves along U, for the position and the derivatives along V.
+				// All lanes have the same parameter, the basis functions are broadcasted.
+				size_t spansV[ 4 ];
+				spansV[ 0 ] = spansV[ 1 ] = spansV[ 2 ] = spansV[ 3 ] = findSpan( surface.knotsV, surface.countV, q, v );
+				BasisDerivatives basisV;
+				basisFunctions4( surface.knotsV, q, spansV, _mm256_set1_pd( v ), order, basisV );
+				for( uint32_t l = 0; l <= order; l++ )
+				{
+					double* const rdi = buffer + l * cu * 4;
+					for( size_t k = 0; k < cu; k++ )
+					{
+						const double* rsi = hom.data() + ( ( spansV[ 0 ] - q ) * cu + k ) * 4;
+						__m256d acc = _mm256_setzero_pd();
+						for( uint32_t j = 0; j <= q; j++, rsi += cu * 4 )
+							acc = vectorMultiplyAdd( _mm256_loadu_pd( rsi ), basisV[ l ][ j ], acc );
+						_mm256_storeu_pd( rdi + k * 4, acc );
+					}
+				}
+
+				for( size_t b = 0; b < blocksU.size(); b++ )
+				{
+					const size_t i = b * 4;
+					const size_t count = std::min( countU - i, (size_t)4 );
+					const BlockU& block = blocksU[ b ];
+
+					// a[ k ][ l ] is the derivative of the homogeneous surface, k times along U and l times along V
+					Homogeneous4 a[ 3 ][ 3 ];
+					for( uint32_t l = 0; l <= order; l++ )
+					{
+						Homogeneous4 tmp[ 3 ];
+						combine( buffer + l * cu * 4, block.spans, p, block.basis, order - l, tmp );
+						for( uint32_t k = 0; k + l <= order; k++ )
+							a[ k ][ l ] = tmp[ k ];
+					}
+
+					Vector3x4 s[ 3 ][ 3 ];
+					surfaceDerivatives( a, s );
+					const size_t offset = i * 3;
+					storePoints( out.position + offset, s[ 0 ][ 0 ], count );
+					if( nullptr != out.du )
+						storePoints( out.du + offset, s[ 1 ][ 0 ], count );
+					if( nullptr != out.dv )
+						storePoints( out.dv + offset, s[ 0 ][ 1 ], count );
+					if( nullptr != out.duu )
+						storePoints( out.duu + offset, s[ 2 ][ 0 ], count );
+					if( nullptr != out.duv )
+						storePoints( out.duv + offset, s[ 1 ][ 1 ], count );
+					if( nullptr != out.dvv )
+						storePoints( out.dvv + offset, s[ 0 ][ 2 ], count );
+				}
+			}
+
+		private:
+			// Derivatives of the surface from the derivatives of the homogeneous surface, Piegl and Tiller algorithm A4.4
+			void surfaceDerivatives( const Homogeneous4( &a )[ 3 ][ 3 ], Vector3x4( &s )[ 3 ][ 3 ] ) const
+			{
+				if( !rational )
+				{
+					for( uint32_t k = 0; k <= order; k++ )
+						for( uint32_t l = 0; k + l <= order; l++ )
+							s[ k ][ l ] = cartesian( a[ k ][ l ] );
+					return;
+				}
+
+				const __m256d inv = _mm256_div_pd( _mm256_set1_pd( 1.0 ), a[ 0 ][ 0 ].w );
+				s[ 0 ][ 0 ] = vector3x4Scale( cartesian( a[ 0 ][ 0 ] ), inv );
+				if( order < 1 )
+					return;
+				const __m256d wu = a[ 1 ][ 0 ].w, wv = a[ 0 ][ 1 ].w;
+				s[ 1 ][ 0 ] = vector3x4Scale( quotientTerm( cartesian( a[ 1 ][ 0 ] ), s[ 0 ][ 0 ], wu ), inv );
+				s[ 0 ][ 1 ] = vector3x4Scale( quotientTerm( cartesian( a[ 0 ][ 1 ] ), s[ 0 ][ 0 ], wv ), inv );
+				if( order < 2 )
+					return;
+
+				Vector3x4 r = quotientTerm( cartesian( a[ 2 ][ 0 ] ), s[ 1 ][ 0 ], _mm256_add_pd( wu, wu ) );
+				s[ 2 ][ 0 ] = vector3x4Scale( quotientTerm( r, s[ 0 ][ 0 ], a[ 2 ][ 0 ].w ), inv );
+				r = quotientTerm( cartesian( a[ 0 ][ 2 ] ), s[ 0 ][ 1 ], _mm256_add_pd( wv, wv ) );
+				s[ 0 ][ 2 ] = vector3x4Scale( quotientTerm( r, s[ 0 ][ 0 ], a[ 0 ][ 2 ].w ), inv );
+				r = quotientTerm( cartesian( a[ 1 ][ 1 ] ), s[ 0 ][ 0 ], a[ 1 ][ 1 ].w );
+				r = quotientTerm( r, s[ 0 ][ 1 ], wu );
+				s[ 1 ][ 1 ] = vector3x4Scale( quotientTerm( r, s[ 1 ][ 0 ], wv ), inv );
+			}
+		};
+
+		// Offset the output pointers to the row of the grid
+		inline SurfaceGrid gridRow( const SurfaceGrid& grid, size_t offset )
+		{
+			const auto row = [ offset ]( double* p ) { return ( nullptr != p ) ? p + offset : nullptr; };
+			SurfaceGrid res;
+			res.position = row( grid.position );
+			res.du = row( grid.du );
+			res.dv = row( grid.dv );
+			res.duu = row( grid.duu );
+			res.duv = row( grid.duv );
+			res.dvv = row( grid.dvv );
+			return res;
+		}
+
+		// Evenly spaced parameters covering the domain, the last one is exactly at the end
+		std::vector<double> uniformParameters( const double* knots, size_t count, uint32_t degree, size_t samples )
+		{
+			const double begin = knots[ degree ], end = knots[ count ];
+			std::vector<double> res( samples );
+			for( size_t i = 0; i < samples; i++ )
+				res[ i ] = begin + ( end - begin ) * (double)i / (double)( samples - 1 );
+			res[ samples - 1 ] = end;
+			return res;
+		}
+
+		// Unit normals from the partial derivatives, zero when the cross product is zero
+		void normalsSpan( const double* du, const double* dv, double* normals, size_t count )
+		{
+			for( size_t i = 0; i < count; i += 4 )
+			{
+				const size_t n = std::min( count - i, (size_t)4 );
+				double bufferU[ 12 ], bufferV[ 12 ];
+				memcpy( bufferU, du + i * 3, n * 3 * sizeof( double ) );
+				memcpy( bufferV, dv + i * 3, n * 3 * sizeof( double ) );
+				const Vector3x4 c = vector3x4Cross( loadVector3x4( bufferU ), loadVector3x4( bufferV ) );
+				const __m256d len = _mm256_sqrt_pd( vector3x4Dot( c, c ) );
+				const __m256d inv = _mm256_and_pd( _mm256_div_pd( _mm256_set1_pd( 1.0 ), len ), _mm256_cmp_pd( len, _mm256_setzero_pd(), _CMP_GT_OQ ) );
+				storePoints( normals + i * 3, vector3x4Scale( c, inv ), n );
+			}
+		}
+	}
+
+	void bezierEvaluate( const double* points, const double* weights, size_t count, const double* t, size_t length, double* position, double* d1, double* d2 )
+	{
+		if( 0 == count || 0 == length )
+			return;
+		assert( count <= nurbsMaxDegree + 1 );
+		const std::vector<double> hom = homogeneousPoints( points, weights, count );
+		const uint32_t n = (uint32_t)count - 1;
+		const uint32_t order = derivativesOrder( d1, d2 );
+		const __m256d first = _mm256_set1_pd( n ), second = _mm256_set1_pd( (double)n * (double)( n - 1 ) );
+
+		Homogeneous4 b[ nurbsMaxDegree + 1 ];
+		for( size_t i = 0; i < length; i += 4 )
+		{
+			const size_t lanes = std::min( length - i, (size_t)4 );
+			const __m256d tv = loadParameters( t + i, lanes );
+			for( uint32_t j = 0; j <= n; j++ )
+				b[ j ] = homogeneousSplat( &hom[ j * 4 ] );
+
+			// The derivatives are the differences of the intermediate points, when 3 and then 2 points remain
+			Homogeneous4 a[ 3 ] = { homogeneousZero(), homogeneousZero(), homogeneousZero() };
+			for( uint32_t level = 1; level <= n; level++ )
+			{
+				const uint32_t remaining = n + 2 - level;
+				if( 3 == remaining && order >= 2 )
+				{
+					const Homogeneous4 diff = homogeneousSubtract( homogeneousSubtract( b[ 2 ], b[ 1 ] ), homogeneousSubtract( b[ 1 ], b[ 0 ] ) );
+					a[ 2 ] = homogeneousScale( diff, second );
+				}
+				else if( 2 == remaining && order >= 1 )
+					a[ 1 ] = homogeneousScale( homogeneousSubtract( b[ 1 ], b[ 0 ] ), first );
+
+				for( uint32_t j = 0; j + level <= n; j++ )
+					b[ j ] = homogeneousMultiplyAdd( b[ j ], homogeneousSubtract( b[ j + 1 ], b[ j ] ), tv );
+			}
+			a[ 0 ] = b[ 0 ];
+
+			Vector3x4 c[ 3 ];
+			curveDerivatives( a, order, nullptr != weights, c );
+			storePoints( position + i * 3, c[ 0 ], lanes );
+			if( nullptr != d1 )
+				storePoints( d1 + i * 3, c[ 1 ], lanes );
+			if( nullptr != d2 )
+				storePoints( d2 + i * 3, c[ 2 ], lanes );
+		}
+	}
+
+	void nurbsEvaluate( const NurbsCurve& curve, const double* t, size_t length, double* position, double* d1, double* d2, bool parallel )
+	{
+		if( 0 == length || 0 == curve.count )
+			return;
+		assert( curve.degree <= nurbsMaxDegree && curve.count > curve.degree );
+		const std::vector<double> hom = homogeneousPoints( curve.points, curve.weights, curve.count );
+		parallelFor( length, parallel ? minParallelChunk : length, [ & ]( size_t begin, size_t end )
+		{
+			curveSpan( curve, hom.data(), t, begin, end, position, d1, d2 );
+		} );
+	}
+
+	void nurbsEvaluateGrid( const NurbsSurface& surface, const double* u, size_t countU, const double* v, size_t countV, const SurfaceGrid& output, bool parallel )
+	{
+		if( 0 == countU || 0 == countV || 0 == surface.countU || 0 == surface.countV )
+			return;
+		assert( surface.degreeU <= nurbsMaxDegree && surface.countU > surface.degreeU );
+		assert( surface.degreeV <= nurbsMaxDegree && surface.countV > surface.degreeV );
+		assert( nullptr != output.position );
+
+		uint32_t order = 0;
+		if( nullptr != output.du || nullptr != output.dv )
+			order = 1;
+		if( nullptr != output.duu || nullptr != output.duv || nullptr != output.dvv )
+			order = 2;
+
+		const GridEvaluator evaluator{ surface, u, countU, order };
+		const size_t minRows = std::max( minParallelChunk / countU, (size_t)1 );
+		parallelFor( countV, parallel ? minRows : countV, [ & ]( size_t begin, size_t end )
+		{
+			std::vector<double> buffer( evaluator.bufferSize() );
+			for( size_t j = begin; j < end; j++ )
+				evaluator.evaluateRow( v[ j ], gridRow( output, j * countU * 3 ), buffer.data() );
+		} );
+	}
+
+	void nurbsTessellate( const NurbsSurface& surface, size_t samplesU, size_t samplesV, double* positions, double* normals, uint32_t* indices, bool parallel )
+	{
+		assert( samplesU >= 2 && samplesV >= 2 );
+		assert( surface.degreeU <= nurbsMaxDegree && surface.countU > surface.degreeU );
+		assert( surface.degreeV <= nurbsMaxDegree && surface.countV > surface.degreeV );
+		const std::vector<double> u = uniformParameters( surface.knotsU, surface.countU, surface.degreeU, samplesU );
+		const std::vector<double> v = uniformParameters( surface.knotsV, surface.countV, surface.degreeV, samplesV );
+
+		const GridEvaluator evaluator{ surface, u.data(), samplesU, 1 };
+		const size_t minRows = std::max( minParallelChunk / samplesU, (size_t)1 );
+		parallelFor( samplesV, parallel ? minRows : samplesV, [ & ]( size_t begin, size_t end )
+		{
+			std::vector<double> buffer( evaluator.bufferSize() ), du( samplesU * 3 ), dv( samplesU * 3 );
+			SurfaceGrid row;
+			row.du = du.data();
+			row.dv = dv.data();
+			for( size_t j = begin; j < end; j++ )
+			{
+				row.position = positions + j * samplesU * 3;
+				evaluator.evaluateRow( v[ j ], row, buffer.data() );
+				normalsSpan( du.data(), dv.data(), normals + j * samplesU * 3, samplesU );
+			}
+		} );
+
+		if( nullptr == indices )
+			return;
+		// 2 triangles per quad of the grid, the normals are along du x dv
+		const size_t quadsU = samplesU - 1, quads = quadsU * ( samplesV - 1 );
+		parallelFor( quads, parallel ? minParallelChunk : quads, [ = ]( size_t begin, size_t end )
+		{
+			for( size_t q = begin; q < end; q++ )
+			{
+				const uint32_t a = (uint32_t)( ( q / quadsU ) * samplesU + q % quadsU );
+				const uint32_t b = a + 1, c = a + (uint32_t)samplesU + 1, d = a + (uint32_t)samplesU;
+				uint32_t* const rdi = indices + q * 6;
+				rdi[ 0 ] = a;
+				rdi[ 1 ] = b;
+				rdi[ 2 ] = c;
+				rdi[ 3 ] = a;
+				rdi[ 4 ] = c;
+				rdi[ 5 ] = d;
+			}
+		} );
+	}
+}
\ No newline at end of file
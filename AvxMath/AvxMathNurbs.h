@@ -0,0 +1,60 @@
+// Batch evaluation of Bezier, B-spline and NURBS curves and surfaces, with derivatives up to the second order
+#pragma once
+
+namespace AvxMath
+{
+	// Maximum degree of the curves and surfaces, in both directions
+	constexpr uint32_t nurbsMaxDegree = 15;
+
+	// The structures reference the caller's arrays, they don't copy the data.
+	// The control points have 3 doubles per point. Weights are optional, nullptr means a non-rational curve or surface.
+	// The knot vectors are non-decreasing, with count + degree + 1 elements; the domain is [ knots[ degree ] .. knots[ count ] ].
+	struct NurbsCurve
+	{
+		const double* points;
+		const double* weights;
+		const double* knots;
+		size_t count;
+		uint32_t degree;
+	};
+
+	// Control point ( i, j ) is at the index j * countU + i, i.e. the rows of the control net go along U
+	struct NurbsSurface
+	{
+		const double* points;
+		const double* weights;
+		const double* knotsU;
+		const double* knotsV;
+		size_t countU, countV;
+		uint32_t degreeU, degreeV;
+	};
+
+	// Output arrays of the surface evaluation, 3 doubles per point. The derivatives with null pointers are not computed.
+	struct SurfaceGrid
+	{
+		double* position = nullptr;
+		double* du = nullptr;
+		double* dv = nullptr;
+		double* duu = nullptr;
+		double* duv = nullptr;
+		double* dvv = nullptr;
+	};
+
+	// The evaluators process 4 parameter values per iteration, in SoA layout. Parameters outside of the domain extrapolate the first or last span.
+	// The output arrays have 3 doubles per parameter value; the derivatives are optional, with respect to the parameter.
+
+	// Evaluate the Bezier curve with count control points at the count of parameters in [ 0 .. 1 ] interval, with de Casteljau algorithm
+	void bezierEvaluate( const double* points, const double* weights, size_t count, const double* t, size_t length, double* position, double* d1 = nullptr, double* d2 = nullptr );
+
+	// Evaluate the NURBS curve, computing basis functions with Cox-de Boor recursion. With parallel = true, large batches are split across the hardware threads.
+	void nurbsEvaluate( const NurbsCurve& curve, const double* t, size_t length, double* position, double* d1 = nullptr, double* d2 = nullptr, bool parallel = false );
+
+	// Evaluate the NURBS surface on the grid of parameters, u[ countU ] by v[ countV ]; the result for ( u[ i ], v[ j ] ) is at the index j * countU + i.
+	// Bezier surfaces are NURBS with 2 knots of multiplicity degree + 1, at 0 and 1. With parallel = true, the rows of the grid are split across the hardware threads.
+	void nurbsEvaluateGrid( const NurbsSurface& surface, const double* u, size_t countU, const double* v, size_t countV, const SurfaceGrid& output, bool parallel = false );
+
+	// Tessellate the surface into the uniform grid of samplesU by samplesV points covering the domain, both counts are at least 2.
+	// positions and normals receive samplesU * samplesV points, normals are unit length, or zero at the degenerate points of the surface.
+	// Optional indices receive ( samplesU - 1 ) * ( samplesV - 1 ) * 6 vertex indices for the triangles, oriented counter-clockwise around the normals.
+	void nurbsTessellate( const NurbsSurface& surface, size_t samplesU, size_t samplesV, double* positions, double* normals, uint32_t* indices = nullptr, bool parallel = false );
+}
\ No newline at end of file
@@ -0,0 +1,247 @@
+#include "AvxMath.h"
+#include "AvxMathParallel.h"
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+namespace AvxMath
+{
+	namespace
+	{
+		size_t hardwareThreads()
+		{
+			static const size_t count = std::max( (size_t)std::thread::hardware_concurrency(), (size_t)1 );
+			return count;
+		}
+
+		std::atomic<size_t> g_threadsLimit{ 0 };
+
+		// Chunks [ begin .. end ) of a thread, packed into 64 bits: begin in the lower half, end in the higher one.
+		// The owner takes the chunks from the front, the thieves from the back; both update the range with compare and swap.
+		struct alignas( 64 ) Slot
+		{
+			std::atomic<uint64_t> range;
+
+			bool popFront( size_t& chunk )
+			{
+				uint64_t r = range.load( std::memory_order_relaxed );
+				while( true )
+				{
+					const uint32_t begin = (uint32_t)r, end = (uint32_t)( r >> 32 );
+					if( begin >= end )
+						return false;
+					if( range.compare_exchange_weak( r, r + 1, std::memory_order_relaxed ) )
+					{
+						chunk = begin;
+						return true;
+					}
+				}
+			}
+
+			bool popBack( size_t& chunk )
+			{
+				uint64_t r = range.load( std::memory_order_relaxed );
+				while( true )
+				{
+					const uint32_t begin = (uint32_t)r, end = (uint32_t)( r >> 32 );
+					if( begin >= end )
+						return false;
+					const uint64_t next = ( (uint64_t)( end - 1 ) << 32 ) | begin;
+					if( range.compare_exchange_weak( r, next, std::memory_order_relaxed ) )
+					{
+						chunk = end - 1;
+						return true;
+					}
+				}
+			}
+
+			bool empty() const
+			{
+				const uint64_t r = range.load( std::memory_order_relaxed );
+				return (uint32_t)r >= (uint32_t)( r >> 32 );
+			}
+		};
+
+		// A parallel loop submitted to the pool
+		struct Job
+		{
+			ParallelBody body;
+			void* context;
+			size_t length, chunkSize;
+			size_t countSlots;
+			std::unique_ptr<Slot[]> slots;
+			// These fields are protected by the mutex of the pool: the slots taken by the threads, count of the pool threads which joined the job, and which are still running it
+			std::vector<bool> taken;
+			size_t joined = 0, active = 0;
+
+			Job( size_t length, size_t chunkSize, size_t threads, ParallelBody body, void* context ) :
+				body( body ), context( context ), length( length ), chunkSize( chunkSize )
+			{
+				const size_t chunks = ( length + chunkSize - 1 ) / chunkSize;
+				assert( chunks < UINT32_MAX );
+				countSlots = std::min( threads, chunks );
+				slots.reset( new Slot[ countSlots ] );
+				taken.assign( countSlots, false );
+				taken[ 0 ] = true;
+				for( size_t i = 0; i < countSlots; i++ )
+				{
+					const uint64_t begin = chunks * i / countSlots, end = chunks * ( i + 1 ) / countSlots;
+					slots[ i ].range.store( begin | ( end << 32 ), std::memory_order_relaxed );
+				}
+			}
+
+			bool hasWork() const
+			{
+				for( size_t i = 0; i < countSlots; i++ )
+					if( !slots[ i ].empty() )
+						return true;
+				return false;
+			}
+
+			void runChunk( size_t chunk )
+			{
+				const size_t begin = chunk * chunkSize;
+				body( context, begin, std::min( begin + chunkSize, length ) );
+			}
+
+			// Process the own slot, then steal from the others
+			void process( size_t slot )
+			{
+				size_t chunk;
+				while( slots[ slot ].popFront( chunk ) )
+					runChunk( chunk );
+				for( size_t i = 1; i <= countSlots; i++ )
+				{
+					Slot& victim = slots[ ( slot + i ) % countSlots ];
+					while( victim.popBack( chunk ) )
+						runChunk( chunk );
+				}
+			}
+		};
+
+		class ThreadPool
+		{
+			std::vector<std::thread> workers;
+			std::mutex mutex;
+			std::condition_variable wake, done;
+			// Jobs with chunks which may be available for the pool threads, the nested ones are at the end
+			std::vector<Job*> jobs;
+			bool stopping = false;
+
+			// Find a job for the pool thread, the newest first; the caller holds the lock
+			Job* findJob()
+			{
+				for( auto it = jobs.rbegin(); it != jobs.rend(); it++ )
+				{
+					Job* job = *it;
+					if( job->joined + 1 < job->countSlots && job->hasWork() )
+						return job;
+				}
+				return nullptr;
+			}
+
+			// Take a free slot of the job for the pool thread, preferably the one with the same index as the thread; the caller holds the lock
+			static size_t takeSlot( Job& job, size_t id )
+			{
+				size_t slot = id;
+				if( slot >= job.countSlots || job.taken[ slot ] )
+					slot = std::find( job.taken.begin(), job.taken.end(), false ) - job.taken.begin();
+				job.taken[ slot ] = true;
+				return slot;
+			}
+
+			void workerMain( size_t id )
+			{
+				std::unique_lock<std::mutex> lock{ mutex };
+				while( true )
+				{
+					Job* job = nullptr;
+					wake.wait( lock, [ & ]() { return stopping || nullptr != ( job = findJob() ); } );
+					if( stopping )
+						return;
+					job->joined++;
+					job->active++;
+					const size_t slot = takeSlot( *job, id );
+					lock.unlock();
+					job->process( slot );
+					lock.lock();
+					if( 0 == --job->active )
+						done.notify_all();
+				}
+			}
+
+		public:
+			ThreadPool()
+			{
+				// The calling thread is the slot #0, the pool threads have the rest of them
+				const size_t count = hardwareThreads();
+				workers.reserve( count - 1 );
+				for( size_t i = 1; i < count; i++ )
+					workers.emplace_back( [ this, i ]() { workerMain( i ); } );
+			}
+
+			~ThreadPool()
+			{
+				{
+					std::lock_guard<std::mutex> lock{ mutex };
+					stopping = true;
+				}
+				wake.notify_all();
+				for( auto& t : workers )
+					t.join();
+			}
+
+			void run( Job& job )
+			{
+				{
+					std::lock_guard<std::mutex> lock{ mutex };
+					jobs.push_back( &job );
+				}
+				for( size_t i = 1; i < job.countSlots; i++ )
+					wake.notify_one();
+
+				job.process( 0 );
+
+				// No more chunks to take, remove the job so no other thread joins it, and wait for the threads which are still running the chunks
+				std::unique_lock<std::mutex> lock{ mutex };
+				jobs.erase( std::find( jobs.begin(), jobs.end(), &job ) );
+				done.wait( lock, [ & ]() { return 0 == job.active; } );
+			}
+		};
+
+		ThreadPool& threadPool()
+		{
+			static ThreadPool pool;
+			return pool;
+		}
+	}
+
+	void setParallelThreads( size_t threads )
+	{
+		g_threadsLimit = std::min( std::max( threads, (size_t)1 ), hardwareThreads() );
+	}
+
+	size_t parallelThreadsLimit()
+	{
+		const size_t limit = g_threadsLimit.load( std::memory_order_relaxed );
+		return ( 0 != limit ) ? limit : hardwareThreads();
+	}
+
+	void parallelRun( size_t length, size_t chunkSize, size_t threads, ParallelBody body, void* context )
+	{
+		if( 0 == length )
+			return;
+		assert( chunkSize > 0 );
+		Job job{ length, chunkSize, threads, body, context };
+		if( job.countSlots <= 1 )
+		{
+			body( context, 0, length );
+			return;
+		}
+		threadPool().run( job );
+	}
+}
\ No newline at end of file
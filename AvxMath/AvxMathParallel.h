@@ -0,0 +1,86 @@
+// Multithreading support for the batch functions of the library, runs the loops on a persistent pool of threads.
+// Not included by AvxMath.h, only by the source files which need it.
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <type_traits>
+
+namespace AvxMath
+{
+	// Limit count of the threads used by the batch functions, including the calling thread; the value is clamped to [ 1 .. hardware threads ].
+	// The default is all hardware threads.
+	void setParallelThreads( size_t threads );
+	// Current limit of the threads
+	size_t parallelThreadsLimit();
+
+	// Body of a parallel loop with erased type, processes [ begin .. end ) range of the elements
+	using ParallelBody = void( *)( void* context, size_t begin, size_t end );
+
+	// Run the body over [ 0 .. length ) range, split into chunks of chunkSize elements, on up to threads threads of the pool including the calling one.
+	// Every thread owns a contiguous slot of the chunks and processes it in ascending order; the threads which are done steal the chunks from the end of other slots.
+	// The calling thread owns the slot #0; the pool thread #k prefers the slot #k, and takes another free slot when its own one is out of range or already taken.
+	// The arrays initialized with a parallel loop get their memory pages placed on the NUMA nodes of the threads which touched them first,
+	// the loops of the same length then mostly access local memory, as long as the same pool threads are idle when the loops start.
+	// Can be called from inside the body of another loop, the calling thread processes the chunks which no other thread picked up.
+	void parallelRun( size_t length, size_t chunkSize, size_t threads, ParallelBody body, void* context );
+
+	// Count of threads to use for the specified count of elements, when every thread needs at least minChunk of them
+	inline size_t parallelThreads( size_t length, size_t minChunk )
+	{
+		const size_t threads = std::min( parallelThreadsLimit(), length / std::max( minChunk, (size_t)1 ) );
+		return std::max( threads, (size_t)1 );
+	}
+
+	namespace details
+	{
+		template<class Fn>
+		void invokeRange( void* context, size_t begin, size_t end )
+		{
+			( *(Fn*)context )( begin, end );
+		}
+
+		template<class Fn>
+		void invokeIndex( void* context, size_t begin, size_t end )
+		{
+			for( size_t i = begin; i < end; i++ )
+				( *(Fn*)context )( i );
+		}
+	}
+
+	// Split [ 0 .. length ) range into contiguous chunks, and call fn( begin, end ) for each chunk on the threads of the pool.
+	// Uses as many threads as there are minChunk elements in the range; each thread gets several chunks for load balancing.
+	// Chunk boundaries are aligned by 16 elements. The calling thread participates, and returns when all chunks are complete.
+	template<class Fn>
+	inline void parallelFor( size_t length, size_t minChunk, Fn&& fn )
+	{
+		const size_t threads = parallelThreads( length, minChunk );
+		if( threads <= 1 )
+		{
+			fn( (size_t)0, length );
+			return;
+		}
+
+		// 4 chunks per thread
+		size_t chunk = ( length + threads * 4 - 1 ) / ( threads * 4 );
+		chunk = ( chunk + 15 ) & ~(size_t)15;
+		using F = std::remove_reference_t<Fn>;
+		parallelRun( length, chunk, threads, &details::invokeRange<F>, (void*)&fn );
+	}
+
+	// Call fn( i ) for every i in [ 0 .. count ) interval, in parallel on up to count threads.
+	// The calls may share a thread when the pool is busy, they should not wait for each other.
+	template<class Fn>
+	inline void parallelInvoke( size_t count, Fn&& fn )
+	{
+		if( count == 0 )
+			return;
+		if( count == 1 )
+		{
+			fn( (size_t)0 );
+			return;
+		}
+		using F = std::remove_reference_t<Fn>;
+		parallelRun( count, 1, count, &details::invokeIndex<F>, (void*)&fn );
+	}
+}
\ No newline at end of file
@@ -0,0 +1,157 @@
+// Fused batch processing of 3D vectors: a chain of stages compiled into a single loop over the array.
+// The loop loads 4 vectors at a time, transposes them into SoA layout, applies all the stages while the intermediate values stay in registers, and stores the result.
+// For example, the following line is equivalent to storeDouble3( rdi, vector3Normalize( vector3Transform( loadDouble3( rsi ), mat ) ) ) for every vector:
+// makePipeline( PipeTransform{ mat }, PipeNormalize{} ).run( rsi, rdi, count );
+// Any callable which takes and returns Vector3x4 can be a stage.
+#pragma once
+#include <tuple>
+#include <utility>
+#include <string.h>
+
+namespace AvxMath
+{
+	namespace details
+	{
+		// Broadcast 4 lanes of the vector into 4 registers
+		inline void splatLanes( __m256d vec, __m256d* rdi )
+		{
+			rdi[ 0 ] = vectorSplatX( vec );
+			rdi[ 1 ] = vectorSplatY( vec );
+			rdi[ 2 ] = vectorSplatZ( vec );
+			rdi[ 3 ] = vectorSplatW( vec );
+		}
+
+		// Dot product of 4 vectors with W = 1 and a row of the matrix, the row is broadcasted into 4 registers
+		inline __m256d dotRow( const Vector3x4& v, const __m256d* row )
+		{
+			__m256d res = vectorMultiplyAdd( v.z, row[ 2 ], row[ 3 ] );
+			res = vectorMultiplyAdd( v.y, row[ 1 ], res );
+			return vectorMultiplyAdd( v.x, row[ 0 ], res );
+		}
+	}
+
+	// Transform the vectors by the matrix with W = 1, same as vector3Transform; the W component of the result is discarded
+	struct PipeTransform
+	{
+		__m256d m[ 12 ];
+
+		PipeTransform( const Matrix4x4& mat )
+		{
+			details::splatLanes( mat.r0, m );
+			details::splatLanes( mat.r1, m + 4 );
+			details::splatLanes( mat.r2, m + 8 );
+		}
+
+		Vector3x4 operator()( const Vector3x4& v ) const
+		{
+			return Vector3x4{ details::dotRow( v, m ), details::dotRow( v, m + 4 ), details::dotRow( v, m + 8 ) };
+		}
+	};
+
+	// Transform the vectors by the matrix with W = 1 and project back into W = 1, same as vector3TransformCoord
+	struct PipeTransformCoord
+	{
+		__m256d m[ 16 ];
+
+		PipeTransformCoord( const Matrix4x4& mat )
+		{
+			details::splatLanes( mat.r0, m );
+			details::splatLanes( mat.r1, m + 4 );
+			details::splatLanes( mat.r2, m + 8 );
+			details::splatLanes( mat.r3, m + 12 );
+		}
+
+		Vector3x4 operator()( const Vector3x4& v ) const
+		{
+			// One division and 3 multiplications, the results may differ from vector3TransformCoord by 1 ULP
+			const __m256d inv = _mm256_div_pd( broadcast( g_misc.one ), details::dotRow( v, m + 12 ) );
+			return vector3x4Scale( Vector3x4{ details::dotRow( v, m ), details::dotRow( v, m + 4 ), details::dotRow( v, m + 8 ) }, inv );
+		}
+	};
+
+	// Normalize the vectors, same as vector3Normalize: zero and NaN vectors become zero, infinitely long ones become NaN.
+	// Multiplies by the reciprocal of the length, the results may differ from vector3Normalize by 1 ULP.
+	struct PipeNormalize
+	{
+		Vector3x4 operator()( const Vector3x4& v ) const
+		{
+			const __m256d lsq = vector3x4Dot( v, v );
+			const __m256d inf = broadcast( g_misc.infinity );
+			const __m256d positive = _mm256_cmp_pd( lsq, _mm256_setzero_pd(), _CMP_GT_OQ );
+			const __m256d infinite = _mm256_cmp_pd( lsq, inf, _CMP_EQ_OQ );
+			countLanes( eCounter::NormalizeZero, _mm256_cmp_pd( lsq, _mm256_setzero_pd(), _CMP_NGT_UQ ) );
+			countLanes( eCounter::NormalizeInfinite, infinite );
+
+			// Zero the lanes which are not positive, set the infinite ones to all bits set, which is a NaN
+			const __m256d mul = _mm256_div_pd( broadcast( g_misc.one ), _mm256_sqrt_pd( lsq ) );
+			const Vector3x4 r = vector3x4Scale( v, mul );
+			return Vector3x4{
+				_mm256_or_pd( _mm256_and_pd( r.x, positive ), infinite ),
+				_mm256_or_pd( _mm256_and_pd( r.y, positive ), infinite ),
+				_mm256_or_pd( _mm256_and_pd( r.z, positive ), infinite ) };
+		}
+	};
+
+	// A chain of stages applied to arrays of 3D vectors, see the comment at the top of this header
+	template<class... Stages>
+	class Pipeline
+	{
+		std::tuple<Stages...> stages;
+
+		template<size_t... I>
+		Vector3x4 apply( Vector3x4 v, std::index_sequence<I...> ) const
+		{
+			( ( v = std::get<I>( stages )( v ) ), ... );
+			return v;
+		}
+
+	public:
+		explicit Pipeline( const Stages&... s ) : stages( s... ) { }
+
+		// Apply all stages to 4 vectors
+		Vector3x4 operator()( const Vector3x4& v ) const
+		{
+			return apply( v, std::index_sequence_for<Stages...>{} );
+		}
+
+		// Process count vectors, 3 numbers each. The output may be the same array as the input, otherwise they should not overlap.
+		// The elements of the arrays are double, float, or uint16_t with FP16 numbers when F16C is available; the conversions happen in registers, without temporary arrays.
+		template<class In, class Out>
+		void run( const In* rsi, Out* rdi, size_t count ) const
+		{
+			// 8 vectors per iteration, the 2 independent chains of the stages give the CPU more instructions to overlap
+			for( ; count >= 8; count -= 8, rsi += 24, rdi += 24 )
+			{
+				const Vector3x4 a = loadVector3x4( rsi );
+				const Vector3x4 b = loadVector3x4( rsi + 12 );
+				storeVector3x4( rdi, ( *this )( a ) );
+				storeVector3x4( rdi + 12, ( *this )( b ) );
+			}
+			if( count >= 4 )
+			{
+				storeVector3x4( rdi, ( *this )( loadVector3x4( rsi ) ) );
+				count -= 4;
+				rsi += 12;
+				rdi += 12;
+			}
+			if( 0 == count )
+				return;
+
+			// The remainder goes through local buffers, the unused lanes repeat the last vector; with the counters enabled, the events of that vector may be counted more than once
+			In source[ 12 ];
+			memcpy( source, rsi, count * 3 * sizeof( In ) );
+			for( size_t i = count; i < 4; i++ )
+				memcpy( source + i * 3, rsi + ( count - 1 ) * 3, 3 * sizeof( In ) );
+			Out dest[ 12 ];
+			storeVector3x4( dest, ( *this )( loadVector3x4( source ) ) );
+			memcpy( rdi, dest, count * 3 * sizeof( Out ) );
+		}
+	};
+
+	// Compose the stages into a pipeline, they are applied in the order of the arguments
+	template<class... Stages>
+	inline Pipeline<Stages...> makePipeline( const Stages&... stages )
+	{
+		return Pipeline<Stages...>{ stages... };
+	}
+}
\ No newline at end of file
@@ -0,0 +1,252 @@
+#include "AvxMath.h"
+#include "AvxMathParallel.h"
+#include <string.h>
+
+namespace AvxMath
+{
+	namespace
+	{
+		// When running multithreaded, each thread gets at least that many segments or points
+		constexpr size_t minParallelChunk = 1 << 16;
+
+		// Copy count points into the buffer with the capacity of the specified count of points, padding with copies of the last point.
+		// The incomplete batches at the end of the spans are processed with the same vector code, on these buffers.
+		inline void copyPadded( double* buffer, const double* rsi, size_t count, size_t capacity )
+		{
+			memcpy( buffer, rsi, count * 3 * sizeof( double ) );
+			for( size_t i = count; i < capacity; i++ )
+				memcpy( buffer + i * 3, rsi + ( count - 1 ) * 3, 3 * sizeof( double ) );
+		}
+
+		// Lengths of the 4 segments which start at the point; reads 5 points
+		inline __m256d segmentLengths4( const double* rsi )
+		{
+			const Vector3x4 a = loadVector3x4( rsi );
+			const Vector3x4 b = loadVector3x4( rsi + 3 );
+			const Vector3x4 d = vector3x4Subtract( b, a );
+			return _mm256_sqrt_pd( vector3x4Dot( d, d ) );
+		}
+
+		// Curvature at the 4 points which follow the argument; reads 6 points
+		inline __m256d curvature4( const double* rsi )
+		{
+			const Vector3x4 a = loadVector3x4( rsi );
+			const Vector3x4 b = loadVector3x4( rsi + 3 );
+			const Vector3x4 c = loadVector3x4( rsi + 6 );
+			const Vector3x4 u = vector3x4Subtract( b, a );
+			const Vector3x4 v = vector3x4Subtract( c, b );
+			const Vector3x4 w = vector3x4Subtract( c, a );
+
+			// Menger curvature, 4 * area / product of the sides, the length of the cross product is 2 * area
+			const Vector3x4 cross = vector3x4Cross( u, v );
+			const __m256d num = _mm256_sqrt_pd( vector3x4Dot( cross, cross ) );
+			__m256d den = _mm256_mul_pd( vector3x4Dot( u, u ), vector3x4Dot( v, v ) );
+			den = _mm256_sqrt_pd( _mm256_mul_pd( den, vector3x4Dot( w, w ) ) );
+			const __m256d res = _mm256_div_pd( _mm256_add_pd( num, num ), den );
+			// Zero denominator means duplicate points, the result is 0.0 instead of NaN
+			return _mm256_and_pd( res, _mm256_cmp_pd( den, _mm256_setzero_pd(), _CMP_GT_OQ ) );
+		}
+
+		// Inclusive prefix sum of the 4 lanes
+		inline __m256d prefixSum( __m256d x )
+		{
+			// [ 0, 0, x0, x1 ]
+			const __m256d t = _mm256_permute2f128_pd( x, x, 0x08 );
+			// Add [ 0, x0, x1, x2 ]
+			x = _mm256_add_pd( x, _mm256_shuffle_pd( t, x, 0b0100 ) );
+			// Add [ 0, 0, x0 + 0, x1 + x0 ]
+			return _mm256_add_pd( x, _mm256_permute2f128_pd( x, x, 0x08 ) );
+		}
+
+		// Broadcast W lane of the vector
+		inline __m256d splatLast( __m256d x )
+		{
+			return _mm256_permute_pd( _mm256_permute2f128_pd( x, x, 0x11 ), 0b1111 );
+		}
+
+		void lengthsSpan( const double* xyz, size_t begin, size_t end, double* lengths )
+		{
+			size_t i = begin;
+			for( ; i + 4 <= end; i += 4 )
+				_mm256_storeu_pd( lengths + i, segmentLengths4( xyz + i * 3 ) );
+			if( i < end )
+			{
+				double buffer[ 15 ];
+				copyPadded( buffer, xyz + i * 3, end - i + 1, 5 );
+				storePartial( lengths + i, segmentLengths4( buffer ), end - i );
+			}
+		}
+
+		// Write the cumulative lengths of the segments [ begin .. end ) into arcLength[ begin + 1 .. end ], starting with the specified value.
+		// Returns the last value written.
+		double arcLengthSpan( const double* xyz, size_t begin, size_t end, double* arcLength, double start )
+		{
+			__m256d acc = _mm256_set1_pd( start );
+			size_t i = begin;
+			for( ; i + 4 <= end; i += 4 )
+			{
+				const __m256d s = _mm256_add_pd( prefixSum( segmentLengths4( xyz + i * 3 ) ), acc );
+				_mm256_storeu_pd( arcLength + i + 1, s );
+				acc = splatLast( s );
+			}
+			if( i < end )
+			{
+				// The padding segments have zero length, the W lane has the complete sum
+				double buffer[ 15 ];
+				copyPadded( buffer, xyz + i * 3, end - i + 1, 5 );
+				const __m256d s = _mm256_add_pd( prefixSum( segmentLengths4( buffer ) ), acc );
+				storePartial( arcLength + i + 1, s, end - i );
+				acc = splatLast( s );
+			}
+			return _mm256_cvtsd_f64( acc );
+		}
+
+		void resampleSpan( const double* xyz, const double* arcLength, size_t count, double* result, size_t samples, size_t begin, size_t end )
+		{
+			const double total = arcLength[ count - 1 ];
+			const double step = total / (double)( samples - 1 );
+
+			// Locate the segment of the first sample; the rest of them are found by walking forward
+			size_t j = std::upper_bound( arcLength, arcLength + count, (double)begin * step ) - arcLength;
+			j = std::min( std::max( j, (size_t)1 ), count - 1 ) - 1;
+
+			for( size_t k = begin; k < end; k++ )
+			{
+				if( 0 == k || k + 1 == samples )
+				{
+					// The endpoints are exact
+					memcpy( result + k * 3, xyz + ( 0 == k ? 0 : ( count - 1 ) * 3 ), 3 * sizeof( double ) );
+					continue;
+				}
+				const double s = std::min( (double)k * step, total );
+
+				// Advance to the segment which contains the sample, i.e. arcLength[ j ] <= s <= arcLength[ j + 1 ]
+				const __m256d sv = _mm256_set1_pd( s );
+				while( true )
+				{
+					if( j + 5 > count )
+					{
+						while( j + 2 < count && arcLength[ j + 1 ] < s )
+							j++;
+						break;
+					}
+					const int mask = _mm256_movemask_pd( _mm256_cmp_pd( _mm256_loadu_pd( arcLength + j + 1 ), sv, _CMP_LT_OQ ) );
+					if( 0b1111 == mask )
+					{
+						j += 4;
+						continue;
+					}
+					// The arc length doesn't decrease, the mask is a sequence of set bits starting from the lowest one
+					j += ( mask & 1 ) + ( ( mask >> 1 ) & 1 ) + ( ( mask >> 2 ) & 1 );
+					break;
+				}
+
+				const double len = arcLength[ j + 1 ] - arcLength[ j ];
+				const double t = len > 0 ? ( s - arcLength[ j ] ) / len : 0.0;
+				const __m256d a = loadDouble3( xyz + j * 3 );
+				const __m256d b = loadDouble3( xyz + j * 3 + 3 );
+				storeDouble3( result + k * 3, vectorMultiplyAdd( _mm256_sub_pd( b, a ), _mm256_set1_pd( t ), a ) );
+			}
+		}
+
+		// Curvature of the interior points in [ begin .. end ) range
+		void curvatureSpan( const double* xyz, size_t begin, size_t end, double* curvature )
+		{
+			size_t i = begin;
+			for( ; i + 4 <= end; i += 4 )
+				_mm256_storeu_pd( curvature + i, curvature4( xyz + ( i - 1 ) * 3 ) );
+			if( i < end )
+			{
+				double buffer[ 18 ];
+				copyPadded( buffer, xyz + ( i - 1 ) * 3, end - i + 2, 6 );
+				storePartial( curvature + i, curvature4( buffer ), end - i );
+			}
+		}
+	}
+
+	void polylineSegmentLengths( const double* xyz, size_t count, double* lengths, bool parallel )
+	{
+		if( count < 2 )
+			return;
+		const size_t segments = count - 1;
+		parallelFor( segments, parallel ? minParallelChunk : segments, [ = ]( size_t begin, size_t end )
+		{
+			lengthsSpan( xyz, begin, end, lengths );
+		} );
+	}
+
+	double polylineArcLength( const double* xyz, size_t count, double* arcLength, bool parallel )
+	{
+		if( 0 == count )
+			return 0;
+		arcLength[ 0 ] = 0;
+		const size_t segments = count - 1;
+		const size_t threads = parallel ? parallelThreads( segments, minParallelChunk ) : 1;
+		if( threads <= 1 )
+			return arcLengthSpan( xyz, 0, segments, arcLength, 0.0 );
+
+		// Compute the prefix sums of the chunks in parallel, then offset all chunks except the first one by the sums of the preceding chunks
+		size_t chunk = ( segments + threads - 1 ) / threads;
+		chunk = ( chunk + 15 ) & ~(size_t)15;
+		const size_t chunks = ( segments + chunk - 1 ) / chunk;
+		std::vector<double> offsets( chunks );
+		parallelInvoke( chunks, [ & ]( size_t i )
+		{
+			offsets[ i ] = arcLengthSpan( xyz, i * chunk, std::min( i * chunk + chunk, segments ), arcLength, 0.0 );
+		} );
+
+		double acc = 0;
+		for( double& o : offsets )
+		{
+			const double sum = o;
+			o = acc;
+			acc += sum;
+		}
+
+		parallelInvoke( chunks - 1, [ & ]( size_t i )
+		{
+			i++;
+			const __m256d offset = _mm256_set1_pd( offsets[ i ] );
+			double* rdi = arcLength + i * chunk + 1;
+			double* const end = arcLength + std::min( i * chunk + chunk, segments ) + 1;
+			for( ; rdi + 4 <= end; rdi += 4 )
+				_mm256_storeu_pd( rdi, _mm256_add_pd( _mm256_loadu_pd( rdi ), offset ) );
+			for( ; rdi < end; rdi++ )
+				*rdi += offsets[ i ];
+		} );
+		return arcLength[ segments ];
+	}
+
+	void polylineResample( const double* xyz, const double* arcLength, size_t count, double* result, size_t samples, bool parallel )
+	{
+		if( 0 == samples || 0 == count )
+			return;
+		if( 1 == count || 1 == samples )
+		{
+			for( size_t k = 0; k < samples; k++ )
+				memcpy( result + k * 3, xyz, 3 * sizeof( double ) );
+			return;
+		}
+		parallelFor( samples, parallel ? minParallelChunk : samples, [ = ]( size_t begin, size_t end )
+		{
+			resampleSpan( xyz, arcLength, count, result, samples, begin, end );
+		} );
+	}
+
+	void polylineCurvature( const double* xyz, size_t count, double* curvature, bool parallel )
+	{
+		if( 0 == count )
+			return;
+		curvature[ 0 ] = 0;
+		if( 1 == count )
+			return;
+		curvature[ count - 1 ] = 0;
+
+		// Interior points are [ 1 .. count - 1 ), parallelFor splits [ 0 .. count - 2 ) range
+		const size_t interior = count - 2;
+		parallelFor( interior, parallel ? minParallelChunk : interior, [ = ]( size_t begin, size_t end )
+		{
+			curvatureSpan( xyz, begin + 1, end + 1, curvature );
+		} );
+	}
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+// Batch processing of 3D polylines: segment lengths, arc length, uniform resampling, discrete curvature
+#pragma once
+
+namespace AvxMath
+{
+	// The polylines are arrays of count 3D points, 3 doubles per point; the functions process 4 segments or points per iteration.
+	// With parallel = true, long polylines are split across the hardware threads.
+
+	// Compute lengths of the count - 1 segments of the polyline
+	void polylineSegmentLengths( const double* xyz, size_t count, double* lengths, bool parallel = false );
+
+	// Compute the cumulative arc length at every point of the polyline, arcLength[ 0 ] is 0.0. Returns length of the complete polyline.
+	// The prefix sums are computed 4 segments at a time, the results may differ from the sequential sum by a few ULPs.
+	double polylineArcLength( const double* xyz, size_t count, double* arcLength, bool parallel = false );
+
+	// Resample the polyline into the specified count of points, evenly spaced along the arc length; the first and last samples are the endpoints of the polyline.
+	// arcLength is the output of polylineArcLength, the result has samples * 3 doubles.
+	// The segments are found by walking the arc length 4 points at a time, in the order of the samples; there's no binary search per sample.
+	void polylineResample( const double* xyz, const double* arcLength, size_t count, double* result, size_t samples, bool parallel = false );
+
+	// Compute discrete curvature at every point of the polyline: 1 / radius of the circle through the point and the 2 adjacent ones.
+	// The curvature is 0.0 at the endpoints, for collinear points, and when the point is equal to one of the adjacent ones.
+	void polylineCurvature( const double* xyz, size_t count, double* curvature, bool parallel = false );
+}
\ No newline at end of file
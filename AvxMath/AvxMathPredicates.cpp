@@ -1,5 +1,6 @@
 #include "AvxMath.h"
 #include <array>
+#include <string.h>
 
 namespace AvxMath
 {
@@ -29,7 +30,11 @@ namespace AvxMath
 #if _AM_AVX2_INTRINSICS_
 		// That instruction is from BMI2 set.
 		// According to Wikipedia https://en.wikipedia.org/wiki/X86_Bit_manipulation_instruction_set#Supporting_CPUs was implemented by Intel and AMD at the same time as AVX2
-		return _mulx_u64( a, b, &high );
+		// The intrinsic takes unsigned long long pointer, with GCC uint64_t is a different type
+		unsigned long long h;
+		const uint64_t low = _mulx_u64( a, b, &h );
+		high = h;
+		return low;
 #else
 #ifdef _MSC_VER
 		return _umul128( a, b, &high );
@@ -108,6 +113,51 @@ namespace AvxMath
 		return vectorHash64Impl<false>( vec );
 	}
 
+	static inline uint64_t loadWord( const double* rsi )
+	{
+		uint64_t res;
+		memcpy( &res, rsi, 8 );
+		return res;
+	}
+
+	// Hash arrays of 3D or 4D vectors with 64-bit hashes.
+	// Loads the data directly into general purpose registers, and interleaves 4 independent chains of hash steps to hide the latency of the multiplications.
+	template<size_t lanes>
+	static inline void arrayHash64Impl( const double* rsi, size_t length, uint64_t* rdi )
+	{
+		const uint64_t* const secret = (const uint64_t*)g_secret.data();
+		constexpr uint64_t initial = prime64 * lanes * 8;
+
+		const double* const rsiEndAligned = rsi + ( length & ~(size_t)3 ) * lanes;
+		for( ; rsi < rsiEndAligned; rsi += lanes * 4, rdi += 4 )
+		{
+			uint64_t acc[ 4 ] = { initial, initial, initial, initial };
+			for( size_t lane = 0; lane < lanes; lane++ )
+				for( size_t i = 0; i < 4; i++ )
+					acc[ i ] += hashStep( loadWord( rsi + i * lanes + lane ), secret[ lane ] );
+			for( size_t i = 0; i < 4; i++ )
+				rdi[ i ] = avalanche( acc[ i ] );
+		}
+
+		for( size_t rem = length % 4; rem > 0; rem--, rsi += lanes, rdi++ )
+		{
+			uint64_t acc = initial;
+			for( size_t lane = 0; lane < lanes; lane++ )
+				acc += hashStep( loadWord( rsi + lane ), secret[ lane ] );
+			*rdi = avalanche( acc );
+		}
+	}
+
+	void arrayHash64( const double* rsi, size_t length, uint64_t* rdi )
+	{
+		arrayHash64Impl<4>( rsi, length, rdi );
+	}
+
+	void array3Hash64( const double* rsi, size_t length, uint64_t* rdi )
+	{
+		arrayHash64Impl<3>( rsi, length, rdi );
+	}
+
 	// ==== 32 bit hashes ====
 
 	constexpr uint32_t prime32_1 = 0x9E3779B1u;
@@ -206,4 +256,123 @@ namespace AvxMath
 	{
 		return vectorHash32Impl<false>( vec );
 	}
+
+#if _AM_AVX2_INTRINSICS_
+	// The AVX2 version of the array hashes handles 8 vectors per iteration.
+	// Each 32-byte register holds states of 2 hashes, the low half is for vectors [ 0 .. 3 ], the high half for vectors [ 4 .. 7 ].
+
+	// Lower 32 bits of the products. Emulating this with a pair of _mm256_mul_epu32 has lower latency, but it's 5 instructions instead of 1.
+	// In this throughput-bound code, _mm256_mullo_epi32 was about 1.5x faster on Skylake.
+	static inline __m256i multiplyLow( __m256i a, __m256i b )
+	{
+		return _mm256_mullo_epi32( a, b );
+	}
+
+	static inline __m256i updateState( __m256i acc, __m256i data )
+	{
+		const __m256i prime2 = _mm256_broadcastsi128_si256( g_32bit.prime2 );
+		const __m256i prime1 = _mm256_broadcastsi128_si256( g_32bit.prime1 );
+		acc = _mm256_add_epi32( acc, multiplyLow( data, prime2 ) );
+		acc = _mm256_or_si256( _mm256_slli_epi32( acc, 13 ), _mm256_srli_epi32( acc, 32 - 13 ) );
+		return multiplyLow( acc, prime1 );
+	}
+
+	// Load 16 bytes for vector i in the low half, and 16 bytes for vector i + 4 in the high half
+	static inline __m256i loadPair( const double* rsi, size_t stride )
+	{
+		const __m128i low = _mm_loadu_si128( (const __m128i*)rsi );
+		const __m128i high = _mm_loadu_si128( (const __m128i*)( rsi + stride * 4 ) );
+		return _mm256_inserti128_si256( _mm256_castsi128_si256( low ), high, 1 );
+	}
+
+	// Same as above, 8 bytes per vector, the upper 8 bytes of both halves are zeros
+	static inline __m256i loadPair8( const double* rsi, size_t stride )
+	{
+		const __m128i low = _mm_loadl_epi64( (const __m128i*)rsi );
+		const __m128i high = _mm_loadl_epi64( (const __m128i*)( rsi + stride * 4 ) );
+		return _mm256_inserti128_si256( _mm256_castsi128_si256( low ), high, 1 );
+	}
+
+	template<size_t lanes>
+	static inline __m256i hashPair( const double* rsi )
+	{
+		const __m256i initial = _mm256_broadcastsi128_si256( g_32bit.initialState );
+		__m256i acc = updateState( initial, loadPair( rsi, lanes ) );
+		if constexpr( lanes == 4 )
+			return updateState( acc, loadPair( rsi + 2, lanes ) );
+		else
+		{
+			const __m256i a2 = updateState( acc, loadPair8( rsi + 2, lanes ) );
+			return _mm256_blend_epi32( a2, acc, 0b11001100 );
+		}
+	}
+
+	// Rotate lanes of the state by 1, 7, 12 and 18 bits
+	static inline __m256i rotateState( __m256i acc )
+	{
+		const __m256i ls = _mm256_broadcastsi128_si256( g_32bit.leftShift );
+		const __m256i rs = _mm256_broadcastsi128_si256( g_32bit.rightShift );
+		return _mm256_or_si256( _mm256_sllv_epi32( acc, ls ), _mm256_srlv_epi32( acc, rs ) );
+	}
+
+	static inline __m256i avalanche( __m256i hash )
+	{
+		hash = _mm256_xor_si256( hash, _mm256_srli_epi32( hash, 15 ) );
+		hash = multiplyLow( hash, _mm256_set1_epi32( (int)prime32_2 ) );
+		hash = _mm256_xor_si256( hash, _mm256_srli_epi32( hash, 13 ) );
+		hash = multiplyLow( hash, _mm256_set1_epi32( (int)prime32_3 ) );
+		hash = _mm256_xor_si256( hash, _mm256_srli_epi32( hash, 16 ) );
+		return hash;
+	}
+
+	template<size_t lanes>
+	static inline void arrayHash32Impl( const double* rsi, size_t length, uint32_t* rdi )
+	{
+		const double* const rsiEndAligned = rsi + ( length & ~(size_t)7 ) * lanes;
+		for( ; rsi < rsiEndAligned; rsi += lanes * 8, rdi += 8 )
+		{
+			// 4 independent states, 8 hashes
+			const __m256i s0 = rotateState( hashPair<lanes>( rsi ) );
+			const __m256i s1 = rotateState( hashPair<lanes>( rsi + lanes ) );
+			const __m256i s2 = rotateState( hashPair<lanes>( rsi + lanes * 2 ) );
+			const __m256i s3 = rotateState( hashPair<lanes>( rsi + lanes * 3 ) );
+
+			// The addition is commutative, the order of the horizontal additions doesn't affect the result
+			__m256i h = _mm256_hadd_epi32( _mm256_hadd_epi32( s0, s1 ), _mm256_hadd_epi32( s2, s3 ) );
+			h = _mm256_add_epi32( h, _mm256_set1_epi32( (int)( lanes * 8 ) ) );
+			_mm256_storeu_si256( (__m256i*)rdi, avalanche( h ) );
+		}
+
+		for( size_t rem = length % 8; rem > 0; rem--, rsi += lanes, rdi++ )
+		{
+			if constexpr( lanes == 4 )
+				*rdi = vectorHash32( loadDouble4( rsi ) );
+			else
+				*rdi = vector3Hash32( loadDouble3( rsi ) );
+		}
+	}
+
+	void arrayHash32( const double* rsi, size_t length, uint32_t* rdi )
+	{
+		arrayHash32Impl<4>( rsi, length, rdi );
+	}
+
+	void array3Hash32( const double* rsi, size_t length, uint32_t* rdi )
+	{
+		arrayHash32Impl<3>( rsi, length, rdi );
+	}
+#else
+	// Without AVX2, the 32-bit integer vectors are only 16 bytes, the array versions are simple loops
+	void arrayHash32( const double* rsi, size_t length, uint32_t* rdi )
+	{
+		for( size_t i = 0; i < length; i++ )
+			rdi[ i ] = vectorHash32( loadDouble4( rsi + i * 4 ) );
+	}
+
+	void array3Hash32( const double* rsi, size_t length, uint32_t* rdi )
+	{
+		for( size_t i = 0; i < length; i++ )
+			rdi[ i ] = vector3Hash32( loadDouble3( rsi + i * 3 ) );
+	}
+#endif
 }
\ No newline at end of file
@@ -87,10 +87,27 @@ namespace AvxMath
 	// Hash 16 bytes in the vector into uint64_t
 	uint64_t vectorHash64( __m128d vec );
 
+	// The 32-bit hashes are xxHash32, each of the 4 lanes of the state consumes 32-bit pieces at the same offset in 16-byte blocks.
+	// Doubles with few significant bits have zeros in the lower halves, for integer coordinates only 2 of the 4 lanes of the state get any data.
+	// For 4D vectors with integer coordinates this causes 2.6x more collisions than ideal; for large hash tables, prefer the 64-bit hashes.
+
 	// Hash 32 bytes in the vector into uint32_t
 	uint32_t vectorHash32( __m256d vec );
 	// Hash 24 bytes in the vector into uint32_t
 	uint32_t vector3Hash32( __m256d vec );
 	// Hash 16 bytes in the vector into uint32_t
 	uint32_t vectorHash32( __m128d vec );
+
+	// ==== Array versions ====
+	// The results are equal to the functions above; these versions hash several vectors at once for better throughput.
+	// The 4D versions hash length * 4 doubles, the 3D versions hash length * 3 doubles, i.e. tightly packed 3D vectors.
+
+	// Hash 4D vectors into uint64_t
+	void arrayHash64( const double* rsi, size_t length, uint64_t* rdi );
+	// Hash 3D vectors into uint64_t
+	void array3Hash64( const double* rsi, size_t length, uint64_t* rdi );
+	// Hash 4D vectors into uint32_t
+	void arrayHash32( const double* rsi, size_t length, uint32_t* rdi );
+	// Hash 3D vectors into uint32_t
+	void array3Hash32( const double* rsi, size_t length, uint32_t* rdi );
 }
\ No newline at end of file
@@ -0,0 +1,164 @@
+// Ray / triangle intersection tests, 4 at a time
+#pragma once
+
+namespace AvxMath
+{
+	// Result of 4 ray / triangle tests.
+	// t is the distance along the ray in units of the ray direction, u and v are barycentric coordinates of the intersection,
+	// the intersection point is v0 * ( 1 - u - v ) + v1 * u + v2 * v. The values are only meaningful in the lanes where the mask is set.
+	struct RayHit4
+	{
+		__m256d mask;
+		__m256d t, u, v;
+	};
+
+	// Moller-Trumbore test, lane i of the output has the intersection of ray i with triangle i.
+	// Intersections with 0 <= t <= tMax are reported, from both sides of the triangles. Degenerate triangles and rays parallel to the triangles never intersect.
+	// Adjacent triangles may both miss a ray which goes exactly through their shared edge, use intersectWatertight when that's unacceptable.
+	inline RayHit4 _AM_CALL_ intersectRayTriangle4( const Vector3x4& origin, const Vector3x4& dir,
+		const Vector3x4& v0, const Vector3x4& v1, const Vector3x4& v2, __m256d tMax )
+	{
+		const Vector3x4 e1 = vector3x4Subtract( v1, v0 );
+		const Vector3x4 e2 = vector3x4Subtract( v2, v0 );
+		const Vector3x4 p = vector3x4Cross( dir, e2 );
+		const __m256d det = vector3x4Dot( e1, p );
+		const __m256d inv = _mm256_div_pd( broadcast( g_misc.one ), det );
+
+		const Vector3x4 s = vector3x4Subtract( origin, v0 );
+		const Vector3x4 q = vector3x4Cross( s, e1 );
+		RayHit4 res;
+		res.u = _mm256_mul_pd( vector3x4Dot( s, p ), inv );
+		res.v = _mm256_mul_pd( vector3x4Dot( dir, q ), inv );
+		res.t = _mm256_mul_pd( vector3x4Dot( e2, q ), inv );
+
+		const __m256d zero = _mm256_setzero_pd();
+		__m256d mask = _mm256_cmp_pd( det, zero, _CMP_NEQ_OQ );
+		mask = _mm256_and_pd( mask, _mm256_cmp_pd( res.u, zero, _CMP_GE_OQ ) );
+		mask = _mm256_and_pd( mask, _mm256_cmp_pd( res.v, zero, _CMP_GE_OQ ) );
+		mask = _mm256_and_pd( mask, _mm256_cmp_pd( _mm256_add_pd( res.u, res.v ), broadcast( g_misc.one ), _CMP_LE_OQ ) );
+		mask = _mm256_and_pd( mask, _mm256_cmp_pd( res.t, zero, _CMP_GE_OQ ) );
+		mask = _mm256_and_pd( mask, _mm256_cmp_pd( res.t, tMax, _CMP_LE_OQ ) );
+		res.mask = mask;
+		return res;
+	}
+
+	// Test 1 ray against 4 triangles
+	inline RayHit4 _AM_CALL_ intersectRayTriangles( __m256d origin, __m256d dir,
+		const Vector3x4& v0, const Vector3x4& v1, const Vector3x4& v2, double tMax = std::numeric_limits<double>::infinity() )
+	{
+		return intersectRayTriangle4( vector3x4Splat( origin ), vector3x4Splat( dir ), v0, v1, v2, _mm256_set1_pd( tMax ) );
+	}
+
+	// Test 4 rays against 1 triangle
+	inline RayHit4 _AM_CALL_ intersectRaysTriangle( const Vector3x4& origin, const Vector3x4& dir,
+		__m256d v0, __m256d v1, __m256d v2, double tMax = std::numeric_limits<double>::infinity() )
+	{
+		return intersectRayTriangle4( origin, dir, vector3x4Splat( v0 ), vector3x4Splat( v1 ), vector3x4Splat( v2 ), _mm256_set1_pd( tMax ) );
+	}
+
+	// 4 rays prepared for the watertight test: the axis most aligned with the direction, and the shear which transforms the direction into +Z
+	struct WatertightRays4
+	{
+		Vector3x4 origin;
+		// Masks to select X, Y or Z coordinates for the axes of the ray space; when both are clear, the axis is Z
+		__m256d kxIsX, kxIsY, kyIsX, kyIsY, kzIsX, kzIsY;
+		// Negative shear constants, and 1.0 / dir[ kz ]
+		__m256d sx, sy, sz;
+	};
+
+	// Prepare 4 rays for intersectWatertight
+	inline WatertightRays4 _AM_CALL_ prepareWatertightRays( const Vector3x4& origin, const Vector3x4& dir )
+	{
+		WatertightRays4 r;
+		r.origin = origin;
+
+		// kz is the axis with the largest absolute value of the direction
+		const __m256d ax = vectorAbs( dir.x );
+		const __m256d ay = vectorAbs( dir.y );
+		const __m256d az = vectorAbs( dir.z );
+		r.kzIsX = _mm256_and_pd( _mm256_cmp_pd( ax, ay, _CMP_GE_OQ ), _mm256_cmp_pd( ax, az, _CMP_GE_OQ ) );
+		r.kzIsY = _mm256_andnot_pd( r.kzIsX, _mm256_cmp_pd( ay, az, _CMP_GE_OQ ) );
+		const __m256d kzIsZ = _mm256_andnot_pd( _mm256_or_pd( r.kzIsX, r.kzIsY ), _mm256_castsi256_pd( _mm256_set1_epi32( -1 ) ) );
+
+		// kx = ( kz + 1 ) % 3, ky = ( kx + 1 ) % 3
+		__m256d kxIsX = kzIsZ, kxIsY = r.kzIsX;
+		__m256d kyIsX = r.kzIsY, kyIsY = kzIsZ;
+
+		// Swap kx and ky when the direction is negative, to preserve the winding of the triangles
+		const __m256d dz = vector3x4Component( dir, r.kzIsX, r.kzIsY );
+		r.kxIsX = _mm256_blendv_pd( kxIsX, kyIsX, dz );
+		r.kxIsY = _mm256_blendv_pd( kxIsY, kyIsY, dz );
+		r.kyIsX = _mm256_blendv_pd( kyIsX, kxIsX, dz );
+		r.kyIsY = _mm256_blendv_pd( kyIsY, kxIsY, dz );
+
+		r.sz = _mm256_div_pd( broadcast( g_misc.one ), dz );
+		const __m256d negSz = vectorNegate( r.sz );
+		r.sx = _mm256_mul_pd( vector3x4Component( dir, r.kxIsX, r.kxIsY ), negSz );
+		r.sy = _mm256_mul_pd( vector3x4Component( dir, r.kyIsX, r.kyIsY ), negSz );
+		return r;
+	}
+
+	// Prepare 1 ray for intersectWatertight, broadcasting it into all 4 lanes
+	inline WatertightRays4 _AM_CALL_ prepareWatertightRays( __m256d origin, __m256d dir )
+	{
+		return prepareWatertightRays( vector3x4Splat( origin ), vector3x4Splat( dir ) );
+	}
+
+	// Watertight ray / triangle test, Woop, Benthin, Wald, "Watertight Ray/Triangle Intersection", JCGT 2013.
+	// Rays which go through an edge or a vertex shared by several triangles hit at least one of them, regardless of the orientation of the triangles.
+	// Intersections with 0 <= t <= tMax are reported, from both sides of the triangles. Up to 1.5x slower than intersectRayTriangle4.
+	inline RayHit4 _AM_CALL_ intersectWatertight( const WatertightRays4& r, const Vector3x4& v0, const Vector3x4& v1, const Vector3x4& v2, __m256d tMax )
+	{
+		// Translate vertices to the ray origin, permute and shear into the ray space
+		const auto transform = [ &r ]( const Vector3x4& v, __m256d& x, __m256d& y, __m256d& z )
+		{
+			const Vector3x4 a = vector3x4Subtract( v, r.origin );
+			const __m256d az = vector3x4Component( a, r.kzIsX, r.kzIsY );
+			x = vectorMultiplyAdd( r.sx, az, vector3x4Component( a, r.kxIsX, r.kxIsY ) );
+			y = vectorMultiplyAdd( r.sy, az, vector3x4Component( a, r.kyIsX, r.kyIsY ) );
+			z = _mm256_mul_pd( r.sz, az );
+		};
+		__m256d ax, ay, az, bx, by, bz, cx, cy, cz;
+		transform( v0, ax, ay, az );
+		transform( v1, bx, by, bz );
+		transform( v2, cx, cy, cz );
+
+		// Scaled barycentric coordinates. The edge functions of a shared edge must be exactly opposite in the 2 triangles.
+		const __m256d u = vectorDifferenceOfProducts( cx, by, cy, bx );
+		const __m256d v = vectorDifferenceOfProducts( ax, cy, ay, cx );
+		const __m256d w = vectorDifferenceOfProducts( bx, ay, by, ax );
+
+		// Miss when the signs are different
+		const __m256d zero = _mm256_setzero_pd();
+		const __m256d anyNegative = _mm256_or_pd( _mm256_or_pd( _mm256_cmp_pd( u, zero, _CMP_LT_OQ ), _mm256_cmp_pd( v, zero, _CMP_LT_OQ ) ), _mm256_cmp_pd( w, zero, _CMP_LT_OQ ) );
+		const __m256d anyPositive = _mm256_or_pd( _mm256_or_pd( _mm256_cmp_pd( u, zero, _CMP_GT_OQ ), _mm256_cmp_pd( v, zero, _CMP_GT_OQ ) ), _mm256_cmp_pd( w, zero, _CMP_GT_OQ ) );
+
+		const __m256d det = _mm256_add_pd( _mm256_add_pd( u, v ), w );
+		__m256d mask = _mm256_andnot_pd( _mm256_and_pd( anyNegative, anyPositive ), _mm256_cmp_pd( det, zero, _CMP_NEQ_OQ ) );
+
+		// Scaled distance, compare with 0 and tMax without dividing
+		__m256d t = _mm256_mul_pd( u, az );
+		t = vectorMultiplyAdd( v, bz, t );
+		t = vectorMultiplyAdd( w, cz, t );
+		const __m256d detSign = _mm256_and_pd( det, broadcast( g_misc.negativeZero ) );
+		const __m256d tScaled = _mm256_xor_pd( t, detSign );
+		const __m256d detAbs = _mm256_xor_pd( det, detSign );
+		mask = _mm256_and_pd( mask, _mm256_cmp_pd( tScaled, zero, _CMP_GE_OQ ) );
+		mask = _mm256_and_pd( mask, _mm256_cmp_pd( tScaled, _mm256_mul_pd( tMax, detAbs ), _CMP_LE_OQ ) );
+
+		const __m256d inv = _mm256_div_pd( broadcast( g_misc.one ), det );
+		RayHit4 res;
+		res.mask = mask;
+		res.t = _mm256_mul_pd( t, inv );
+		res.u = _mm256_mul_pd( v, inv );
+		res.v = _mm256_mul_pd( w, inv );
+		return res;
+	}
+
+	// Watertight test of the prepared rays against 1 triangle
+	inline RayHit4 _AM_CALL_ intersectWatertight( const WatertightRays4& r, __m256d v0, __m256d v1, __m256d v2,
+		double tMax = std::numeric_limits<double>::infinity() )
+	{
+		return intersectWatertight( r, vector3x4Splat( v0 ), vector3x4Splat( v1 ), vector3x4Splat( v2 ), _mm256_set1_pd( tMax ) );
+	}
+}
\ No newline at end of file
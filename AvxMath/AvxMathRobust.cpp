@@ -0,0 +1,400 @@
+#include "AvxMath.h"
+
+namespace AvxMath
+{
+	namespace
+	{
+		// Exact arithmetic on floating-point expansions. An expansion is a sum of doubles sorted by increasing magnitude, without overlapping bits.
+		// The functions below eliminate zero components, the sign of the expansion is the sign of the last component.
+
+		inline void twoSum( double a, double b, double& x, double& y )
+		{
+			x = a + b;
+			const double bv = x - a;
+			const double av = x - bv;
+			y = ( a - av ) + ( b - bv );
+		}
+
+		// Same as twoSum, requires |a| >= |b| or a == 0
+		inline void fastTwoSum( double a, double b, double& x, double& y )
+		{
+			x = a + b;
+			y = b - ( x - a );
+		}
+
+		inline void twoProduct( double a, double b, double& x, double& y )
+		{
+			x = a * b;
+#if _AM_FMA3_INTRINSICS_ || defined( __FMA__ )
+			y = _mm_cvtsd_f64( _mm_fmsub_sd( _mm_set_sd( a ), _mm_set_sd( b ), _mm_set_sd( x ) ) );
+#else
+			// Dekker's product; without FMA in the instruction set, the compiler can't contract these multiplications
+			constexpr double splitter = 134217729.0; // 2^27 + 1
+			double c = splitter * a;
+			const double ahi = c - ( c - a );
+			const double alo = a - ahi;
+			c = splitter * b;
+			const double bhi = c - ( c - b );
+			const double blo = b - bhi;
+			y = ( ( ( ahi * bhi - x ) + alo * bhi ) + ahi * blo ) + alo * blo;
+#endif
+		}
+
+		// Shewchuk's fast_expansion_sum_zeroelim; the inputs have at least 1 component. Returns length of the output, at least 1.
+		size_t expansionSum( const double* e, size_t elen, const double* f, size_t flen, double* h )
+		{
+			double enow = e[ 0 ], fnow = f[ 0 ];
+			size_t ei = 0, fi = 0, hi = 0;
+			double q, qnew, hh;
+			const auto nextE = [ & ]() { ei++; enow = ei < elen ? e[ ei ] : 0.0; };
+			const auto nextF = [ & ]() { fi++; fnow = fi < flen ? f[ fi ] : 0.0; };
+
+			if( ( fnow > enow ) == ( fnow > -enow ) )
+			{
+				q = enow;
+				nextE();
+			}
+			else
+			{
+				q = fnow;
+				nextF();
+			}
+			if( ei < elen && fi < flen )
+			{
+				if( ( fnow > enow ) == ( fnow > -enow ) )
+				{
+					fastTwoSum( enow, q, qnew, hh );
+					nextE();
+				}
+				else
+				{
+					fastTwoSum( fnow, q, qnew, hh );
+					nextF();
+				}
+				q = qnew;
+				if( hh != 0.0 )
+					h[ hi++ ] = hh;
+				while( ei < elen && fi < flen )
+				{
+					if( ( fnow > enow ) == ( fnow > -enow ) )
+					{
+						twoSum( q, enow, qnew, hh );
+						nextE();
+					}
+					else
+					{
+						twoSum( q, fnow, qnew, hh );
+						nextF();
+					}
+					q = qnew;
+					if( hh != 0.0 )
+						h[ hi++ ] = hh;
+				}
+			}
+			while( ei < elen )
+			{
+				twoSum( q, enow, qnew, hh );
+				nextE();
+				q = qnew;
+				if( hh != 0.0 )
+					h[ hi++ ] = hh;
+			}
+			while( fi < flen )
+			{
+				twoSum( q, fnow, qnew, hh );
+				nextF();
+				q = qnew;
+				if( hh != 0.0 )
+					h[ hi++ ] = hh;
+			}
+			if( q != 0.0 || hi == 0 )
+				h[ hi++ ] = q;
+			return hi;
+		}
+
+		// Shewchuk's scale_expansion_zeroelim, computes e * b. Returns length of the output, at least 1.
+		size_t scaleExpansion( const double* e, size_t elen, double b, double* h )
+		{
+			double q, hh, p1, p0, sum;
+			size_t hi = 0;
+			twoProduct( e[ 0 ], b, q, hh );
+			if( hh != 0.0 )
+				h[ hi++ ] = hh;
+			for( size_t i = 1; i < elen; i++ )
+			{
+				twoProduct( e[ i ], b, p1, p0 );
+				twoSum( q, p0, sum, hh );
+				if( hh != 0.0 )
+					h[ hi++ ] = hh;
+				fastTwoSum( p1, sum, q, hh );
+				if( hh != 0.0 )
+					h[ hi++ ] = hh;
+			}
+			if( q != 0.0 || hi == 0 )
+				h[ hi++ ] = q;
+			return hi;
+		}
+
+		// Expansion with the capacity for N components
+		template<size_t N>
+		struct Expansion
+		{
+			size_t length;
+			double e[ N ];
+
+			double mostSignificant() const
+			{
+				return e[ length - 1 ];
+			}
+		};
+
+		inline Expansion<2> product( double a, double b )
+		{
+			Expansion<2> r;
+			double x, y;
+			twoProduct( a, b, x, y );
+			r.length = 0;
+			if( y != 0.0 )
+				r.e[ r.length++ ] = y;
+			r.e[ r.length++ ] = x;
+			return r;
+		}
+
+		template<size_t N, size_t M>
+		inline Expansion<N + M> add( const Expansion<N>& a, const Expansion<M>& b )
+		{
+			Expansion<N + M> r;
+			r.length = expansionSum( a.e, a.length, b.e, b.length, r.e );
+			return r;
+		}
+
+		template<size_t N>
+		inline Expansion<N> negate( Expansion<N> a )
+		{
+			for( size_t i = 0; i < a.length; i++ )
+				a.e[ i ] = -a.e[ i ];
+			return a;
+		}
+
+		template<size_t N>
+		inline Expansion<N * 2> scale( const Expansion<N>& a, double b )
+		{
+			Expansion<N * 2> r;
+			r.length = scaleExpansion( a.e, a.length, b, r.e );
+			return r;
+		}
+
+		// Product of 2 expansions, the sum of a scaled by every component of b
+		template<size_t N, size_t M>
+		Expansion<N * M * 2> multiply( const Expansion<N>& a, const Expansion<M>& b )
+		{
+			Expansion<N * M * 2> r;
+			double buffer[ N * M * 2 ];
+			double scaled[ N * 2 ];
+			double* acc = r.e;
+			double* tmp = buffer;
+			size_t length = scaleExpansion( a.e, a.length, b.e[ 0 ], acc );
+			for( size_t i = 1; i < b.length; i++ )
+			{
+				const size_t sl = scaleExpansion( a.e, a.length, b.e[ i ], scaled );
+				length = expansionSum( acc, length, scaled, sl, tmp );
+				std::swap( acc, tmp );
+			}
+			if( acc != r.e )
+				std::copy( acc, acc + length, r.e );
+			r.length = length;
+			return r;
+		}
+
+		// ax * by - ay * bx
+		inline Expansion<4> cross2( double ax, double ay, double bx, double by )
+		{
+			return add( product( ax, by ), product( -ay, bx ) );
+		}
+
+		// Determinant of 3x3 matrix with the specified rows
+		Expansion<24> det3( const double* p, const double* q, const double* r )
+		{
+			const Expansion<8> x = scale( cross2( q[ 1 ], q[ 2 ], r[ 1 ], r[ 2 ] ), p[ 0 ] );
+			const Expansion<8> y = scale( cross2( q[ 2 ], q[ 0 ], r[ 2 ], r[ 0 ] ), p[ 1 ] );
+			const Expansion<8> z = scale( cross2( q[ 0 ], q[ 1 ], r[ 0 ], r[ 1 ] ), p[ 2 ] );
+			return add( add( x, y ), z );
+		}
+
+		// x^2 + y^2
+		inline Expansion<4> lift2( const double* p )
+		{
+			return add( product( p[ 0 ], p[ 0 ] ), product( p[ 1 ], p[ 1 ] ) );
+		}
+
+		// x^2 + y^2 + z^2
+		inline Expansion<6> lift3( const double* p )
+		{
+			return add( lift2( p ), product( p[ 2 ], p[ 2 ] ) );
+		}
+
+		// Determinant of 3x3 matrix with rows [ x, y, x^2 + y^2 ]
+		Expansion<96> liftedDet3( const double* p, const double* q, const double* r )
+		{
+			const Expansion<32> a = multiply( lift2( p ), cross2( q[ 0 ], q[ 1 ], r[ 0 ], r[ 1 ] ) );
+			const Expansion<32> b = multiply( lift2( q ), cross2( r[ 0 ], r[ 1 ], p[ 0 ], p[ 1 ] ) );
+			const Expansion<32> c = multiply( lift2( r ), cross2( p[ 0 ], p[ 1 ], q[ 0 ], q[ 1 ] ) );
+			return add( add( a, b ), c );
+		}
+
+		// The determinants of 4x4 or 5x5 matrices are expanded along the last column, which is all ones.
+		// These predicates use the original coordinates instead of the differences, because the differences are not exact in floating point.
+	}
+
+	double orient2dExact( __m128d a, __m128d b, __m128d c )
+	{
+		countEvent( eCounter::RobustExact );
+		alignas( 16 ) double pa[ 2 ], pb[ 2 ], pc[ 2 ];
+		_mm_store_pd( pa, a );
+		_mm_store_pd( pb, b );
+		_mm_store_pd( pc, c );
+		const Expansion<4> ab = cross2( pa[ 0 ], pa[ 1 ], pb[ 0 ], pb[ 1 ] );
+		const Expansion<4> bc = cross2( pb[ 0 ], pb[ 1 ], pc[ 0 ], pc[ 1 ] );
+		const Expansion<4> ca = cross2( pc[ 0 ], pc[ 1 ], pa[ 0 ], pa[ 1 ] );
+		return add( add( ab, bc ), ca ).mostSignificant();
+	}
+
+	double orient3dExact( __m256d a, __m256d b, __m256d c, __m256d d )
+	{
+		countEvent( eCounter::RobustExact );
+		alignas( 32 ) double pa[ 4 ], pb[ 4 ], pc[ 4 ], pd[ 4 ];
+		_mm256_store_pd( pa, a );
+		_mm256_store_pd( pb, b );
+		_mm256_store_pd( pc, c );
+		_mm256_store_pd( pd, d );
+		// det | a 1; b 1; c 1; d 1 |
+		const Expansion<48> x = add( negate( det3( pb, pc, pd ) ), det3( pa, pc, pd ) );
+		const Expansion<48> y = add( negate( det3( pa, pb, pd ) ), det3( pa, pb, pc ) );
+		return add( x, y ).mostSignificant();
+	}
+
+	double incircleExact( __m128d a, __m128d b, __m128d c, __m128d d )
+	{
+		countEvent( eCounter::RobustExact );
+		alignas( 16 ) double pa[ 2 ], pb[ 2 ], pc[ 2 ], pd[ 2 ];
+		_mm_store_pd( pa, a );
+		_mm_store_pd( pb, b );
+		_mm_store_pd( pc, c );
+		_mm_store_pd( pd, d );
+		// det | a lift( a ) 1; b lift( b ) 1; c lift( c ) 1; d lift( d ) 1 |
+		const Expansion<192> x = add( negate( liftedDet3( pb, pc, pd ) ), liftedDet3( pa, pc, pd ) );
+		const Expansion<192> y = add( negate( liftedDet3( pa, pb, pd ) ), liftedDet3( pa, pb, pc ) );
+		return add( x, y ).mostSignificant();
+	}
+
+	double insphereExact( __m256d a, __m256d b, __m256d c, __m256d d, __m256d e )
+	{
+		countEvent( eCounter::RobustExact );
+		alignas( 32 ) double pts[ 5 ][ 4 ];
+		_mm256_store_pd( pts[ 0 ], a );
+		_mm256_store_pd( pts[ 1 ], b );
+		_mm256_store_pd( pts[ 2 ], c );
+		_mm256_store_pd( pts[ 3 ], d );
+		_mm256_store_pd( pts[ 4 ], e );
+
+		// The 10 determinants of 3 points, indexed by the bitmap of the points, and lifts of the points
+		Expansion<24> minors[ 32 ];
+		for( uint32_t i = 0; i < 5; i++ )
+			for( uint32_t j = i + 1; j < 5; j++ )
+				for( uint32_t k = j + 1; k < 5; k++ )
+					minors[ ( 1u << i ) | ( 1u << j ) | ( 1u << k ) ] = det3( pts[ i ], pts[ j ], pts[ k ] );
+		Expansion<6> lifts[ 5 ];
+		for( uint32_t i = 0; i < 5; i++ )
+			lifts[ i ] = lift3( pts[ i ] );
+
+		// det | p lift( p ) | of 4 points, expanded along the lift column
+		const auto det4 = [ & ]( uint32_t skip )
+		{
+			uint32_t idx[ 4 ];
+			uint32_t count = 0;
+			for( uint32_t i = 0; i < 5; i++ )
+				if( i != skip )
+					idx[ count++ ] = i;
+			const uint32_t all = 31u & ~( 1u << skip );
+			const Expansion<288> t0 = negate( multiply( lifts[ idx[ 0 ] ], minors[ all & ~( 1u << idx[ 0 ] ) ] ) );
+			const Expansion<288> t1 = multiply( lifts[ idx[ 1 ] ], minors[ all & ~( 1u << idx[ 1 ] ) ] );
+			const Expansion<288> t2 = negate( multiply( lifts[ idx[ 2 ] ], minors[ all & ~( 1u << idx[ 2 ] ) ] ) );
+			const Expansion<288> t3 = multiply( lifts[ idx[ 3 ] ], minors[ all & ~( 1u << idx[ 3 ] ) ] );
+			return add( add( t0, t1 ), add( t2, t3 ) );
+		};
+
+		// det | a lift( a ) 1; ... e lift( e ) 1 |
+		const Expansion<2304> x = add( det4( 0 ), negate( det4( 1 ) ) );
+		const Expansion<2304> y = add( det4( 2 ), negate( det4( 3 ) ) );
+		return add( add( x, y ), det4( 4 ) ).mostSignificant();
+	}
+
+	namespace
+	{
+		// Lanes of SoA vectors, as AoS vectors for the scalar predicates
+		struct Lanes2
+		{
+			alignas( 32 ) double x[ 4 ], y[ 4 ];
+			Lanes2( const Vector2x4& v )
+			{
+				_mm256_store_pd( x, v.x );
+				_mm256_store_pd( y, v.y );
+			}
+			__m128d operator[]( size_t i ) const
+			{
+				return _mm_setr_pd( x[ i ], y[ i ] );
+			}
+		};
+
+		struct Lanes3
+		{
+			alignas( 32 ) double x[ 4 ], y[ 4 ], z[ 4 ];
+			Lanes3( const Vector3x4& v )
+			{
+				_mm256_store_pd( x, v.x );
+				_mm256_store_pd( y, v.y );
+				_mm256_store_pd( z, v.z );
+			}
+			__m256d operator[]( size_t i ) const
+			{
+				return _mm256_setr_pd( x[ i ], y[ i ], z[ i ], 0 );
+			}
+		};
+
+		// Call fn( lane ) for the lanes in the bitmap, replace these lanes of the vector with the results
+		template<class Fn>
+		inline __m256d replaceLanes( __m256d vec, int lanes, Fn&& fn )
+		{
+			alignas( 32 ) double res[ 4 ];
+			_mm256_store_pd( res, vec );
+			for( size_t i = 0; i < 4; i++ )
+				if( 0 != ( lanes & ( 1 << i ) ) )
+					res[ i ] = fn( i );
+			return _mm256_load_pd( res );
+		}
+	}
+
+	__m256d orient2dExact4( const Vector2x4& a, const Vector2x4& b, const Vector2x4& c, __m256d det, int lanes )
+	{
+		const Lanes2 la{ a }, lb{ b }, lc{ c };
+		return replaceLanes( det, lanes, [ & ]( size_t i ) { return orient2dExact( la[ i ], lb[ i ], lc[ i ] ); } );
+	}
+
+	__m256d orient3dExact4( const Vector3x4& a, const Vector3x4& b, const Vector3x4& c, const Vector3x4& d, __m256d det, int lanes )
+	{
+		const Lanes3 la{ a }, lb{ b }, lc{ c }, ld{ d };
+		return replaceLanes( det, lanes, [ & ]( size_t i ) { return orient3dExact( la[ i ], lb[ i ], lc[ i ], ld[ i ] ); } );
+	}
+
+	__m256d incircleExact4( const Vector2x4& a, const Vector2x4& b, const Vector2x4& c, const Vector2x4& d, __m256d det, int lanes )
+	{
+		const Lanes2 la{ a }, lb{ b }, lc{ c }, ld{ d };
+		return replaceLanes( det, lanes, [ & ]( size_t i ) { return incircleExact( la[ i ], lb[ i ], lc[ i ], ld[ i ] ); } );
+	}
+
+	__m256d insphereExact4( const Vector3x4& a, const Vector3x4& b, const Vector3x4& c, const Vector3x4& d, const Vector3x4& e, __m256d det, int lanes )
+	{
+		const Lanes3 la{ a }, lb{ b }, lc{ c }, ld{ d }, le{ e };
+		return replaceLanes( det, lanes, [ & ]( size_t i ) { return insphereExact( la[ i ], lb[ i ], lc[ i ], ld[ i ], le[ i ] ); } );
+	}
+}
\ No newline at end of file
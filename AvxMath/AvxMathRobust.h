@@ -0,0 +1,255 @@
+// Robust geometric predicates: orientation of 2D and 3D points, in-circle and in-sphere tests, with exact signs.
+// Shewchuk, "Adaptive Precision Floating-Point Arithmetic and Fast Robust Geometric Predicates", 1997.
+#pragma once
+
+namespace AvxMath
+{
+	// The predicates first evaluate the determinant in floating point, and compare it with the error bound computed from the permanent.
+	// When the filter can't certify the sign, the determinant is recomputed with exact arithmetic on floating-point expansions.
+	// The results are approximations of the determinants, with the exact sign; zero means the points are exactly degenerate.
+	// The error bounds assume no overflow nor underflow in the intermediate products. For NaN inputs the results are unspecified.
+
+	// Error bound coefficients of the floating-point filters, from the paper. Fused multiply-add makes fewer roundings, the bounds hold with or without FMA.
+	constexpr double g_orient2dErrorBound = ( 3.0 + 16.0 * 0x1p-53 ) * 0x1p-53;
+	constexpr double g_orient3dErrorBound = ( 7.0 + 56.0 * 0x1p-53 ) * 0x1p-53;
+	constexpr double g_incircleErrorBound = ( 10.0 + 96.0 * 0x1p-53 ) * 0x1p-53;
+	constexpr double g_insphereErrorBound = ( 16.0 + 224.0 * 0x1p-53 ) * 0x1p-53;
+
+	// Exact versions of the predicates
+	double orient2dExact( __m128d a, __m128d b, __m128d c );
+	double orient3dExact( __m256d a, __m256d b, __m256d c, __m256d d );
+	double incircleExact( __m128d a, __m128d b, __m128d c, __m128d d );
+	double insphereExact( __m256d a, __m256d b, __m256d c, __m256d d, __m256d e );
+
+	// Replace the specified lanes of the determinants with the exact results, the batch predicates call these when the filter fails
+	__m256d orient2dExact4( const Vector2x4& a, const Vector2x4& b, const Vector2x4& c, __m256d det, int lanes );
+	__m256d orient3dExact4( const Vector3x4& a, const Vector3x4& b, const Vector3x4& c, const Vector3x4& d, __m256d det, int lanes );
+	__m256d incircleExact4( const Vector2x4& a, const Vector2x4& b, const Vector2x4& c, const Vector2x4& d, __m256d det, int lanes );
+	__m256d insphereExact4( const Vector3x4& a, const Vector3x4& b, const Vector3x4& c, const Vector3x4& d, const Vector3x4& e, __m256d det, int lanes );
+
+	// Bitmap of the lanes where the filter can't certify the sign of the determinant, i.e. NOT( |det| >= bound ). NaN lanes are included.
+	inline int robustUncertainLanes( __m256d det, __m256d permanent, double errorBound )
+	{
+		const __m256d bound = _mm256_mul_pd( permanent, _mm256_set1_pd( errorBound ) );
+		return _mm256_movemask_pd( _mm256_cmp_pd( vectorAbs( det ), bound, _CMP_NGE_UQ ) );
+	}
+
+	// ==== Floating-point filters ====
+	// They compute 4 determinants, and set the bitmap of the lanes where the sign is uncertain
+
+	inline __m256d _AM_CALL_ orient2dFilter( const Vector2x4& a, const Vector2x4& b, const Vector2x4& c, int& uncertain )
+	{
+		const __m256d acx = _mm256_sub_pd( a.x, c.x );
+		const __m256d acy = _mm256_sub_pd( a.y, c.y );
+		const __m256d bcx = _mm256_sub_pd( b.x, c.x );
+		const __m256d bcy = _mm256_sub_pd( b.y, c.y );
+		const __m256d left = _mm256_mul_pd( acx, bcy );
+		const __m256d right = _mm256_mul_pd( acy, bcx );
+		const __m256d det = _mm256_sub_pd( left, right );
+		uncertain = robustUncertainLanes( det, _mm256_add_pd( vectorAbs( left ), vectorAbs( right ) ), g_orient2dErrorBound );
+		return det;
+	}
+
+	inline __m256d _AM_CALL_ orient3dFilter( const Vector3x4& a, const Vector3x4& b, const Vector3x4& c, const Vector3x4& d, int& uncertain )
+	{
+		const Vector3x4 ad = vector3x4Subtract( a, d );
+		const Vector3x4 bd = vector3x4Subtract( b, d );
+		const Vector3x4 cd = vector3x4Subtract( c, d );
+
+		const __m256d bdxcdy = _mm256_mul_pd( bd.x, cd.y );
+		const __m256d cdxbdy = _mm256_mul_pd( cd.x, bd.y );
+		const __m256d cdxady = _mm256_mul_pd( cd.x, ad.y );
+		const __m256d adxcdy = _mm256_mul_pd( ad.x, cd.y );
+		const __m256d adxbdy = _mm256_mul_pd( ad.x, bd.y );
+		const __m256d bdxady = _mm256_mul_pd( bd.x, ad.y );
+
+		__m256d det = _mm256_mul_pd( ad.z, _mm256_sub_pd( bdxcdy, cdxbdy ) );
+		det = vectorMultiplyAdd( bd.z, _mm256_sub_pd( cdxady, adxcdy ), det );
+		det = vectorMultiplyAdd( cd.z, _mm256_sub_pd( adxbdy, bdxady ), det );
+
+		__m256d perm = _mm256_mul_pd( _mm256_add_pd( vectorAbs( bdxcdy ), vectorAbs( cdxbdy ) ), vectorAbs( ad.z ) );
+		perm = vectorMultiplyAdd( _mm256_add_pd( vectorAbs( cdxady ), vectorAbs( adxcdy ) ), vectorAbs( bd.z ), perm );
+		perm = vectorMultiplyAdd( _mm256_add_pd( vectorAbs( adxbdy ), vectorAbs( bdxady ) ), vectorAbs( cd.z ), perm );
+		uncertain = robustUncertainLanes( det, perm, g_orient3dErrorBound );
+		return det;
+	}
+
+	inline __m256d _AM_CALL_ incircleFilter( const Vector2x4& a, const Vector2x4& b, const Vector2x4& c, const Vector2x4& d, int& uncertain )
+	{
+		const __m256d adx = _mm256_sub_pd( a.x, d.x );
+		const __m256d ady = _mm256_sub_pd( a.y, d.y );
+		const __m256d bdx = _mm256_sub_pd( b.x, d.x );
+		const __m256d bdy = _mm256_sub_pd( b.y, d.y );
+		const __m256d cdx = _mm256_sub_pd( c.x, d.x );
+		const __m256d cdy = _mm256_sub_pd( c.y, d.y );
+
+		const __m256d bdxcdy = _mm256_mul_pd( bdx, cdy );
+		const __m256d cdxbdy = _mm256_mul_pd( cdx, bdy );
+		const __m256d cdxady = _mm256_mul_pd( cdx, ady );
+		const __m256d adxcdy = _mm256_mul_pd( adx, cdy );
+		const __m256d adxbdy = _mm256_mul_pd( adx, bdy );
+		const __m256d bdxady = _mm256_mul_pd( bdx, ady );
+		const __m256d alift = vectorMultiplyAdd( adx, adx, _mm256_mul_pd( ady, ady ) );
+		const __m256d blift = vectorMultiplyAdd( bdx, bdx, _mm256_mul_pd( bdy, bdy ) );
+		const __m256d clift = vectorMultiplyAdd( cdx, cdx, _mm256_mul_pd( cdy, cdy ) );
+
+		__m256d det = _mm256_mul_pd( alift, _mm256_sub_pd( bdxcdy, cdxbdy ) );
+		det = vectorMultiplyAdd( blift, _mm256_sub_pd( cdxady, adxcdy ), det );
+		det = vectorMultiplyAdd( clift, _mm256_sub_pd( adxbdy, bdxady ), det );
+
+		__m256d perm = _mm256_mul_pd( _mm256_add_pd( vectorAbs( bdxcdy ), vectorAbs( cdxbdy ) ), alift );
+		perm = vectorMultiplyAdd( _mm256_add_pd( vectorAbs( cdxady ), vectorAbs( adxcdy ) ), blift, perm );
+		perm = vectorMultiplyAdd( _mm256_add_pd( vectorAbs( adxbdy ), vectorAbs( bdxady ) ), clift, perm );
+		uncertain = robustUncertainLanes( det, perm, g_incircleErrorBound );
+		return det;
+	}
+
+	inline __m256d _AM_CALL_ insphereFilter( const Vector3x4& a, const Vector3x4& b, const Vector3x4& c, const Vector3x4& d, const Vector3x4& e, int& uncertain )
+	{
+		const Vector3x4 ae = vector3x4Subtract( a, e );
+		const Vector3x4 be = vector3x4Subtract( b, e );
+		const Vector3x4 ce = vector3x4Subtract( c, e );
+		const Vector3x4 de = vector3x4Subtract( d, e );
+
+		// 2x2 minors of XY coordinates
+		const __m256d aexbey = _mm256_mul_pd( ae.x, be.y );
+		const __m256d bexaey = _mm256_mul_pd( be.x, ae.y );
+		const __m256d bexcey = _mm256_mul_pd( be.x, ce.y );
+		const __m256d cexbey = _mm256_mul_pd( ce.x, be.y );
+		const __m256d cexdey = _mm256_mul_pd( ce.x, de.y );
+		const __m256d dexcey = _mm256_mul_pd( de.x, ce.y );
+		const __m256d dexaey = _mm256_mul_pd( de.x, ae.y );
+		const __m256d aexdey = _mm256_mul_pd( ae.x, de.y );
+		const __m256d aexcey = _mm256_mul_pd( ae.x, ce.y );
+		const __m256d cexaey = _mm256_mul_pd( ce.x, ae.y );
+		const __m256d bexdey = _mm256_mul_pd( be.x, de.y );
+		const __m256d dexbey = _mm256_mul_pd( de.x, be.y );
+		const __m256d ab = _mm256_sub_pd( aexbey, bexaey );
+		const __m256d bc = _mm256_sub_pd( bexcey, cexbey );
+		const __m256d cd = _mm256_sub_pd( cexdey, dexcey );
+		const __m256d da = _mm256_sub_pd( dexaey, aexdey );
+		const __m256d ac = _mm256_sub_pd( aexcey, cexaey );
+		const __m256d bd = _mm256_sub_pd( bexdey, dexbey );
+
+		// 3x3 minors
+		const __m256d abc = vectorMultiplyAdd( ce.z, ab, _mm256_sub_pd( _mm256_mul_pd( ae.z, bc ), _mm256_mul_pd( be.z, ac ) ) );
+		const __m256d bcd = vectorMultiplyAdd( de.z, bc, _mm256_sub_pd( _mm256_mul_pd( be.z, cd ), _mm256_mul_pd( ce.z, bd ) ) );
+		const __m256d cda = vectorMultiplyAdd( ae.z, cd, vectorMultiplyAdd( de.z, ac, _mm256_mul_pd( ce.z, da ) ) );
+		const __m256d dab = vectorMultiplyAdd( be.z, da, vectorMultiplyAdd( ae.z, bd, _mm256_mul_pd( de.z, ab ) ) );
+
+		const __m256d alift = vector3x4Dot( ae, ae );
+		const __m256d blift = vector3x4Dot( be, be );
+		const __m256d clift = vector3x4Dot( ce, ce );
+		const __m256d dlift = vector3x4Dot( de, de );
+
+		const __m256d det = _mm256_add_pd( _mm256_sub_pd( _mm256_mul_pd( dlift, abc ), _mm256_mul_pd( clift, dab ) ),
+			_mm256_sub_pd( _mm256_mul_pd( blift, cda ), _mm256_mul_pd( alift, bcd ) ) );
+
+		const __m256d aez = vectorAbs( ae.z ), bez = vectorAbs( be.z ), cez = vectorAbs( ce.z ), dez = vectorAbs( de.z );
+		const __m256d abPlus = _mm256_add_pd( vectorAbs( aexbey ), vectorAbs( bexaey ) );
+		const __m256d bcPlus = _mm256_add_pd( vectorAbs( bexcey ), vectorAbs( cexbey ) );
+		const __m256d cdPlus = _mm256_add_pd( vectorAbs( cexdey ), vectorAbs( dexcey ) );
+		const __m256d daPlus = _mm256_add_pd( vectorAbs( dexaey ), vectorAbs( aexdey ) );
+		const __m256d acPlus = _mm256_add_pd( vectorAbs( aexcey ), vectorAbs( cexaey ) );
+		const __m256d bdPlus = _mm256_add_pd( vectorAbs( bexdey ), vectorAbs( dexbey ) );
+
+		const __m256d permA = vectorMultiplyAdd( bcPlus, dez, vectorMultiplyAdd( bdPlus, cez, _mm256_mul_pd( cdPlus, bez ) ) );
+		const __m256d permB = vectorMultiplyAdd( cdPlus, aez, vectorMultiplyAdd( acPlus, dez, _mm256_mul_pd( daPlus, cez ) ) );
+		const __m256d permC = vectorMultiplyAdd( daPlus, bez, vectorMultiplyAdd( bdPlus, aez, _mm256_mul_pd( abPlus, dez ) ) );
+		const __m256d permD = vectorMultiplyAdd( abPlus, cez, vectorMultiplyAdd( acPlus, bez, _mm256_mul_pd( bcPlus, aez ) ) );
+		__m256d perm = _mm256_mul_pd( permA, alift );
+		perm = vectorMultiplyAdd( permB, blift, perm );
+		perm = vectorMultiplyAdd( permC, clift, perm );
+		perm = vectorMultiplyAdd( permD, dlift, perm );
+		uncertain = robustUncertainLanes( det, perm, g_insphereErrorBound );
+		return det;
+	}
+
+	// ==== Batch predicates, 4 queries per call ====
+
+	// Positive when the points a, b, c are in counterclockwise order, negative when clockwise, zero when collinear
+	inline __m256d _AM_CALL_ orient2d4( const Vector2x4& a, const Vector2x4& b, const Vector2x4& c )
+	{
+		int uncertain;
+		const __m256d det = orient2dFilter( a, b, c, uncertain );
+		if( 0 == uncertain )
+			return det;
+		return orient2dExact4( a, b, c, det, uncertain );
+	}
+
+	// Positive when the point d is below the plane through a, b, c; "below" is defined so that a, b, c appear counterclockwise when viewed from above the plane.
+	// Negative when d is above the plane, zero when the 4 points are coplanar.
+	inline __m256d _AM_CALL_ orient3d4( const Vector3x4& a, const Vector3x4& b, const Vector3x4& c, const Vector3x4& d )
+	{
+		int uncertain;
+		const __m256d det = orient3dFilter( a, b, c, d, uncertain );
+		if( 0 == uncertain )
+			return det;
+		return orient3dExact4( a, b, c, d, det, uncertain );
+	}
+
+	// Positive when the point d is inside the circle through a, b, c, negative outside, zero when the 4 points are cocircular.
+	// The points a, b, c must be in counterclockwise order, otherwise the sign is reversed.
+	inline __m256d _AM_CALL_ incircle4( const Vector2x4& a, const Vector2x4& b, const Vector2x4& c, const Vector2x4& d )
+	{
+		int uncertain;
+		const __m256d det = incircleFilter( a, b, c, d, uncertain );
+		if( 0 == uncertain )
+			return det;
+		return incircleExact4( a, b, c, d, det, uncertain );
+	}
+
+	// Positive when the point e is inside the sphere through a, b, c, d, negative outside, zero when the 5 points are cospherical.
+	// The points a, b, c, d must have positive orientation as defined by orient3d, otherwise the sign is reversed.
+	inline __m256d _AM_CALL_ insphere4( const Vector3x4& a, const Vector3x4& b, const Vector3x4& c, const Vector3x4& d, const Vector3x4& e )
+	{
+		int uncertain;
+		const __m256d det = insphereFilter( a, b, c, d, e, uncertain );
+		if( 0 == uncertain )
+			return det;
+		return insphereExact4( a, b, c, d, e, det, uncertain );
+	}
+
+	// ==== Single queries ====
+	// The filters are the same vector code as the batch versions, on broadcasted arguments
+
+	// Positive when the points a, b, c are in counterclockwise order, negative when clockwise, zero when collinear
+	inline double orient2d( __m128d a, __m128d b, __m128d c )
+	{
+		int uncertain;
+		const __m256d det = orient2dFilter( vector2x4Splat( a ), vector2x4Splat( b ), vector2x4Splat( c ), uncertain );
+		if( 0 == ( uncertain & 1 ) )
+			return _mm256_cvtsd_f64( det );
+		return orient2dExact( a, b, c );
+	}
+
+	// Positive when the point d is below the plane through a, b, c, same as orient3d4. The W lanes of the arguments are ignored.
+	inline double orient3d( __m256d a, __m256d b, __m256d c, __m256d d )
+	{
+		int uncertain;
+		const __m256d det = orient3dFilter( vector3x4Splat( a ), vector3x4Splat( b ), vector3x4Splat( c ), vector3x4Splat( d ), uncertain );
+		if( 0 == ( uncertain & 1 ) )
+			return _mm256_cvtsd_f64( det );
+		return orient3dExact( a, b, c, d );
+	}
+
+	// Positive when the point d is inside the circle through counterclockwise a, b, c
+	inline double incircle( __m128d a, __m128d b, __m128d c, __m128d d )
+	{
+		int uncertain;
+		const __m256d det = incircleFilter( vector2x4Splat( a ), vector2x4Splat( b ), vector2x4Splat( c ), vector2x4Splat( d ), uncertain );
+		if( 0 == ( uncertain & 1 ) )
+			return _mm256_cvtsd_f64( det );
+		return incircleExact( a, b, c, d );
+	}
+
+	// Positive when the point e is inside the sphere through positively oriented a, b, c, d. The W lanes of the arguments are ignored.
+	inline double insphere( __m256d a, __m256d b, __m256d c, __m256d d, __m256d e )
+	{
+		int uncertain;
+		const __m256d det = insphereFilter( vector3x4Splat( a ), vector3x4Splat( b ), vector3x4Splat( c ), vector3x4Splat( d ), vector3x4Splat( e ), uncertain );
+		if( 0 == ( uncertain & 1 ) )
+			return _mm256_cvtsd_f64( det );
+		return insphereExact( a, b, c, d, e );
+	}
+}
\ No newline at end of file
@@ -0,0 +1,336 @@
+#include "AvxMath.h"
+#include "AvxMathParallel.h"
+#include <cmath>
+#include <string.h>
+
+namespace AvxMath
+{
+	namespace
+	{
+		// When running multithreaded, each thread gets at least that many vertices or triangles
+		constexpr size_t minParallelChunk = 1 << 14;
+
+		// Height of the plane #i. Both the bucketing of the triangles and the slicing use this function, they need exactly the same numbers.
+		inline double planeHeight( double first, double step, ptrdiff_t i )
+		{
+			return first + step * (double)i;
+		}
+
+		// Heights of the vertices [ begin .. end ) along the unit normal
+		void heightsSpan( const double* xyz, size_t begin, size_t end, const Vector3x4& normal, double* heights )
+		{
+			size_t i = begin;
+			for( ; i + 4 <= end; i += 4 )
+				_mm256_storeu_pd( heights + i, vector3x4Dot( loadVector3x4( xyz + i * 3 ), normal ) );
+			if( i < end )
+			{
+				double buffer[ 12 ] = {};
+				memcpy( buffer, xyz + i * 3, ( end - i ) * 3 * sizeof( double ) );
+				storePartial( heights + i, vector3x4Dot( loadVector3x4( buffer ), normal ), end - i );
+			}
+		}
+
+		// Planes [ lo .. hi ] which may cross a triangle, the range is empty when lo > hi
+		struct LayerRange
+		{
+			uint32_t lo, hi;
+		};
+
+		// The plane crosses the triangle when minHeight < height <= maxHeight, because the vertices exactly on the plane are above it.
+		// The division gives the initial guess, then the range is adjusted with the heights of the planes.
+		inline LayerRange layerRange( double minHeight, double maxHeight, double first, double step, size_t layers )
+		{
+			if( !( minHeight <= maxHeight ) )
+				return LayerRange{ 1, 0 };
+			const double limit = (double)layers;
+			ptrdiff_t lo = (ptrdiff_t)std::min( std::max( std::floor( ( minHeight - first ) / step ) + 1, -1.0 ), limit );
+			ptrdiff_t hi = (ptrdiff_t)std::min( std::max( std::floor( ( maxHeight - first ) / step ), -1.0 ), limit );
+			const ptrdiff_t count = (ptrdiff_t)layers;
+			while( lo > 0 && planeHeight( first, step, lo - 1 ) > minHeight )
+				lo--;
+			while( lo < count && planeHeight( first, step, lo ) <= minHeight )
+				lo++;
+			while( hi >= 0 && planeHeight( first, step, hi ) > maxHeight )
+				hi--;
+			while( hi + 1 < count && planeHeight( first, step, hi + 1 ) <= maxHeight )
+				hi++;
+			lo = std::max( lo, (ptrdiff_t)0 );
+			hi = std::min( hi, count - 1 );
+			if( lo > hi )
+				return LayerRange{ 1, 0 };
+			return LayerRange{ (uint32_t)lo, (uint32_t)hi };
+		}
+
+		// Compute the plane ranges for the triangles [ begin .. end ), and count the triangles of every plane
+		void rangesSpan( const double* heights, const uint32_t* indices, size_t begin, size_t end, double first, double step, size_t layers, LayerRange* ranges, uint32_t* counts )
+		{
+			for( size_t i = begin; i < end; i += 4 )
+			{
+				const size_t n = std::min( end - i, (size_t)4 );
+				double h[ 3 ][ 4 ];
+				for( size_t l = 0; l < 4; l++ )
+				{
+					const uint32_t* tri = indices + ( i + std::min( l, n - 1 ) ) * 3;
+					for( size_t v = 0; v < 3; v++ )
+						h[ v ][ l ] = heights[ tri[ v ] ];
+				}
+				const __m256d a = _mm256_loadu_pd( h[ 0 ] ), b = _mm256_loadu_pd( h[ 1 ] ), c = _mm256_loadu_pd( h[ 2 ] );
+				double minHeight[ 4 ], maxHeight[ 4 ];
+				_mm256_storeu_pd( minHeight, _mm256_min_pd( _mm256_min_pd( a, b ), c ) );
+				_mm256_storeu_pd( maxHeight, _mm256_max_pd( _mm256_max_pd( a, b ), c ) );
+
+				for( size_t l = 0; l < n; l++ )
+				{
+					const LayerRange r = layerRange( minHeight[ l ], maxHeight[ l ], first, step, layers );
+					ranges[ i + l ] = r;
+					for( uint32_t k = r.lo; k <= r.hi && r.lo <= r.hi; k++ )
+						counts[ k ]++;
+				}
+			}
+		}
+
+		// Key of the mesh edge for the hash set, the vertex indices are exact in FP64
+		inline __m256d edgeKey( uint32_t a, uint32_t b )
+		{
+			return _mm256_setr_pd( (double)std::min( a, b ), (double)std::max( a, b ), 0, 0 );
+		}
+
+		// Intersects the triangles with a plane, and stitches the segments into contours.
+		// Every segment starts where the triangle edge goes from above the plane to below it, and ends on the edge which goes up.
+		// For a closed manifold mesh, every crossed edge is the start of one segment and the end of another one.
+		class LayerSlicer
+		{
+			const double* const xyz;
+			const double* const heights;
+			const uint32_t* const indices;
+
+			// The start edges of the segments
+			Vector3HashSet edges;
+			// Segment for every entry in the edges set
+			std::vector<uint32_t> byStart;
+			// For every segment, vertices of the end edge, then the start and end points
+			std::vector<uint32_t> endEdges;
+			std::vector<double> points;
+			std::vector<uint32_t> next;
+			std::vector<uint8_t> hasPrev, visited;
+
+			void addSegment( uint32_t s0, uint32_t s1, const double* start, uint32_t e0, uint32_t e1, const double* end )
+			{
+				const uint32_t segment = (uint32_t)( endEdges.size() / 2 );
+				const uint32_t id = edges.insert( edgeKey( s0, s1 ) );
+				// For non-manifold edges, the last segment wins
+				if( id == byStart.size() )
+					byStart.push_back( segment );
+				else
+					byStart[ id ] = segment;
+				endEdges.push_back( e0 );
+				endEdges.push_back( e1 );
+				points.insert( points.end(), start, start + 3 );
+				points.insert( points.end(), end, end + 3 );
+			}
+
+			// Append the point to the contour, unless it's equal to the previous one; the vertices on the plane produce zero-length segments
+			static void appendPoint( SliceContours& out, size_t contourBegin, const double* pt )
+			{
+				const size_t size = out.xyz.size();
+				if( size > contourBegin * 3 && 0 == memcmp( &out.xyz[ size - 3 ], pt, 3 * sizeof( double ) ) )
+					return;
+				out.xyz.insert( out.xyz.end(), pt, pt + 3 );
+			}
+
+			void trace( uint32_t first, SliceContours& out )
+			{
+				const size_t contourBegin = out.xyz.size() / 3;
+				uint32_t s = first, last = first;
+				do
+				{
+					visited[ s ] = 1;
+					appendPoint( out, contourBegin, &points[ (size_t)s * 6 ] );
+					last = s;
+					s = next[ s ];
+				}
+				while( s != UINT32_MAX && 0 == visited[ s ] );
+
+				const bool closed = ( s == first );
+				if( closed )
+				{
+					const size_t size = out.xyz.size();
+					if( size >= contourBegin * 3 + 6 && 0 == memcmp( &out.xyz[ size - 3 ], &out.xyz[ contourBegin * 3 ], 3 * sizeof( double ) ) )
+						out.xyz.resize( size - 3 );
+				}
+				else
+					appendPoint( out, contourBegin, &points[ (size_t)last * 6 + 3 ] );
+				out.offsets.push_back( (uint32_t)( out.xyz.size() / 3 ) );
+				out.closed.push_back( closed ? 1 : 0 );
+			}
+
+		public:
+			LayerSlicer( const double* xyz, const double* heights, const uint32_t* indices ) :
+				xyz( xyz ), heights( heights ), indices( indices ) { }
+
+			void slice( const uint32_t* triangles, size_t count, double height, SliceContours& out )
+			{
+				edges.clear();
+				byStart.clear();
+				endEdges.clear();
+				points.clear();
+				const __m256d h = _mm256_set1_pd( height );
+				const __m256d zero = _mm256_setzero_pd();
+
+				for( size_t i = 0; i < count; i += 4 )
+				{
+					const size_t n = std::min( count - i, (size_t)4 );
+					uint32_t v[ 3 ][ 4 ];
+					for( size_t l = 0; l < 4; l++ )
+					{
+						const uint32_t* tri = indices + (size_t)triangles[ i + std::min( l, n - 1 ) ] * 3;
+						v[ 0 ][ l ] = tri[ 0 ];
+						v[ 1 ][ l ] = tri[ 1 ];
+						v[ 2 ][ l ] = tri[ 2 ];
+					}
+
+					// Signed distances of the vertices, 4 triangles at a time
+					__m256d d[ 3 ];
+					int above[ 3 ];
+					for( size_t e = 0; e < 3; e++ )
+					{
+						d[ e ] = _mm256_sub_pd( _mm256_setr_pd( heights[ v[ e ][ 0 ] ], heights[ v[ e ][ 1 ] ], heights[ v[ e ][ 2 ] ], heights[ v[ e ][ 3 ] ] ), h );
+						above[ e ] = _mm256_movemask_pd( _mm256_cmp_pd( d[ e ], zero, _CMP_GE_OQ ) );
+					}
+					// The triangle crosses the plane when some vertices are above it and some are not
+					const int crossing = ( above[ 0 ] | above[ 1 ] | above[ 2 ] ) & ~( above[ 0 ] & above[ 1 ] & above[ 2 ] ) & ( ( 1 << n ) - 1 );
+					if( 0 == crossing )
+						continue;
+
+					// Intersection points of all 3 edges of the 4 triangles, only the crossing edges are used
+					Vector3x4 p[ 3 ];
+					for( size_t e = 0; e < 3; e++ )
+					{
+						p[ e ].x = _mm256_setr_pd( xyz[ v[ e ][ 0 ] * 3ull ], xyz[ v[ e ][ 1 ] * 3ull ], xyz[ v[ e ][ 2 ] * 3ull ], xyz[ v[ e ][ 3 ] * 3ull ] );
+						p[ e ].y = _mm256_setr_pd( xyz[ v[ e ][ 0 ] * 3ull + 1 ], xyz[ v[ e ][ 1 ] * 3ull + 1 ], xyz[ v[ e ][ 2 ] * 3ull + 1 ], xyz[ v[ e ][ 3 ] * 3ull + 1 ] );
+						p[ e ].z = _mm256_setr_pd( xyz[ v[ e ][ 0 ] * 3ull + 2 ], xyz[ v[ e ][ 1 ] * 3ull + 2 ], xyz[ v[ e ][ 2 ] * 3ull + 2 ], xyz[ v[ e ][ 3 ] * 3ull + 2 ] );
+					}
+					double pts[ 3 ][ 12 ];
+					for( size_t e = 0; e < 3; e++ )
+					{
+						const size_t e1 = ( e + 1 ) % 3;
+						const __m256d t = _mm256_div_pd( d[ e ], _mm256_sub_pd( d[ e ], d[ e1 ] ) );
+						storeVector3x4( pts[ e ], vector3x4MultiplyAdd( vector3x4Subtract( p[ e1 ], p[ e ] ), t, p[ e ] ) );
+					}
+
+					for( size_t l = 0; l < n; l++ )
+					{
+						if( 0 == ( ( crossing >> l ) & 1 ) )
+							continue;
+						size_t start = 0, end = 0;
+						for( size_t e = 0; e < 3; e++ )
+						{
+							const int a0 = ( above[ e ] >> l ) & 1, a1 = ( above[ ( e + 1 ) % 3 ] >> l ) & 1;
+							if( a0 && !a1 )
+								start = e;
+							else if( !a0 && a1 )
+								end = e;
+						}
+						addSegment( v[ start ][ l ], v[ ( start + 1 ) % 3 ][ l ], &pts[ start ][ l * 3 ], v[ end ][ l ], v[ ( end + 1 ) % 3 ][ l ], &pts[ end ][ l * 3 ] );
+					}
+				}
+				stitch( out );
+			}
+
+		private:
+			void stitch( SliceContours& out )
+			{
+				out.xyz.clear();
+				out.offsets.assign( 1, 0 );
+				out.closed.clear();
+
+				const size_t segments = endEdges.size() / 2;
+				next.resize( segments );
+				hasPrev.assign( segments, 0 );
+				visited.assign( segments, 0 );
+				for( size_t s = 0; s < segments; s++ )
+				{
+					const uint32_t id = edges.find( edgeKey( endEdges[ s * 2 ], endEdges[ s * 2 + 1 ] ) );
+					next[ s ] = ( id != UINT32_MAX ) ? byStart[ id ] : UINT32_MAX;
+					if( next[ s ] != UINT32_MAX )
+						hasPrev[ next[ s ] ] = 1;
+				}
+
+				// Open chains start at the segments without predecessors, the rest of the segments form closed loops
+				for( size_t s = 0; s < segments; s++ )
+					if( 0 == hasPrev[ s ] && 0 == visited[ s ] )
+						trace( (uint32_t)s, out );
+				for( size_t s = 0; s < segments; s++ )
+					if( 0 == visited[ s ] )
+						trace( (uint32_t)s, out );
+			}
+		};
+	}
+
+	void meshSlice( const double* xyz, size_t vertices, const uint32_t* indices, size_t triangles, __m256d normal, double first, double step, size_t layers,
+		std::vector<SliceContours>& result, bool parallel )
+	{
+		result.resize( layers );
+		if( 0 == layers )
+			return;
+		assert( step > 0 && layers < UINT32_MAX );
+
+		// Heights of the vertices along the normal
+		const __m256d lengthSquared = vector3Dot( normal, normal );
+		const __m256d unit = _mm256_div_pd( normal, _mm256_sqrt_pd( lengthSquared ) );
+		const Vector3x4 n = vector3x4Splat( unit );
+		std::vector<double> heights( vertices );
+		parallelFor( vertices, parallel ? minParallelChunk : vertices, [ & ]( size_t begin, size_t end )
+		{
+			heightsSpan( xyz, begin, end, n, heights.data() );
+		} );
+
+		// Distribute the triangles into the planes which cross them. Each thread counts the planes for a range of triangles,
+		// then the triangles are written in compressed sparse rows, in ascending order within each plane.
+		const size_t threads = parallel ? parallelThreads( triangles, minParallelChunk ) : 1;
+		const size_t chunk = ( triangles + threads - 1 ) / threads;
+		std::vector<LayerRange> ranges( triangles );
+		std::vector<uint32_t> counts( threads * layers, 0 );
+		parallelInvoke( threads, [ & ]( size_t t )
+		{
+			const size_t begin = std::min( triangles, t * chunk );
+			rangesSpan( heights.data(), indices, begin, std::min( triangles, begin + chunk ), first, step, layers, ranges.data(), &counts[ t * layers ] );
+		} );
+
+		std::vector<uint32_t> offsets( layers + 1 );
+		size_t sum = 0;
+		for( size_t k = 0; k < layers; k++ )
+		{
+			offsets[ k ] = (uint32_t)sum;
+			for( size_t t = 0; t < threads; t++ )
+			{
+				const uint32_t c = counts[ t * layers + k ];
+				counts[ t * layers + k ] = (uint32_t)sum;
+				sum += c;
+			}
+		}
+		assert( sum < UINT32_MAX );
+		offsets[ layers ] = (uint32_t)sum;
+
+		std::vector<uint32_t> buckets( sum );
+		parallelInvoke( threads, [ & ]( size_t t )
+		{
+			uint32_t* const positions = &counts[ t * layers ];
+			const size_t end = std::min( triangles, t * chunk + chunk );
+			for( size_t i = std::min( triangles, t * chunk ); i < end; i++ )
+			{
+				const LayerRange r = ranges[ i ];
+				for( uint32_t k = r.lo; k <= r.hi && r.lo <= r.hi; k++ )
+					buckets[ positions[ k ]++ ] = (uint32_t)i;
+			}
+		} );
+
+		// Slice the planes, each thread handles a range of them
+		parallelFor( layers, parallel ? 1 : layers, [ & ]( size_t begin, size_t end )
+		{
+			LayerSlicer slicer{ xyz, heights.data(), indices };
+			for( size_t k = begin; k < end; k++ )
+				slicer.slice( &buckets[ offsets[ k ] ], offsets[ k + 1 ] - offsets[ k ], planeHeight( first, step, (ptrdiff_t)k ), result[ k ] );
+		} );
+	}
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+// Slicing of triangle meshes with parallel planes into contours, for additive manufacturing
+#pragma once
+#include <vector>
+
+namespace AvxMath
+{
+	// Contours of a single slice. The points of the contour #i are xyz[ offsets[ i ] * 3 .. offsets[ i + 1 ] * 3 ), 3 doubles per point.
+	// The closed contours don't repeat the first point. Outer boundaries are counter-clockwise when looking from the positive side of the plane, holes are clockwise.
+	struct SliceContours
+	{
+		std::vector<double> xyz;
+		std::vector<uint32_t> offsets;
+		// For every contour, 1 when it's closed, 0 for the open chains which end at the boundary of a non-closed mesh
+		std::vector<uint8_t> closed;
+
+		// Count of contours
+		size_t size() const { return closed.size(); }
+	};
+
+	// Slice the indexed triangle mesh with the planes perpendicular to the normal: dot( normal, pos ) = first + i * step, for i in [ 0 .. layers ).
+	// The normal doesn't need to be unit length, first and step are distances along the normalized direction.
+	// The triangles are counter-clockwise when looking from outside, the contours are traced from the intersection segments of the triangles.
+	// The vertices exactly on the plane are treated as slightly above it, the contours are closed for any closed manifold mesh.
+	// With parallel = true, the slices are distributed across the hardware threads. Replaces the content of the result vector.
+	void meshSlice( const double* xyz, size_t vertices, const uint32_t* indices, size_t triangles, __m256d normal, double first, double step, size_t layers,
+		std::vector<SliceContours>& result, bool parallel = false );
+}
\ No newline at end of file
@@ -0,0 +1,165 @@
+// 3D and 2D vectors in structure of arrays layout, 4 vectors in 3 or 2 AVX registers
+#pragma once
+
+namespace AvxMath
+{
+	// 4 3D vectors, lane i of the registers contains the vector #i
+	struct Vector3x4
+	{
+		__m256d x, y, z;
+	};
+
+	// Transpose 4 3D vectors from 12 consecutive numbers in 3 registers into SoA layout. Only needs AVX1.
+	inline Vector3x4 vector3x4FromAos( __m256d a, __m256d b, __m256d c )
+	{
+		// a = x0, y0, z0, x1
+		// b = y1, z1, x2, y2
+		// c = z2, x3, y3, z3
+		const __m256d u = _mm256_blend_pd( a, b, 0b1100 );          // x0, y0, x2, y2
+		const __m256d v = _mm256_permute2f128_pd( a, c, 0x21 );     // z0, x1, z2, x3
+		const __m256d w = _mm256_blend_pd( b, c, 0b1100 );          // y1, z1, y3, z3
+
+		Vector3x4 res;
+		res.x = _mm256_shuffle_pd( u, v, 0b1010 );
+		res.y = _mm256_shuffle_pd( u, w, 0b0101 );
+		res.z = _mm256_shuffle_pd( v, w, 0b1010 );
+		return res;
+	}
+
+	// Transpose 4 3D vectors into 12 consecutive numbers in 3 registers
+	inline void vector3x4ToAos( const Vector3x4& vec, __m256d& a, __m256d& b, __m256d& c )
+	{
+		const __m256d u = _mm256_shuffle_pd( vec.x, vec.y, 0b0000 ); // x0, y0, x2, y2
+		const __m256d v = _mm256_shuffle_pd( vec.z, vec.x, 0b1010 ); // z0, x1, z2, x3
+		const __m256d w = _mm256_shuffle_pd( vec.y, vec.z, 0b1111 ); // y1, z1, y3, z3
+
+		a = _mm256_permute2f128_pd( u, v, 0x20 );
+		b = _mm256_blend_pd( w, u, 0b1100 );
+		c = _mm256_permute2f128_pd( v, w, 0x31 );
+	}
+
+	// Load 4 3D vectors from 12 consecutive doubles, transposing into SoA layout
+	inline Vector3x4 loadVector3x4( const double* rsi )
+	{
+		return vector3x4FromAos( _mm256_loadu_pd( rsi ), _mm256_loadu_pd( rsi + 4 ), _mm256_loadu_pd( rsi + 8 ) );
+	}
+
+	// Store 4 3D vectors into 12 consecutive doubles
+	inline void storeVector3x4( double* rdi, const Vector3x4& vec )
+	{
+		__m256d a, b, c;
+		vector3x4ToAos( vec, a, b, c );
+		_mm256_storeu_pd( rdi, a );
+		_mm256_storeu_pd( rdi + 4, b );
+		_mm256_storeu_pd( rdi + 8, c );
+	}
+
+	// Load 4 3D vectors from 12 consecutive floats, converting to FP64
+	inline Vector3x4 loadVector3x4( const float* rsi )
+	{
+		return vector3x4FromAos( _mm256_cvtps_pd( _mm_loadu_ps( rsi ) ), _mm256_cvtps_pd( _mm_loadu_ps( rsi + 4 ) ), _mm256_cvtps_pd( _mm_loadu_ps( rsi + 8 ) ) );
+	}
+
+	// Store 4 3D vectors into 12 consecutive floats, rounding to nearest
+	inline void storeVector3x4( float* rdi, const Vector3x4& vec )
+	{
+		__m256d a, b, c;
+		vector3x4ToAos( vec, a, b, c );
+		_mm_storeu_ps( rdi, _mm256_cvtpd_ps( a ) );
+		_mm_storeu_ps( rdi + 4, _mm256_cvtpd_ps( b ) );
+		_mm_storeu_ps( rdi + 8, _mm256_cvtpd_ps( c ) );
+	}
+
+#if _AM_F16C_INTRINSICS_
+	// Load 4 3D vectors from 12 consecutive FP16 numbers
+	inline Vector3x4 loadVector3x4( const uint16_t* rsi )
+	{
+		const __m128i ab = _mm_loadu_si128( ( const __m128i* )rsi );
+		const __m128i c = _mm_loadl_epi64( ( const __m128i* )( rsi + 8 ) );
+		return vector3x4FromAos( _mm256_cvtps_pd( _mm_cvtph_ps( ab ) ), _mm256_cvtps_pd( _mm_cvtph_ps( _mm_unpackhi_epi64( ab, ab ) ) ), _mm256_cvtps_pd( _mm_cvtph_ps( c ) ) );
+	}
+
+	// Store 4 3D vectors into 12 consecutive FP16 numbers, rounding twice like storeHalf4
+	inline void storeVector3x4( uint16_t* rdi, const Vector3x4& vec )
+	{
+		__m256d a, b, c;
+		vector3x4ToAos( vec, a, b, c );
+		const __m128i ha = _mm_cvtps_ph( _mm256_cvtpd_ps( a ), _MM_FROUND_TO_NEAREST_INT );
+		const __m128i hb = _mm_cvtps_ph( _mm256_cvtpd_ps( b ), _MM_FROUND_TO_NEAREST_INT );
+		_mm_storeu_si128( ( __m128i* )rdi, _mm_unpacklo_epi64( ha, hb ) );
+		_mm_storel_epi64( ( __m128i* )( rdi + 8 ), _mm_cvtps_ph( _mm256_cvtpd_ps( c ), _MM_FROUND_TO_NEAREST_INT ) );
+	}
+#endif
+
+	// Broadcast 3D vector into all 4 lanes
+	inline Vector3x4 vector3x4Splat( __m256d vec )
+	{
+		return Vector3x4{ vectorSplatX( vec ), vectorSplatY( vec ), vectorSplatZ( vec ) };
+	}
+
+	inline Vector3x4 vector3x4Add( const Vector3x4& a, const Vector3x4& b )
+	{
+		return Vector3x4{ _mm256_add_pd( a.x, b.x ), _mm256_add_pd( a.y, b.y ), _mm256_add_pd( a.z, b.z ) };
+	}
+
+	inline Vector3x4 vector3x4Subtract( const Vector3x4& a, const Vector3x4& b )
+	{
+		return Vector3x4{ _mm256_sub_pd( a.x, b.x ), _mm256_sub_pd( a.y, b.y ), _mm256_sub_pd( a.z, b.z ) };
+	}
+
+	// Multiply 4 vectors by 4 scalars
+	inline Vector3x4 vector3x4Scale( const Vector3x4& a, __m256d s )
+	{
+		return Vector3x4{ _mm256_mul_pd( a.x, s ), _mm256_mul_pd( a.y, s ), _mm256_mul_pd( a.z, s ) };
+	}
+
+	// Compute a * s + b
+	inline Vector3x4 vector3x4MultiplyAdd( const Vector3x4& a, __m256d s, const Vector3x4& b )
+	{
+		return Vector3x4{ vectorMultiplyAdd( a.x, s, b.x ), vectorMultiplyAdd( a.y, s, b.y ), vectorMultiplyAdd( a.z, s, b.z ) };
+	}
+
+	// 4 dot products
+	inline __m256d vector3x4Dot( const Vector3x4& a, const Vector3x4& b )
+	{
+		__m256d res = _mm256_mul_pd( a.x, b.x );
+		res = vectorMultiplyAdd( a.y, b.y, res );
+		return vectorMultiplyAdd( a.z, b.z, res );
+	}
+
+	// 4 cross products. Unlike the dot product, the code has no explicit FMA; still, with FMA enabled, the compiler may contract
+	// these multiplications and subtractions, GCC does by default with -ffp-contract=fast, so the lowest bits may differ between builds.
+	inline Vector3x4 vector3x4Cross( const Vector3x4& a, const Vector3x4& b )
+	{
+		Vector3x4 res;
+		res.x = _mm256_sub_pd( _mm256_mul_pd( a.y, b.z ), _mm256_mul_pd( a.z, b.y ) );
+		res.y = _mm256_sub_pd( _mm256_mul_pd( a.z, b.x ), _mm256_mul_pd( a.x, b.z ) );
+		res.z = _mm256_sub_pd( _mm256_mul_pd( a.x, b.y ), _mm256_mul_pd( a.y, b.x ) );
+		return res;
+	}
+
+	// Select lanes from b where the mask is set, from a otherwise
+	inline Vector3x4 vector3x4Select( const Vector3x4& a, const Vector3x4& b, __m256d mask )
+	{
+		return Vector3x4{ _mm256_blendv_pd( a.x, b.x, mask ), _mm256_blendv_pd( a.y, b.y, mask ), _mm256_blendv_pd( a.z, b.z, mask ) };
+	}
+
+	// Select X, Y or Z component of the vectors, separately for every lane; when both masks are clear, the component is Z
+	inline __m256d vector3x4Component( const Vector3x4& v, __m256d isX, __m256d isY )
+	{
+		return _mm256_blendv_pd( _mm256_blendv_pd( v.z, v.y, isY ), v.x, isX );
+	}
+
+	// 4 2D vectors, lane i of the registers contains the vector #i
+	struct Vector2x4
+	{
+		__m256d x, y;
+	};
+
+	// Broadcast 2D vector into all 4 lanes
+	inline Vector2x4 vector2x4Splat( __m128d vec )
+	{
+		const __m256d v = dup2( vec );
+		return Vector2x4{ _mm256_permute_pd( v, 0b0000 ), _mm256_permute_pd( v, 0b1111 ) };
+	}
+}
\ No newline at end of file
@@ -0,0 +1,284 @@
+#include "AvxMath.h"
+#include "AvxMathParallel.h"
+#include <vector>
+#include <array>
+#include <string.h>
+
+namespace AvxMath
+{
+	namespace
+	{
+		constexpr size_t minParallelChunk = 1 << 15;
+
+		// Transform IEEE numbers into unsigned integers with the same order: flip all bits of negative numbers, and the sign bit of positive ones.
+		// _mm256_blendv_pd selects by the sign bit, this works without AVX2 and handles -0.0 and NaNs correctly.
+		inline __m256d sortableKeys( __m256d v )
+		{
+			const __m256d signBit = broadcast( g_misc.negativeZero );
+			const __m256d allOnes = _mm256_castsi256_pd( _mm256_set1_epi32( -1 ) );
+			const __m256d mask = _mm256_blendv_pd( signBit, allOnes, v );
+			return _mm256_xor_pd( v, mask );
+		}
+
+		void transformKeys( const double* rsi, size_t count, uint64_t* rdi )
+		{
+			double* const dest = (double*)rdi;
+			size_t i = 0;
+			for( ; i + 4 <= count; i += 4 )
+				_mm256_storeu_pd( dest + i, sortableKeys( _mm256_loadu_pd( rsi + i ) ) );
+			if( i < count )
+				storePartial( dest + i, sortableKeys( loadPartial( rsi + i, count - i ) ), count - i );
+		}
+
+		inline size_t digit( uint64_t key, size_t pass )
+		{
+			return (size_t)( key >> ( pass * 8 ) ) & 0xFF;
+		}
+
+		// The radix sort moves these structures between 2 arrays; 16 bytes per element, and a single output stream per bucket
+		struct Item
+		{
+			uint64_t key;
+			uint64_t index;
+		};
+
+		using Histogram = std::array<size_t, 256>;
+
+		// Sort the items by the specified byte of the keys
+		void scatter( const Item* source, Item* dest, size_t begin, size_t end, size_t pass, Histogram& offsets )
+		{
+			for( size_t i = begin; i < end; i++ )
+			{
+				const Item it = source[ i ];
+				dest[ offsets[ digit( it.key, pass ) ]++ ] = it;
+			}
+		}
+
+		// Histograms of all 8 bytes of the keys in the range
+		void histograms( const Item* items, size_t begin, size_t end, Histogram* hist )
+		{
+			for( size_t i = begin; i < end; i++ )
+			{
+				const uint64_t k = items[ i ].key;
+				for( size_t pass = 0; pass < 8; pass++ )
+					hist[ pass ][ digit( k, pass ) ]++;
+			}
+		}
+
+		// LSD radix sort of the items by the complete 64-bit keys, the result is in the items array
+		void radixSort( Item* items, Item* temp, size_t length, size_t threads )
+		{
+			Item* source = items;
+			Item* dest = temp;
+
+			if( threads <= 1 )
+			{
+				Histogram hist[ 8 ] = {};
+				histograms( items, 0, length, hist );
+				for( size_t pass = 0; pass < 8; pass++ )
+				{
+					Histogram& h = hist[ pass ];
+					if( h[ digit( items[ 0 ].key, pass ) ] == length )
+						continue;
+					size_t sum = 0;
+					for( size_t& c : h )
+					{
+						const size_t count = c;
+						c = sum;
+						sum += count;
+					}
+					scatter( source, dest, 0, length, pass, h );
+					std::swap( source, dest );
+				}
+			}
+			else
+			{
+				// Each thread handles a contiguous range of the source array; the ranges are the same for all passes
+				const size_t chunk = ( length + threads - 1 ) / threads;
+				const auto chunkEnd = [ = ]( size_t t ) { return std::min( length, t * chunk + chunk ); };
+				std::vector<Histogram> hist( threads * 8 );
+				std::vector<Histogram> offsets( threads );
+
+				// Histograms of all bytes, to skip the passes where all keys have the same byte
+				parallelInvoke( threads, [ & ]( size_t t ) { histograms( items, t * chunk, chunkEnd( t ), &hist[ t * 8 ] ); } );
+
+				for( size_t pass = 0; pass < 8; pass++ )
+				{
+					size_t count = 0;
+					for( size_t t = 0; t < threads; t++ )
+						count += hist[ t * 8 + pass ][ digit( items[ 0 ].key, pass ) ];
+					if( count == length )
+						continue;
+
+					// After the first pass the data is moved between the ranges, per-range histograms need to be computed again
+					parallelInvoke( threads, [ & ]( size_t t )
+					{
+						Histogram& h = offsets[ t ];
+						h.fill( 0 );
+						for( size_t i = t * chunk; i < chunkEnd( t ); i++ )
+							h[ digit( source[ i ].key, pass ) ]++;
+					} );
+
+					// Output position of the first element with every byte value, for every thread
+					size_t sum = 0;
+					for( size_t d = 0; d < 256; d++ )
+						for( size_t t = 0; t < threads; t++ )
+						{
+							const size_t c = offsets[ t ][ d ];
+							offsets[ t ][ d ] = sum;
+							sum += c;
+						}
+
+					parallelInvoke( threads, [ & ]( size_t t ) { scatter( source, dest, t * chunk, chunkEnd( t ), pass, offsets[ t ] ); } );
+					std::swap( source, dest );
+				}
+			}
+
+			if( source != items )
+				memcpy( items, source, length * sizeof( Item ) );
+		}
+
+		// The runs shorter than that are sorted with insertion sort
+		constexpr size_t minRadixRun = 64;
+
+		// The items in the range are sorted by the lane, and have the keys of that lane.
+		// Sort the runs of equal keys by the less significant lanes.
+		template<size_t lanes>
+		void sortRuns( Item* items, Item* temp, size_t begin, size_t end, size_t lane, const uint64_t* keys )
+		{
+			if( lane == 0 )
+				return;
+			const size_t next = lane - 1;
+
+			for( size_t runBegin = begin; runBegin < end; )
+			{
+				size_t runEnd = runBegin + 1;
+				while( runEnd < end && items[ runEnd ].key == items[ runBegin ].key )
+					runEnd++;
+
+				const size_t runLength = runEnd - runBegin;
+				if( runLength >= minRadixRun )
+				{
+					// Long run: replace the keys with the next lane, radix sort, then recursively process the runs in the next lane
+					for( size_t i = runBegin; i < runEnd; i++ )
+						items[ i ].key = keys[ items[ i ].index * lanes + next ];
+					radixSort( items + runBegin, temp + runBegin, runLength, 1 );
+					sortRuns<lanes>( items, temp, runBegin, runEnd, next, keys );
+				}
+				else if( runLength > 1 )
+				{
+					// Short run: stable insertion sort, comparing the remaining lanes
+					const auto less = [ keys, next ]( uint64_t a, uint64_t b )
+					{
+						for( size_t l = next; ; l-- )
+						{
+							const uint64_t ka = keys[ a * lanes + l ];
+							const uint64_t kb = keys[ b * lanes + l ];
+							if( ka != kb )
+								return ka < kb;
+							if( l == 0 )
+								return false;
+						}
+					};
+					for( size_t i = runBegin + 1; i < runEnd; i++ )
+					{
+						const Item it = items[ i ];
+						size_t j = i;
+						for( ; j > runBegin && less( it.index, items[ j - 1 ].index ); j-- )
+							items[ j ] = items[ j - 1 ];
+						items[ j ] = it;
+					}
+				}
+				runBegin = runEnd;
+			}
+		}
+
+		template<size_t lanes>
+		void sortIndices( const double* rsi, size_t length, uint32_t* indices, bool parallel )
+		{
+			if( 0 == length )
+				return;
+			const size_t threads = parallel ? parallelThreads( length, minParallelChunk ) : 1;
+			const size_t minChunk = parallel ? minParallelChunk : length;
+
+			std::vector<uint64_t> keys( length * lanes );
+			std::vector<Item> items( length * 2 );
+			Item* const temp = items.data() + length;
+
+			constexpr size_t top = lanes - 1;
+			parallelFor( length, minChunk, [ & ]( size_t begin, size_t end )
+			{
+				transformKeys( rsi + begin * lanes, ( end - begin ) * lanes, keys.data() + begin * lanes );
+				for( size_t i = begin; i < end; i++ )
+					items[ i ] = Item{ keys[ i * lanes + top ], i };
+			} );
+
+			// Radix sort by the most significant lane. For typical data most keys are unique at this point.
+			radixSort( items.data(), temp, length, threads );
+
+			// Sort the runs of equal keys by the remaining lanes. The runs are independent, the threads take the runs which start in their ranges.
+			// The boundaries are found before any thread starts, because sorting the runs replaces the keys.
+			const size_t chunk = ( length + threads - 1 ) / threads;
+			const auto runStart = [ & ]( size_t i ) { return i == 0 || i >= length || items[ i ].key != items[ i - 1 ].key; };
+			std::vector<size_t> bounds( threads + 1 );
+			bounds[ threads ] = length;
+			for( size_t t = 1; t < threads; t++ )
+			{
+				size_t i = std::max( t * chunk, bounds[ t - 1 ] );
+				while( !runStart( i ) )
+					i++;
+				bounds[ t ] = i;
+			}
+			parallelInvoke( threads, [ & ]( size_t t )
+			{
+				sortRuns<lanes>( items.data(), temp, bounds[ t ], bounds[ t + 1 ], top, keys.data() );
+			} );
+
+			parallelFor( length, minChunk, [ & ]( size_t begin, size_t end )
+			{
+				for( size_t i = begin; i < end; i++ )
+					indices[ i ] = (uint32_t)items[ i ].index;
+			} );
+		}
+
+		template<size_t lanes>
+		void sortVectors( double* rsi, size_t length, bool parallel )
+		{
+			std::vector<uint32_t> indices( length );
+			sortIndices<lanes>( rsi, length, indices.data(), parallel );
+
+			const std::vector<double> copy( rsi, rsi + length * lanes );
+			parallelFor( length, parallel ? minParallelChunk : length, [ & ]( size_t begin, size_t end )
+			{
+				for( size_t i = begin; i < end; i++ )
+					memcpy( rsi + i * lanes, &copy[ (size_t)indices[ i ] * lanes ], lanes * 8 );
+			} );
+		}
+	}
+
+	void arraySort( double* rsi, size_t length, bool parallel )
+	{
+		sortVectors<4>( rsi, length, parallel );
+	}
+	void array3Sort( double* rsi, size_t length, bool parallel )
+	{
+		sortVectors<3>( rsi, length, parallel );
+	}
+	void array2Sort( double* rsi, size_t length, bool parallel )
+	{
+		sortVectors<2>( rsi, length, parallel );
+	}
+
+	void arraySortIndices( const double* rsi, size_t length, uint32_t* indices, bool parallel )
+	{
+		sortIndices<4>( rsi, length, indices, parallel );
+	}
+	void array3SortIndices( const double* rsi, size_t length, uint32_t* indices, bool parallel )
+	{
+		sortIndices<3>( rsi, length, indices, parallel );
+	}
+	void array2SortIndices( const double* rsi, size_t length, uint32_t* indices, bool parallel )
+	{
+		sortIndices<2>( rsi, length, indices, parallel );
+	}
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+// Radix sort for arrays of vectors, in the order defined by vectorLess functions
+#pragma once
+
+namespace AvxMath
+{
+	// These functions sort arrays of vectors in lexicographic order: the last lane is the most significant, X lane is the least significant.
+	// For 2D vectors that's the order of vectorLess( __m128d, __m128d ), for 3D vector3Less, for 4D vectorLess( __m256d, __m256d ).
+	// The sort is stable. It's LSD radix sort of the most significant lane, on 64-bit keys made from the bits of the numbers;
+	// the runs of equal keys are then sorted by the remaining lanes, with radix sort for long runs and insertion sort for short ones.
+	// The passes where all keys have the same byte are skipped, e.g. when all numbers in a lane have the same sign and exponent.
+	// Unlike vectorLess, the radix sort places -0.0 before +0.0, negative NaNs first and positive NaNs last.
+	// With parallel = true, large arrays are sorted on all hardware threads. The length must be less than 2^32.
+
+	// Sort 4D vectors, the array has length * 4 doubles
+	void arraySort( double* rsi, size_t length, bool parallel = false );
+	// Sort 3D vectors, the array has length * 3 doubles
+	void array3Sort( double* rsi, size_t length, bool parallel = false );
+	// Sort 2D vectors, the array has length * 2 doubles
+	void array2Sort( double* rsi, size_t length, bool parallel = false );
+
+	// Compute the permutation which sorts the 4D vectors, i.e. indices of the source vectors in the sorted order
+	void arraySortIndices( const double* rsi, size_t length, uint32_t* indices, bool parallel = false );
+	// Compute the permutation which sorts the 3D vectors
+	void array3SortIndices( const double* rsi, size_t length, uint32_t* indices, bool parallel = false );
+	// Compute the permutation which sorts the 2D vectors
+	void array2SortIndices( const double* rsi, size_t length, uint32_t* indices, bool parallel = false );
+}
\ No newline at end of file
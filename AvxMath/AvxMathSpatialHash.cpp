@@ -0,0 +1,177 @@
+#include "AvxMath.h"
+#include <algorithm>
+#include <cmath>
+
+namespace AvxMath
+{
+	SpatialHashGrid::SpatialHashGrid( double cellSize, size_t capacity ) :
+		m_cells( capacity ),
+		m_invCellSize( 1.0 / cellSize )
+	{
+		m_heads.reserve( capacity );
+		m_next.reserve( capacity );
+		m_points.reserve( capacity );
+	}
+
+	void SpatialHashGrid::clear()
+	{
+		m_cells.clear();
+		m_heads.clear();
+		m_next.clear();
+		m_points.clear();
+	}
+
+	void SpatialHashGrid::link( uint32_t point, uint32_t cell )
+	{
+		if( cell == m_heads.size() )
+			m_heads.push_back( UINT32_MAX );
+		m_next.push_back( m_heads[ cell ] );
+		m_heads[ cell ] = point;
+	}
+
+	uint32_t SpatialHashGrid::insert( __m256d pos )
+	{
+		pos = _mm256_blend_pd( pos, _mm256_setzero_pd(), 0b1000 );
+		const uint32_t cell = m_cells.insert( spatialCell( pos, _mm256_set1_pd( m_invCellSize ) ) );
+
+		const uint32_t idx = (uint32_t)m_points.size();
+		m_points.emplace_back();
+		_mm256_store_pd( &m_points.back().x, pos );
+		link( idx, cell );
+		return idx;
+	}
+
+	void SpatialHashGrid::insert( const double* xyz, size_t length )
+	{
+		constexpr size_t blockSize = 16;
+		double cells[ blockSize * 3 ];
+		uint32_t cellIndices[ blockSize ];
+		const __m256d inv = _mm256_set1_pd( m_invCellSize );
+
+		m_points.reserve( m_points.size() + length );
+		m_next.reserve( m_next.size() + length );
+
+		for( size_t i = 0; i < length; i += blockSize )
+		{
+			// Quantize a block of points, then use the batch insert of the hash set to find or create their cells
+			const size_t count = std::min( length - i, blockSize );
+			for( size_t j = 0; j < count; j++ )
+				storeDouble3( &cells[ j * 3 ], spatialCell( loadDouble3( xyz + ( i + j ) * 3 ), inv ) );
+			m_cells.insert( cells, count, cellIndices );
+
+			for( size_t j = 0; j < count; j++ )
+			{
+				const uint32_t idx = (uint32_t)m_points.size();
+				m_points.emplace_back();
+				_mm256_store_pd( &m_points.back().x, loadDouble3( xyz + ( i + j ) * 3 ) );
+				link( idx, cellIndices[ j ] );
+			}
+		}
+	}
+
+	template<class Fn>
+	void SpatialHashGrid::forEachInRadius( __m256d center, double radius, Fn&& fn ) const
+	{
+		if( m_points.empty() || !( radius >= 0 ) )
+			return;
+		center = _mm256_blend_pd( center, _mm256_setzero_pd(), 0b1000 );
+		const double radiusSq = radius * radius;
+
+		const auto testPoint = [ & ]( uint32_t i )
+		{
+			const __m256d d = _mm256_sub_pd( point( i ), center );
+			const double distSq = _mm_cvtsd_f64( vector3Dot2( d, d ) );
+			if( distSq <= radiusSq )
+				fn( i, distSq );
+		};
+
+		// Compute range of the cells which intersect the bounding box of the sphere.
+		// The box is slightly expanded, to compensate for the rounding of center +- radius.
+		const __m256d r = _mm256_set1_pd( radius );
+		__m256d box = _mm256_add_pd( vectorAbs( center ), r );
+		box = vectorMultiplyAdd( box, _mm256_set1_pd( 0x1p-50 ), r );
+		const __m256d inv = _mm256_set1_pd( m_invCellSize );
+		const __m256d loCell = spatialCell( _mm256_sub_pd( center, box ), inv );
+		const __m256d hiCell = spatialCell( _mm256_add_pd( center, box ), inv );
+
+		// Above 2^52 the cell coordinates are no longer consecutive integers; infinite radius or position makes infinitely many cells, NAN makes none.
+		// In these cases, and when the box has more cells than the grid has points, test every point instead of the cells.
+		const __m256d maxCell = _mm256_max_pd( vectorAbs( loCell ), vectorAbs( hiCell ) );
+		const bool inRange = 0 == _mm256_movemask_pd( _mm256_cmp_pd( maxCell, _mm256_set1_pd( 0x1p52 ), _CMP_NLE_UQ ) );
+		alignas( 32 ) double lo[ 4 ], hi[ 4 ];
+		_mm256_store_pd( lo, loCell );
+		_mm256_store_pd( hi, hiCell );
+		if( !inRange || ( hi[ 0 ] - lo[ 0 ] + 1 ) * ( hi[ 1 ] - lo[ 1 ] + 1 ) * ( hi[ 2 ] - lo[ 2 ] + 1 ) > (double)m_points.size() )
+		{
+			for( uint32_t i = 0; i < (uint32_t)m_points.size(); i++ )
+				testPoint( i );
+			return;
+		}
+
+		// Within 2^52 the integers are exact in both FP64 and int64_t
+		const int64_t x0 = (int64_t)lo[ 0 ], x1 = (int64_t)hi[ 0 ];
+		const int64_t y0 = (int64_t)lo[ 1 ], y1 = (int64_t)hi[ 1 ];
+		const int64_t z0 = (int64_t)lo[ 2 ], z1 = (int64_t)hi[ 2 ];
+		for( int64_t z = z0; z <= z1; z++ )
+			for( int64_t y = y0; y <= y1; y++ )
+				for( int64_t x = x0; x <= x1; x++ )
+				{
+					const uint32_t cell = m_cells.find( _mm256_setr_pd( (double)x, (double)y, (double)z, 0 ) );
+					if( cell == UINT32_MAX )
+						continue;
+					for( uint32_t i = m_heads[ cell ]; i != UINT32_MAX; i = m_next[ i ] )
+						testPoint( i );
+				}
+	}
+
+	size_t SpatialHashGrid::queryRadius( __m256d center, double radius, std::vector<uint32_t>& result ) const
+	{
+		const size_t count = result.size();
+		forEachInRadius( center, radius, [ &result ]( uint32_t i, double ) { result.push_back( i ); } );
+		return result.size() - count;
+	}
+
+	uint32_t SpatialHashGrid::findNearest( __m256d pos, double radius ) const
+	{
+		uint32_t nearest = UINT32_MAX;
+		double nearestSq = std::numeric_limits<double>::infinity();
+		forEachInRadius( pos, radius, [ & ]( uint32_t i, double distSq )
+		{
+			// On ties, prefer the smaller index to make the output independent of the order of the linked lists
+			if( distSq < nearestSq || ( distSq == nearestSq && i < nearest ) )
+			{
+				nearestSq = distSq;
+				nearest = i;
+			}
+		} );
+		return nearest;
+	}
+
+	size_t mergeVertices( const double* xyz, size_t length, double epsilon, double* uniqueXyz, uint32_t* indices )
+	{
+		if( !( epsilon > 0 ) )
+			return weldVertices( xyz, length, uniqueXyz, indices );
+
+		// With cells 8x larger than epsilon, the queries visit 1.4 cells on average. With smaller cells, they visit 8 cells, much slower.
+		// When epsilon is tiny compared to the coordinates, the cells are enlarged to keep the cell coordinates well below 2^52, otherwise every query would test all points.
+		double maxAbs = 0;
+		for( size_t i = 0; i < length * 3; i++ )
+			if( std::isfinite( xyz[ i ] ) )
+				maxAbs = std::max( maxAbs, std::abs( xyz[ i ] ) );
+		SpatialHashGrid grid{ std::max( epsilon * 8, maxAbs * 0x1p-44 ), length / 4 };
+		for( size_t i = 0; i < length; i++ )
+		{
+			const __m256d pos = loadDouble3( xyz + i * 3 );
+			uint32_t idx = grid.findNearest( pos, epsilon );
+			if( idx == UINT32_MAX )
+				idx = grid.insert( pos );
+			indices[ i ] = idx;
+		}
+
+		// Every unique vertex was loaded before it's stored, the output may be the same array as the input
+		const size_t count = grid.size();
+		for( size_t i = 0; i < count; i++ )
+			storeDouble3( uniqueXyz + i * 3, grid.point( (uint32_t)i ) );
+		return count;
+	}
+}
\ No newline at end of file
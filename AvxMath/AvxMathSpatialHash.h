@@ -0,0 +1,78 @@
+// Uniform grid of points stored in a hash table of cells, for the proximity queries, and merging of near-duplicate vertices
+#pragma once
+#include <vector>
+
+namespace AvxMath
+{
+	// Quantize 3D positions into coordinates of the grid cells, W lane of the result is 0.0.
+	// The cells are centered at integer multiples of the cell size, i.e. the cell [ 0, 0, 0 ] spans [ -size/2 .. +size/2 ] interval on each axis.
+	// The coordinates are integral FP64 values, and can be used as keys of Vector3HashSet.
+	// Above 2^52 the FP64 values are no longer consecutive integers, the cells become larger than the cell size.
+	inline __m256d spatialCell( __m256d pos, __m256d invCellSize )
+	{
+		__m256d v = _mm256_mul_pd( pos, invCellSize );
+		v = _mm256_round_pd( v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC );
+		return _mm256_blend_pd( v, _mm256_setzero_pd(), 0b1000 );
+	}
+
+	// Spatial hash grid of 3D points. Each non-empty cell has a linked list of the points in that cell.
+	// The points get sequential indices in the order of insertion.
+	class SpatialHashGrid
+	{
+	public:
+		// Create an empty grid. For the best performance, the cells should be several times larger than the typical query radius,
+		// so most queries only visit 1 cell, yet small enough to keep few points per cell.
+		SpatialHashGrid( double cellSize, size_t capacity = 0 );
+
+		// Count of points in the grid
+		size_t size() const { return m_points.size(); }
+
+		// Get position of the point by index, W lane of the result is 0.0
+		__m256d point( uint32_t index ) const { return _mm256_load_pd( &m_points[ index ].x ); }
+
+		// Insert a point, return its index
+		uint32_t insert( __m256d pos );
+
+		// Insert 3D points from the array of length * 3 doubles
+		void insert( const double* xyz, size_t length );
+
+		// Append indices of all points within the radius from the center, i.e. distance <= radius, to the vector.
+		// The order of the results is unspecified. Returns count of the points found.
+		// The queries visit all cells which intersect bounding box of the sphere, large radius compared to the cell size is slow.
+		// When the box has more cells than the grid has points, or the cell coordinates exceed 2^52, the query tests every point instead.
+		// Negative or NAN radius finds nothing, infinite radius finds all points except the NAN ones.
+		size_t queryRadius( __m256d center, double radius, std::vector<uint32_t>& result ) const;
+
+		// Find the point closest to the position, within the radius. Returns UINT32_MAX if there're no points within the radius.
+		uint32_t findNearest( __m256d pos, double radius ) const;
+
+		// Remove all points, keep the memory
+		void clear();
+
+	private:
+		struct alignas( 32 ) Point
+		{
+			double x, y, z, w;
+		};
+
+		Vector3HashSet m_cells;
+		// For each cell, index of the last point inserted into that cell
+		std::vector<uint32_t> m_heads;
+		// For each point, index of the previous point in the same cell, or UINT32_MAX
+		std::vector<uint32_t> m_next;
+		std::vector<Point> m_points;
+		double m_invCellSize;
+
+		// Call fn( index, distanceSquared ) for every point within the radius
+		template<class Fn>
+		void forEachInRadius( __m256d center, double radius, Fn&& fn ) const;
+		void link( uint32_t point, uint32_t cell );
+	};
+
+	// Merge the vertices closer than epsilon to each other, the input array has length * 3 doubles.
+	// Each vertex is merged into the closest of the previous unique vertices within epsilon, or becomes a new unique vertex if there're none.
+	// When epsilon is tiny compared to the coordinates, the grid uses cells larger than 8 * epsilon to keep the cell coordinates within range.
+	// Writes the unique vertices in the order of their first occurrence, and indices into that array for every input vertex.
+	// The output vertices may be the same array as the input. Returns count of the unique vertices.
+	size_t mergeVertices( const double* xyz, size_t length, double epsilon, double* uniqueXyz, uint32_t* indices );
+}
\ No newline at end of file
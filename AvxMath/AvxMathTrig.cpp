@@ -1,5 +1,5 @@
 ﻿#include "AvxMath.h"
-#include <array>
+#include "AvxMathParallel.h"
 
 namespace AvxMath
 {
@@ -41,8 +41,27 @@ namespace AvxMath
 	}
 	g_piConstants;
 
+	// Above that magnitude, about 1.6E+6, the range reduction of the angles loses precision: n * part of pi/2 is no longer exact in the precise tier
+	constexpr double g_reductionLimit = 0x1p19 * g_pi;
+
+	// Count the angles outside of the range, including infinities and NaN
+	inline void countAngles( __m256d a )
+	{
+		if constexpr( countersEnabled )
+			countLanes( eCounter::AngleOutOfRange, _mm256_cmp_pd( vectorAbs( a ), _mm256_set1_pd( g_reductionLimit ), _CMP_NLE_UQ ) );
+	}
+	inline void countAngles( double a )
+	{
+		if constexpr( countersEnabled )
+		{
+			if( !( a <= g_reductionLimit && a >= -g_reductionLimit ) )
+				countEvent( eCounter::AngleOutOfRange );
+		}
+	}
+
 	inline __m256d vectorModAngles( __m256d a )
 	{
+		countAngles( a );
 		const __m256d inv2pi = broadcast( g_piConstants.inv2pi );
 		__m256d v = _mm256_mul_pd( a, inv2pi );
 		v = _mm256_round_pd( v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC );
@@ -55,67 +74,167 @@ namespace AvxMath
 
 	inline double scalarModAngles( double a )
 	{
+		countAngles( a );
 		double v = a * g_piConstants.inv2pi;
 		v = round( v );
 		v *= g_piConstants.twoPi;
 		return a - v;
 	}
 
-	// Interleaved magic numbers for cosine and sine polynomial approximations.
-	// See GTE_C_COS_DEG10_C[1-5] and GTE_C_SIN_DEG11_C[1-5] macros in that header https://www.geometrictools.com/GTE/Mathematics/Math.h
-	// The X lanes of these vectors correspond to cosine, Y lanes to sine.
-	// This way scalarSinCos function can use memory operands for optimal performance.
-	// The rest of the functions which use these numbers are loading scalars, RAM layout doesn't matter much.
-	static const std::array<__m128d, 5> g_cosSinCoefficients
-	{
-		_mm_setr_pd( -4.9999999508695869e-01,  -1.6666666601721269e-01 ),
-		_mm_setr_pd( +4.1666638865338612e-02,  +8.3333303183525942e-03 ),
-		_mm_setr_pd( -1.3888377661039897e-03,  -1.9840782426250314e-04 ),
-		_mm_setr_pd( +2.4760495088926859e-05,  +2.7521557770526783e-06 ),
-		_mm_setr_pd( -2.6051615464872668e-07,  -2.3828544692960918e-08 ),
-	};
+	// Magic numbers for Cody-Waite range reduction used by the precise tier.
+	// Each of the first two parts of pi/2 has 33 significant bits, n * part is exact for |n| < 2^20.
+	alignas( 32 ) static const struct
+	{
+		const double twoOverPi = 2.0 / g_pi;
+		const double negHalfPi = -g_pi / 2;
+		const double negHalfPi1 = -1.57079632673412561e+00;
+		const double negHalfPi2 = -6.07710050630396598e-11;
+		const double negHalfPi3 = -2.02226624879595063e-21;
+		// 1.5 * 2^52 plus 0, 1 and 2; adding that to an integer below 2^50 puts the integer into the low bits of the mantissa
+		const double bitsMagic[ 3 ] = { 6755399441055744.0, 6755399441055745.0, 6755399441055746.0 };
+		const double two = 2;
+		alignas( 16 ) const double signPair[ 2 ] = { 0.0, -0.0 };
+	}
+	g_reduction;
 
-	void _AM_CALL_ vectorSinCos( __m256d& sin, __m256d& cos, __m256d x )
+	// Map the angles into [ -pi/2, +pi/2 ] interval for the fast and default tiers, outputs the sign bits to apply to the cosine
+	inline __m256d reduceAngles( __m256d x, __m256d& sign )
 	{
 		// Force the value within the bounds of pi
 		x = vectorModAngles( x );
 
-		const __m256d one = broadcast( g_misc.one );
 		const __m256d neg0 = broadcast( g_misc.negativeZero );
 
 		// Map in [-pi/2,pi/2] with sin(y) = sin(x), cos(y) = sign*cos(x).
-		__m256d sign = _mm256_and_pd( x, neg0 );
-		__m256d c = _mm256_or_pd( broadcast( g_piConstants.pi ), sign );  // pi when x >= 0, -pi when x < 0
-		__m256d absx = _mm256_andnot_pd( sign, x );  // |x|
+		__m256d s = _mm256_and_pd( x, neg0 );
+		__m256d c = _mm256_or_pd( broadcast( g_piConstants.pi ), s );  // pi when x >= 0, -pi when x < 0
+		__m256d absx = _mm256_andnot_pd( s, x );  // |x|
 		__m256d rflx = _mm256_sub_pd( c, x );
 		__m256d comp = _mm256_cmp_pd( absx, broadcast( g_piConstants.halfPi ), _CMP_LE_OQ );
-		x = _mm256_blendv_pd( rflx, x, comp );
 		sign = _mm256_andnot_pd( comp, neg0 );
+		return _mm256_blendv_pd( rflx, x, comp );
+	}
+
+	// Map the angles into [ -pi/4, +pi/4 ] interval for the precise tier, x = r + n * pi/2.
+	// Unlike the reflection into [ -pi/2, +pi/2 ], this keeps small relative errors near the zeros of cosine, where the result is the sine of a small angle.
+	inline __m256d reduceQuadrants( __m256d x, __m256d& n )
+	{
+		countAngles( x );
+		n = _mm256_mul_pd( x, broadcast( g_reduction.twoOverPi ) );
+		n = _mm256_round_pd( n, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC );
+		x = vectorMultiplyAdd( n, broadcast( g_reduction.negHalfPi1 ), x );
+		x = vectorMultiplyAdd( n, broadcast( g_reduction.negHalfPi2 ), x );
+		return vectorMultiplyAdd( n, broadcast( g_reduction.negHalfPi3 ), x );
+	}
+
+	// Given sine and cosine of the reduced angles, compute them for the original ones.
+	// Odd quadrants swap sine and cosine; sine is negative when n mod 4 is 2 or 3, cosine when n mod 4 is 1 or 2.
+	// The quadrant bits are moved into bit 1 with the magic numbers, then permutevar_pd makes the sign bits.
+	inline void applyQuadrants( __m256d& sin, __m256d& cos, __m256d n )
+	{
+		const __m256d signPair = _mm256_broadcast_pd( (const __m128d*)g_reduction.signPair );
+		const __m256d odd = _mm256_permutevar_pd( signPair, _mm256_castpd_si256( vectorMultiplyAdd( n, broadcast( g_reduction.two ), broadcast( g_reduction.bitsMagic[ 0 ] ) ) ) );
+		const __m256d signSin = _mm256_permutevar_pd( signPair, _mm256_castpd_si256( _mm256_add_pd( n, broadcast( g_reduction.bitsMagic[ 0 ] ) ) ) );
+		const __m256d signCos = _mm256_permutevar_pd( signPair, _mm256_castpd_si256( _mm256_add_pd( n, broadcast( g_reduction.bitsMagic[ 1 ] ) ) ) );
+		// blendv only tests the sign bits of the mask
+		const __m256d s = _mm256_blendv_pd( sin, cos, odd );
+		const __m256d c = _mm256_blendv_pd( cos, sin, odd );
+		sin = _mm256_xor_pd( s, signSin );
+		cos = _mm256_xor_pd( c, signCos );
+	}
+
+	// Minimax polynomial approximations of cosine and sine, one structure per accuracy tier.
+	// The magic numbers are interleaved, even elements are for cosine, odd elements for sine, starting from x^2 terms.
+	// This way scalarSinCos function and the vectorSinCos can use 16-byte loads for them.
+	template<eTrigPrecision precision>
+	struct SinCosCoefficients;
+
+	// Computed with Remez algorithm on [ 0, pi/2 ]; relative error for sine, absolute for cosine
+	template<>
+	struct SinCosCoefficients<eTrigPrecision::Fast>
+	{
+		static constexpr size_t count = 3;
+		alignas( 16 ) static constexpr double values[ count * 2 ] =
+		{
+			-4.99935630733041703e-01, -1.66658532530665426e-01,
+			+4.15070668522044689e-02, +8.31427474647302919e-03,
+			-1.27575198499514111e-03, -1.85422229309988533e-04,
+		};
+	};
+
+	// See GTE_C_COS_DEG10_C[1-5] and GTE_C_SIN_DEG11_C[1-5] macros in that header https://www.geometrictools.com/GTE/Mathematics/Math.h
+	template<>
+	struct SinCosCoefficients<eTrigPrecision::Default>
+	{
+		static constexpr size_t count = 5;
+		alignas( 16 ) static constexpr double values[ count * 2 ] =
+		{
+			-4.9999999508695869e-01, -1.6666666601721269e-01,
+			+4.1666638865338612e-02, +8.3333303183525942e-03,
+			-1.3888377661039897e-03, -1.9840782426250314e-04,
+			+2.4760495088926859e-05, +2.7521557770526783e-06,
+			-2.6051615464872668e-07, -2.3828544692960918e-08,
+		};
+	};
+
+	// Computed with Remez algorithm on [ 0, pi/2 ]; relative error for sine, absolute for cosine
+	template<>
+	struct SinCosCoefficients<eTrigPrecision::Precise>
+	{
+		static constexpr size_t count = 8;
+		alignas( 16 ) static constexpr double values[ count * 2 ] =
+		{
+			-4.99999999999999833e-01, -1.66666666666666657e-01,
+			+4.16666666666643676e-02, +8.33333333333319444e-03,
+			-1.38888888887856517e-03, -1.98412698412092181e-04,
+			+2.48015872791490329e-05, +2.75573192111372879e-06,
+			-2.75573165252287140e-07, -2.50521068728032553e-08,
+			+2.08765677410708708e-09, +1.60589397059427776e-10,
+			-1.14630393705195544e-11, -7.64299149041800015e-13,
+			+4.61029417236881150e-14, +2.72117497347660417e-15,
+		};
+	};
+
+	// Evaluate the polynomial 1 + c[ 0 ] * x + c[ 1 ] * x^2 + ..., loading the coefficients from memory with the specified stride
+	template<size_t count, size_t stride>
+	inline __m256d polynomial( __m256d x, const double* c, __m256d one )
+	{
+		__m256d vec = vectorMultiplyAdd( x, broadcast( c[ ( count - 1 ) * stride ] ), broadcast( c[ ( count - 2 ) * stride ] ) );
+		for( size_t i = count - 2; i > 0; i-- )
+			vec = vectorMultiplyAdd( vec, x, broadcast( c[ ( i - 1 ) * stride ] ) );
+		return vectorMultiplyAdd( vec, x, one );
+	}
+
+	template<eTrigPrecision precision>
+	inline void sinCosKernel( __m256d& sin, __m256d& cos, __m256d x )
+	{
+		using Coefficients = SinCosCoefficients<precision>;
+		constexpr size_t count = Coefficients::count;
+		const __m128d* const coeffs = (const __m128d*)Coefficients::values;
+
+		// For the precise tier, sign is the quadrant number n
+		__m256d sign;
+		if constexpr( precision == eTrigPrecision::Precise )
+			x = reduceQuadrants( x, sign );
+		else
+			x = reduceAngles( x, sign );
 
+		const __m256d one = broadcast( g_misc.one );
 		const __m256d x2 = _mm256_mul_pd( x, x );
 
 		// Compute both polynomial approximations, using 16-byte broadcast loads for the magic numbers
 		const __m256d y1 = _mm256_unpacklo_pd( x2, x2 );	// x2.xxzz
 		const __m256d y2 = _mm256_unpackhi_pd( x2, x2 );	// x2.yyww
 
-		__m256d r1 = _mm256_broadcast_pd( &g_cosSinCoefficients[ 4 ] );
+		__m256d r1 = _mm256_broadcast_pd( &coeffs[ count - 1 ] );
 		__m256d r2 = r1;
 
-		__m256d tmp = _mm256_broadcast_pd( &g_cosSinCoefficients[ 3 ] );
-		r1 = vectorMultiplyAdd( r1, y1, tmp );
-		r2 = vectorMultiplyAdd( r2, y2, tmp );
-
-		tmp = _mm256_broadcast_pd( &g_cosSinCoefficients[ 2 ] );
-		r1 = vectorMultiplyAdd( r1, y1, tmp );
-		r2 = vectorMultiplyAdd( r2, y2, tmp );
-
-		tmp = _mm256_broadcast_pd( &g_cosSinCoefficients[ 1 ] );
-		r1 = vectorMultiplyAdd( r1, y1, tmp );
-		r2 = vectorMultiplyAdd( r2, y2, tmp );
-
-		tmp = _mm256_broadcast_pd( &g_cosSinCoefficients[ 0 ] );
-		r1 = vectorMultiplyAdd( r1, y1, tmp );
-		r2 = vectorMultiplyAdd( r2, y2, tmp );
+		for( size_t i = count - 1; i > 0; i-- )
+		{
+			const __m256d tmp = _mm256_broadcast_pd( &coeffs[ i - 1 ] );
+			r1 = vectorMultiplyAdd( r1, y1, tmp );
+			r2 = vectorMultiplyAdd( r2, y2, tmp );
+		}
 
 		r1 = vectorMultiplyAdd( r1, y1, one );
 		r2 = vectorMultiplyAdd( r2, y2, one );
@@ -124,69 +243,118 @@ namespace AvxMath
 		__m256d rc = _mm256_unpacklo_pd( r1, r2 );
 
 		sin = _mm256_mul_pd( rs, x );
-		cos = _mm256_or_pd( rc, sign );
+		if constexpr( precision == eTrigPrecision::Precise )
+		{
+			cos = rc;
+			applyQuadrants( sin, cos, sign );
+		}
+		else
+			cos = _mm256_xor_pd( rc, sign );
 	}
 
-	__m256d vectorSin( __m256d x )
+	// Sine or cosine for the precise tier. In the odd quadrants the other polynomial is needed, the lanes select between the interleaved magic numbers.
+	// The selection uses permutevar_pd which only tests bit 1 of the control, the quadrant bits are moved there with the magic numbers.
+	template<bool cosine>
+	inline __m256d sinOrCosPrecise( __m256d x )
 	{
-		// Force the value within the bounds of pi
-		x = vectorModAngles( x );
+		using Coefficients = SinCosCoefficients<eTrigPrecision::Precise>;
+		constexpr size_t count = Coefficients::count;
+		const __m128d* const coeffs = (const __m128d*)Coefficients::values;
+
+		__m256d n;
+		x = reduceQuadrants( x, n );
+
+		// Bit 1 of 2n + 2 is set for even n, when computing sine with the sine polynomial; bit 1 of 2n is set for odd n, when computing cosine with it
+		const __m256d two = broadcast( g_reduction.two );
+		const __m256i useSin = _mm256_castpd_si256( vectorMultiplyAdd( n, two, broadcast( g_reduction.bitsMagic[ cosine ? 0 : 2 ] ) ) );
+		// Bit 1 of n is set when sine is negative, bit 1 of n + 1 when cosine is
+		const __m256i negative = _mm256_castpd_si256( _mm256_add_pd( n, broadcast( g_reduction.bitsMagic[ cosine ? 1 : 0 ] ) ) );
+
+		const __m256d signPair = _mm256_broadcast_pd( (const __m128d*)g_reduction.signPair );
+		const __m256d sign = _mm256_permutevar_pd( signPair, negative );
 
 		const __m256d one = broadcast( g_misc.one );
-		const __m256d neg0 = broadcast( g_misc.negativeZero );
+		const __m256d x2 = _mm256_mul_pd( x, x );
 
-		// Map in [-pi/2,pi/2] with sin(y) = sin(x), cos(y) = sign*cos(x).
-		__m256d sign = _mm256_and_pd( x, neg0 );
-		__m256d c = _mm256_or_pd( broadcast( g_piConstants.pi ), sign );  // pi when x >= 0, -pi when x < 0
-		__m256d absx = _mm256_andnot_pd( sign, x );  // |x|
-		__m256d rflx = _mm256_sub_pd( c, x );
-		__m256d comp = _mm256_cmp_pd( absx, broadcast( g_piConstants.halfPi ), _CMP_LE_OQ );
-		x = _mm256_blendv_pd( rflx, x, comp );
+		// Even elements of the pairs are for cosine, odd elements for sine
+		__m256d r = _mm256_permutevar_pd( _mm256_broadcast_pd( &coeffs[ count - 1 ] ), useSin );
+		for( size_t i = count - 1; i > 0; i-- )
+			r = vectorMultiplyAdd( r, x2, _mm256_permutevar_pd( _mm256_broadcast_pd( &coeffs[ i - 1 ] ), useSin ) );
+		r = vectorMultiplyAdd( r, x2, one );
+
+		// The sine polynomial is multiplied by x
+		r = _mm256_mul_pd( r, _mm256_blendv_pd( one, x, _mm256_permutevar_pd( signPair, useSin ) ) );
+		return _mm256_xor_pd( r, sign );
+	}
+
+	template<eTrigPrecision precision>
+	inline __m256d sinKernel( __m256d x )
+	{
+		using Coefficients = SinCosCoefficients<precision>;
+
+		if constexpr( precision == eTrigPrecision::Precise )
+			return sinOrCosPrecise<false>( x );
+
+		__m256d sign;
+		x = reduceAngles( x, sign );
 
+		const __m256d one = broadcast( g_misc.one );
 		const __m256d x2 = _mm256_mul_pd( x, x );
 
-		const double* const coeffs = (const double*)g_cosSinCoefficients.data();
 		// Compute polynomial approximation of sine
-		__m256d vec = vectorMultiplyAdd( x2, broadcast( coeffs[ 9 ] ), broadcast( coeffs[ 7 ] ) );
-		vec = vectorMultiplyAdd( vec, x2, broadcast( coeffs[ 5 ] ) );
-		vec = vectorMultiplyAdd( vec, x2, broadcast( coeffs[ 3 ] ) );
-		vec = vectorMultiplyAdd( vec, x2, broadcast( coeffs[ 1 ] ) );
-		vec = vectorMultiplyAdd( vec, x2, one );
-		vec = _mm256_mul_pd( vec, x );
-		return vec;
+		__m256d vec = polynomial<Coefficients::count, 2>( x2, &Coefficients::values[ 1 ], one );
+		return _mm256_mul_pd( vec, x );
 	}
 
-	__m256d vectorCos( __m256d x )
+	template<eTrigPrecision precision>
+	inline __m256d cosKernel( __m256d x )
 	{
-		// Force the value within the bounds of pi
-		x = vectorModAngles( x );
+		using Coefficients = SinCosCoefficients<precision>;
 
-		const __m256d one = broadcast( g_misc.one );
-		const __m256d neg0 = broadcast( g_misc.negativeZero );
+		if constexpr( precision == eTrigPrecision::Precise )
+			return sinOrCosPrecise<true>( x );
 
-		// Map in [-pi/2,pi/2] with sin(y) = sin(x), cos(y) = sign*cos(x).
-		__m256d sign = _mm256_and_pd( x, neg0 );
-		__m256d c = _mm256_or_pd( broadcast( g_piConstants.pi ), sign );  // pi when x >= 0, -pi when x < 0
-		__m256d absx = _mm256_andnot_pd( sign, x );  // |x|
-		__m256d rflx = _mm256_sub_pd( c, x );
-		__m256d comp = _mm256_cmp_pd( absx, broadcast( g_piConstants.halfPi ), _CMP_LE_OQ );
-		x = _mm256_blendv_pd( rflx, x, comp );
-		sign = _mm256_andnot_pd( comp, neg0 );
+		__m256d sign;
+		x = reduceAngles( x, sign );
 
+		const __m256d one = broadcast( g_misc.one );
 		const __m256d x2 = _mm256_mul_pd( x, x );
 
-		const double* const coeffs = (const double*)g_cosSinCoefficients.data();
-
 		// Compute polynomial approximation of cosine
-		__m256d vec = vectorMultiplyAdd( x2, broadcast( coeffs[ 8 ] ), broadcast( coeffs[ 6 ] ) );
-		vec = vectorMultiplyAdd( vec, x2, broadcast( coeffs[ 4 ] ) );
-		vec = vectorMultiplyAdd( vec, x2, broadcast( coeffs[ 2 ] ) );
-		vec = vectorMultiplyAdd( vec, x2, broadcast( coeffs[ 0 ] ) );
-		vec = vectorMultiplyAdd( vec, x2, one );
-		vec = _mm256_or_pd( vec, sign );
-		return vec;
+		__m256d vec = polynomial<Coefficients::count, 2>( x2, &Coefficients::values[ 0 ], one );
+		return _mm256_xor_pd( vec, sign );
+	}
+
+	template<eTrigPrecision precision>
+	void _AM_CALL_ vectorSinCos( __m256d& sin, __m256d& cos, __m256d angles )
+	{
+		sinCosKernel<precision>( sin, cos, angles );
 	}
 
+	template<eTrigPrecision precision>
+	__m256d vectorSin( __m256d angles )
+	{
+		return sinKernel<precision>( angles );
+	}
+
+	template<eTrigPrecision precision>
+	__m256d vectorCos( __m256d angles )
+	{
+		return cosKernel<precision>( angles );
+	}
+
+	template void _AM_CALL_ vectorSinCos<eTrigPrecision::Fast>( __m256d& sin, __m256d& cos, __m256d angles );
+	template void _AM_CALL_ vectorSinCos<eTrigPrecision::Default>( __m256d& sin, __m256d& cos, __m256d angles );
+	template void _AM_CALL_ vectorSinCos<eTrigPrecision::Precise>( __m256d& sin, __m256d& cos, __m256d angles );
+	template __m256d vectorSin<eTrigPrecision::Fast>( __m256d angles );
+	template __m256d vectorSin<eTrigPrecision::Default>( __m256d angles );
+	template __m256d vectorSin<eTrigPrecision::Precise>( __m256d angles );
+	template __m256d vectorCos<eTrigPrecision::Fast>( __m256d angles );
+	template __m256d vectorCos<eTrigPrecision::Default>( __m256d angles );
+	template __m256d vectorCos<eTrigPrecision::Precise>( __m256d angles );
+
+	using DefaultSinCos = SinCosCoefficients<eTrigPrecision::Default>;
+
 	__m128d scalarSinCos( double a )
 	{
 		a = scalarModAngles( a );
@@ -205,7 +373,7 @@ namespace AvxMath
 		sign = _mm_andnot_pd( comp, neg0 );
 
 		const __m128d x2 = _mm_mul_pd( x, x );
-		const __m128d* const coeffs = g_cosSinCoefficients.data();
+		const __m128d* const coeffs = (const __m128d*)DefaultSinCos::values;
 
 		// Compute both polynomials using 2 lanes of the SSE vector
 		__m128d vec = vectorMultiplyAdd( x2, coeffs[ 4 ], coeffs[ 3 ] );
@@ -239,7 +407,7 @@ namespace AvxMath
 		double x2 = _mm_cvtsd_f64( x );
 		x2 *= x2;
 
-		const double* const coeffs = (const double*)g_cosSinCoefficients.data();
+		const double* const coeffs = DefaultSinCos::values;
 
 		// Compute polynomial approximation of sine
 		double res = x2 * coeffs[ 9 ];
@@ -280,7 +448,7 @@ namespace AvxMath
 		double x2 = _mm_cvtsd_f64( x );
 		x2 *= x2;
 
-		const double* const coeffs = (const double*)g_cosSinCoefficients.data();
+		const double* const coeffs = DefaultSinCos::values;
 
 		// Compute polynomial approximation of cosine
 		double res = x2 * coeffs[ 8 ];
@@ -318,10 +486,12 @@ namespace AvxMath
 	}
 	g_TanConstants;
 
-	__m256d _AM_CALL_ vectorTan( __m256d a )
+	// Padé approximation for the default tier, the input is in units of pi
+	inline __m256d tanDefault( __m256d a )
 	{
 		// Wrap into [ -pi/2 .. +pi/2 ] interval.
 		// Don't multiply back, we include that multiplier into these Padé magic numbers.
+		countAngles( a );
 		a = _mm256_mul_pd( a, broadcast( g_TanConstants.invPi ) );
 		__m256d tmp = _mm256_round_pd( a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC );
 		a = _mm256_sub_pd( a, tmp );
@@ -341,9 +511,97 @@ namespace AvxMath
 		return _mm256_div_pd( mul, div );
 	}
 
+	// Padé approximations for the fast and precise tiers are convergents of Lambert's continued fraction of tangent.
+	// The input is reduced into [ -pi/4, +pi/4 ] interval, i.e. far from the poles where the approximation is least accurate.
+	// Both polynomials are in x^2, starting from the x^2 terms; the leading 1.0 is implied.
+	template<eTrigPrecision precision>
+	struct TanCoefficients;
+
+	// [ 5 / 4 ] approximation
+	template<>
+	struct TanCoefficients<eTrigPrecision::Fast>
+	{
+		static constexpr size_t count = 3;
+		static constexpr double numerator[ count - 1 ] = { -1.11111111111111105e-01, +1.05820105820105827e-03 };
+		static constexpr double denominator[ count - 1 ] = { -4.44444444444444420e-01, +1.58730158730158721e-02 };
+	};
+
+	// [ 9 / 8 ] approximation
+	template<>
+	struct TanCoefficients<eTrigPrecision::Precise>
+	{
+		static constexpr size_t count = 5;
+		static constexpr double numerator[ count - 1 ] =
+		{
+			-1.37254901960784326e-01, +3.92156862745098034e-03, -2.87294404941463761e-05, +2.90196368627741191e-08
+		};
+		static constexpr double denominator[ count - 1 ] =
+		{
+			-4.70588235294117641e-01, +2.74509803921568624e-02, -4.02212166918049252e-04, +1.30588365882483526e-06
+		};
+	};
+
+	// Tangent or cotangent for the fast and precise tiers
+	template<eTrigPrecision precision, bool cotangent>
+	inline __m256d tanReduced( __m256d x )
+	{
+		using Coefficients = TanCoefficients<precision>;
+
+		// x = r + n * pi/2; tan( x ) = tan( r ) for even n, -1 / tan( r ) for odd n
+		countAngles( x );
+		__m256d n = _mm256_mul_pd( x, broadcast( g_reduction.twoOverPi ) );
+		n = _mm256_round_pd( n, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC );
+		if constexpr( precision == eTrigPrecision::Precise )
+		{
+			x = vectorMultiplyAdd( n, broadcast( g_reduction.negHalfPi1 ), x );
+			x = vectorMultiplyAdd( n, broadcast( g_reduction.negHalfPi2 ), x );
+			x = vectorMultiplyAdd( n, broadcast( g_reduction.negHalfPi3 ), x );
+		}
+		else
+			x = vectorMultiplyAdd( n, broadcast( g_reduction.negHalfPi ), x );
+
+		const __m256d one = broadcast( g_misc.one );
+		const __m256d x2 = _mm256_mul_pd( x, x );
+		__m256d num = polynomial<Coefficients::count - 1, 1>( x2, Coefficients::numerator, one );
+		__m256d den = polynomial<Coefficients::count - 1, 1>( x2, Coefficients::denominator, one );
+		num = _mm256_mul_pd( num, x );
+
+		// Swap numerator and denominator for odd n when computing tangent, for even n when computing cotangent
+		const __m256d half = _mm256_mul_pd( n, broadcast( g_misc.oneHalf ) );
+		const __m256d halfRounded = _mm256_round_pd( half, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC );
+		const __m256d odd = _mm256_cmp_pd( half, halfRounded, _CMP_NEQ_UQ );
+		const __m256d swap = cotangent ? _mm256_cmp_pd( half, halfRounded, _CMP_EQ_OQ ) : odd;
+
+		const __m256d a = _mm256_blendv_pd( num, den, swap );
+		const __m256d b = _mm256_blendv_pd( den, num, swap );
+		const __m256d res = _mm256_div_pd( a, b );
+		// In both cases, the result is negated for odd n
+		return _mm256_xor_pd( res, _mm256_and_pd( odd, broadcast( g_misc.negativeZero ) ) );
+	}
+
+	template<eTrigPrecision precision>
+	inline __m256d tanKernel( __m256d a )
+	{
+		if constexpr( precision == eTrigPrecision::Default )
+			return tanDefault( a );
+		else
+			return tanReduced<precision, false>( a );
+	}
+
+	template<eTrigPrecision precision>
+	__m256d _AM_CALL_ vectorTan( __m256d a )
+	{
+		return tanKernel<precision>( a );
+	}
+
+	template __m256d _AM_CALL_ vectorTan<eTrigPrecision::Fast>( __m256d a );
+	template __m256d _AM_CALL_ vectorTan<eTrigPrecision::Default>( __m256d a );
+	template __m256d _AM_CALL_ vectorTan<eTrigPrecision::Precise>( __m256d a );
+
 	double scalarTan( double a )
 	{
 		// Wrap into [ -pi/2 .. +pi/2 ] interval.
+		countAngles( a );
 		a *= g_TanConstants.invPi;
 		a -= round( a );
 
@@ -361,16 +619,159 @@ namespace AvxMath
 		return mul / div;
 	}
 
+	template<eTrigPrecision precision>
 	__m256d _AM_CALL_ vectorCot( __m256d a )
 	{
-		// cot( a ) = tan( Pi/2 - a )
-		// https://en.wikipedia.org/wiki/List_of_trigonometric_identities#Reflections
-		a = _mm256_sub_pd( broadcast( g_piConstants.halfPi ), a );
-		return vectorTan( a );
+		if constexpr( precision == eTrigPrecision::Default )
+		{
+			// cot( a ) = tan( Pi/2 - a )
+			// https://en.wikipedia.org/wiki/List_of_trigonometric_identities#Reflections
+			a = _mm256_sub_pd( broadcast( g_piConstants.halfPi ), a );
+			return tanDefault( a );
+		}
+		else
+			return tanReduced<precision, true>( a );
 	}
 
+	template __m256d _AM_CALL_ vectorCot<eTrigPrecision::Fast>( __m256d a );
+	template __m256d _AM_CALL_ vectorCot<eTrigPrecision::Default>( __m256d a );
+	template __m256d _AM_CALL_ vectorCot<eTrigPrecision::Precise>( __m256d a );
+
 	double scalarCot( double a )
 	{
 		return scalarTan( g_piConstants.halfPi - a );
 	}
+
+	// ==== Array versions ====
+
+	// Apply the kernel to the array. The loop handles 4 vectors per iteration, they are independent,
+	// the CPU interleaves the instructions of the 4 dependency chains to hide the latency of FMA.
+	template<class Kernel>
+	inline void mapSpan( const double* rsi, double* rdi, size_t length, Kernel kernel )
+	{
+		const double* const endUnrolled = rsi + ( length & ~(size_t)15 );
+		for( ; rsi < endUnrolled; rsi += 16, rdi += 16 )
+		{
+			const __m256d r0 = kernel( _mm256_loadu_pd( rsi ) );
+			const __m256d r1 = kernel( _mm256_loadu_pd( rsi + 4 ) );
+			const __m256d r2 = kernel( _mm256_loadu_pd( rsi + 8 ) );
+			const __m256d r3 = kernel( _mm256_loadu_pd( rsi + 12 ) );
+			_mm256_storeu_pd( rdi, r0 );
+			_mm256_storeu_pd( rdi + 4, r1 );
+			_mm256_storeu_pd( rdi + 8, r2 );
+			_mm256_storeu_pd( rdi + 12, r3 );
+		}
+
+		length %= 16;
+		const double* const endVectors = rsi + ( length & ~(size_t)3 );
+		for( ; rsi < endVectors; rsi += 4, rdi += 4 )
+			_mm256_storeu_pd( rdi, kernel( _mm256_loadu_pd( rsi ) ) );
+
+		length %= 4;
+		if( 0 != length )
+			storePartial( rdi, kernel( loadPartial( rsi, length ) ), length );
+	}
+
+	template<eTrigPrecision precision>
+	inline void sinCosSpan( const double* rsi, double* sin, double* cos, size_t length )
+	{
+		const double* const endUnrolled = rsi + ( length & ~(size_t)15 );
+		for( ; rsi < endUnrolled; rsi += 16, sin += 16, cos += 16 )
+		{
+			__m256d s0, s1, s2, s3, c0, c1, c2, c3;
+			sinCosKernel<precision>( s0, c0, _mm256_loadu_pd( rsi ) );
+			sinCosKernel<precision>( s1, c1, _mm256_loadu_pd( rsi + 4 ) );
+			sinCosKernel<precision>( s2, c2, _mm256_loadu_pd( rsi + 8 ) );
+			sinCosKernel<precision>( s3, c3, _mm256_loadu_pd( rsi + 12 ) );
+			_mm256_storeu_pd( sin, s0 );
+			_mm256_storeu_pd( sin + 4, s1 );
+			_mm256_storeu_pd( sin + 8, s2 );
+			_mm256_storeu_pd( sin + 12, s3 );
+			_mm256_storeu_pd( cos, c0 );
+			_mm256_storeu_pd( cos + 4, c1 );
+			_mm256_storeu_pd( cos + 8, c2 );
+			_mm256_storeu_pd( cos + 12, c3 );
+		}
+
+		length %= 16;
+		const double* const endVectors = rsi + ( length & ~(size_t)3 );
+		for( ; rsi < endVectors; rsi += 4, sin += 4, cos += 4 )
+		{
+			__m256d s, c;
+			sinCosKernel<precision>( s, c, _mm256_loadu_pd( rsi ) );
+			_mm256_storeu_pd( sin, s );
+			_mm256_storeu_pd( cos, c );
+		}
+
+		length %= 4;
+		if( 0 != length )
+		{
+			__m256d s, c;
+			sinCosKernel<precision>( s, c, loadPartial( rsi, length ) );
+			storePartial( sin, s, length );
+			storePartial( cos, c, length );
+		}
+	}
+
+	// When running multithreaded, each thread gets at least that many elements; for smaller arrays, waking up the pool threads and splitting the chunks into their slots costs more than it saves
+	constexpr size_t minParallelChunk = 1 << 16;
+
+	template<class Kernel>
+	inline void mapArray( const double* rsi, double* rdi, size_t length, bool parallel, Kernel kernel )
+	{
+		if( !parallel )
+		{
+			mapSpan( rsi, rdi, length, kernel );
+			return;
+		}
+		parallelFor( length, minParallelChunk, [ = ]( size_t begin, size_t end )
+		{
+			mapSpan( rsi + begin, rdi + begin, end - begin, kernel );
+		} );
+	}
+
+	template<eTrigPrecision precision>
+	void arraySinCos( const double* angles, double* sin, double* cos, size_t length, bool parallel )
+	{
+		if( !parallel )
+		{
+			sinCosSpan<precision>( angles, sin, cos, length );
+			return;
+		}
+		parallelFor( length, minParallelChunk, [ = ]( size_t begin, size_t end )
+		{
+			sinCosSpan<precision>( angles + begin, sin + begin, cos + begin, end - begin );
+		} );
+	}
+
+	template<eTrigPrecision precision>
+	void arraySin( const double* angles, double* result, size_t length, bool parallel )
+	{
+		mapArray( angles, result, length, parallel, []( __m256d a ) { return sinKernel<precision>( a ); } );
+	}
+
+	template<eTrigPrecision precision>
+	void arrayCos( const double* angles, double* result, size_t length, bool parallel )
+	{
+		mapArray( angles, result, length, parallel, []( __m256d a ) { return cosKernel<precision>( a ); } );
+	}
+
+	template<eTrigPrecision precision>
+	void arrayTan( const double* angles, double* result, size_t length, bool parallel )
+	{
+		mapArray( angles, result, length, parallel, []( __m256d a ) { return tanKernel<precision>( a ); } );
+	}
+
+	template void arraySinCos<eTrigPrecision::Fast>( const double* angles, double* sin, double* cos, size_t length, bool parallel );
+	template void arraySinCos<eTrigPrecision::Default>( const double* angles, double* sin, double* cos, size_t length, bool parallel );
+	template void arraySinCos<eTrigPrecision::Precise>( const double* angles, double* sin, double* cos, size_t length, bool parallel );
+	template void arraySin<eTrigPrecision::Fast>( const double* angles, double* result, size_t length, bool parallel );
+	template void arraySin<eTrigPrecision::Default>( const double* angles, double* result, size_t length, bool parallel );
+	template void arraySin<eTrigPrecision::Precise>( const double* angles, double* result, size_t length, bool parallel );
+	template void arrayCos<eTrigPrecision::Fast>( const double* angles, double* result, size_t length, bool parallel );
+	template void arrayCos<eTrigPrecision::Default>( const double* angles, double* result, size_t length, bool parallel );
+	template void arrayCos<eTrigPrecision::Precise>( const double* angles, double* result, size_t length, bool parallel );
+	template void arrayTan<eTrigPrecision::Fast>( const double* angles, double* result, size_t length, bool parallel );
+	template void arrayTan<eTrigPrecision::Default>( const double* angles, double* result, size_t length, bool parallel );
+	template void arrayTan<eTrigPrecision::Precise>( const double* angles, double* result, size_t length, bool parallel );
 }
\ No newline at end of file
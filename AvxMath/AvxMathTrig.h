@@ -17,16 +17,41 @@ namespace AvxMath
 	// Scale the angle from radians to degrees
 	double degrees( double rad );
 
-	// The sine/cosine are both using minimax polynomial approximations: 11-degree for sine, 10-degree for cosine.
-	// Absolute errors compared to the standard library of VC++ for sine / cosine are within 5.7E-11 / 3.1E-10 when using FMA3, i.e. pretty accurate despite way faster.
+	// Accuracy tiers of the vector trigonometric functions
+	enum struct eTrigPrecision : uint8_t
+	{
+		// Minimax polynomials of degree 7 for sine, 6 for cosine; tangent uses [ 5 / 4 ] Padé approximation
+		Fast,
+		// Minimax polynomials of degree 11 for sine, 10 for cosine; tangent uses [ 7 / 6 ] Padé approximation
+		Default,
+		// Minimax polynomials of degree 17 for sine, 16 for cosine; tangent uses [ 9 / 8 ] Padé approximation.
+		// Also uses Cody-Waite range reduction by pi/2 with quadrant selection, keeps the precision for angles up to about 1.6E+6.
+		Precise,
+	};
+
+	// Maximum errors compared to the long double versions of the standard library, for angles in [ -1000 .. +1000 ] interval, with FMA3.
+	// Absolute errors for sine and cosine, relative errors for tangent and cotangent; for the precise tier, also the errors in ULP.
+	// The fast and default tiers reduce the angles with a single constant, their ULP errors are unbounded near the zeros of the functions.
+	// Fast     sin 1.1E-6,  cos 7.8E-6,  tan 1.5E-7
+	// Default  sin 1.9E-11, cos 2.7E-10, tan 1.1E-2, the error grows near the poles
+	// Precise  sin 1.4E-16 or 1.9 ULP, cos 1.4E-16 or 1.9 ULP, tan 4.3E-16 or 3.4 ULP
+	// Throughput in TSC ticks per 4 angles, best of several runs on Intel Xeon Skylake-SP VM:
+	// Fast     sincos 10.5, sin 7.0, cos 7.0, tan 7.3
+	// Default  sincos 13.4, sin 7.6, cos 7.5, tan 7.0
+	// Precise  sincos 17.8, sin 9.6, cos 9.4, tan 10.1
 
 	// Compute both sine and cosine of 4 angles in radian
+	template<eTrigPrecision precision = eTrigPrecision::Default>
 	void _AM_CALL_ vectorSinCos( __m256d& sin, __m256d& cos, __m256d angles );
 	// Compute sine of 4 angles
+	template<eTrigPrecision precision = eTrigPrecision::Default>
 	__m256d vectorSin( __m256d angles );
 	// Compute cosine of 4 angles
+	template<eTrigPrecision precision = eTrigPrecision::Default>
 	__m256d vectorCos( __m256d angles );
 
+	// The scalar sine/cosine functions are using the polynomials of the default tier
+
 	// Compute both sine and cosine of the angle, make a 2D vector with [ cos, sin ] values
 	__m128d scalarSinCos( double a );
 
@@ -35,15 +60,34 @@ namespace AvxMath
 	// Compute cosine of the angle
 	double scalarCos( double a );
 
-	// Tangent and cotangent are using Padé approximation of degrees 7/6 for numerator/denominator
-
 	// Compute tangents of 4 angles in radians
+	template<eTrigPrecision precision = eTrigPrecision::Default>
 	__m256d _AM_CALL_ vectorTan( __m256d a );
 	// Compute cotangents of 4 angles in radians
+	template<eTrigPrecision precision = eTrigPrecision::Default>
 	__m256d _AM_CALL_ vectorCot( __m256d a );
 
+	// The scalar tangent and cotangent are using [ 7 / 6 ] Padé approximation of the default tier
+
 	// Compute tangent of the angle
 	double scalarTan( double a );
 	// Compute cotangent of the angle
 	double scalarCot( double a );
+
+	// ==== Array versions ====
+	// These functions handle 16 angles per loop iteration, this helps to saturate FMA throughput despite the long dependency chains of the polynomials.
+	// The output arrays may be the same as the input one. With parallel = true, large arrays are split across the hardware threads.
+
+	// Compute both sine and cosine of the angles
+	template<eTrigPrecision precision = eTrigPrecision::Default>
+	void arraySinCos( const double* angles, double* sin, double* cos, size_t length, bool parallel = false );
+	// Compute sine of the angles
+	template<eTrigPrecision precision = eTrigPrecision::Default>
+	void arraySin( const double* angles, double* result, size_t length, bool parallel = false );
+	// Compute cosine of the angles
+	template<eTrigPrecision precision = eTrigPrecision::Default>
+	void arrayCos( const double* angles, double* result, size_t length, bool parallel = false );
+	// Compute tangent of the angles
+	template<eTrigPrecision precision = eTrigPrecision::Default>
+	void arrayTan( const double* angles, double* result, size_t length, bool parallel = false );
 }
\ No newline at end of file
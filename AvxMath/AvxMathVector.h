@@ -60,8 +60,10 @@ namespace AvxMath
 		{
 			if( s > 0 )
 				return _mm_div_pd( v, _mm_sqrt_pd( lsq ) );
+			countEvent( eCounter::NormalizeZero );
 			return _mm_setzero_pd();
 		}
+		countEvent( eCounter::NormalizeInfinite );
 		return _mm_loaddup_pd( &g_misc.quietNaN );
 	}
 
@@ -110,8 +112,10 @@ namespace AvxMath
 #endif
 				return _mm256_div_pd( vec, len4 );
 			}
+			countEvent( eCounter::NormalizeZero );
 			return _mm256_setzero_pd();
 		}
+		countEvent( eCounter::NormalizeInfinite );
 		return _mm256_broadcast_sd( &g_misc.quietNaN );
 	}
 
@@ -184,8 +188,10 @@ namespace AvxMath
 #endif
 				return _mm256_div_pd( vec, len4 );
 			}
+			countEvent( eCounter::NormalizeZero );
 			return _mm256_setzero_pd();
 		}
+		countEvent( eCounter::NormalizeInfinite );
 		return broadcast( g_misc.quietNaN );
 	}
 
@@ -0,0 +1,13 @@
+#include "testAccuracy.h"
+#include <stdlib.h>
+
+// Usage: AvxMathAccuracy [ points per range ] [ kernel name filter ]
+// The exit code is non-zero when any kernel exceeded the error limit, can be used to gate the CI builds.
+int main( int argc, const char** argv )
+{
+	size_t points = (size_t)1 << 20;
+	if( argc > 1 )
+		points = strtoull( argv[ 1 ], nullptr, 0 );
+	const char* filter = ( argc > 2 ) ? argv[ 2 ] : nullptr;
+	return testAccuracy( points, filter ) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "benchmarks.h"
+#include "benchMisc.h"
+#include <vector>
+#include <cmath>
+
+namespace
+{
+	using namespace AvxMath;
+
+	// Bumpy heightfield in [ -1 .. +1 ] square, 2 * side^2 triangles
+	void makeTerrain( uint32_t side, std::vector<double>& xyz, std::vector<uint32_t>& indices )
+	{
+		xyz.clear();
+		indices.clear();
+		xyz.reserve( (size_t)( side + 1 ) * ( side + 1 ) * 3 );
+		indices.reserve( (size_t)side * side * 6 );
+		for( uint32_t y = 0; y <= side; y++ )
+			for( uint32_t x = 0; x <= side; x++ )
+			{
+				const double fx = (double)x / side * 2 - 1, fy = (double)y / side * 2 - 1;
+				xyz.insert( xyz.end(), { fx, fy, 0.1 * std::sin( fx * 17 ) * std::cos( fy * 13 ) } );
+			}
+		for( uint32_t y = 0; y < side; y++ )
+			for( uint32_t x = 0; x < side; x++ )
+			{
+				const uint32_t i = y * ( side + 1 ) + x;
+				indices.insert( indices.end(), { i, i + 1, i + side + 2, i, i + side + 2, i + side + 1 } );
+			}
+	}
+
+	double seconds( uint64_t ticks )
+	{
+		return (double)ticks / tscFrequency();
+	}
+}
+
+void benchBvh()
+{
+	std::vector<double> xyz;
+	std::vector<uint32_t> indices;
+	// 1M triangles
+	makeTerrain( 708, xyz, indices );
+	const size_t triangles = indices.size() / 3;
+	char name[ 64 ];
+
+	TriangleBvh bvh;
+	for( bool parallel : { false, true } )
+	{
+		const double ticks = measureTicks( [ & ]() { bvh.build( xyz.data(), indices.data(), triangles, parallel ); }, 3 );
+		snprintf( name, sizeof( name ), "build %zu triangles%s", triangles, parallel ? ", parallel" : "" );
+		printResult( "bvh", name, seconds( (uint64_t)ticks ) * 1000, "milliseconds" );
+	}
+
+	// Random rays from above, towards random points on the terrain; and coherent rays, a 256x256 grid of parallel rays in scanline order
+	constexpr size_t queries = 1 << 16;
+	std::vector<double> origins( queries * 3 ), dirs( queries * 3 ), coherent( queries * 3 );
+	Random rng;
+	for( size_t i = 0; i < queries; i++ )
+	{
+		origins[ i * 3 ] = rng.next() * 2;
+		origins[ i * 3 + 1 ] = rng.next() * 2;
+		origins[ i * 3 + 2 ] = 2;
+		dirs[ i * 3 ] = rng.next() - origins[ i * 3 ];
+		dirs[ i * 3 + 1 ] = rng.next() - origins[ i * 3 + 1 ];
+		dirs[ i * 3 + 2 ] = -2;
+
+		coherent[ i * 3 ] = (double)( i % 256 ) / 128.0 - 1.0;
+		coherent[ i * 3 + 1 ] = (double)( i / 256 ) / 128.0 - 1.0;
+		coherent[ i * 3 + 2 ] = 2;
+	}
+	const __m256d coherentDir = _mm256_setr_pd( 0.1, 0.2, -1, 0 );
+
+	const auto benchRays = [ & ]( const char* what, auto query )
+	{
+		size_t hits = 0;
+		const double ticks = measureTicks( [ & ]()
+		{
+			hits = 0;
+			for( size_t i = 0; i < queries; i++ )
+				hits += query( i ) ? 1 : 0;
+		}, 4 );
+		printResult( "bvh", what, queries / seconds( (uint64_t)ticks ) * 1E-6, "M rays/second" );
+		assert( hits > queries / 2 );
+	};
+	BvhRayHit hit;
+	benchRays( "intersect, random rays", [ & ]( size_t i ) { return bvh.intersect( loadDouble3( &origins[ i * 3 ] ), loadDouble3( &dirs[ i * 3 ] ), g_misc.infinity, hit ); } );
+	benchRays( "intersectAny, random rays", [ & ]( size_t i ) { return bvh.intersectAny( loadDouble3( &origins[ i * 3 ] ), loadDouble3( &dirs[ i * 3 ] ), g_misc.infinity ); } );
+	benchRays( "intersect, coherent rays", [ & ]( size_t i ) { return bvh.intersect( loadDouble3( &coherent[ i * 3 ] ), coherentDir, g_misc.infinity, hit ); } );
+	benchRays( "intersectAny, coherent rays", [ & ]( size_t i ) { return bvh.intersectAny( loadDouble3( &coherent[ i * 3 ] ), coherentDir, g_misc.infinity ); } );
+
+	// Closest points for the points near the surface, like a scan compared against CAD
+	std::vector<double> points( queries * 3 );
+	for( size_t i = 0; i < queries; i++ )
+	{
+		points[ i * 3 ] = rng.next();
+		points[ i * 3 + 1 ] = rng.next();
+		points[ i * 3 + 2 ] = rng.next() * 0.15;
+	}
+	for( double maxDistance : { 0.01, 1.0 } )
+	{
+		const double ticks = measureTicks( [ & ]()
+		{
+			BvhClosestPoint cp;
+			for( size_t i = 0; i < queries; i++ )
+				bvh.closestPoint( loadDouble3( &points[ i * 3 ] ), maxDistance, cp );
+		}, 4 );
+		snprintf( name, sizeof( name ), "closestPoint, maxDistance %g", maxDistance );
+		printResult( "bvh", name, queries / seconds( (uint64_t)ticks ) * 1E-6, "M queries/second" );
+	}
+}
\ No newline at end of file
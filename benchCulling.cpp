@@ -0,0 +1,100 @@
+#include "benchmarks.h"
+#include "benchMisc.h"
+#include <vector>
+#include <cmath>
+
+namespace
+{
+	using namespace AvxMath;
+
+	// Camera at the origin looking along +Z, 90 degrees field of view, the far plane at 150 units
+	Frustum makeFrustum()
+	{
+		const double n = 0.1, f = 150;
+		Matrix4x4 m;
+		m.r0 = _mm256_setr_pd( 1, 0, 0, 0 );
+		m.r1 = _mm256_setr_pd( 0, 1, 0, 0 );
+		m.r2 = _mm256_setr_pd( 0, 0, f / ( f - n ), -n * f / ( f - n ) );
+		m.r3 = _mm256_setr_pd( 0, 0, 1, 0 );
+		return frustumFromMatrix( m );
+	}
+
+	// The typical per-object code: test the planes one by one, stop at the first plane which culls the object
+	size_t cullBoxesScalar( const Frustum& frustum, const double* boxes, size_t count, uint32_t* visible )
+	{
+		size_t res = 0;
+		for( size_t i = 0; i < count; i++, boxes += 6 )
+		{
+			bool culled = false;
+			for( size_t p = 0; p < 6 && !culled; p++ )
+			{
+				const double* plane = frustum.planes[ p ];
+				// The corner of the box furthest along the normal
+				const double x = plane[ 0 ] >= 0 ? boxes[ 3 ] : boxes[ 0 ];
+				const double y = plane[ 1 ] >= 0 ? boxes[ 4 ] : boxes[ 1 ];
+				const double z = plane[ 2 ] >= 0 ? boxes[ 5 ] : boxes[ 2 ];
+				culled = plane[ 0 ] * x + plane[ 1 ] * y + plane[ 2 ] * z + plane[ 3 ] < 0;
+			}
+			if( !culled )
+				visible[ res++ ] = (uint32_t)i;
+		}
+		return res;
+	}
+
+	size_t cullSpheresScalar( const Frustum& frustum, const double* spheres, size_t count, uint32_t* visible )
+	{
+		size_t res = 0;
+		for( size_t i = 0; i < count; i++, spheres += 4 )
+		{
+			bool culled = false;
+			for( size_t p = 0; p < 6 && !culled; p++ )
+			{
+				const double* plane = frustum.planes[ p ];
+				culled = plane[ 0 ] * spheres[ 0 ] + plane[ 1 ] * spheres[ 1 ] + plane[ 2 ] * spheres[ 2 ] + plane[ 3 ] < -spheres[ 3 ];
+			}
+			if( !culled )
+				visible[ res++ ] = (uint32_t)i;
+		}
+		return res;
+	}
+
+	void print( const char* name, double ticks, size_t count, size_t visible )
+	{
+		char buffer[ 64 ];
+		snprintf( buffer, sizeof( buffer ), "%zuK %s, %zu%% visible", count / 1024, name, visible * 100 / count );
+		printResult( "culling", buffer, ticks / (double)count, "ticks/object" );
+	}
+}
+
+void benchCulling()
+{
+	// Objects about 1 unit large, within 200 units cube around the camera.
+	// 4K objects fit in L2 cache and measure the computations, 256K objects are mostly limited by memory bandwidth.
+	for( size_t count : { (size_t)1 << 12, (size_t)1 << 18 } )
+	{
+		Random rng;
+		std::vector<double> boxes, spheres;
+		boxes.reserve( count * 6 );
+		spheres.reserve( count * 4 );
+		for( size_t i = 0; i < count; i++ )
+		{
+			const double x = rng.next() * 100, y = rng.next() * 100, z = rng.next() * 100;
+			const double ex = std::abs( rng.next() ), ey = std::abs( rng.next() ), ez = std::abs( rng.next() );
+			boxes.insert( boxes.end(), { x - ex, y - ey, z - ez, x + ex, y + ey, z + ez } );
+			spheres.insert( spheres.end(), { x, y, z, std::sqrt( ex * ex + ey * ey + ez * ez ) } );
+		}
+		const Frustum frustum = makeFrustum();
+		std::vector<uint32_t> visible( count );
+
+		size_t found = 0;
+		double ticks = measureTicks( [ & ]() { found = cullBoxesScalar( frustum, boxes.data(), count, visible.data() ); } );
+		print( "boxes, scalar", ticks, count, found );
+		ticks = measureTicks( [ & ]() { found = frustumCullBoxes( frustum, boxes.data(), count, visible.data() ); } );
+		print( "boxes, frustumCullBoxes", ticks, count, found );
+
+		ticks = measureTicks( [ & ]() { found = cullSpheresScalar( frustum, spheres.data(), count, visible.data() ); } );
+		print( "spheres, scalar", ticks, count, found );
+		ticks = measureTicks( [ & ]() { found = frustumCullSpheres( frustum, spheres.data(), count, visible.data() ); } );
+		print( "spheres, frustumCullSpheres", ticks, count, found );
+	}
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "benchmarks.h"
+#include "benchMisc.h"
+#include <vector>
+
+namespace
+{
+	using namespace AvxMath;
+
+	constexpr size_t count = 1 << 12;
+
+	// Arrays of double-double numbers, high and low parts in separate arrays
+	struct Numbers
+	{
+		std::vector<double> hi, lo;
+
+		Numbers( Random& rng ) : hi( count ), lo( count )
+		{
+			for( size_t i = 0; i < count; i++ )
+			{
+				const double h = rng.next() + 2.0;
+				hi[ i ] = h;
+				lo[ i ] = rng.next() * h * 0x1p-54;
+			}
+		}
+		DoubleDouble4 load( size_t i ) const
+		{
+			return ddLoad( &hi[ i ], &lo[ i ] );
+		}
+	};
+
+	void print( const char* name, double ticks )
+	{
+		printResult( "dd", name, ticks / (double)count, "ticks/number" );
+	}
+
+	// Element-wise operation on the double-double arrays, 4 numbers per iteration
+	template<class F>
+	void benchVector( const char* name, const Numbers& a, const Numbers& b, Numbers& res, F&& fn )
+	{
+		print( name, measureTicks( [ & ]()
+		{
+			for( size_t i = 0; i < count; i += 4 )
+			{
+				const DoubleDouble4 r = fn( a.load( i ), b.load( i ) );
+				ddStore( &res.hi[ i ], &res.lo[ i ], r );
+			}
+		} ) );
+	}
+
+#ifdef __SIZEOF_FLOAT128__
+	template<class F>
+	void benchQuad( const char* name, const std::vector<__float128>& a, const std::vector<__float128>& b, std::vector<__float128>& res, F&& fn )
+	{
+		print( name, measureTicks( [ & ]()
+		{
+			for( size_t i = 0; i < count; i++ )
+				res[ i ] = fn( a[ i ], b[ i ] );
+		} ) );
+	}
+#endif
+}
+
+void benchDoubleDouble()
+{
+	Random rng;
+	const Numbers a{ rng }, b{ rng };
+	Numbers res{ rng };
+
+	benchVector( "add, DoubleDouble4", a, b, res, []( DoubleDouble4 x, DoubleDouble4 y ) { return ddAdd( x, y ); } );
+	benchVector( "multiply, DoubleDouble4", a, b, res, []( DoubleDouble4 x, DoubleDouble4 y ) { return ddMultiply( x, y ); } );
+	benchVector( "multiply-add, DoubleDouble4", a, b, res, []( DoubleDouble4 x, DoubleDouble4 y ) { return ddMultiplyAdd( x, y, x ); } );
+	benchVector( "divide, DoubleDouble4", a, b, res, []( DoubleDouble4 x, DoubleDouble4 y ) { return ddDivide( x, y ); } );
+	benchVector( "sqrt, DoubleDouble4", a, b, res, []( DoubleDouble4 x, DoubleDouble4 ) { return ddSqrt( x ); } );
+	print( "dot product, ddDot", measureTicks( [ & ]() { consume( ddDot( a.hi.data(), b.hi.data(), count ).hi ); } ) );
+
+#ifdef __SIZEOF_FLOAT128__
+	// Software quad precision, the square root is not measured because it requires libquadmath
+	std::vector<__float128> qa( count ), qb( count ), qres( count );
+	for( size_t i = 0; i < count; i++ )
+	{
+		qa[ i ] = (__float128)a.hi[ i ] + a.lo[ i ];
+		qb[ i ] = (__float128)b.hi[ i ] + b.lo[ i ];
+	}
+	benchQuad( "add, __float128", qa, qb, qres, []( __float128 x, __float128 y ) { return x + y; } );
+	benchQuad( "multiply, __float128", qa, qb, qres, []( __float128 x, __float128 y ) { return x * y; } );
+	benchQuad( "multiply-add, __float128", qa, qb, qres, []( __float128 x, __float128 y ) { return x * y + x; } );
+	benchQuad( "divide, __float128", qa, qb, qres, []( __float128 x, __float128 y ) { return x / y; } );
+	print( "dot product, __float128", measureTicks( [ & ]()
+	{
+		__float128 acc = 0;
+		for( size_t i = 0; i < count; i++ )
+			acc += (__float128)a.hi[ i ] * b.hi[ i ];
+		consume( _mm256_set1_pd( (double)acc ) );
+	} ) );
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "benchmarks.h"
+#include "benchMisc.h"
+#include <vector>
+#include <array>
+#include <unordered_map>
+
+namespace
+{
+	using namespace AvxMath;
+
+	// Vertices of a triangle mesh stored as an STL file: a grid of squares, 2 triangles per square, every inner vertex repeated 6 times
+	std::vector<double> makeStlVertices( size_t gridSize )
+	{
+		std::vector<double> vec;
+		vec.reserve( gridSize * gridSize * 18 );
+		const auto vertex = [ & ]( size_t x, size_t y )
+		{
+			vec.push_back( (double)x * 0.1 );
+			vec.push_back( (double)y * 0.1 );
+			vec.push_back( (double)( ( x * y ) % 7 ) * 0.01 );
+		};
+		for( size_t y = 0; y < gridSize; y++ )
+			for( size_t x = 0; x < gridSize; x++ )
+			{
+				vertex( x, y ); vertex( x + 1, y ); vertex( x + 1, y + 1 );
+				vertex( x, y ); vertex( x + 1, y + 1 ); vertex( x, y + 1 );
+			}
+		return vec;
+	}
+
+	struct ArrayHash
+	{
+		size_t operator()( const std::array<double, 3>& a ) const
+		{
+			const std::hash<double> h;
+			size_t res = h( a[ 0 ] );
+			res = res * 31 + h( a[ 1 ] );
+			res = res * 31 + h( a[ 2 ] );
+			return res;
+		}
+	};
+
+	// The baseline, what the mesh import code was doing before
+	size_t weldUnorderedMap( const double* xyz, size_t length, double* unique, uint32_t* indices )
+	{
+		std::unordered_map<std::array<double, 3>, uint32_t, ArrayHash> map;
+		for( size_t i = 0; i < length; i++ )
+		{
+			const std::array<double, 3> key = { xyz[ i * 3 ], xyz[ i * 3 + 1 ], xyz[ i * 3 + 2 ] };
+			auto res = map.emplace( key, (uint32_t)map.size() );
+			if( res.second )
+				std::copy( key.begin(), key.end(), unique + res.first->second * 3 );
+			indices[ i ] = res.first->second;
+		}
+		return map.size();
+	}
+
+	// Compare the hash functions with their array versions, in ticks per hashed vector
+	void benchHashFunctions()
+	{
+		constexpr size_t length = 4096;
+		std::vector<double> data( length * 4 );
+		for( size_t i = 0; i < data.size(); i++ )
+			data[ i ] = (double)( i * 7 % 1001 ) * 0.01;
+		std::vector<uint64_t> h64( length );
+		std::vector<uint32_t> h32( length );
+		const double count = (double)length;
+
+		double ticks = measureTicks( [ & ]() { for( size_t i = 0; i < length; i++ ) h64[ i ] = vectorHash64( loadDouble4( &data[ i * 4 ] ) ); } );
+		printResult( "hash", "vectorHash64", ticks / count, "ticks/vector" );
+		ticks = measureTicks( [ & ]() { arrayHash64( data.data(), length, h64.data() ); } );
+		printResult( "hash", "arrayHash64", ticks / count, "ticks/vector" );
+
+		ticks = measureTicks( [ & ]() { for( size_t i = 0; i < length; i++ ) h64[ i ] = vector3Hash64( loadDouble3( &data[ i * 3 ] ) ); } );
+		printResult( "hash", "vector3Hash64", ticks / count, "ticks/vector" );
+		ticks = measureTicks( [ & ]() { array3Hash64( data.data(), length, h64.data() ); } );
+		printResult( "hash", "array3Hash64", ticks / count, "ticks/vector" );
+
+		ticks = measureTicks( [ & ]() { for( size_t i = 0; i < length; i++ ) h32[ i ] = vectorHash32( loadDouble4( &data[ i * 4 ] ) ); } );
+		printResult( "hash", "vectorHash32", ticks / count, "ticks/vector" );
+		ticks = measureTicks( [ & ]() { arrayHash32( data.data(), length, h32.data() ); } );
+		printResult( "hash", "arrayHash32", ticks / count, "ticks/vector" );
+
+		ticks = measureTicks( [ & ]() { for( size_t i = 0; i < length; i++ ) h32[ i ] = vector3Hash32( loadDouble3( &data[ i * 3 ] ) ); } );
+		printResult( "hash", "vector3Hash32", ticks / count, "ticks/vector" );
+		ticks = measureTicks( [ & ]() { array3Hash32( data.data(), length, h32.data() ); } );
+		printResult( "hash", "array3Hash32", ticks / count, "ticks/vector" );
+	}
+
+}
+
+void benchHash()
+{
+	benchHashFunctions();
+	for( size_t grid : { (size_t)64, (size_t)1024 } )
+	{
+		const std::vector<double> xyz = makeStlVertices( grid );
+		const size_t length = xyz.size() / 3;
+		std::vector<double> unique( xyz.size() );
+		std::vector<uint32_t> indices( length );
+		char name[ 64 ];
+
+		double ticks = measureTicks( [ & ]() { weldUnorderedMap( xyz.data(), length, unique.data(), indices.data() ); }, 4 );
+		snprintf( name, sizeof( name ), "std::unordered_map weld, %zu", length );
+		printResult( "hash", name, ticks / (double)length, "ticks/vertex" );
+
+		ticks = measureTicks( [ & ]() { weldVertices( xyz.data(), length, unique.data(), indices.data() ); }, 4 );
+		snprintf( name, sizeof( name ), "weldVertices, %zu", length );
+		printResult( "hash", name, ticks / (double)length, "ticks/vertex" );
+
+		// Same mesh after FP64 transforms, the copies of the vertices differ by a few ULP
+		std::vector<double> noisy = xyz;
+		for( size_t i = 0; i < noisy.size(); i++ )
+			noisy[ i ] += (double)( ( i * 2654435761u ) % 5 ) * 1E-14;
+
+		ticks = measureTicks( [ & ]() { mergeVertices( noisy.data(), length, 1E-9, unique.data(), indices.data() ); }, 4 );
+		snprintf( name, sizeof( name ), "mergeVertices, %zu", length );
+		printResult( "hash", name, ticks / (double)length, "ticks/vertex" );
+
+		SpatialHashGrid spatial{ 0.1 };
+		ticks = measureTicks( [ & ]() { spatial.clear(); spatial.insert( noisy.data(), length ); }, 4 );
+		snprintf( name, sizeof( name ), "SpatialHashGrid insert, %zu", length );
+		printResult( "hash", name, ticks / (double)length, "ticks/point" );
+
+		std::vector<uint32_t> found;
+		const size_t queries = 4096;
+		ticks = measureTicks( [ & ]()
+		{
+			for( size_t i = 0; i < queries; i++ )
+			{
+				found.clear();
+				spatial.queryRadius( loadDouble3( &noisy[ ( i * 7919 % length ) * 3 ] ), 0.05, found );
+			}
+		}, 4 );
+		snprintf( name, sizeof( name ), "SpatialHashGrid queryRadius, %zu", length );
+		printResult( "hash", name, ticks / (double)queries, "ticks/query" );
+	}
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "benchmarks.h"
+#include "benchMisc.h"
+#include <vector>
+#include <cmath>
+#include <stdlib.h>
+
+namespace
+{
+	using namespace AvxMath;
+
+	double seconds( uint64_t ticks )
+	{
+		return (double)ticks / tscFrequency();
+	}
+
+	constexpr size_t queries = 1 << 16;
+
+	void printQueries( const char* what, size_t points, double ticks )
+	{
+		char name[ 64 ];
+		snprintf( name, sizeof( name ), "%s, %zuM points", what, points / 1000000 );
+		printResult( "kdtree", name, queries / seconds( (uint64_t)ticks ) * 1E-6, "M queries/second" );
+	}
+
+	void benchKdTree( size_t count )
+	{
+		// Uniformly distributed points in [ -1 .. +1 ] cube, random query positions in the same cube
+		Random rng;
+		std::vector<double> xyz( count * 3 ), positions( queries * 3 );
+		for( double& v : xyz )
+			v = rng.next();
+		for( double& v : positions )
+			v = rng.next();
+		char name[ 64 ];
+
+		KdTree tree;
+		for( bool parallel : { false, true } )
+		{
+			const double ticks = measureTicks( [ & ]() { tree.build( xyz.data(), count, parallel ); }, 2 );
+			snprintf( name, sizeof( name ), "build %zuM points%s", count / 1000000, parallel ? ", parallel" : "" );
+			printResult( "kdtree", name, seconds( (uint64_t)ticks ) * 1000, "milliseconds" );
+		}
+
+		constexpr size_t k = 8;
+		std::vector<uint32_t> indices( queries * k );
+		std::vector<double> distances( queries * k );
+		for( size_t kk : { (size_t)1, k } )
+		{
+			printQueries( kk == 1 ? "nearest, k = 1" : "nearest, k = 8", count, measureTicks( [ & ]()
+			{
+				for( size_t i = 0; i < queries; i++ )
+					tree.nearest( loadDouble3( &positions[ i * 3 ] ), kk, &indices[ i * kk ], &distances[ i * kk ] );
+			}, 4 ) );
+		}
+		for( bool parallel : { false, true } )
+		{
+			printQueries( parallel ? "nearest batch, k = 8, parallel" : "nearest batch, k = 8", count, measureTicks( [ & ]()
+			{
+				tree.nearest( positions.data(), queries, k, indices.data(), distances.data(), g_misc.infinity, parallel );
+			}, 4 ) );
+		}
+
+		// The radius with 16 points on average
+		const double radius = std::cbrt( 16.0 * 8.0 / ( (double)count * 4.0 / 3.0 * M_PI ) );
+		std::vector<uint32_t> found;
+		std::vector<size_t> offsets;
+		printQueries( "radius, 16 points", count, measureTicks( [ & ]()
+		{
+			for( size_t i = 0; i < queries; i++ )
+			{
+				found.clear();
+				tree.radiusSearch( loadDouble3( &positions[ i * 3 ] ), radius, found );
+			}
+		}, 4 ) );
+		for( bool parallel : { false, true } )
+		{
+			printQueries( parallel ? "radius batch, 16 points, parallel" : "radius batch, 16 points", count, measureTicks( [ & ]()
+			{
+				tree.radiusSearch( positions.data(), queries, radius, offsets, found, parallel );
+			}, 4 ) );
+		}
+	}
+}
+
+void benchKdTree()
+{
+	benchKdTree( 1000000 );
+	benchKdTree( 10000000 );
+	// The tree with 100M points needs about 10 GB of memory, including the source array and the temporary buffer of the builder
+	if( nullptr != getenv( "AVXMATH_BENCH_100M" ) )
+		benchKdTree( 100000000 );
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include "benchmarks.h"
+#include "benchMisc.h"
+#include <vector>
+#include <cmath>
+
+namespace
+{
+	using namespace AvxMath;
+
+	// Regular grid of vertices displaced with a few waves, 2 triangles per cell
+	void makeMesh( size_t size, std::vector<double>& xyz, std::vector<uint32_t>& indices )
+	{
+		xyz.clear();
+		indices.clear();
+		for( size_t i = 0; i < size; i++ )
+			for( size_t j = 0; j < size; j++ )
+				xyz.insert( xyz.end(), { (double)j, (double)i, std::sin( (double)j * 0.1 ) * std::cos( (double)i * 0.07 ) * 5 } );
+		for( uint32_t i = 0; i + 1 < size; i++ )
+		{
+			for( uint32_t j = 0; j + 1 < size; j++ )
+			{
+				const uint32_t v = i * (uint32_t)size + j;
+				indices.insert( indices.end(), { v, v + 1, v + (uint32_t)size + 1 } );
+				indices.insert( indices.end(), { v, v + (uint32_t)size + 1, v + (uint32_t)size } );
+			}
+		}
+	}
+
+	// The typical code: scalar cross products, scatter-add into the vertices, then normalize
+	void normalsScalar( const double* xyz, size_t vertices, const uint32_t* indices, size_t triangles, double* normals )
+	{
+		std::fill( normals, normals + vertices * 3, 0.0 );
+		for( size_t t = 0; t < triangles; t++, indices += 3 )
+		{
+			const double* a = xyz + indices[ 0 ] * 3;
+			const double* b = xyz + indices[ 1 ] * 3;
+			const double* c = xyz + indices[ 2 ] * 3;
+			const double ux = b[ 0 ] - a[ 0 ], uy = b[ 1 ] - a[ 1 ], uz = b[ 2 ] - a[ 2 ];
+			const double vx = c[ 0 ] - a[ 0 ], vy = c[ 1 ] - a[ 1 ], vz = c[ 2 ] - a[ 2 ];
+			const double nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+			for( int v = 0; v < 3; v++ )
+			{
+				double* n = normals + indices[ v ] * 3;
+				n[ 0 ] += nx;
+				n[ 1 ] += ny;
+				n[ 2 ] += nz;
+			}
+		}
+		for( size_t i = 0; i < vertices; i++, normals += 3 )
+		{
+			const double len = std::sqrt( normals[ 0 ] * normals[ 0 ] + normals[ 1 ] * normals[ 1 ] + normals[ 2 ] * normals[ 2 ] );
+			const double mul = len > 0 ? 1.0 / len : 0.0;
+			normals[ 0 ] *= mul;
+			normals[ 1 ] *= mul;
+			normals[ 2 ] *= mul;
+		}
+	}
+
+	void print( const char* name, double ticks, size_t vertices )
+	{
+		printResult( "mesh", name, ticks / (double)vertices, "ticks/vertex" );
+	}
+}
+
+void benchMesh()
+{
+	// 64K vertices mostly stay in the caches, 1M vertices are limited by the memory bandwidth
+	for( size_t size : { (size_t)256, (size_t)1024 } )
+	{
+		std::vector<double> xyz;
+		std::vector<uint32_t> indices;
+		makeMesh( size, xyz, indices );
+		const size_t vertices = xyz.size() / 3;
+		const size_t triangles = indices.size() / 3;
+		std::vector<double> normals( vertices * 3 );
+
+		char name[ 64 ];
+		snprintf( name, sizeof( name ), "%zuK vertices, scalar scatter-add", vertices / 1024 );
+		print( name, measureTicks( [ & ]() { normalsScalar( xyz.data(), vertices, indices.data(), triangles, normals.data() ); } ), vertices );
+
+		MeshNormals mn;
+		snprintf( name, sizeof( name ), "%zuK vertices, MeshNormals.build", vertices / 1024 );
+		print( name, measureTicks( [ & ]() { mn.build( indices.data(), triangles, vertices ); } ), vertices );
+		for( bool parallel : { false, true } )
+		{
+			snprintf( name, sizeof( name ), "%zuK vertices, MeshNormals.compute%s", vertices / 1024, parallel ? ", parallel" : "" );
+			print( name, measureTicks( [ & ]() { mn.compute( xyz.data(), normals.data(), parallel ); } ), vertices );
+		}
+	}
+}
\ No newline at end of file
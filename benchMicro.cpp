@@ -0,0 +1,376 @@
+#include "benchmarks.h"
+#include "benchMisc.h"
+#include <vector>
+#include <cmath>
+#include <string.h>
+
+// Microbenchmarks of the individual functions. Every function gets 2 numbers, in TSC ticks per call:
+// throughput: independent calls on a batch of inputs, the results are stored to memory;
+// latency: every call depends on the result of the previous one, minus the cost of the link which makes the dependency.
+// The inputs stay in L1 cache. The scalar libm and naive versions are measured the same way, as the baselines.
+namespace
+{
+	using namespace AvxMath;
+
+	// Count of calls per measurement
+	constexpr size_t batch = 1024;
+
+	// Zero bits the compiler can't see through
+	__m256d opaqueZero()
+	{
+		static volatile double zero = 0;
+		return _mm256_set1_pd( zero );
+	}
+
+	// Make the next input depend on the previous result without changing its value: 2 bitwise instructions
+	inline __m256d link( __m256d result, __m256d next, __m256d zero )
+	{
+		return _mm256_or_pd( _mm256_and_pd( result, zero ), next );
+	}
+	inline Matrix4x4 link( const Matrix4x4& result, const Matrix4x4& next, __m256d zero )
+	{
+		return Matrix4x4{ link( result.r0, next.r0, zero ), link( result.r1, next.r1, zero ), link( result.r2, next.r2, zero ), link( result.r3, next.r3, zero ) };
+	}
+
+	// Scalar results are moved to a vector register, that move is a part of the measured latency
+	inline __m256d toVector( uint64_t v )
+	{
+		return _mm256_castsi256_pd( _mm256_castsi128_si256( _mm_cvtsi64_si128( (int64_t)v ) ) );
+	}
+	inline __m256d toVector( double v )
+	{
+		return _mm256_castpd128_pd256( _mm_set_sd( v ) );
+	}
+
+	// Inputs and outputs of the measured functions
+	__m256d g_vectorA[ batch ], g_vectorB[ batch ], g_vectorOut[ batch ];
+	Matrix4x4 g_matrixA[ batch ], g_matrixB[ batch ], g_matrixOut[ batch ];
+
+	void makeInputs()
+	{
+		Random rng;
+		for( __m256d* vec : { g_vectorA, g_vectorB } )
+			for( size_t i = 0; i < batch; i++ )
+			{
+				const double x = rng.next(), y = rng.next(), z = rng.next(), w = rng.next();
+				vec[ i ] = _mm256_setr_pd( x, y, z, w );
+			}
+
+		// The matrices are rotations, to keep the values bounded in the dependency chains
+		for( Matrix4x4* vec : { g_matrixA, g_matrixB } )
+			for( size_t i = 0; i < batch; i++ )
+			{
+				const __m256d q = quaternionNormalize( ( vec == g_matrixA ) ? g_vectorA[ i ] : g_vectorB[ i ] );
+				const Matrix4x4 id = matrixIdentity();
+				vec[ i ] = Matrix4x4{ vector3Rotate( id.r0, q ), vector3Rotate( id.r1, q ), vector3Rotate( id.r2, q ), id.r3 };
+			}
+	}
+
+	inline void getInputs( const __m256d*& a, const __m256d*& b, __m256d*& out )
+	{
+		a = g_vectorA;
+		b = g_vectorB;
+		out = g_vectorOut;
+	}
+	inline void getInputs( const Matrix4x4*& a, const Matrix4x4*& b, Matrix4x4*& out )
+	{
+		a = g_matrixA;
+		b = g_matrixB;
+		out = g_matrixOut;
+	}
+
+	template<class T, class F>
+	double throughputTicks( F f )
+	{
+		const T* a;
+		const T* b;
+		T* out;
+		getInputs( a, b, out );
+		return measureTicks( [ & ]()
+		{
+			for( size_t i = 0; i < batch; i++ )
+				out[ i ] = f( a[ i ], b[ i ] );
+		} ) / batch;
+	}
+
+	template<class T, class F>
+	double chainTicks( F f )
+	{
+		const T* a;
+		const T* b;
+		T* out;
+		getInputs( a, b, out );
+		const __m256d zero = opaqueZero();
+		T result = a[ 0 ];
+		const double ticks = measureTicks( [ & ]()
+		{
+			T x = result;
+			for( size_t i = 0; i < batch; i++ )
+				x = link( f( x, b[ i ] ), a[ i ], zero );
+			result = x;
+		} );
+		out[ 0 ] = result;
+		return ticks / batch;
+	}
+
+	template<class T, class F>
+	double latencyTicks( F f )
+	{
+		static const double linkTicks = chainTicks<T>( []( const T& a, const T& ) { return a; } );
+		return std::max( chainTicks<T>( f ) - linkTicks, 0.0 );
+	}
+
+	void print( const char* group, const char* name, const char* what, double ticks )
+	{
+		// The names are up to 48 characters, the longest suffix is "throughput"
+		char buffer[ 48 + 2 + 10 + 1 ];
+		snprintf( buffer, sizeof( buffer ), "%.48s, %.10s", name, what );
+		printResult( group, buffer, ticks, "ticks/call" );
+	}
+
+	// Measure throughput and latency of the function of 2 arguments; the unary functions ignore the second one
+	template<class T, class F>
+	void measure( const char* group, const char* name, F f )
+	{
+		print( group, name, "throughput", throughputTicks<T>( f ) );
+		print( group, name, "latency", latencyTicks<T>( f ) );
+	}
+
+	// Apply the scalar function to the 4 lanes
+	template<class F>
+	inline __m256d scalar4( __m256d v, F f )
+	{
+		alignas( 32 ) double tmp[ 4 ];
+		_mm256_store_pd( tmp, v );
+		for( double& d : tmp )
+			d = f( d );
+		return _mm256_load_pd( tmp );
+	}
+
+	void benchMemory()
+	{
+		// The loads and stores go together, latency is not meaningful for them
+		std::vector<double> source( batch * 4 + 4 ), dest( batch * 4 + 4 );
+		for( size_t i = 0; i < source.size(); i++ )
+			source[ i ] = (double)i;
+		const double* rsi = source.data();
+		double* rdi = dest.data();
+		auto copy = [ & ]( const char* name, size_t stride, auto f )
+		{
+			print( "mem", name, "throughput", measureTicks( [ & ]()
+			{
+				for( size_t i = 0; i < batch; i++ )
+					f( rsi + i * stride, rdi + i * stride );
+			} ) / batch );
+		};
+		copy( "loadDouble4 + storeDouble4", 4, []( const double* s, double* d ) { storeDouble4( d, loadDouble4( s ) ); } );
+		copy( "loadDouble3 + storeDouble3", 3, []( const double* s, double* d ) { storeDouble3( d, loadDouble3( s ) ); } );
+		copy( "loadPartial + storePartial, 3", 3, []( const double* s, double* d ) { storePartial( d, loadPartial( s, 3 ), 3 ); } );
+		copy( "naive, 3 scalars", 3, []( const double* s, double* d ) { d[ 0 ] = s[ 0 ]; d[ 1 ] = s[ 1 ]; d[ 2 ] = s[ 2 ]; } );
+
+		std::vector<double> matrices( batch * 16 + 16 ), matricesOut( batch * 16 + 16 );
+		const double* rsiMat = matrices.data();
+		double* rdiMat = matricesOut.data();
+		auto copyMatrix = [ & ]( const char* name, auto f )
+		{
+			print( "mem", name, "throughput", measureTicks( [ & ]()
+			{
+				for( size_t i = 0; i < batch; i++ )
+					f( rsiMat + i * 16, rdiMat + i * 16 );
+			} ) / batch );
+		};
+		copyMatrix( "loadMatrix + storeMatrix", []( const double* s, double* d ) { storeMatrix( d, loadMatrix( s ) ); } );
+		copyMatrix( "loadMatrixTransposed + storeMatrix", []( const double* s, double* d ) { storeMatrix( d, loadMatrixTransposed( s ) ); } );
+	}
+
+	void benchVector()
+	{
+		using V = __m256d;
+		measure<V>( "vector", "vector3Dot", []( V a, V b ) { return vector3Dot( a, b ); } );
+		measure<V>( "vector", "vector3Dot, naive", []( V a, V b )
+		{
+			alignas( 32 ) double x[ 4 ], y[ 4 ];
+			_mm256_store_pd( x, a );
+			_mm256_store_pd( y, b );
+			return _mm256_set1_pd( x[ 0 ] * y[ 0 ] + x[ 1 ] * y[ 1 ] + x[ 2 ] * y[ 2 ] );
+		} );
+		measure<V>( "vector", "vector4Dot", []( V a, V b ) { return vector4Dot( a, b ); } );
+		measure<V>( "vector", "vector3Cross", []( V a, V b ) { return vector3Cross( a, b ); } );
+		measure<V>( "vector", "vector3Cross, naive", []( V a, V b )
+		{
+			alignas( 32 ) double x[ 4 ], y[ 4 ];
+			_mm256_store_pd( x, a );
+			_mm256_store_pd( y, b );
+			return _mm256_setr_pd( x[ 1 ] * y[ 2 ] - x[ 2 ] * y[ 1 ], x[ 2 ] * y[ 0 ] - x[ 0 ] * y[ 2 ], x[ 0 ] * y[ 1 ] - x[ 1 ] * y[ 0 ], 0 );
+		} );
+		measure<V>( "vector", "vector3Normalize", []( V a, V ) { return vector3Normalize( a ); } );
+		measure<V>( "vector", "vector3Normalize, naive", []( V a, V )
+		{
+			alignas( 32 ) double x[ 4 ];
+			_mm256_store_pd( x, a );
+			const double inv = 1.0 / std::sqrt( x[ 0 ] * x[ 0 ] + x[ 1 ] * x[ 1 ] + x[ 2 ] * x[ 2 ] );
+			return _mm256_setr_pd( x[ 0 ] * inv, x[ 1 ] * inv, x[ 2 ] * inv, x[ 3 ] * inv );
+		} );
+		measure<V>( "vector", "vector4Normalize", []( V a, V ) { return vector4Normalize( a ); } );
+		measure<V>( "vector", "vectorMultiplyAdd", []( V a, V b ) { return vectorMultiplyAdd( a, b, b ); } );
+		measure<V>( "vector", "vectorDifferenceOfProducts", []( V a, V b ) { return vectorDifferenceOfProducts( a, b, b, a ); } );
+		measure<V>( "vector", "vectorSplatZ", []( V a, V ) { return vectorSplatZ( a ); } );
+		measure<V>( "vector", "vectorNegateLanes", []( V a, V ) { return vectorNegateLanes<0b1010>( a ); } );
+		measure<V>( "vector", "saturate", []( V a, V ) { return saturate( a ); } );
+		measure<V>( "vector", "vector3Homogeneous", []( V a, V ) { return vector3Homogeneous( a ); } );
+		measure<V>( "vector", "vector4Carthesian", []( V a, V ) { return vector4Carthesian( a ); } );
+	}
+
+	void benchMatrix()
+	{
+		using M = Matrix4x4;
+		using V = __m256d;
+		const Matrix4x4 mat = g_matrixA[ 0 ];
+		measure<V>( "matrix", "vector4Transform", [ = ]( V a, V ) { return vector4Transform( a, mat ); } );
+		measure<V>( "matrix", "vector4TransformTransposed", [ = ]( V a, V ) { return vector4TransformTransposed( a, mat ); } );
+		measure<V>( "matrix", "vector3TransformCoord", [ = ]( V a, V ) { return vector3TransformCoord( a, mat ); } );
+		measure<M>( "matrix", "matrixMultiply", []( const M& a, const M& b ) { return matrixMultiply( a, b ); } );
+		measure<M>( "matrix", "matrixMultiply, naive", []( const M& a, const M& b )
+		{
+			alignas( 32 ) double x[ 16 ], y[ 16 ], r[ 16 ];
+			storeMatrix( x, a );
+			storeMatrix( y, b );
+			for( size_t i = 0; i < 4; i++ )
+				for( size_t j = 0; j < 4; j++ )
+				{
+					double s = 0;
+					for( size_t k = 0; k < 4; k++ )
+						s += x[ i * 4 + k ] * y[ k * 4 + j ];
+					r[ i * 4 + j ] = s;
+				}
+			return loadMatrix( r );
+		} );
+		measure<M>( "matrix", "matrixTranspose", []( const M& a, const M& )
+		{
+			Matrix4x4 m = a;
+			matrixTranspose( m );
+			return m;
+		} );
+	}
+
+	void benchQuaternion()
+	{
+		using V = __m256d;
+		measure<V>( "quaternion", "quaternionMultiply", []( V a, V b ) { return quaternionMultiply( a, b ); } );
+		measure<V>( "quaternion", "quaternionMultiply, naive", []( V a, V b )
+		{
+			alignas( 32 ) double p[ 4 ], q[ 4 ];
+			_mm256_store_pd( p, a );
+			_mm256_store_pd( q, b );
+			return _mm256_setr_pd(
+				p[ 3 ] * q[ 0 ] + p[ 0 ] * q[ 3 ] + p[ 1 ] * q[ 2 ] - p[ 2 ] * q[ 1 ],
+				p[ 3 ] * q[ 1 ] - p[ 0 ] * q[ 2 ] + p[ 1 ] * q[ 3 ] + p[ 2 ] * q[ 0 ],
+				p[ 3 ] * q[ 2 ] + p[ 0 ] * q[ 1 ] - p[ 1 ] * q[ 0 ] + p[ 2 ] * q[ 3 ],
+				p[ 3 ] * q[ 3 ] - p[ 0 ] * q[ 0 ] - p[ 1 ] * q[ 1 ] - p[ 2 ] * q[ 2 ] );
+		} );
+		measure<V>( "quaternion", "quaternionNormalize", []( V a, V ) { return quaternionNormalize( a ); } );
+		measure<V>( "quaternion", "quaternionRollPitchYaw", []( V a, V ) { return quaternionRollPitchYaw( a ); } );
+		measure<V>( "quaternion", "quaternionRotationNormal", []( V a, V b ) { return quaternionRotationNormal( b, vectorGetX( a ) ); } );
+		measure<V>( "quaternion", "vector3Rotate", []( V a, V b ) { return vector3Rotate( a, b ); } );
+	}
+
+	template<eTrigPrecision precision>
+	void benchTrigTier( const char* tier )
+	{
+		using V = __m256d;
+		char name[ 64 ];
+		snprintf( name, sizeof( name ), "vectorSin<%s>", tier );
+		measure<V>( "trig", name, []( V a, V ) { return vectorSin<precision>( a ); } );
+		snprintf( name, sizeof( name ), "vectorCos<%s>", tier );
+		measure<V>( "trig", name, []( V a, V ) { return vectorCos<precision>( a ); } );
+		snprintf( name, sizeof( name ), "vectorSinCos<%s>", tier );
+		measure<V>( "trig", name, []( V a, V )
+		{
+			__m256d s, c;
+			vectorSinCos<precision>( s, c, a );
+			return _mm256_add_pd( s, c );
+		} );
+		snprintf( name, sizeof( name ), "vectorTan<%s>", tier );
+		measure<V>( "trig", name, []( V a, V ) { return vectorTan<precision>( a ); } );
+	}
+
+	void benchTranscendental()
+	{
+		using V = __m256d;
+		benchTrigTier<eTrigPrecision::Fast>( "Fast" );
+		benchTrigTier<eTrigPrecision::Default>( "Default" );
+		benchTrigTier<eTrigPrecision::Precise>( "Precise" );
+		measure<V>( "trig", "scalarSin", []( V a, V ) { return toVector( scalarSin( vectorGetX( a ) ) ); } );
+		measure<V>( "trig", "scalarTan", []( V a, V ) { return toVector( scalarTan( vectorGetX( a ) ) ); } );
+		measure<V>( "trig", "libm sin, 4 calls", []( V a, V ) { return scalar4( a, []( double x ) { return std::sin( x ); } ); } );
+		measure<V>( "trig", "libm cos, 4 calls", []( V a, V ) { return scalar4( a, []( double x ) { return std::cos( x ); } ); } );
+		measure<V>( "trig", "libm tan, 4 calls", []( V a, V ) { return scalar4( a, []( double x ) { return std::tan( x ); } ); } );
+
+		measure<V>( "exp", "vectorExp", []( V a, V ) { return vectorExp( a ); } );
+		measure<V>( "exp", "libm exp, 4 calls", []( V a, V ) { return scalar4( a, []( double x ) { return std::exp( x ); } ); } );
+		measure<V>( "exp", "vectorTanH", []( V a, V ) { return vectorTanH( a ); } );
+		measure<V>( "exp", "vectorTanHFast", []( V a, V ) { return vectorTanHFast( a ); } );
+		measure<V>( "exp", "libm tanh, 4 calls", []( V a, V ) { return scalar4( a, []( double x ) { return std::tanh( x ); } ); } );
+		measure<V>( "exp", "vectorSigmoid", []( V a, V ) { return vectorSigmoid( a ); } );
+		measure<V>( "exp", "vectorSoftplus", []( V a, V ) { return vectorSoftplus( a ); } );
+		measure<V>( "exp", "libm softplus, 4 calls", []( V a, V ) { return scalar4( a, []( double x ) { return std::log1p( std::exp( x ) ); } ); } );
+	}
+
+	// FNV-1a over the bytes of the vector, the naive baseline for the hashes
+	inline uint64_t fnv1a( __m256d v, size_t bytes )
+	{
+		alignas( 32 ) uint8_t tmp[ 32 ];
+		_mm256_store_pd( (double*)tmp, v );
+		uint64_t h = 14695981039346656037ull;
+		for( size_t i = 0; i < bytes; i++ )
+			h = ( h ^ tmp[ i ] ) * 1099511628211ull;
+		return h;
+	}
+
+	void benchHashes()
+	{
+		using V = __m256d;
+		measure<V>( "hash", "vectorHash64", []( V a, V ) { return toVector( vectorHash64( a ) ); } );
+		measure<V>( "hash", "vector3Hash64", []( V a, V ) { return toVector( vector3Hash64( a ) ); } );
+		measure<V>( "hash", "vectorHash32", []( V a, V ) { return toVector( (uint64_t)vectorHash32( a ) ); } );
+		measure<V>( "hash", "vector3Hash32", []( V a, V ) { return toVector( (uint64_t)vector3Hash32( a ) ); } );
+		measure<V>( "hash", "FNV-1a 24 bytes, naive", []( V a, V ) { return toVector( fnv1a( a, 24 ) ); } );
+
+		// The array versions hash many vectors per call, report them per vector
+		std::vector<uint64_t> hashes( batch );
+		const double* rsi = (const double*)g_vectorA;
+		print( "hash", "arrayHash64, per vector", "throughput", measureTicks( [ & ]() { arrayHash64( rsi, batch, hashes.data() ); } ) / batch );
+		print( "hash", "array3Hash64, per vector", "throughput", measureTicks( [ & ]() { array3Hash64( rsi, batch, hashes.data() ); } ) / batch );
+	}
+
+	void benchPredicates()
+	{
+		using V = __m256d;
+		measure<V>( "predicate", "vectorEqual", []( V a, V b ) { return toVector( (uint64_t)vectorEqual( a, b ) ); } );
+		measure<V>( "predicate", "vector3Less", []( V a, V b ) { return toVector( (uint64_t)vector3Less( a, b ) ); } );
+		measure<V>( "predicate", "vectorBitwiseEqual", []( V a, V b ) { return toVector( (uint64_t)vectorBitwiseEqual( a, b ) ); } );
+		measure<V>( "predicate", "vector3InBounds", []( V a, V b ) { return toVector( (uint64_t)vector3InBounds( a, b ) ); } );
+		measure<V>( "predicate", "vector3Equal, naive", []( V a, V b )
+		{
+			alignas( 32 ) double x[ 4 ], y[ 4 ];
+			_mm256_store_pd( x, a );
+			_mm256_store_pd( y, b );
+			return toVector( (uint64_t)( x[ 0 ] == y[ 0 ] && x[ 1 ] == y[ 1 ] && x[ 2 ] == y[ 2 ] ) );
+		} );
+		measure<V>( "predicate", "orient3d", []( V a, V b ) { return toVector( orient3d( a, b, vectorSplatZ( a ), vectorSplatW( b ) ) ); } );
+	}
+}
+
+void benchMicro()
+{
+	makeInputs();
+	if( !csvOutput() )
+		printf( "Microbenchmarks, %s build\n", instructionSet() );
+	benchMemory();
+	benchVector();
+	benchMatrix();
+	benchQuaternion();
+	benchTranscendental();
+	benchHashes();
+	benchPredicates();
+}
\ No newline at end of file
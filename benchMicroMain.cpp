@@ -0,0 +1,14 @@
+#include "benchmarks.h"
+#include "benchMisc.h"
+#include <string.h>
+
+// Entry point of the microbenchmark executables, CMake builds them for several instruction sets.
+// Usage: AvxMathMicro* [--csv]
+int main( int argc, char** argv )
+{
+	for( int i = 1; i < argc; i++ )
+		if( 0 == strcmp( argv[ i ], "--csv" ) )
+			csvOutput() = true;
+	benchMicro();
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+#include "AvxMath/AvxMath.h"
+#include "testsMisc.h"
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+// Run the function several times, return the minimum count of TSC ticks per run
+template<class F>
+inline double measureTicks( F&& f, int repeats = 16 )
+{
+	uint64_t best = ~(uint64_t)0;
+	for( int i = 0; i < repeats; i++ )
+	{
+		const uint64_t t0 = __rdtsc();
+		f();
+		const uint64_t t1 = __rdtsc();
+		best = std::min( best, t1 - t0 );
+	}
+	return (double)best;
+}
+
+// Instruction set of the build, the library selects the code paths at compile time
+inline const char* instructionSet()
+{
+#if _AM_AVX2_INTRINSICS_
+	return "AVX2";
+#elif _AM_FMA3_INTRINSICS_
+	return "AVX+FMA3";
+#else
+	return "AVX";
+#endif
+}
+
+// When true, printResult makes CSV lines for regression tracking: instruction set, group, name, value, unit
+inline bool& csvOutput()
+{
+	static bool csv = false;
+	return csv;
+}
+
+// Print a line with the result of a benchmark
+inline void printResult( const char* group, const char* name, double value, const char* unit )
+{
+	if( csvOutput() )
+		printf( "%s,%s,\"%s\",%.4f,%s\n", instructionSet(), group, name, value, unit );
+	else
+		printf( "%-10s %-44s %12.3f %s\n", group, name, value, unit );
+}
+
+// The volatile store target of consume(), at namespace scope because GCC warns about local variables which are only written
+inline volatile double g_sink;
+
+// Prevent the compiler from optimizing away the computations which produced the vector
+inline void consume( __m256d vec )
+{
+	g_sink = _mm256_cvtsd_f64( vec );
+}
+
+// Frequency of the TSC counter in Hz, measured once against the steady clock
+inline double tscFrequency()
+{
+	static const double freq = []()
+	{
+		using clock = std::chrono::steady_clock;
+		const auto begin = clock::now();
+		const uint64_t t0 = __rdtsc();
+		while( clock::now() - begin < std::chrono::milliseconds( 100 ) )
+			;
+		const uint64_t t1 = __rdtsc();
+		const std::chrono::duration<double> elapsed = clock::now() - begin;
+		return (double)( t1 - t0 ) / elapsed.count();
+	}();
+	return freq;
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "benchmarks.h"
+#include "benchMisc.h"
+#include <vector>
+
+namespace
+{
+	using namespace AvxMath;
+
+	double seconds( uint64_t ticks )
+	{
+		return (double)ticks / tscFrequency();
+	}
+
+	void print( const char* name, size_t points, double ticks )
+	{
+		printResult( "nurbs", name, points / seconds( (uint64_t)ticks ) * 1E-6, "M points/second" );
+	}
+
+	// Uniform clamped knot vector on [ 0 .. 1 ] domain
+	std::vector<double> uniformKnots( size_t count, uint32_t degree )
+	{
+		std::vector<double> knots( count + degree + 1 );
+		for( size_t i = 0; i < knots.size(); i++ )
+		{
+			const double k = (double)( (ptrdiff_t)i - (ptrdiff_t)degree ) / (double)( count - degree );
+			knots[ i ] = std::min( std::max( k, 0.0 ), 1.0 );
+		}
+		return knots;
+	}
+
+	std::vector<double> randomArray( Random& rng, size_t count, double offset )
+	{
+		std::vector<double> res( count );
+		for( double& v : res )
+			v = rng.next() * 0.5 + offset;
+		return res;
+	}
+
+	// Evenly spaced parameters in [ 0 .. 1 ]
+	std::vector<double> uniformParameters( size_t count )
+	{
+		std::vector<double> res( count );
+		for( size_t i = 0; i < count; i++ )
+			res[ i ] = (double)i / (double)( count - 1 );
+		return res;
+	}
+}
+
+void benchNurbs()
+{
+	Random rng;
+	constexpr size_t samples = 1 << 16;
+	const std::vector<double> t = uniformParameters( samples );
+	std::vector<double> pos( samples * 3 ), d1( samples * 3 ), d2( samples * 3 );
+
+	// Cubic Bezier curve
+	const std::vector<double> bezier = randomArray( rng, 12, 0 );
+	print( "cubic Bezier", samples, measureTicks( [ & ]() { bezierEvaluate( bezier.data(), nullptr, 4, t.data(), samples, pos.data() ); } ) );
+	print( "cubic Bezier, 2 derivatives", samples, measureTicks( [ & ]() { bezierEvaluate( bezier.data(), nullptr, 4, t.data(), samples, pos.data(), d1.data(), d2.data() ); } ) );
+
+	// Cubic rational curve with 100 control points, the parameters are sorted like in a toolpath
+	constexpr size_t controlPoints = 100;
+	const std::vector<double> points = randomArray( rng, controlPoints * 3, 0 );
+	const std::vector<double> weights = randomArray( rng, controlPoints, 1.25 );
+	const std::vector<double> knots = uniformKnots( controlPoints, 3 );
+	const NurbsCurve curve{ points.data(), weights.data(), knots.data(), controlPoints, 3 };
+	print( "NURBS curve, cubic", samples, measureTicks( [ & ]() { nurbsEvaluate( curve, t.data(), samples, pos.data() ); } ) );
+	print( "NURBS curve, cubic, 2 derivatives", samples, measureTicks( [ & ]() { nurbsEvaluate( curve, t.data(), samples, pos.data(), d1.data(), d2.data() ); } ) );
+	std::vector<double> randomT = randomArray( rng, samples, 0.5 );
+	print( "NURBS curve, cubic, random parameters", samples, measureTicks( [ & ]() { nurbsEvaluate( curve, randomT.data(), samples, pos.data() ); } ) );
+
+	// Bicubic rational surface with 32x32 control points
+	constexpr size_t net = 32, grid = 512;
+	const std::vector<double> netPoints = randomArray( rng, net * net * 3, 0 );
+	const std::vector<double> netWeights = randomArray( rng, net * net, 1.25 );
+	const std::vector<double> netKnots = uniformKnots( net, 3 );
+	const NurbsSurface surface{ netPoints.data(), netWeights.data(), netKnots.data(), netKnots.data(), net, net, 3, 3 };
+	const std::vector<double> uv = uniformParameters( grid );
+	std::vector<double> out[ 6 ];
+	for( auto& o : out )
+		o.resize( grid * grid * 3 );
+	SurfaceGrid positions;
+	positions.position = out[ 0 ].data();
+	print( "surface grid, bicubic", grid * grid, measureTicks( [ & ]() { nurbsEvaluateGrid( surface, uv.data(), grid, uv.data(), grid, positions ); }, 4 ) );
+	SurfaceGrid all;
+	all.position = out[ 0 ].data();
+	all.du = out[ 1 ].data();
+	all.dv = out[ 2 ].data();
+	all.duu = out[ 3 ].data();
+	all.duv = out[ 4 ].data();
+	all.dvv = out[ 5 ].data();
+	print( "surface grid, bicubic, 2 derivatives", grid * grid, measureTicks( [ & ]() { nurbsEvaluateGrid( surface, uv.data(), grid, uv.data(), grid, all ); }, 4 ) );
+
+	// Tessellation into positions, normals and triangles
+	constexpr size_t tess = 1024;
+	std::vector<double> tessPositions( tess * tess * 3 ), tessNormals( tess * tess * 3 );
+	std::vector<uint32_t> indices( ( tess - 1 ) * ( tess - 1 ) * 6 );
+	for( bool parallel : { false, true } )
+	{
+		print( parallel ? "tessellate 1024x1024, parallel" : "tessellate 1024x1024", tess * tess, measureTicks( [ & ]()
+		{
+			nurbsTessellate( surface, tess, tess, tessPositions.data(), tessNormals.data(), indices.data(), parallel );
+		}, 4 ) );
+	}
+}
\ No newline at end of file
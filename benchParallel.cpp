@@ -0,0 +1,89 @@
+#include "benchmarks.h"
+#include "benchMisc.h"
+#include "AvxMath/AvxMathParallel.h"
+#include <vector>
+#include <cmath>
+
+namespace
+{
+	using namespace AvxMath;
+
+	double seconds( uint64_t ticks )
+	{
+		return (double)ticks / tscFrequency();
+	}
+
+	// 1, 2, 4, ... threads, and finally all of them
+	std::vector<size_t> threadCounts()
+	{
+		const size_t all = parallelThreadsLimit();
+		std::vector<size_t> res;
+		for( size_t i = 1; i < all; i *= 2 )
+			res.push_back( i );
+		res.push_back( all );
+		return res;
+	}
+
+	void print( const char* what, size_t threads, double ticks, double baseline )
+	{
+		char name[ 64 ];
+		snprintf( name, sizeof( name ), "%s, %zu threads", what, threads );
+		printResult( "parallel", name, seconds( (uint64_t)ticks ) * 1000, "milliseconds" );
+		snprintf( name, sizeof( name ), "%s, %zu threads, speedup", what, threads );
+		printResult( "parallel", name, baseline / ticks, "x" );
+	}
+}
+
+void benchParallel()
+{
+	// Angles for the trigonometry, and a helix for the arc length
+	constexpr size_t length = 1 << 24;
+	std::vector<double> angles( length ), result( length );
+	for( size_t i = 0; i < length; i++ )
+		angles[ i ] = (double)( i % 1000 ) * 0.013 - 6.5;
+	constexpr size_t points = 1 << 22;
+	std::vector<double> helix( points * 3 ), arc( points );
+	for( size_t i = 0; i < points; i++ )
+	{
+		const double t = (double)i * 1E-3;
+		helix[ i * 3 ] = std::cos( t );
+		helix[ i * 3 + 1 ] = std::sin( t );
+		helix[ i * 3 + 2 ] = t * 0.1;
+	}
+	std::vector<double> sortSource( points * 3 ), sortData;
+	for( size_t i = 0; i < sortSource.size(); i++ )
+		sortSource[ i ] = angles[ ( i * 7919 ) % length ];
+
+	const size_t limit = parallelThreadsLimit();
+	double baseline[ 3 ] = {};
+	for( size_t threads : threadCounts() )
+	{
+		setParallelThreads( threads );
+
+		// Cost of an empty loop, dominated by the synchronization
+		double ticks = measureTicks( [ & ]() { parallelFor( length, 1 << 10, []( size_t, size_t ) {} ); }, 64 );
+		char name[ 64 ];
+		snprintf( name, sizeof( name ), "empty parallelFor, %zu threads", threads );
+		printResult( "parallel", name, seconds( (uint64_t)ticks ) * 1E6, "microseconds" );
+
+		ticks = measureTicks( [ & ]() { arraySin( angles.data(), result.data(), length, true ); }, 4 );
+		if( threads == 1 )
+			baseline[ 0 ] = ticks;
+		print( "arraySin 16M", threads, ticks, baseline[ 0 ] );
+
+		ticks = measureTicks( [ & ]() { polylineArcLength( helix.data(), points, arc.data(), true ); }, 4 );
+		if( threads == 1 )
+			baseline[ 1 ] = ticks;
+		print( "polylineArcLength 4M", threads, ticks, baseline[ 1 ] );
+
+		ticks = measureTicks( [ & ]()
+		{
+			sortData = sortSource;
+			array3Sort( sortData.data(), points, true );
+		}, 2 );
+		if( threads == 1 )
+			baseline[ 2 ] = ticks;
+		print( "array3Sort 4M", threads, ticks, baseline[ 2 ] );
+	}
+	setParallelThreads( limit );
+}
\ No newline at end of file
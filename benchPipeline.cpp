@@ -0,0 +1,70 @@
+#include "benchmarks.h"
+#include "benchMisc.h"
+#include <vector>
+
+namespace
+{
+	using namespace AvxMath;
+
+	// Sequential loop written by hand, one vector at a time
+	void transformNormalizeLoop( const double* rsi, double* rdi, size_t count, const Matrix4x4& mat )
+	{
+		for( size_t i = 0; i < count; i++, rsi += 3, rdi += 3 )
+			storeDouble3( rdi, vector3Normalize( vector3Transform( loadDouble3( rsi ), mat ) ) );
+	}
+
+	void transformCoordLoop( const double* rsi, double* rdi, size_t count, const Matrix4x4& mat )
+	{
+		for( size_t i = 0; i < count; i++, rsi += 3, rdi += 3 )
+			storeDouble3( rdi, vector3TransformCoord( loadDouble3( rsi ), mat ) );
+	}
+
+	void print( const char* name, size_t count, double ticks )
+	{
+		printResult( "pipeline", name, ticks / (double)count, "ticks/vector" );
+	}
+}
+
+void benchPipeline()
+{
+	Matrix4x4 mat;
+	mat.r0 = _mm256_setr_pd( 0.8, -0.6, 0.1, 3 );
+	mat.r1 = _mm256_setr_pd( 0.6, 0.8, 0.2, -2 );
+	mat.r2 = _mm256_setr_pd( -0.1, 0.3, 1.5, 0.5 );
+	mat.r3 = _mm256_setr_pd( 0.01, 0.02, 0.03, 1 );
+	const auto transformNormalize = makePipeline( PipeTransform{ mat }, PipeNormalize{} );
+	const auto transformCoord = makePipeline( PipeTransformCoord{ mat } );
+
+	// 64k vectors fit in L2 cache, 4M vectors are limited by the memory bandwidth
+	for( size_t count : { (size_t)1 << 16, (size_t)1 << 22 } )
+	{
+		std::vector<double> source( count * 3 ), dest( count * 3 );
+		for( size_t i = 0; i < source.size(); i++ )
+			source[ i ] = (double)( ( i * 7919 ) % 1000 ) * 0.01 - 5;
+		const int repeats = count > 100000 ? 4 : 64;
+		const bool large = count > 100000;
+
+		double ticks = measureTicks( [ & ]() { transformNormalizeLoop( source.data(), dest.data(), count, mat ); }, repeats );
+		print( large ? "transform, normalize, 4M, loop" : "transform, normalize, 64k, loop", count, ticks );
+		ticks = measureTicks( [ & ]() { transformNormalize.run( source.data(), dest.data(), count ); }, repeats );
+		print( large ? "transform, normalize, 4M, pipeline" : "transform, normalize, 64k, pipeline", count, ticks );
+
+		ticks = measureTicks( [ & ]() { transformCoordLoop( source.data(), dest.data(), count, mat ); }, repeats );
+		print( large ? "transform coord, 4M, loop" : "transform coord, 64k, loop", count, ticks );
+		ticks = measureTicks( [ & ]() { transformCoord.run( source.data(), dest.data(), count ); }, repeats );
+		print( large ? "transform coord, 4M, pipeline" : "transform coord, 64k, pipeline", count, ticks );
+
+		// FP32 input and output: converting through a temporary FP64 array, versus the conversions fused into the pipeline
+		std::vector<float> floats( count * 3 ), floatsOut( count * 3 );
+		arrayDoubleToFloat( source.data(), floats.data(), count * 3 );
+		ticks = measureTicks( [ & ]()
+		{
+			arrayFloatToDouble( floats.data(), dest.data(), count * 3 );
+			transformNormalize.run( dest.data(), dest.data(), count );
+			arrayDoubleToFloat( dest.data(), floatsOut.data(), count * 3 );
+		}, repeats );
+		print( large ? "FP32 transform, normalize, 4M, temporary" : "FP32 transform, normalize, 64k, temporary", count, ticks );
+		ticks = measureTicks( [ & ]() { transformNormalize.run( floats.data(), floatsOut.data(), count ); }, repeats );
+		print( large ? "FP32 transform, normalize, 4M, pipeline" : "FP32 transform, normalize, 64k, pipeline", count, ticks );
+	}
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "benchmarks.h"
+#include "benchMisc.h"
+#include <vector>
+#include <cmath>
+
+namespace
+{
+	using namespace AvxMath;
+
+	// Toolpath-like polyline: a spiral with a small noise, 4M points
+	std::vector<double> makePath( size_t count )
+	{
+		std::vector<double> xyz;
+		xyz.reserve( count * 3 );
+		Random rng;
+		for( size_t i = 0; i < count; i++ )
+		{
+			const double noise = rng.nextUnit() * 0x1p-10;
+			const double a = (double)i * 1E-3;
+			const double r = 10 + a * 0.01 + noise;
+			xyz.insert( xyz.end(), { r * std::cos( a ), r * std::sin( a ), a * 0.001 } );
+		}
+		return xyz;
+	}
+
+	double arcLengthScalar( const double* xyz, size_t count, double* arcLength )
+	{
+		double acc = 0;
+		arcLength[ 0 ] = 0;
+		for( size_t i = 1; i < count; i++, xyz += 3 )
+		{
+			const double dx = xyz[ 3 ] - xyz[ 0 ], dy = xyz[ 4 ] - xyz[ 1 ], dz = xyz[ 5 ] - xyz[ 2 ];
+			acc += std::sqrt( dx * dx + dy * dy + dz * dz );
+			arcLength[ i ] = acc;
+		}
+		return acc;
+	}
+
+	// The typical resampling code: binary search for every sample
+	void resampleScalar( const double* xyz, const double* arcLength, size_t count, double* result, size_t samples )
+	{
+		const double step = arcLength[ count - 1 ] / (double)( samples - 1 );
+		for( size_t k = 0; k < samples; k++, result += 3 )
+		{
+			const double s = (double)k * step;
+			size_t j = std::upper_bound( arcLength, arcLength + count, s ) - arcLength;
+			j = std::min( std::max( j, (size_t)1 ), count - 1 ) - 1;
+			const double len = arcLength[ j + 1 ] - arcLength[ j ];
+			const double t = len > 0 ? ( s - arcLength[ j ] ) / len : 0.0;
+			for( int c = 0; c < 3; c++ )
+				result[ c ] = xyz[ j * 3 + c ] + ( xyz[ j * 3 + 3 + c ] - xyz[ j * 3 + c ] ) * t;
+		}
+	}
+
+	void print( const char* name, double ticks, size_t count, const char* unit )
+	{
+		printResult( "polyline", name, ticks / (double)count, unit );
+	}
+}
+
+void benchPolyline()
+{
+	constexpr size_t count = (size_t)1 << 22;
+	constexpr size_t samples = count / 3;
+	const std::vector<double> xyz = makePath( count );
+	std::vector<double> buffer( count ), arc( count ), result( samples * 3 );
+
+	double ticks = measureTicks( [ & ]() { arcLengthScalar( xyz.data(), count, arc.data() ); } );
+	print( "arc length, scalar", ticks, count, "ticks/point" );
+	for( bool parallel : { false, true } )
+	{
+		ticks = measureTicks( [ & ]() { polylineSegmentLengths( xyz.data(), count, buffer.data(), parallel ); } );
+		print( parallel ? "segment lengths, parallel" : "segment lengths", ticks, count, "ticks/point" );
+		ticks = measureTicks( [ & ]() { polylineArcLength( xyz.data(), count, arc.data(), parallel ); } );
+		print( parallel ? "arc length, parallel" : "arc length", ticks, count, "ticks/point" );
+		ticks = measureTicks( [ & ]() { polylineCurvature( xyz.data(), count, buffer.data(), parallel ); } );
+		print( parallel ? "curvature, parallel" : "curvature", ticks, count, "ticks/point" );
+	}
+
+	ticks = measureTicks( [ & ]() { resampleScalar( xyz.data(), arc.data(), count, result.data(), samples ); } );
+	print( "resample, binary search", ticks, samples, "ticks/sample" );
+	for( bool parallel : { false, true } )
+	{
+		ticks = measureTicks( [ & ]() { polylineResample( xyz.data(), arc.data(), count, result.data(), samples, parallel ); } );
+		print( parallel ? "resample, parallel" : "resample", ticks, samples, "ticks/sample" );
+	}
+}
\ No newline at end of file
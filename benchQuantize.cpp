@@ -0,0 +1,81 @@
+#include "benchmarks.h"
+#include "benchMisc.h"
+#include <vector>
+#include <cmath>
+
+namespace
+{
+	using namespace AvxMath;
+
+	double seconds( uint64_t ticks )
+	{
+		return (double)ticks / tscFrequency();
+	}
+
+	void print( const char* name, size_t count, double ticks )
+	{
+		printResult( "quantize", name, (double)count / seconds( (uint64_t)ticks ) * 1E-6, "M points/second" );
+	}
+
+	// Scalar loop with lround, the baseline
+	void quantizeScalar( const double* rsi, size_t length, double scale, int64_t* rdi )
+	{
+		for( size_t i = 0; i < length; i++ )
+			rdi[ i ] = AvxMath::lround( rsi[ i ] * scale );
+	}
+}
+
+void benchQuantize()
+{
+	// 32k 2D points in L2 cache, limited by the computations
+	{
+		constexpr size_t small = 1 << 15;
+		std::vector<double> source( small * 2 );
+		for( size_t i = 0; i < source.size(); i++ )
+			source[ i ] = (double)( ( i * 7919 ) % 1000003 ) * 1E-3 - 500;
+		std::vector<int64_t> dest( small * 2 );
+		double ticks = measureTicks( [ & ]() { quantizeScalar( source.data(), source.size(), 1E+6, dest.data() ); }, 64 );
+		print( "2D, 32k, int64, lround", small, ticks );
+		ticks = measureTicks( [ & ]() { array2Quantize( source.data(), small, _mm_setzero_pd(), 1E+6, dest.data() ); }, 64 );
+		print( "2D, 32k, int64", small, ticks );
+		ticks = measureTicks( [ & ]() { array2Dequantize( dest.data(), small, _mm_setzero_pd(), 1E+6, source.data() ); }, 64 );
+		print( "2D, 32k, int64, dequantize", small, ticks );
+	}
+
+	// 100M 2D points, 1.6 GB of FP64 numbers, plus the same size of int64 ones
+	constexpr size_t count = 100'000'000;
+	const double scale = 1E+6;
+	std::vector<double> xy( count * 2 );
+	for( size_t i = 0; i < xy.size(); i++ )
+		xy[ i ] = (double)( ( i * 7919 ) % 1000003 ) * 1E-3 - 500;
+
+	std::vector<int64_t> q64( count * 2 );
+	double ticks = measureTicks( [ & ]() { quantizeScalar( xy.data(), xy.size(), scale, q64.data() ); }, 2 );
+	print( "2D, 100M, int64, lround", count, ticks );
+	ticks = measureTicks( [ & ]() { array2Quantize( xy.data(), count, _mm_setzero_pd(), scale, q64.data() ); }, 2 );
+	print( "2D, 100M, int64", count, ticks );
+	ticks = measureTicks( [ & ]() { array2Quantize( xy.data(), count, _mm_setzero_pd(), scale, q64.data(), nullptr, true ); }, 2 );
+	print( "2D, 100M, int64, parallel", count, ticks );
+	{
+		std::vector<int32_t> q32( count * 2 );
+		ticks = measureTicks( [ & ]() { array2Quantize( xy.data(), count, _mm_setzero_pd(), scale, q32.data() ); }, 2 );
+		print( "2D, 100M, int32", count, ticks );
+	}
+
+	// The overflow bytes add 100 MB of writes
+	{
+		std::vector<uint8_t> overflow( count );
+		ticks = measureTicks( [ & ]() { array2Quantize( xy.data(), count, _mm_setzero_pd(), scale, q64.data(), overflow.data() ); }, 2 );
+		print( "2D, 100M, int64, overflow masks", count, ticks );
+	}
+
+	ticks = measureTicks( [ & ]() { array2Dequantize( q64.data(), count, _mm_setzero_pd(), scale, xy.data() ); }, 2 );
+	print( "2D, 100M, int64, dequantize", count, ticks );
+
+	// 3D points, reusing the memory: 2/3 of the count
+	const size_t count3 = count * 2 / 3;
+	ticks = measureTicks( [ & ]() { array3Quantize( xy.data(), count3, _mm256_setzero_pd(), scale, q64.data() ); }, 2 );
+	print( "3D, 67M, int64", count3, ticks );
+	ticks = measureTicks( [ & ]() { array3Dequantize( q64.data(), count3, _mm256_setzero_pd(), scale, xy.data() ); }, 2 );
+	print( "3D, 67M, int64, dequantize", count3, ticks );
+}
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include "benchmarks.h"
+#include "benchMisc.h"
+#include <vector>
+
+namespace
+{
+	using namespace AvxMath;
+
+	// Triangles in the unit cube, and rays from the outside towards the center of the cube.
+	// Soup of 1024 triangles in SoA blocks of 4, every block has 36 doubles: 4 x v0, 4 x v1, 4 x v2.
+	struct Scene
+	{
+		static constexpr size_t triangles = 1024;
+		static constexpr size_t rays = 256;
+		std::vector<double> soup;
+		std::vector<double> origins, dirs;
+
+		Scene()
+		{
+			Random rng;
+			soup.resize( triangles * 9 );
+			for( size_t i = 0; i < soup.size(); i += 9 )
+			{
+				// Triangles about 0.2 units large
+				const double cx = rng.next(), cy = rng.next(), cz = rng.next();
+				for( size_t j = 0; j < 9; j += 3 )
+				{
+					soup[ i + j ] = cx + rng.next() * 0.1;
+					soup[ i + j + 1 ] = cy + rng.next() * 0.1;
+					soup[ i + j + 2 ] = cz + rng.next() * 0.1;
+				}
+			}
+			// Reorder from AoS triangles to the blocks
+			std::vector<double> blocks( soup.size() );
+			for( size_t t = 0; t < triangles; t++ )
+				for( size_t v = 0; v < 3; v++ )
+					for( size_t c = 0; c < 3; c++ )
+						blocks[ ( t / 4 ) * 36 + v * 12 + ( t % 4 ) * 3 + c ] = soup[ t * 9 + v * 3 + c ];
+			soup.swap( blocks );
+
+			for( size_t i = 0; i < rays; i++ )
+			{
+				const double ox = rng.next() * 3, oy = rng.next() * 3, oz = rng.next() * 3;
+				origins.insert( origins.end(), { ox, oy, oz } );
+				dirs.insert( dirs.end(), { rng.next() * 0.3 - ox, rng.next() * 0.3 - oy, rng.next() * 0.3 - oz } );
+			}
+		}
+	};
+
+	void print( const char* name, double ticks, double tests, const char* rateUnit = "M ray/triangle tests/second" )
+	{
+		const double perTest = ticks / tests;
+		printResult( "ray", name, perTest, "ticks/test" );
+		char buffer[ 64 ];
+		snprintf( buffer, sizeof( buffer ), "%s, rate", name );
+		printResult( "ray", buffer, tscFrequency() / perTest * 1E-6, rateUnit );
+	}
+}
+
+void benchRay()
+{
+	const Scene scene;
+	const double tests = (double)( Scene::triangles * Scene::rays );
+	const size_t blocks = Scene::triangles / 4;
+
+	// 1 ray against 4 triangles per iteration
+	double ticks = measureTicks( [ & ]()
+	{
+		__m256d acc = _mm256_setzero_pd();
+		for( size_t r = 0; r < Scene::rays; r++ )
+		{
+			const __m256d origin = loadDouble3( &scene.origins[ r * 3 ] );
+			const __m256d dir = loadDouble3( &scene.dirs[ r * 3 ] );
+			for( size_t b = 0; b < blocks; b++ )
+			{
+				const double* rsi = &scene.soup[ b * 36 ];
+				const RayHit4 hit = intersectRayTriangles( origin, dir, loadVector3x4( rsi ), loadVector3x4( rsi + 12 ), loadVector3x4( rsi + 24 ) );
+				acc = _mm256_add_pd( acc, _mm256_and_pd( hit.mask, hit.t ) );
+			}
+		}
+		consume( acc );
+	} );
+	print( "1 ray x 4 triangles", ticks, tests );
+
+	ticks = measureTicks( [ & ]()
+	{
+		__m256d acc = _mm256_setzero_pd();
+		const __m256d tMax = _mm256_set1_pd( g_misc.infinity );
+		for( size_t r = 0; r < Scene::rays; r++ )
+		{
+			const WatertightRays4 ray = prepareWatertightRays( loadDouble3( &scene.origins[ r * 3 ] ), loadDouble3( &scene.dirs[ r * 3 ] ) );
+			for( size_t b = 0; b < blocks; b++ )
+			{
+				const double* rsi = &scene.soup[ b * 36 ];
+				const RayHit4 hit = intersectWatertight( ray, loadVector3x4( rsi ), loadVector3x4( rsi + 12 ), loadVector3x4( rsi + 24 ), tMax );
+				acc = _mm256_add_pd( acc, _mm256_and_pd( hit.mask, hit.t ) );
+			}
+		}
+		consume( acc );
+	} );
+	print( "1 ray x 4 triangles, watertight", ticks, tests );
+
+	// 4 rays against 1 triangle per iteration
+	// The triangles as 3 vertices, 4 doubles per vertex
+	std::vector<double> triangles( Scene::triangles * 12 );
+	for( size_t t = 0; t < Scene::triangles; t++ )
+		for( size_t v = 0; v < 3; v++ )
+			storeDouble4( &triangles[ t * 12 + v * 4 ], loadDouble3( &scene.soup[ ( t / 4 ) * 36 + v * 12 + ( t % 4 ) * 3 ] ) );
+
+	ticks = measureTicks( [ & ]()
+	{
+		__m256d acc = _mm256_setzero_pd();
+		for( size_t r = 0; r < Scene::rays; r += 4 )
+		{
+			const Vector3x4 origins = loadVector3x4( &scene.origins[ r * 3 ] );
+			const Vector3x4 dirs = loadVector3x4( &scene.dirs[ r * 3 ] );
+			for( size_t t = 0; t < Scene::triangles; t++ )
+			{
+				const double* tri = &triangles[ t * 12 ];
+				const RayHit4 hit = intersectRaysTriangle( origins, dirs, loadDouble4( tri ), loadDouble4( tri + 4 ), loadDouble4( tri + 8 ) );
+				acc = _mm256_add_pd( acc, _mm256_and_pd( hit.mask, hit.t ) );
+			}
+		}
+		consume( acc );
+	} );
+	print( "4 rays x 1 triangle", ticks, tests );
+
+	ticks = measureTicks( [ & ]()
+	{
+		__m256d acc = _mm256_setzero_pd();
+		for( size_t r = 0; r < Scene::rays; r += 4 )
+		{
+			const WatertightRays4 rays = prepareWatertightRays( loadVector3x4( &scene.origins[ r * 3 ] ), loadVector3x4( &scene.dirs[ r * 3 ] ) );
+			for( size_t t = 0; t < Scene::triangles; t++ )
+			{
+				const double* tri = &triangles[ t * 12 ];
+				const RayHit4 hit = intersectWatertight( rays, loadDouble4( tri ), loadDouble4( tri + 4 ), loadDouble4( tri + 8 ) );
+				acc = _mm256_add_pd( acc, _mm256_and_pd( hit.mask, hit.t ) );
+			}
+		}
+		consume( acc );
+	} );
+	print( "4 rays x 1 triangle, watertight", ticks, tests );
+
+	// Closest points, the ray origins scaled into the cube are the query positions
+	ticks = measureTicks( [ & ]()
+	{
+		__m256d acc = _mm256_setzero_pd();
+		const __m256d scale = _mm256_set1_pd( 1.0 / 3.0 );
+		for( size_t r = 0; r < Scene::rays; r++ )
+		{
+			const __m256d pos = _mm256_mul_pd( loadDouble3( &scene.origins[ r * 3 ] ), scale );
+			for( size_t b = 0; b < blocks; b++ )
+			{
+				const double* rsi = &scene.soup[ b * 36 ];
+				const TriangleClosestPoint4 cp = closestPointOnTriangles( pos, loadVector3x4( rsi ), loadVector3x4( rsi + 12 ), loadVector3x4( rsi + 24 ) );
+				acc = _mm256_add_pd( acc, cp.distanceSquared );
+			}
+		}
+		consume( acc );
+	} );
+	print( "closest point, 1 point x 4 triangles", ticks, tests, "M point/triangle tests/second" );
+}
\ No newline at end of file
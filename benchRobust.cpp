@@ -0,0 +1,227 @@
+#include "benchmarks.h"
+#include "benchMisc.h"
+#include <vector>
+
+namespace
+{
+	using namespace AvxMath;
+
+	// Coordinates of the queries in SoA layout, the arguments #0 .. #4 of the predicates
+	struct Queries
+	{
+		size_t count = 0;
+		std::vector<double> x[ 5 ], y[ 5 ], z[ 5 ];
+
+		void add( int arg, double px, double py, double pz )
+		{
+			x[ arg ].push_back( px );
+			y[ arg ].push_back( py );
+			z[ arg ].push_back( pz );
+		}
+
+		__m128d point2( int arg, size_t i ) const
+		{
+			return _mm_setr_pd( x[ arg ][ i ], y[ arg ][ i ] );
+		}
+		__m256d point3( int arg, size_t i ) const
+		{
+			return _mm256_setr_pd( x[ arg ][ i ], y[ arg ][ i ], z[ arg ][ i ], 0 );
+		}
+		Vector2x4 batch2( int arg, size_t i ) const
+		{
+			return Vector2x4{ _mm256_loadu_pd( &x[ arg ][ i ] ), _mm256_loadu_pd( &y[ arg ][ i ] ) };
+		}
+		Vector3x4 batch3( int arg, size_t i ) const
+		{
+			return Vector3x4{ _mm256_loadu_pd( &x[ arg ][ i ] ), _mm256_loadu_pd( &y[ arg ][ i ] ), _mm256_loadu_pd( &z[ arg ][ i ] ) };
+		}
+	};
+
+	// Random points in [ -1 .. +1 ] cube
+	Queries randomQueries( size_t count )
+	{
+		Random rng;
+		Queries q;
+		q.count = count;
+		for( size_t i = 0; i < count; i++ )
+			for( int arg = 0; arg < 5; arg++ )
+			{
+				const double x = rng.next(), y = rng.next(), z = rng.next();
+				q.add( arg, x, y, z );
+			}
+		return q;
+	}
+
+	enum struct Predicate : uint8_t
+	{
+		Orient2d,
+		Incircle,
+		Orient3d,
+		Insphere,
+	};
+
+	// Nearly degenerate queries: the last argument is within a few ULPs of the line, circle, plane or sphere through the rest of them.
+	// The filters fail for most of these, the timings measure the exact fallback.
+	Queries degenerateQueries( Predicate pred, size_t count )
+	{
+		Random rng;
+		Queries q;
+		q.count = count;
+		for( size_t i = 0; i < count; i++ )
+		{
+			const double i0 = rng.next() * 16, i1 = rng.next() * 16, i2 = rng.next() * 16;
+			switch( pred )
+			{
+			case Predicate::Orient2d:
+				// Line x = y
+				q.add( 0, 12, 12, 0 );
+				q.add( 1, 24, 24, 0 );
+				q.add( 2, 0.5 + i0 * 0x1p-53, 0.5 + i1 * 0x1p-53, 0 );
+				break;
+			case Predicate::Incircle:
+				// Circle of radius 5 around the origin, near ( 3, 4 ) point
+				q.add( 0, 5, 0, 0 );
+				q.add( 1, 0, 5, 0 );
+				q.add( 2, -5, 0, 0 );
+				q.add( 3, 3 + i0 * 0x1p-51, 4 + i1 * 0x1p-50, 0 );
+				break;
+			case Predicate::Orient3d:
+				// Plane z = x + y
+				q.add( 0, 3, 5, 8 );
+				q.add( 1, 7, -2, 5 );
+				q.add( 2, -4, 6, 2 );
+				q.add( 3, 0.5 + i0 * 0x1p-53, 0.5 + i1 * 0x1p-53, 1 + i2 * 0x1p-52 );
+				break;
+			case Predicate::Insphere:
+				// Sphere of radius 3 around the origin, near ( 1, 2, 2 ) point
+				q.add( 0, 0, 3, 0 );
+				q.add( 1, 3, 0, 0 );
+				q.add( 2, 0, 0, 3 );
+				q.add( 3, -3, 0, 0 );
+				q.add( 4, 1 + i0 * 0x1p-52, 2 + i1 * 0x1p-51, 2 + i2 * 0x1p-51 );
+				break;
+			}
+		}
+		return q;
+	}
+
+	// The plain floating-point determinants, same formulas as the filters
+	double orient2dNaive( const Queries& q, size_t i )
+	{
+		const double acx = q.x[ 0 ][ i ] - q.x[ 2 ][ i ], acy = q.y[ 0 ][ i ] - q.y[ 2 ][ i ];
+		const double bcx = q.x[ 1 ][ i ] - q.x[ 2 ][ i ], bcy = q.y[ 1 ][ i ] - q.y[ 2 ][ i ];
+		return acx * bcy - acy * bcx;
+	}
+
+	double incircleNaive( const Queries& q, size_t i )
+	{
+		const double adx = q.x[ 0 ][ i ] - q.x[ 3 ][ i ], ady = q.y[ 0 ][ i ] - q.y[ 3 ][ i ];
+		const double bdx = q.x[ 1 ][ i ] - q.x[ 3 ][ i ], bdy = q.y[ 1 ][ i ] - q.y[ 3 ][ i ];
+		const double cdx = q.x[ 2 ][ i ] - q.x[ 3 ][ i ], cdy = q.y[ 2 ][ i ] - q.y[ 3 ][ i ];
+		return ( adx * adx + ady * ady ) * ( bdx * cdy - cdx * bdy ) + ( bdx * bdx + bdy * bdy ) * ( cdx * ady - adx * cdy ) +
+			( cdx * cdx + cdy * cdy ) * ( adx * bdy - bdx * ady );
+	}
+
+	double orient3dNaive( const Queries& q, size_t i )
+	{
+		const double adx = q.x[ 0 ][ i ] - q.x[ 3 ][ i ], ady = q.y[ 0 ][ i ] - q.y[ 3 ][ i ], adz = q.z[ 0 ][ i ] - q.z[ 3 ][ i ];
+		const double bdx = q.x[ 1 ][ i ] - q.x[ 3 ][ i ], bdy = q.y[ 1 ][ i ] - q.y[ 3 ][ i ], bdz = q.z[ 1 ][ i ] - q.z[ 3 ][ i ];
+		const double cdx = q.x[ 2 ][ i ] - q.x[ 3 ][ i ], cdy = q.y[ 2 ][ i ] - q.y[ 3 ][ i ], cdz = q.z[ 2 ][ i ] - q.z[ 3 ][ i ];
+		return adz * ( bdx * cdy - cdx * bdy ) + bdz * ( cdx * ady - adx * cdy ) + cdz * ( adx * bdy - bdx * ady );
+	}
+
+	double insphereNaive( const Queries& q, size_t i )
+	{
+		double m[ 4 ][ 4 ];
+		for( int r = 0; r < 4; r++ )
+		{
+			m[ r ][ 0 ] = q.x[ r ][ i ] - q.x[ 4 ][ i ];
+			m[ r ][ 1 ] = q.y[ r ][ i ] - q.y[ 4 ][ i ];
+			m[ r ][ 2 ] = q.z[ r ][ i ] - q.z[ 4 ][ i ];
+			m[ r ][ 3 ] = m[ r ][ 0 ] * m[ r ][ 0 ] + m[ r ][ 1 ] * m[ r ][ 1 ] + m[ r ][ 2 ] * m[ r ][ 2 ];
+		}
+		const auto det3 = [ &m ]( int r0, int r1, int r2 )
+		{
+			return m[ r0 ][ 0 ] * ( m[ r1 ][ 1 ] * m[ r2 ][ 2 ] - m[ r2 ][ 1 ] * m[ r1 ][ 2 ] ) - m[ r1 ][ 0 ] * ( m[ r0 ][ 1 ] * m[ r2 ][ 2 ] - m[ r2 ][ 1 ] * m[ r0 ][ 2 ] ) +
+				m[ r2 ][ 0 ] * ( m[ r0 ][ 1 ] * m[ r1 ][ 2 ] - m[ r1 ][ 1 ] * m[ r0 ][ 2 ] );
+		};
+		return ( m[ 3 ][ 3 ] * det3( 0, 1, 2 ) - m[ 2 ][ 3 ] * det3( 0, 1, 3 ) ) + ( m[ 1 ][ 3 ] * det3( 0, 2, 3 ) - m[ 0 ][ 3 ] * det3( 1, 2, 3 ) );
+	}
+
+	// Run the predicate for all queries, return the count of positive results
+	template<class F>
+	size_t countPositive( size_t count, F&& f )
+	{
+		size_t res = 0;
+		for( size_t i = 0; i < count; i++ )
+			res += f( i ) > 0 ? 1 : 0;
+		return res;
+	}
+
+	template<class F>
+	size_t countPositive4( size_t count, F&& f )
+	{
+		size_t res = 0;
+		for( size_t i = 0; i < count; i += 4 )
+		{
+			const int mask = _mm256_movemask_pd( _mm256_cmp_pd( f( i ), _mm256_setzero_pd(), _CMP_GT_OQ ) );
+			res += (size_t)( ( mask & 1 ) + ( ( mask >> 1 ) & 1 ) + ( ( mask >> 2 ) & 1 ) + ( mask >> 3 ) );
+		}
+		return res;
+	}
+
+	void print( const char* input, const char* name, double ticks, size_t count )
+	{
+		char buffer[ 64 ];
+		snprintf( buffer, sizeof( buffer ), "%s, %s", input, name );
+		printResult( "robust", buffer, ticks / (double)count, "ticks/query" );
+	}
+
+	// Source of the queries for each predicate
+	template<class F>
+	void benchQueries( const char* input, F&& makeQueries )
+	{
+		size_t positive = 0;
+		size_t n = 0;
+		const auto measure = [ & ]( const char* name, auto&& fn )
+		{
+			print( input, name, measureTicks( [ & ]() { positive += fn(); } ), n );
+		};
+
+		Queries q = makeQueries( Predicate::Orient2d );
+		n = q.count;
+
+		measure( "orient2d, naive", [ & ]() { return countPositive( n, [ & ]( size_t i ) { return orient2dNaive( q, i ); } ); } );
+		measure( "orient2d", [ & ]() { return countPositive( n, [ & ]( size_t i ) { return orient2d( q.point2( 0, i ), q.point2( 1, i ), q.point2( 2, i ) ); } ); } );
+		measure( "orient2d4", [ & ]() { return countPositive4( n, [ & ]( size_t i ) { return orient2d4( q.batch2( 0, i ), q.batch2( 1, i ), q.batch2( 2, i ) ); } ); } );
+		measure( "orient2dExact", [ & ]() { return countPositive( n, [ & ]( size_t i ) { return orient2dExact( q.point2( 0, i ), q.point2( 1, i ), q.point2( 2, i ) ); } ); } );
+
+		q = makeQueries( Predicate::Incircle );
+		measure( "incircle, naive", [ & ]() { return countPositive( n, [ & ]( size_t i ) { return incircleNaive( q, i ); } ); } );
+		measure( "incircle", [ & ]() { return countPositive( n, [ & ]( size_t i ) { return incircle( q.point2( 0, i ), q.point2( 1, i ), q.point2( 2, i ), q.point2( 3, i ) ); } ); } );
+		measure( "incircle4", [ & ]() { return countPositive4( n, [ & ]( size_t i ) { return incircle4( q.batch2( 0, i ), q.batch2( 1, i ), q.batch2( 2, i ), q.batch2( 3, i ) ); } ); } );
+		measure( "incircleExact", [ & ]() { return countPositive( n, [ & ]( size_t i ) { return incircleExact( q.point2( 0, i ), q.point2( 1, i ), q.point2( 2, i ), q.point2( 3, i ) ); } ); } );
+
+		q = makeQueries( Predicate::Orient3d );
+		measure( "orient3d, naive", [ & ]() { return countPositive( n, [ & ]( size_t i ) { return orient3dNaive( q, i ); } ); } );
+		measure( "orient3d", [ & ]() { return countPositive( n, [ & ]( size_t i ) { return orient3d( q.point3( 0, i ), q.point3( 1, i ), q.point3( 2, i ), q.point3( 3, i ) ); } ); } );
+		measure( "orient3d4", [ & ]() { return countPositive4( n, [ & ]( size_t i ) { return orient3d4( q.batch3( 0, i ), q.batch3( 1, i ), q.batch3( 2, i ), q.batch3( 3, i ) ); } ); } );
+		measure( "orient3dExact", [ & ]() { return countPositive( n, [ & ]( size_t i ) { return orient3dExact( q.point3( 0, i ), q.point3( 1, i ), q.point3( 2, i ), q.point3( 3, i ) ); } ); } );
+
+		q = makeQueries( Predicate::Insphere );
+		measure( "insphere, naive", [ & ]() { return countPositive( n, [ & ]( size_t i ) { return insphereNaive( q, i ); } ); } );
+		measure( "insphere", [ & ]() { return countPositive( n, [ & ]( size_t i ) { return insphere( q.point3( 0, i ), q.point3( 1, i ), q.point3( 2, i ), q.point3( 3, i ), q.point3( 4, i ) ); } ); } );
+		measure( "insphere4", [ & ]() { return countPositive4( n, [ & ]( size_t i ) { return insphere4( q.batch3( 0, i ), q.batch3( 1, i ), q.batch3( 2, i ), q.batch3( 3, i ), q.batch3( 4, i ) ); } ); } );
+		measure( "insphereExact", [ & ]() { return countPositive( n, [ & ]( size_t i ) { return insphereExact( q.point3( 0, i ), q.point3( 1, i ), q.point3( 2, i ), q.point3( 3, i ), q.point3( 4, i ) ); } ); } );
+
+		consume( _mm256_set1_pd( (double)positive ) );
+	}
+}
+
+void benchRobust()
+{
+	// Random points: the filters certify nearly all signs. Degenerate points: the exact arithmetic runs for most queries.
+	constexpr size_t count = 1 << 12;
+	benchQueries( "random", []( Predicate ) { return randomQueries( count ); } );
+	benchQueries( "degenerate", []( Predicate pred ) { return degenerateQueries( pred, count ); } );
+}
\ No newline at end of file
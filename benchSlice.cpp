@@ -0,0 +1,46 @@
+#include "benchmarks.h"
+#include "benchMisc.h"
+#include <vector>
+#include <cmath>
+
+namespace
+{
+	using namespace AvxMath;
+
+	double seconds( uint64_t ticks )
+	{
+		return (double)ticks / tscFrequency();
+	}
+}
+
+void benchSlice()
+{
+	// 5M triangles sphere with 25 mm radius, sliced at 0.05 mm layers like a 3D printer would do
+	constexpr size_t tessellation = 1582;
+	constexpr double radius = 25, layerHeight = 0.05;
+	std::vector<double> xyz;
+	std::vector<uint32_t> indices;
+	makeSphere( radius, tessellation, tessellation, xyz, indices );
+	const size_t vertices = xyz.size() / 3, triangles = indices.size() / 3;
+	const size_t layers = (size_t)( 2 * radius / layerHeight );
+	const __m256d normal = _mm256_setr_pd( 0, 0, 1, 0 );
+	const __m256d tilted = _mm256_setr_pd( 0.3, 0.2, 1, 0 );
+
+	std::vector<SliceContours> result;
+	for( bool parallel : { false, true } )
+	{
+		const double ticks = measureTicks( [ & ]()
+		{
+			meshSlice( xyz.data(), vertices, indices.data(), triangles, normal, -radius + layerHeight * 0.5, layerHeight, layers, result, parallel );
+		}, 3 );
+		printResult( "slice", parallel ? "5M triangles, 1000 layers, parallel" : "5M triangles, 1000 layers", seconds( (uint64_t)ticks ) * 1000, "milliseconds" );
+		printResult( "slice", parallel ? "5M triangles, parallel" : "5M triangles", triangles / seconds( (uint64_t)ticks ) * 1E-6, "M triangles/second" );
+	}
+
+	// Tilted planes cross the rings of the sphere, the triangles are no longer sorted by height
+	const double ticks = measureTicks( [ & ]()
+	{
+		meshSlice( xyz.data(), vertices, indices.data(), triangles, tilted, -radius + layerHeight * 0.5, layerHeight, layers, result, true );
+	}, 3 );
+	printResult( "slice", "5M triangles, 1000 tilted layers, parallel", seconds( (uint64_t)ticks ) * 1000, "milliseconds" );
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "benchmarks.h"
+#include "benchMisc.h"
+#include <vector>
+#include <algorithm>
+
+namespace
+{
+	using namespace AvxMath;
+
+	// Random points in [ -1000 .. +1000 ] cube
+	std::vector<double> makePoints( size_t count )
+	{
+		std::vector<double> vec( count );
+		Random rng;
+		for( double& d : vec )
+			d = rng.nextUnit() * 2000.0 - 1000.0;
+		return vec;
+	}
+
+	// The baseline, std::sort of 3D vectors with vector3Less comparison
+	void sortStd3( double* rsi, size_t length )
+	{
+		struct alignas( 8 ) Vec3
+		{
+			double v[ 3 ];
+		};
+		Vec3* const begin = (Vec3*)rsi;
+		std::sort( begin, begin + length, []( const Vec3& a, const Vec3& b ) { return vector3Less( loadDouble3( a.v ), loadDouble3( b.v ) ); } );
+	}
+
+	void sortStd4( double* rsi, size_t length )
+	{
+		struct Vec4
+		{
+			double v[ 4 ];
+		};
+		Vec4* const begin = (Vec4*)rsi;
+		std::sort( begin, begin + length, []( const Vec4& a, const Vec4& b ) { return vectorLess( loadDouble4( a.v ), loadDouble4( b.v ) ); } );
+	}
+}
+
+void benchSort()
+{
+	for( size_t length : { (size_t)1 << 14, (size_t)1 << 20 } )
+	{
+		const std::vector<double> source = makePoints( length * 4 );
+		std::vector<double> data;
+		std::vector<uint32_t> indices( length );
+		const double count = (double)length;
+		char name[ 64 ];
+
+		const auto bench = [ & ]( const char* what, size_t lanes, auto fn )
+		{
+			const double ticks = measureTicks( [ & ]()
+			{
+				data.assign( source.begin(), source.begin() + length * lanes );
+				fn();
+			}, 4 );
+			snprintf( name, sizeof( name ), "%s, %zu", what, length );
+			printResult( "sort", name, ticks / count, "ticks/vector" );
+		};
+
+		bench( "copy only", 4, [] {} );
+		bench( "std::sort vector3Less", 3, [ & ] { sortStd3( data.data(), length ); } );
+		bench( "array3Sort", 3, [ & ] { array3Sort( data.data(), length ); } );
+		bench( "array3Sort parallel", 3, [ & ] { array3Sort( data.data(), length, true ); } );
+		bench( "array3SortIndices", 3, [ & ] { array3SortIndices( data.data(), length, indices.data() ); } );
+		bench( "std::sort vectorLess", 4, [ & ] { sortStd4( data.data(), length ); } );
+		bench( "arraySort", 4, [ & ] { arraySort( data.data(), length ); } );
+	}
+}
\ No newline at end of file
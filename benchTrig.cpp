@@ -0,0 +1,64 @@
+#include "benchmarks.h"
+#include "benchMisc.h"
+#include <vector>
+
+namespace
+{
+	using namespace AvxMath;
+
+	std::vector<double> makeAngles( size_t length )
+	{
+		std::vector<double> vec( length );
+		for( size_t i = 0; i < length; i++ )
+			vec[ i ] = (double)( i % 1000 ) * 0.013 - 6.5;
+		return vec;
+	}
+
+	// The baseline, one vector per loop iteration
+	template<eTrigPrecision precision>
+	void sinCosLoop( const double* rsi, double* sin, double* cos, size_t length )
+	{
+		for( size_t i = 0; i < length; i += 4 )
+		{
+			__m256d s, c;
+			vectorSinCos<precision>( s, c, _mm256_loadu_pd( rsi + i ) );
+			_mm256_storeu_pd( sin + i, s );
+			_mm256_storeu_pd( cos + i, c );
+		}
+	}
+
+	template<eTrigPrecision precision>
+	void benchTier( const char* tier, size_t length )
+	{
+		const std::vector<double> angles = makeAngles( length );
+		std::vector<double> sin( length ), cos( length );
+		const double elements = (double)length;
+		char name[ 64 ];
+
+		double ticks = measureTicks( [ & ]() { sinCosLoop<precision>( angles.data(), sin.data(), cos.data(), length ); } );
+		snprintf( name, sizeof( name ), "%s vectorSinCos loop, %zu", tier, length );
+		printResult( "trig", name, ticks / elements, "ticks/element" );
+
+		ticks = measureTicks( [ & ]() { arraySinCos<precision>( angles.data(), sin.data(), cos.data(), length ); } );
+		snprintf( name, sizeof( name ), "%s arraySinCos, %zu", tier, length );
+		printResult( "trig", name, ticks / elements, "ticks/element" );
+
+		ticks = measureTicks( [ & ]() { arraySinCos<precision>( angles.data(), sin.data(), cos.data(), length, true ); } );
+		snprintf( name, sizeof( name ), "%s arraySinCos parallel, %zu", tier, length );
+		printResult( "trig", name, ticks / elements, "ticks/element" );
+
+		ticks = measureTicks( [ & ]() { arrayTan<precision>( angles.data(), sin.data(), length ); } );
+		snprintf( name, sizeof( name ), "%s arrayTan, %zu", tier, length );
+		printResult( "trig", name, ticks / elements, "ticks/element" );
+	}
+}
+
+void benchTrig()
+{
+	for( size_t length : { (size_t)4096, (size_t)1 << 22 } )
+	{
+		benchTier<eTrigPrecision::Fast>( "Fast", length );
+		benchTier<eTrigPrecision::Default>( "Default", length );
+		benchTier<eTrigPrecision::Precise>( "Precise", length );
+	}
+}
\ No newline at end of file
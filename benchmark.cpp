@@ -0,0 +1,56 @@
+#include "benchmarks.h"
+#include "benchMisc.h"
+#include <string.h>
+
+namespace
+{
+	struct Benchmark
+	{
+		const char* name;
+		void( *run )( );
+	};
+
+	const Benchmark benchmarks[] =
+	{
+		{ "trig", &benchTrig },
+		{ "hash", &benchHash },
+		{ "sort", &benchSort },
+		{ "ray", &benchRay },
+		{ "bvh", &benchBvh },
+		{ "culling", &benchCulling },
+		{ "polyline", &benchPolyline },
+		{ "mesh", &benchMesh },
+		{ "robust", &benchRobust },
+		{ "doubledouble", &benchDoubleDouble },
+		{ "kdtree", &benchKdTree },
+		{ "nurbs", &benchNurbs },
+		{ "slice", &benchSlice },
+		{ "micro", &benchMicro },
+		{ "parallel", &benchParallel },
+		{ "pipeline", &benchPipeline },
+		{ "quantize", &benchQuantize },
+	};
+}
+
+// Usage: AvxMathBench [--csv] [names of the benchmarks]; without names, runs all of them
+int main( int argc, char** argv )
+{
+	bool any = false;
+	for( int i = 1; i < argc; i++ )
+	{
+		if( 0 == strcmp( argv[ i ], "--csv" ) )
+			csvOutput() = true;
+		else
+			any = true;
+	}
+
+	for( const Benchmark& b : benchmarks )
+	{
+		bool selected = !any;
+		for( int i = 1; i < argc && !selected; i++ )
+			selected = 0 == strcmp( argv[ i ], b.name );
+		if( selected )
+			b.run();
+	}
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#pragma once
+
+void benchTrig();
+void benchHash();
+void benchSort();
+void benchRay();
+void benchBvh();
+void benchCulling();
+void benchPolyline();
+void benchMesh();
+void benchRobust();
+void benchDoubleDouble();
+void benchKdTree();
+void benchNurbs();
+void benchSlice();
+void benchMicro();
+void benchParallel();
+void benchPipeline();
+void benchQuantize();
\ No newline at end of file
@@ -0,0 +1,323 @@
+#include "testAccuracy.h"
+#include "AvxMath/AvxMathParallel.h"
+#include <cmath>
+#include <float.h>
+#include <stdio.h>
+#include <string.h>
+#include <mutex>
+
+// On Linux and macOS long double is the 80-bit x87 type with 64-bit mantissa, precise enough to measure errors of a few ULP.
+// With Visual C++ long double is the same as double, the reference is then only as good as the C runtime library.
+
+namespace
+{
+	using namespace AvxMath;
+
+	using VectorFunc = __m256d( * )( __m256d x );
+	using ReferenceFunc = long double( * )( long double x );
+
+	// A range of arguments. Dense ranges are uniform grids including both ends, random ranges are uniformly distributed pseudo-random numbers.
+	struct Range
+	{
+		double begin, end;
+		bool random;
+	};
+
+	// A row of the table: kernel, reference, arguments, and the error limits.
+	// Zero limits are not checked. Absolute errors are useful for periodic functions, ULP errors explode near their zeros.
+	// Relative errors are for the low-precision approximations, where errors of millions ULP are expected.
+	struct Case
+	{
+		const char* name;
+		VectorFunc func;
+		ReferenceFunc reference;
+		Range range;
+		double maxUlp;
+		double maxAbs;
+		double maxRel;
+	};
+
+	struct Stats
+	{
+		double maxUlp = 0;
+		double sumUlp = 0;
+		double maxAbs = 0;
+		double maxRel = 0;
+		double worstArgument = 0;
+
+		void add( double x, double ulp, double abs, double rel )
+		{
+			if( ulp > maxUlp || ulp != ulp )
+			{
+				maxUlp = ulp;
+				worstArgument = x;
+			}
+			sumUlp += ulp;
+			maxAbs = std::max( maxAbs, abs );
+			maxRel = std::max( maxRel, rel );
+		}
+
+		void merge( const Stats& that )
+		{
+			if( that.maxUlp > maxUlp )
+			{
+				maxUlp = that.maxUlp;
+				worstArgument = that.worstArgument;
+			}
+			sumUlp += that.sumUlp;
+			maxAbs = std::max( maxAbs, that.maxAbs );
+			maxRel = std::max( maxRel, that.maxRel );
+		}
+	};
+
+	// SplitMix64 generator, makes the random arguments independent of the way the range is split across threads
+	inline uint64_t splitMix( uint64_t i )
+	{
+		uint64_t z = i * 0x9E3779B97F4A7C15ull + 0x9E3779B97F4A7C15ull;
+		z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ull;
+		z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBull;
+		return z ^ ( z >> 31 );
+	}
+
+	inline double argument( const Range& range, size_t i, size_t points )
+	{
+		double t;
+		if( range.random )
+			t = (double)( splitMix( i ) >> 11 ) * ( 1.0 / (double)( 1ull << 53 ) );
+		else
+			t = ( points > 1 ) ? (double)i / (double)( points - 1 ) : 0.0;
+		return range.begin + ( range.end - range.begin ) * t;
+	}
+
+	// Distance between the double closest to the reference, and the next representable double
+	inline long double ulpSize( long double ref )
+	{
+		const double r = std::max( (double)std::fabs( ref ), DBL_MIN );
+		int e;
+		std::frexp( r, &e );
+		return std::ldexp( 1.0L, e - 53 );
+	}
+
+	inline void accumulate( Stats& stats, double x, double result, long double ref )
+	{
+		if( result == ref )
+		{
+			stats.add( x, 0, 0, 0 );
+			return;
+		}
+		if( std::isnan( result ) || std::isinf( ref ) || std::isinf( result ) )
+		{
+			const double inf = std::numeric_limits<double>::infinity();
+			stats.add( x, inf, inf, inf );
+			return;
+		}
+		const long double abs = std::fabs( (long double)result - ref );
+		const long double rel = ( 0 != ref ) ? abs / std::fabs( ref ) : std::numeric_limits<long double>::infinity();
+		stats.add( x, (double)( abs / ulpSize( ref ) ), (double)abs, (double)rel );
+	}
+
+	Stats measure( const Case& c, size_t points )
+	{
+		Stats result;
+		std::mutex lock;
+		parallelFor( points, 1 << 14, [ & ]( size_t begin, size_t end )
+		{
+			Stats local;
+			alignas( 32 ) double x[ 4 ];
+			alignas( 32 ) double y[ 4 ];
+			for( size_t i = begin; i < end; i += 4 )
+			{
+				const size_t count = std::min( end - i, (size_t)4 );
+				for( size_t j = 0; j < 4; j++ )
+					x[ j ] = argument( c.range, i + std::min( j, count - 1 ), points );
+				_mm256_store_pd( y, c.func( _mm256_load_pd( x ) ) );
+				for( size_t j = 0; j < count; j++ )
+					accumulate( local, x[ j ], y[ j ], c.reference( x[ j ] ) );
+			}
+			std::lock_guard<std::mutex> guard{ lock };
+			result.merge( local );
+		} );
+		return result;
+	}
+
+	// ==== Kernels ====
+	// To measure a new function, add a wrapper here when its signature differs from __m256d( __m256d ), then add rows to the table below.
+
+	// Adapt the library functions to the same calling convention, some of them are _AM_CALL_, others are not
+	template<auto f>
+	__m256d kernel( __m256d x )
+	{
+		return f( x );
+	}
+
+	template<eTrigPrecision precision>
+	__m256d sinCosSin( __m256d x )
+	{
+		__m256d s, c;
+		vectorSinCos<precision>( s, c, x );
+		return s;
+	}
+
+	template<eTrigPrecision precision>
+	__m256d sinCosCos( __m256d x )
+	{
+		__m256d s, c;
+		vectorSinCos<precision>( s, c, x );
+		return c;
+	}
+
+	template<double( *f )( double )>
+	__m256d scalarLanes( __m256d x )
+	{
+		return _mm256_setr_pd( f( vectorGetX( x ) ), f( vectorGetY( x ) ), f( vectorGetZ( x ) ), f( vectorGetW( x ) ) );
+	}
+
+	// scalarSinCos returns [ cos, sin ]
+	template<int lane>
+	double scalarSinCosLane( double a )
+	{
+		const __m128d v = scalarSinCos( a );
+		return ( lane == 0 ) ? _mm_cvtsd_f64( v ) : _mm_cvtsd_f64( _mm_unpackhi_pd( v, v ) );
+	}
+
+	// Reciprocal of the function. Near the poles of tangent and cotangent the reciprocal is close to zero, its absolute error is meaningful there.
+	template<VectorFunc f>
+	__m256d reciprocal( __m256d x )
+	{
+		return _mm256_div_pd( _mm256_set1_pd( 1 ), f( x ) );
+	}
+
+	// Arctangent of the function. For the wide ranges with both zeros and poles of tangent, the absolute error of that angle is the error of the reduced argument.
+	template<VectorFunc f>
+	__m256d angleOf( __m256d x )
+	{
+		const __m256d y = f( x );
+		return _mm256_setr_pd( std::atan( vectorGetX( y ) ), std::atan( vectorGetY( y ) ), std::atan( vectorGetZ( y ) ), std::atan( vectorGetW( y ) ) );
+	}
+
+	long double refSin( long double x ) { return std::sin( x ); }
+	long double refCos( long double x ) { return std::cos( x ); }
+	long double refTan( long double x ) { return std::tan( x ); }
+	long double refCot( long double x ) { return 1.0L / std::tan( x ); }
+	long double refTanAngle( long double x ) { return std::atan( std::tan( x ) ); }
+	long double refCotAngle( long double x ) { return std::atan( 1.0L / std::tan( x ) ); }
+	long double refExp( long double x ) { return std::exp( x ); }
+	long double refTanH( long double x ) { return std::tanh( x ); }
+	long double refSigmoid( long double x ) { return 1.0L / ( 1.0L + std::exp( -x ) ); }
+	long double refSoftplus( long double x ) { return std::log1p( std::exp( x ) ); }
+
+	constexpr Range trigDense{ -g_pi * 2, g_pi * 2, false };
+	constexpr Range trigRandom{ -1000, 1000, true };
+	// Tangent away from the poles, and up to the pole; cotangent away from the pole and the zero, and near each of them
+	constexpr Range tanPrincipal{ -1.4, 1.4, false };
+	constexpr Range tanPole{ 1.4, g_pi / 2, false };
+	constexpr Range cotPrincipal{ 0.17, 1.4, false };
+	constexpr Range cotPole{ 0, 0.17, false };
+	constexpr Range cotZero{ 1.4, g_pi / 2, false };
+	// Around the zero of cosine, the precise tier reduces by pi/2 and keeps small relative errors there
+	constexpr Range cosZero{ g_pi / 2 - 1E-3, g_pi / 2 + 1E-3, false };
+
+	// The limits have some headroom above the errors measured with FMA3; with AVX1 the errors are slightly larger.
+	// Sine and cosine of the fast and default tiers are limited by absolute errors, the precise tier is limited by ULP errors everywhere.
+	// Tangent and cotangent of the fast and default tiers are limited by relative errors away from the poles; near the poles, by absolute errors of the reciprocal;
+	// near the zeros which are reduced with a single constant, by absolute errors. Over the wide random ranges which contain both, by absolute errors of the angle.
+	const Case s_cases[] =
+	{
+		{ "vectorSinCos.sin Fast", &sinCosSin<eTrigPrecision::Fast>, &refSin, trigDense, 0, 1.7E-6, 0 },
+		{ "vectorSinCos.sin Fast", &sinCosSin<eTrigPrecision::Fast>, &refSin, trigRandom, 0, 1.7E-6, 0 },
+		{ "vectorSinCos.cos Fast", &sinCosCos<eTrigPrecision::Fast>, &refCos, trigDense, 0, 1.2E-5, 0 },
+		{ "vectorSinCos.cos Fast", &sinCosCos<eTrigPrecision::Fast>, &refCos, trigRandom, 0, 1.2E-5, 0 },
+		{ "vectorSin Fast", &kernel<&vectorSin<eTrigPrecision::Fast>>, &refSin, trigRandom, 0, 1.7E-6, 0 },
+		{ "vectorCos Fast", &kernel<&vectorCos<eTrigPrecision::Fast>>, &refCos, trigRandom, 0, 1.2E-5, 0 },
+		{ "vectorTan Fast", &kernel<&vectorTan<eTrigPrecision::Fast>>, &refTan, tanPrincipal, 0, 0, 2E-8 },
+		{ "vectorTan Fast pole", &reciprocal<&kernel<&vectorTan<eTrigPrecision::Fast>>>, &refCot, tanPole, 0, 1E-15, 0 },
+		{ "vectorTan Fast angle", &angleOf<&kernel<&vectorTan<eTrigPrecision::Fast>>>, &refTanAngle, trigRandom, 0, 1E-8, 0 },
+		{ "vectorCot Fast", &kernel<&vectorCot<eTrigPrecision::Fast>>, &refCot, cotPrincipal, 0, 0, 2E-8 },
+		{ "vectorCot Fast pole", &reciprocal<&kernel<&vectorCot<eTrigPrecision::Fast>>>, &refTan, cotPole, 20, 0, 0 },
+		{ "vectorCot Fast zero", &kernel<&vectorCot<eTrigPrecision::Fast>>, &refCot, cotZero, 0, 1E-15, 0 },
+		{ "vectorCot Fast angle", &angleOf<&kernel<&vectorCot<eTrigPrecision::Fast>>>, &refCotAngle, trigRandom, 0, 1E-8, 0 },
+
+		{ "vectorSinCos.sin Default", &sinCosSin<eTrigPrecision::Default>, &refSin, trigDense, 0, 3E-11, 0 },
+		{ "vectorSinCos.sin Default", &sinCosSin<eTrigPrecision::Default>, &refSin, trigRandom, 0, 3E-11, 0 },
+		{ "vectorSinCos.cos Default", &sinCosCos<eTrigPrecision::Default>, &refCos, trigDense, 0, 4E-10, 0 },
+		{ "vectorSinCos.cos Default", &sinCosCos<eTrigPrecision::Default>, &refCos, trigRandom, 0, 4E-10, 0 },
+		{ "vectorSin Default", &kernel<&vectorSin<eTrigPrecision::Default>>, &refSin, trigRandom, 0, 3E-11, 0 },
+		{ "vectorCos Default", &kernel<&vectorCos<eTrigPrecision::Default>>, &refCos, trigRandom, 0, 4E-10, 0 },
+		{ "vectorTan Default", &kernel<&vectorTan<eTrigPrecision::Default>>, &refTan, tanPrincipal, 0, 0, 4E-9 },
+		{ "vectorTan Default pole", &reciprocal<&kernel<&vectorTan<eTrigPrecision::Default>>>, &refCot, tanPole, 0, 4E-9, 0 },
+		{ "vectorTan Default angle", &angleOf<&kernel<&vectorTan<eTrigPrecision::Default>>>, &refTanAngle, trigRandom, 0, 4E-9, 0 },
+		{ "vectorCot Default", &kernel<&vectorCot<eTrigPrecision::Default>>, &refCot, cotPrincipal, 0, 0, 4E-9 },
+		{ "vectorCot Default pole", &reciprocal<&kernel<&vectorCot<eTrigPrecision::Default>>>, &refTan, cotPole, 0, 4E-9, 0 },
+		{ "vectorCot Default zero", &kernel<&vectorCot<eTrigPrecision::Default>>, &refCot, cotZero, 0, 3E-16, 0 },
+		{ "vectorCot Default angle", &angleOf<&kernel<&vectorCot<eTrigPrecision::Default>>>, &refCotAngle, trigRandom, 0, 4E-9, 0 },
+
+		{ "vectorSinCos.sin Precise", &sinCosSin<eTrigPrecision::Precise>, &refSin, trigDense, 3, 4E-16, 0 },
+		{ "vectorSinCos.sin Precise", &sinCosSin<eTrigPrecision::Precise>, &refSin, trigRandom, 3, 4E-16, 0 },
+		{ "vectorSinCos.cos Precise", &sinCosCos<eTrigPrecision::Precise>, &refCos, trigDense, 3, 4E-16, 0 },
+		{ "vectorSinCos.cos Precise", &sinCosCos<eTrigPrecision::Precise>, &refCos, trigRandom, 3, 4E-16, 0 },
+		{ "vectorSinCos.cos Precise", &sinCosCos<eTrigPrecision::Precise>, &refCos, cosZero, 3, 4E-16, 0 },
+		{ "vectorSin Precise", &kernel<&vectorSin<eTrigPrecision::Precise>>, &refSin, trigRandom, 3, 4E-16, 0 },
+		{ "vectorCos Precise", &kernel<&vectorCos<eTrigPrecision::Precise>>, &refCos, trigRandom, 3, 4E-16, 0 },
+		{ "vectorCos Precise", &kernel<&vectorCos<eTrigPrecision::Precise>>, &refCos, cosZero, 3, 4E-16, 0 },
+		{ "vectorTan Precise", &kernel<&vectorTan<eTrigPrecision::Precise>>, &refTan, tanPrincipal, 4, 0, 0 },
+		{ "vectorTan Precise pole", &reciprocal<&kernel<&vectorTan<eTrigPrecision::Precise>>>, &refCot, tanPole, 4, 0, 0 },
+		{ "vectorTan Precise", &kernel<&vectorTan<eTrigPrecision::Precise>>, &refTan, trigRandom, 4, 0, 0 },
+		{ "vectorCot Precise", &kernel<&vectorCot<eTrigPrecision::Precise>>, &refCot, cotPrincipal, 4, 0, 0 },
+		{ "vectorCot Precise pole", &reciprocal<&kernel<&vectorCot<eTrigPrecision::Precise>>>, &refTan, cotPole, 4, 0, 0 },
+		{ "vectorCot Precise zero", &kernel<&vectorCot<eTrigPrecision::Precise>>, &refCot, cotZero, 4, 0, 0 },
+		{ "vectorCot Precise", &kernel<&vectorCot<eTrigPrecision::Precise>>, &refCot, trigRandom, 4, 0, 0 },
+
+		{ "scalarSinCos.sin", &scalarLanes<&scalarSinCosLane<1>>, &refSin, trigRandom, 0, 3E-11, 0 },
+		{ "scalarSinCos.cos", &scalarLanes<&scalarSinCosLane<0>>, &refCos, trigRandom, 0, 4E-10, 0 },
+		{ "scalarSin", &scalarLanes<&scalarSin>, &refSin, trigRandom, 0, 3E-11, 0 },
+		{ "scalarCos", &scalarLanes<&scalarCos>, &refCos, trigRandom, 0, 4E-10, 0 },
+		{ "scalarTan", &scalarLanes<&scalarTan>, &refTan, tanPrincipal, 0, 0, 4E-9 },
+		{ "scalarTan pole", &reciprocal<&scalarLanes<&scalarTan>>, &refCot, tanPole, 0, 4E-9, 0 },
+		{ "scalarTan angle", &angleOf<&scalarLanes<&scalarTan>>, &refTanAngle, trigRandom, 0, 4E-9, 0 },
+		{ "scalarCot", &scalarLanes<&scalarCot>, &refCot, cotPrincipal, 0, 0, 4E-9 },
+		{ "scalarCot pole", &reciprocal<&scalarLanes<&scalarCot>>, &refTan, cotPole, 0, 4E-9, 0 },
+		{ "scalarCot zero", &scalarLanes<&scalarCot>, &refCot, cotZero, 0, 3E-16, 0 },
+		{ "scalarCot angle", &angleOf<&scalarLanes<&scalarCot>>, &refCotAngle, trigRandom, 0, 4E-9, 0 },
+
+		{ "vectorExp", &kernel<&vectorExp>, &refExp, { -708, 709.7, false }, 2, 0, 0 },
+		{ "vectorExp", &kernel<&vectorExp>, &refExp, { -1, 1, true }, 2, 0, 0 },
+		{ "vectorExp denormal", &kernel<&vectorExp>, &refExp, { -745, -708, false }, 0, 1E-323, 0 },
+
+		{ "vectorTanH", &kernel<&vectorTanH>, &refTanH, { -20, 20, false }, 3, 0, 0 },
+		{ "vectorTanH", &kernel<&vectorTanH>, &refTanH, { -1, 1, true }, 3, 0, 0 },
+		{ "vectorTanHFast", &kernel<&vectorTanHFast>, &refTanH, { -20, 20, false }, 0, 3.6E-4, 0 },
+		{ "vectorTanHFast", &kernel<&vectorTanHFast>, &refTanH, { -1, 1, true }, 0, 3.6E-4, 0 },
+
+		{ "vectorSigmoid", &kernel<&vectorSigmoid>, &refSigmoid, { -40, 40, false }, 3, 0, 0 },
+		{ "vectorSigmoid", &kernel<&vectorSigmoid>, &refSigmoid, { -1, 1, true }, 3, 0, 0 },
+		{ "vectorSigmoidFast", &kernel<&vectorSigmoidFast>, &refSigmoid, { -40, 40, false }, 0, 1.8E-4, 0 },
+		{ "vectorSigmoidFast", &kernel<&vectorSigmoidFast>, &refSigmoid, { -1, 1, true }, 0, 1.8E-4, 0 },
+
+		{ "vectorSoftplus", &kernel<&vectorSoftplus>, &refSoftplus, { -40, 40, false }, 3, 0, 0 },
+		{ "vectorSoftplus", &kernel<&vectorSoftplus>, &refSoftplus, { -700, 700, true }, 3, 0, 0 },
+		{ "vectorSoftplusFast", &kernel<&vectorSoftplusFast>, &refSoftplus, { -40, 40, false }, 0, 0, 2.5E-7 },
+		{ "vectorSoftplusFast", &kernel<&vectorSoftplusFast>, &refSoftplus, { -700, 700, true }, 0, 0, 2.5E-7 },
+	};
+}
+
+bool testAccuracy( size_t points, const char* filter )
+{
+	printf( "%-26s %-28s %10s %12s %12s %12s %12s %14s  %s\n", "kernel", "range", "points", "max ULP", "mean ULP", "max abs", "max rel", "worst x", "status" );
+
+	bool passed = true;
+	for( const Case& c : s_cases )
+	{
+		if( nullptr != filter && nullptr == strstr( c.name, filter ) )
+			continue;
+
+		const Stats stats = measure( c, points );
+		const bool ok = !( c.maxUlp > 0 && !( stats.maxUlp <= c.maxUlp ) ) && !( c.maxAbs > 0 && !( stats.maxAbs <= c.maxAbs ) ) && !( c.maxRel > 0 && !( stats.maxRel <= c.maxRel ) );
+		passed = passed && ok;
+
+		char range[ 64 ];
+		snprintf( range, sizeof( range ), "%s [ %g, %g ]", c.range.random ? "random" : "dense", c.range.begin, c.range.end );
+		printf( "%-26s %-28s %10zu %12.4g %12.4g %12.4g %12.4g %14.8g  %s\n", c.name, range, points,
+			stats.maxUlp, stats.sumUlp / (double)std::max( points, (size_t)1 ), stats.maxAbs, stats.maxRel, stats.worstArgument, ok ? "ok" : "FAIL" );
+	}
+	return passed;
+}
\ No newline at end of file
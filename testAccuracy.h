@@ -0,0 +1,8 @@
+#pragma once
+#include "testsMisc.h"
+#include <stddef.h>
+
+// Measure errors of the transcendental functions compared to long double versions of the standard library, print a table with the results.
+// points is the count of arguments per kernel per range, filter is an optional substring to select kernels by name.
+// Returns false when any of the kernels exceeded the error limit.
+bool testAccuracy( size_t points, const char* filter );
\ No newline at end of file
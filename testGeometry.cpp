@@ -0,0 +1,1664 @@
+#include "testGeometry.h"
+#include <stdio.h>
+#include <vector>
+#include <cmath>
+#include <string.h>
+#include <algorithm>
+
+namespace
+{
+	using namespace AvxMath;
+
+	double lane( __m256d v, size_t i )
+	{
+		alignas( 32 ) double tmp[ 4 ];
+		_mm256_store_pd( tmp, v );
+		return tmp[ i ];
+	}
+
+	__m256d lane( const Vector3x4& v, size_t i )
+	{
+		return _mm256_setr_pd( lane( v.x, i ), lane( v.y, i ), lane( v.z, i ), 0 );
+	}
+
+	void testSoa()
+	{
+		double source[ 12 ], dest[ 12 ];
+		for( int i = 0; i < 12; i++ )
+			source[ i ] = i;
+		const Vector3x4 v = loadVector3x4( source );
+		assertEqual( v.x, _mm256_setr_pd( 0, 3, 6, 9 ) );
+		assertEqual( v.y, _mm256_setr_pd( 1, 4, 7, 10 ) );
+		assertEqual( v.z, _mm256_setr_pd( 2, 5, 8, 11 ) );
+		storeVector3x4( dest, v );
+		for( int i = 0; i < 12; i++ )
+			assert( dest[ i ] == source[ i ] );
+
+		const Vector3x4 c = vector3x4Cross( v, vector3x4Splat( _mm256_setr_pd( 1, 2, 3, 0 ) ) );
+		for( size_t i = 0; i < 4; i++ )
+			assertEqual( lane( c, i ), vector3Cross( lane( v, i ), _mm256_setr_pd( 1, 2, 3, 0 ) ), 1E-12 );
+	}
+
+	// Zero W lane of the vector, the pipelines don't store it
+	__m256d vector3Cartesian( __m256d v )
+	{
+		return _mm256_blend_pd( v, _mm256_setzero_pd(), 0b1000 );
+	}
+
+	// Fused pipelines match the per-vector functions, for all remainders and in place
+	void testPipeline()
+	{
+		Random rng;
+		Matrix4x4 mat;
+		mat.r0 = _mm256_setr_pd( 0.8, -0.6, 0.1, 3 );
+		mat.r1 = _mm256_setr_pd( 0.6, 0.8, 0.2, -2 );
+		mat.r2 = _mm256_setr_pd( -0.1, 0.3, 1.5, 0.5 );
+		mat.r3 = _mm256_setr_pd( 0.01, 0.02, 0.03, 1 );
+		const auto transformNormalize = makePipeline( PipeTransform{ mat }, PipeNormalize{} );
+		const auto coordScale = makePipeline( PipeTransformCoord{ mat }, []( const Vector3x4& v ) { return vector3x4Scale( v, _mm256_set1_pd( 2 ) ); } );
+
+		for( size_t count = 0; count < 20; count++ )
+		{
+			std::vector<double> source( count * 3 ), dest( count * 3 );
+			for( double& d : source )
+				d = rng.next() * 10;
+			transformNormalize.run( source.data(), dest.data(), count );
+			for( size_t i = 0; i < count; i++ )
+			{
+				const __m256d expected = vector3Normalize( vector3Transform( loadDouble3( &source[ i * 3 ] ), mat ) );
+				assertEqual( loadDouble3( &dest[ i * 3 ] ), vector3Cartesian( expected ), 1E-15 );
+			}
+
+			std::vector<double> inPlace = source;
+			coordScale.run( inPlace.data(), inPlace.data(), count );
+			for( size_t i = 0; i < count; i++ )
+			{
+				const __m256d expected = _mm256_mul_pd( vector3TransformCoord( loadDouble3( &source[ i * 3 ] ), mat ), _mm256_set1_pd( 2 ) );
+				assertEqual( loadDouble3( &inPlace[ i * 3 ] ), vector3Cartesian( expected ), 1E-13 );
+			}
+		}
+
+		// FP32 input and output, same results as converting the arrays
+		for( size_t count : { 3, 8, 13 } )
+		{
+			std::vector<float> source( count * 3 ), dest( count * 3 ), expected( count * 3 );
+			for( float& f : source )
+				f = (float)rng.next() * 10;
+			std::vector<double> wide( count * 3 );
+			arrayFloatToDouble( source.data(), wide.data(), count * 3 );
+			transformNormalize.run( wide.data(), wide.data(), count );
+			arrayDoubleToFloat( wide.data(), expected.data(), count * 3 );
+			transformNormalize.run( source.data(), dest.data(), count );
+			assert( dest == expected );
+
+#if _AM_F16C_INTRINSICS_
+			std::vector<uint16_t> halves( count * 3 ), halvesExpected( count * 3 );
+			arrayDoubleToHalf( wide.data(), halvesExpected.data(), count * 3 );
+			transformNormalize.run( source.data(), halves.data(), count );
+			assert( halves == halvesExpected );
+#endif
+		}
+
+		// Special vectors: zero and NaN become zero, infinite and too long to square become NaN
+		const double inf = std::numeric_limits<double>::infinity(), nan = std::numeric_limits<double>::quiet_NaN();
+		double special[ 15 ] = { 0, 0, 0, 1, nan, 0, -inf, 0, 0, 1E+200, 0, 0, 0, -3, 4 };
+		makePipeline( PipeNormalize{} ).run( special, special, 5 );
+		for( size_t i = 0; i < 6; i++ )
+			assert( special[ i ] == 0 );
+		for( size_t i = 6; i < 12; i++ )
+			assert( std::isnan( special[ i ] ) );
+		assertEqual( loadDouble3( special + 12 ), _mm256_setr_pd( 0, -0.6, 0.8, 0 ), 1E-15 );
+	}
+
+	// Random rays against random triangles: Moller-Trumbore and watertight tests should agree, except very close to the edges
+	void testRandomTriangles()
+	{
+		Random rng;
+		size_t hits = 0, mismatches = 0;
+		for( size_t i = 0; i < 10000; i++ )
+		{
+			const __m256d origin = rng.next3();
+			const __m256d dir = rng.next3();
+			double v[ 36 ];
+			for( double& d : v )
+				d = rng.next();
+			const Vector3x4 v0 = loadVector3x4( v );
+			const Vector3x4 v1 = loadVector3x4( v + 12 );
+			const Vector3x4 v2 = loadVector3x4( v + 24 );
+
+			const RayHit4 mt = intersectRayTriangles( origin, dir, v0, v1, v2, 2.0 );
+			const WatertightRays4 wr = prepareWatertightRays( origin, dir );
+			const RayHit4 wt = intersectWatertight( wr, v0, v1, v2, _mm256_set1_pd( 2.0 ) );
+
+			const int mtMask = _mm256_movemask_pd( mt.mask );
+			const int wtMask = _mm256_movemask_pd( wt.mask );
+			for( size_t j = 0; j < 4; j++ )
+			{
+				const bool mtHit = 0 != ( mtMask & ( 1 << j ) );
+				const bool wtHit = 0 != ( wtMask & ( 1 << j ) );
+				if( mtHit != wtHit )
+				{
+					// Only allowed when the intersection is at the boundary of the triangle or the ray
+					const double u = lane( mt.u, j ), vv = lane( mt.v, j ), t = lane( mt.t, j );
+					const double border = std::min( { std::abs( u ), std::abs( vv ), std::abs( 1 - u - vv ), std::abs( t ), std::abs( 2 - t ) } );
+					assert( border < 1E-9 );
+					mismatches++;
+					continue;
+				}
+				if( !mtHit )
+					continue;
+				hits++;
+				assert( std::abs( lane( mt.t, j ) - lane( wt.t, j ) ) < 1E-9 );
+				assert( std::abs( lane( mt.u, j ) - lane( wt.u, j ) ) < 1E-9 );
+				assert( std::abs( lane( mt.v, j ) - lane( wt.v, j ) ) < 1E-9 );
+
+				// The point computed from the barycentrics must be on the ray
+				const double u = lane( mt.u, j ), vv = lane( mt.v, j ), t = lane( mt.t, j );
+				__m256d pt = _mm256_mul_pd( lane( v0, j ), _mm256_set1_pd( 1 - u - vv ) );
+				pt = _mm256_add_pd( pt, _mm256_mul_pd( lane( v1, j ), _mm256_set1_pd( u ) ) );
+				pt = _mm256_add_pd( pt, _mm256_mul_pd( lane( v2, j ), _mm256_set1_pd( vv ) ) );
+				assertEqual( pt, _mm256_add_pd( origin, _mm256_mul_pd( dir, _mm256_set1_pd( t ) ) ), 1E-9 );
+			}
+
+			// 4 rays against 1 triangle must produce the same results as 1 ray against 4 triangles
+			double o4[ 12 ], d4[ 12 ];
+			for( size_t j = 0; j < 4; j++ )
+			{
+				const __m256d o = rng.next3(), d = rng.next3();
+				memcpy( &o4[ j * 3 ], &o, 24 );
+				memcpy( &d4[ j * 3 ], &d, 24 );
+			}
+			const Vector3x4 origins = loadVector3x4( o4 ), dirs = loadVector3x4( d4 );
+			const RayHit4 rays = intersectRaysTriangle( origins, dirs, lane( v0, 0 ), lane( v1, 0 ), lane( v2, 0 ) );
+			const RayHit4 raysWt = intersectWatertight( prepareWatertightRays( origins, dirs ), lane( v0, 0 ), lane( v1, 0 ), lane( v2, 0 ) );
+			for( size_t j = 0; j < 4; j++ )
+			{
+				const RayHit4 one = intersectRayTriangles( lane( origins, j ), lane( dirs, j ), v0, v1, v2 );
+				const RayHit4 oneWt = intersectWatertight( prepareWatertightRays( lane( origins, j ), lane( dirs, j ) ), v0, v1, v2, _mm256_set1_pd( g_misc.infinity ) );
+				assert( ( ( _mm256_movemask_pd( rays.mask ) >> j ) & 1 ) == ( _mm256_movemask_pd( one.mask ) & 1 ) );
+				assert( ( ( _mm256_movemask_pd( raysWt.mask ) >> j ) & 1 ) == ( _mm256_movemask_pd( oneWt.mask ) & 1 ) );
+				if( _mm256_movemask_pd( one.mask ) & 1 )
+					assert( lane( rays.t, j ) == lane( one.t, 0 ) );
+			}
+		}
+		// About 4% of these rays hit
+		assert( hits > 1000 && mismatches < 10 );
+	}
+
+	// Rays through the vertices and the edges of a triangulated grid must hit at least 1 triangle with the watertight test
+	void testWatertight()
+	{
+		// 8x8 grid of squares in a tilted plane, each square split into 2 triangles
+		constexpr int side = 8;
+		const auto vertex = []( int x, int y )
+		{
+			return _mm256_setr_pd( x * 0.1, y * 0.1, x * 0.03 - y * 0.07, 0 );
+		};
+		std::vector<double> v0, v1, v2;
+		const auto add = [ & ]( __m256d a, __m256d b, __m256d c )
+		{
+			for( int i = 0; i < 3; i++ )
+			{
+				v0.push_back( lane( a, i ) );
+				v1.push_back( lane( b, i ) );
+				v2.push_back( lane( c, i ) );
+			}
+		};
+		for( int y = 0; y < side; y++ )
+			for( int x = 0; x < side; x++ )
+			{
+				add( vertex( x, y ), vertex( x + 1, y ), vertex( x + 1, y + 1 ) );
+				add( vertex( x, y ), vertex( x + 1, y + 1 ), vertex( x, y + 1 ) );
+			}
+		const size_t triangles = side * side * 2;
+
+		Random rng;
+		size_t misses = 0, rays = 0, mtMisses = 0;
+		for( int y = 1; y < side; y++ )
+			for( int x = 1; x < side; x++ )
+				for( int k = 0; k < 16; k++ )
+				{
+					// Target either the vertex, or a point on the diagonal, or the horizontal edge
+					__m256d target = vertex( x, y );
+					if( k % 3 == 1 )
+						target = _mm256_mul_pd( _mm256_add_pd( vertex( x, y ), vertex( x + 1, y + 1 ) ), _mm256_set1_pd( 0.5 ) );
+					else if( k % 3 == 2 )
+						target = _mm256_mul_pd( _mm256_add_pd( vertex( x, y ), vertex( x + 1, y ) ), _mm256_set1_pd( 0.5 ) );
+					const __m256d origin = _mm256_add_pd( target, _mm256_mul_pd( rng.next3(), _mm256_set1_pd( 3.0 ) ) );
+					const __m256d dir = _mm256_sub_pd( target, origin );
+
+					const WatertightRays4 r = prepareWatertightRays( origin, dir );
+					bool hit = false, mtHit = false;
+					for( size_t i = 0; i < triangles; i += 4 )
+					{
+						const Vector3x4 a = loadVector3x4( &v0[ i * 3 ] ), b = loadVector3x4( &v1[ i * 3 ] ), c = loadVector3x4( &v2[ i * 3 ] );
+						hit = hit || 0 != _mm256_movemask_pd( intersectWatertight( r, a, b, c, _mm256_set1_pd( 2.0 ) ).mask );
+						mtHit = mtHit || 0 != _mm256_movemask_pd( intersectRayTriangles( origin, dir, a, b, c, 2.0 ).mask );
+					}
+					rays++;
+					if( !hit )
+						misses++;
+					if( !mtHit )
+						mtMisses++;
+				}
+		assert( 0 == misses );
+		printf( "Rays through the edges and vertices: %zu, misses: %zu watertight, %zu Moller-Trumbore\n", rays, misses, mtMisses );
+	}
+
+	// Indexed mesh for the BVH tests: a bumpy heightfield, plus random triangles above it
+	struct Mesh
+	{
+		std::vector<double> xyz;
+		std::vector<uint32_t> indices;
+		size_t triangles() const { return indices.size() / 3; }
+		__m256d vertex( size_t tri, size_t v ) const { return loadDouble3( &xyz[ (size_t)indices[ tri * 3 + v ] * 3 ] ); }
+
+		Mesh( uint32_t side, size_t soup )
+		{
+			for( uint32_t y = 0; y <= side; y++ )
+				for( uint32_t x = 0; x <= side; x++ )
+				{
+					const double fx = (double)x / side * 2 - 1, fy = (double)y / side * 2 - 1;
+					xyz.insert( xyz.end(), { fx, fy, 0.1 * std::sin( fx * 7 ) * std::cos( fy * 5 ) } );
+				}
+			for( uint32_t y = 0; y < side; y++ )
+				for( uint32_t x = 0; x < side; x++ )
+				{
+					const uint32_t i = y * ( side + 1 ) + x;
+					indices.insert( indices.end(), { i, i + 1, i + side + 2, i, i + side + 2, i + side + 1 } );
+				}
+			Random rng;
+			for( size_t i = 0; i < soup; i++ )
+			{
+				const __m256d center = _mm256_add_pd( rng.next3(), _mm256_setr_pd( 0, 0, 1.2, 0 ) );
+				for( size_t v = 0; v < 3; v++ )
+				{
+					indices.push_back( (uint32_t)( xyz.size() / 3 ) );
+					const __m256d pos = _mm256_add_pd( center, _mm256_mul_pd( rng.next3(), _mm256_set1_pd( 0.05 ) ) );
+					xyz.insert( xyz.end(), { vectorGetX( pos ), vectorGetY( pos ), vectorGetZ( pos ) } );
+				}
+			}
+			// A degenerate triangle
+			indices.insert( indices.end(), { 0, 0, 1 } );
+		}
+	};
+
+	// Scalar closest point on triangle, computed by projecting on the plane, and on the 3 edges when the projection is outside
+	__m256d closestPointReference( __m256d p, __m256d a, __m256d b, __m256d c )
+	{
+		const auto dot = []( __m256d x, __m256d y ) { return _mm_cvtsd_f64( vector3Dot2( x, y ) ); };
+		const auto onSegment = [ & ]( __m256d s0, __m256d s1 )
+		{
+			const __m256d d = _mm256_sub_pd( s1, s0 );
+			const double len = dot( d, d );
+			double t = len > 0 ? dot( _mm256_sub_pd( p, s0 ), d ) / len : 0;
+			t = std::min( std::max( t, 0.0 ), 1.0 );
+			return _mm256_add_pd( s0, _mm256_mul_pd( d, _mm256_set1_pd( t ) ) );
+		};
+		const auto distSq = [ & ]( __m256d x ) { const __m256d d = _mm256_sub_pd( x, p ); return dot( d, d ); };
+
+		const __m256d n = vector3Cross( _mm256_sub_pd( b, a ), _mm256_sub_pd( c, a ) );
+		const double nn = dot( n, n );
+		if( nn > 0 )
+		{
+			const __m256d proj = _mm256_sub_pd( p, _mm256_mul_pd( n, _mm256_set1_pd( dot( _mm256_sub_pd( p, a ), n ) / nn ) ) );
+			// Inside when all 3 edge functions have the same sign as the normal
+			const bool inside = dot( vector3Cross( _mm256_sub_pd( b, a ), _mm256_sub_pd( proj, a ) ), n ) >= 0 &&
+				dot( vector3Cross( _mm256_sub_pd( c, b ), _mm256_sub_pd( proj, b ) ), n ) >= 0 &&
+				dot( vector3Cross( _mm256_sub_pd( a, c ), _mm256_sub_pd( proj, c ) ), n ) >= 0;
+			if( inside )
+				return proj;
+		}
+		__m256d best = onSegment( a, b );
+		for( __m256d candidate : { onSegment( b, c ), onSegment( c, a ) } )
+			if( distSq( candidate ) < distSq( best ) )
+				best = candidate;
+		return best;
+	}
+
+	// Barycentric interpolation of the triangle vertices
+	__m256d interpolate( __m256d a, __m256d b, __m256d c, double u, double v )
+	{
+		__m256d res = _mm256_mul_pd( a, _mm256_set1_pd( 1 - u - v ) );
+		res = vectorMultiplyAdd( b, _mm256_set1_pd( u ), res );
+		return vectorMultiplyAdd( c, _mm256_set1_pd( v ), res );
+	}
+
+	// Compare the vectorized closest points with the scalar reference
+	void testClosestPoint()
+	{
+		Random rng;
+		double maxError = 0;
+		for( size_t i = 0; i < 20000; i++ )
+		{
+			// Positions at different distances from the triangles, to cover all 7 Voronoi regions
+			double p[ 12 ], v[ 36 ];
+			const double scale = ( i % 3 == 0 ) ? 0.1 : ( ( i % 3 == 1 ) ? 1 : 10 );
+			for( double& d : p )
+				d = rng.next() * scale;
+			for( double& d : v )
+				d = rng.next();
+			const Vector3x4 pos = loadVector3x4( p );
+			const Vector3x4 a = loadVector3x4( v ), b = loadVector3x4( v + 12 ), c = loadVector3x4( v + 24 );
+			const TriangleClosestPoint4 cp = closestPointOnTriangle4( pos, a, b, c );
+
+			for( size_t j = 0; j < 4; j++ )
+			{
+				const __m256d ref = closestPointReference( lane( pos, j ), lane( a, j ), lane( b, j ), lane( c, j ) );
+				const __m256d diff = _mm256_sub_pd( ref, lane( pos, j ) );
+				const double refSq = _mm_cvtsd_f64( vector3Dot2( diff, diff ) );
+				const double distSq = lane( cp.distanceSquared, j );
+				const double error = std::abs( std::sqrt( distSq ) - std::sqrt( refSq ) );
+				assert( error < 1E-12 );
+				assertEqual( lane( cp.point, j ), ref, 1E-9 );
+
+				// Barycentrics must be within the triangle, and produce the point
+				const double u = lane( cp.u, j ), vv = lane( cp.v, j );
+				assert( u >= 0 && vv >= 0 && u + vv <= 1 + 1E-15 );
+				assertEqual( interpolate( lane( a, j ), lane( b, j ), lane( c, j ), u, vv ), lane( cp.point, j ), 1E-12 );
+				maxError = std::max( maxError, error );
+			}
+		}
+		printf( "Closest points on random triangles, max. distance error %g\n", maxError );
+
+		// Positions in the vertex regions produce the exact vertices
+		const __m256d a = _mm256_setr_pd( 0.1, 0.2, 0.3, 0 ), b = _mm256_setr_pd( 1.3, 0.1, -0.2, 0 ), c = _mm256_setr_pd( 0.4, 1.7, 0.5, 0 );
+		const __m256d center = _mm256_mul_pd( _mm256_add_pd( _mm256_add_pd( a, b ), c ), _mm256_set1_pd( 1.0 / 3.0 ) );
+		const auto outside = [ center ]( __m256d x ) { return _mm256_add_pd( x, _mm256_mul_pd( _mm256_sub_pd( x, center ), _mm256_set1_pd( 5 ) ) ); };
+		const Vector3x4 tri[ 3 ] = { vector3x4Splat( a ), vector3x4Splat( b ), vector3x4Splat( c ) };
+		double p[ 12 ];
+		storeVector3x4( p, Vector3x4{ _mm256_setr_pd( vectorGetX( outside( a ) ), vectorGetX( outside( b ) ), vectorGetX( outside( c ) ), vectorGetX( center ) ),
+			_mm256_setr_pd( vectorGetY( outside( a ) ), vectorGetY( outside( b ) ), vectorGetY( outside( c ) ), vectorGetY( center ) ),
+			_mm256_setr_pd( vectorGetZ( outside( a ) ), vectorGetZ( outside( b ) ), vectorGetZ( outside( c ) ), vectorGetZ( center ) ) } );
+		TriangleClosestPoint4 cp = closestPointOnTriangle4( loadVector3x4( p ), tri[ 0 ], tri[ 1 ], tri[ 2 ] );
+		assert( vectorEqual( lane( cp.point, 0 ), a ) && vectorEqual( lane( cp.point, 1 ), b ) && vectorEqual( lane( cp.point, 2 ), c ) );
+		assert( lane( cp.u, 1 ) == 1 && lane( cp.v, 2 ) == 1 );
+		assertEqual( lane( cp.point, 3 ), center, 1E-15 );
+		assert( std::abs( lane( cp.u, 3 ) - 1.0 / 3.0 ) < 1E-15 && std::abs( lane( cp.v, 3 ) - 1.0 / 3.0 ) < 1E-15 );
+
+		// Degenerate triangles: 2 equal vertices, collinear vertices, 3 equal vertices, and NaN
+		const __m256d pos = _mm256_setr_pd( 0.5, 1, 0, 0 );
+		const __m256d o = _mm256_setzero_pd(), x1 = _mm256_setr_pd( 1, 0, 0, 0 ), x2 = _mm256_setr_pd( 2, 0, 0, 0 );
+		const auto soa = []( __m256d l0, __m256d l1, __m256d l2, __m256d l3 )
+		{
+			return Vector3x4{ _mm256_setr_pd( vectorGetX( l0 ), vectorGetX( l1 ), vectorGetX( l2 ), vectorGetX( l3 ) ),
+				_mm256_setr_pd( vectorGetY( l0 ), vectorGetY( l1 ), vectorGetY( l2 ), vectorGetY( l3 ) ),
+				_mm256_setr_pd( vectorGetZ( l0 ), vectorGetZ( l1 ), vectorGetZ( l2 ), vectorGetZ( l3 ) ) };
+		};
+		const __m256d nan = _mm256_set1_pd( g_misc.quietNaN );
+		cp = closestPointOnTriangles( pos, soa( o, x2, o, nan ), soa( o, o, o, x1 ), soa( x1, x1, o, x2 ) );
+		assertEqual( lane( cp.point, 0 ), _mm256_setr_pd( 0.5, 0, 0, 0 ), 1E-15 );
+		assertEqual( lane( cp.point, 1 ), _mm256_setr_pd( 0.5, 0, 0, 0 ), 1E-15 );
+		assert( vectorEqual( lane( cp.point, 2 ), o ) && lane( cp.distanceSquared, 2 ) == 1.25 );
+		assert( std::isnan( lane( cp.distanceSquared, 3 ) ) );
+		for( size_t j = 0; j < 2; j++ )
+			assertEqual( interpolate( lane( soa( o, x2, o, nan ), j ), o, x1, lane( cp.u, j ), lane( cp.v, j ) ), lane( cp.point, j ), 1E-15 );
+	}
+
+	void testBvhQueries( const Mesh& mesh, const TriangleBvh& bvh )
+	{
+		const size_t triangles = mesh.triangles();
+		Random rng;
+		size_t hits = 0;
+		for( size_t i = 0; i < 500; i++ )
+		{
+			// Rays from above, in random directions
+			const __m256d origin = _mm256_add_pd( rng.next3(), _mm256_setr_pd( 0, 0, 2, 0 ) );
+			const __m256d dir = _mm256_add_pd( rng.next3(), _mm256_setr_pd( 0, 0, -1.5, 0 ) );
+			const double tMax = ( i % 4 == 0 ) ? 1.0 : g_misc.infinity;
+
+			double bestT = g_misc.infinity;
+			for( size_t t = 0; t < triangles; t++ )
+			{
+				const RayHit4 h = intersectRaysTriangle( vector3x4Splat( origin ), vector3x4Splat( dir ), mesh.vertex( t, 0 ), mesh.vertex( t, 1 ), mesh.vertex( t, 2 ), tMax );
+				if( _mm256_movemask_pd( h.mask ) & 1 )
+					bestT = std::min( bestT, vectorGetX( h.t ) );
+			}
+
+			BvhRayHit hit;
+			const bool found = bvh.intersect( origin, dir, tMax, hit );
+			assert( found == ( bestT != g_misc.infinity ) );
+			assert( found == bvh.intersectAny( origin, dir, tMax ) );
+			if( !found )
+				continue;
+			hits++;
+			assert( std::abs( hit.t - bestT ) <= 1E-12 );
+			// The reported triangle and barycentrics must produce the point on the ray
+			__m256d pt = _mm256_mul_pd( mesh.vertex( hit.triangle, 0 ), _mm256_set1_pd( 1 - hit.u - hit.v ) );
+			pt = vectorMultiplyAdd( mesh.vertex( hit.triangle, 1 ), _mm256_set1_pd( hit.u ), pt );
+			pt = vectorMultiplyAdd( mesh.vertex( hit.triangle, 2 ), _mm256_set1_pd( hit.v ), pt );
+			assertEqual( pt, vectorMultiplyAdd( dir, _mm256_set1_pd( hit.t ), origin ), 1E-9 );
+		}
+		// About 40% of these rays hit
+		assert( hits > 150 );
+
+		for( size_t i = 0; i < 500; i++ )
+		{
+			const __m256d pos = _mm256_mul_pd( rng.next3(), _mm256_set1_pd( 1.5 ) );
+			const double maxDistance = ( i % 4 == 0 ) ? 0.05 : g_misc.infinity;
+
+			double bestSq = g_misc.infinity;
+			for( size_t t = 0; t < triangles; t++ )
+			{
+				const __m256d cp = closestPointReference( pos, mesh.vertex( t, 0 ), mesh.vertex( t, 1 ), mesh.vertex( t, 2 ) );
+				const __m256d d = _mm256_sub_pd( cp, pos );
+				bestSq = std::min( bestSq, _mm_cvtsd_f64( vector3Dot2( d, d ) ) );
+			}
+
+			BvhClosestPoint cp;
+			const bool found = bvh.closestPoint( pos, maxDistance, cp );
+			if( bestSq > maxDistance * maxDistance )
+			{
+				assert( !found );
+				continue;
+			}
+			assert( found );
+			assert( std::abs( cp.distanceSquared - bestSq ) <= 1E-12 );
+			const __m256d d = _mm256_sub_pd( cp.point, pos );
+			assert( std::abs( _mm_cvtsd_f64( vector3Dot2( d, d ) ) - cp.distanceSquared ) <= 1E-12 );
+			const __m256d ref = closestPointReference( pos, mesh.vertex( cp.triangle, 0 ), mesh.vertex( cp.triangle, 1 ), mesh.vertex( cp.triangle, 2 ) );
+			assertEqual( ref, cp.point, 1E-9 );
+			assertEqual( interpolate( mesh.vertex( cp.triangle, 0 ), mesh.vertex( cp.triangle, 1 ), mesh.vertex( cp.triangle, 2 ), cp.u, cp.v ), cp.point, 1E-12 );
+		}
+	}
+
+	void testBvh()
+	{
+		// Compare with brute force
+		const Mesh mesh{ 40, 300 };
+		TriangleBvh bvh;
+		bvh.build( mesh.xyz.data(), mesh.indices.data(), mesh.triangles() );
+		assert( bvh.size() == mesh.triangles() );
+		testBvhQueries( mesh, bvh );
+
+		// Tiny meshes are a single leaf
+		bvh.build( mesh.xyz.data(), mesh.indices.data(), 3 );
+		BvhClosestPoint cp;
+		assert( bvh.nodeCount() == 1 && bvh.closestPoint( loadDouble3( mesh.xyz.data() ), 0.1, cp ) && cp.distanceSquared < 1E-20 );
+		bvh.build( nullptr, nullptr, 0 );
+		assert( !bvh.closestPoint( _mm256_setzero_pd(), 1, cp ) );
+
+		// A NaN vertex makes the centroids of its triangles NaN, they go to the first bin; the rest of the mesh is still found
+		Mesh broken{ 40, 300 };
+		broken.xyz[ 100 * 3 ] = g_misc.quietNaN;
+		bvh.build( broken.xyz.data(), broken.indices.data(), broken.triangles() );
+		assert( bvh.size() == broken.triangles() );
+		BvhRayHit hit;
+		assert( bvh.intersect( _mm256_setr_pd( 0.5, 0.5, -1, 0 ), _mm256_setr_pd( 0, 0, 1, 0 ), g_misc.infinity, hit ) );
+
+		// Parallel build of a larger mesh must produce the same query results
+		const Mesh large{ 256, 1000 };
+		TriangleBvh serial, parallel;
+		serial.build( large.xyz.data(), large.indices.data(), large.triangles() );
+		parallel.build( large.xyz.data(), large.indices.data(), large.triangles(), true );
+		Random rng;
+		for( size_t i = 0; i < 1000; i++ )
+		{
+			const __m256d origin = _mm256_add_pd( rng.next3(), _mm256_setr_pd( 0, 0, 2, 0 ) );
+			const __m256d dir = _mm256_add_pd( rng.next3(), _mm256_setr_pd( 0, 0, -1.5, 0 ) );
+			BvhRayHit h1, h2;
+			const bool f1 = serial.intersect( origin, dir, g_misc.infinity, h1 );
+			const bool f2 = parallel.intersect( origin, dir, g_misc.infinity, h2 );
+			assert( f1 == f2 && ( !f1 || h1.t == h2.t ) );
+
+			BvhClosestPoint c1, c2;
+			serial.closestPoint( origin, g_misc.infinity, c1 );
+			parallel.closestPoint( origin, g_misc.infinity, c2 );
+			assert( c1.distanceSquared == c2.distanceSquared );
+		}
+	}
+}
+
+namespace
+{
+	// Perspective projection looking along +Z, and a view transform which rotates around Y then moves the camera to [ 1, 2, 3 ]
+	Matrix4x4 testViewProj()
+	{
+		const double n = 0.5, f = 20, xs = 1.2, ys = 1.6;
+		Matrix4x4 proj;
+		proj.r0 = _mm256_setr_pd( xs, 0, 0, 0 );
+		proj.r1 = _mm256_setr_pd( 0, ys, 0, 0 );
+		proj.r2 = _mm256_setr_pd( 0, 0, f / ( f - n ), -n * f / ( f - n ) );
+		proj.r3 = _mm256_setr_pd( 0, 0, 1, 0 );
+
+		const double c = std::cos( 0.3 ), s = std::sin( 0.3 );
+		Matrix4x4 view;
+		view.r0 = _mm256_setr_pd( c, 0, -s, 0 );
+		view.r1 = _mm256_setr_pd( 0, 1, 0, 0 );
+		view.r2 = _mm256_setr_pd( s, 0, c, 0 );
+		view.r3 = _mm256_setr_pd( 0, 0, 0, 1 );
+		const __m256d eye = vector4Transform( _mm256_setr_pd( 1, 2, 3, 0 ), view );
+		view.r0 = _mm256_blend_pd( view.r0, vectorNegate( vectorSplatX( eye ) ), 0b1000 );
+		view.r1 = _mm256_blend_pd( view.r1, vectorNegate( vectorSplatY( eye ) ), 0b1000 );
+		view.r2 = _mm256_blend_pd( view.r2, vectorNegate( vectorSplatZ( eye ) ), 0b1000 );
+		// proj * view, the rows of the product are linear combinations of the view rows
+		const auto row = [ &view ]( __m256d r )
+		{
+			__m256d res = _mm256_mul_pd( vectorSplatX( r ), view.r0 );
+			res = vectorMultiplyAdd( vectorSplatY( r ), view.r1, res );
+			res = vectorMultiplyAdd( vectorSplatZ( r ), view.r2, res );
+			return vectorMultiplyAdd( vectorSplatW( r ), view.r3, res );
+		};
+		return Matrix4x4{ row( proj.r0 ), row( proj.r1 ), row( proj.r2 ), row( proj.r3 ) };
+	}
+
+	void testCulling()
+	{
+		const __m256d plane = planeFromPoints( _mm256_setr_pd( 0, 0, 1, 0 ), _mm256_setr_pd( 2, 0, 1, 0 ), _mm256_setr_pd( 0, 3, 1, 0 ) );
+		assertEqual( plane, _mm256_setr_pd( 0, 0, 1, -1 ) );
+		assertEqual( planeDotCoord( plane, _mm256_setr_pd( 5, 5, 3, 7 ) ), _mm256_set1_pd( 2 ) );
+		assertEqual( planeNormalize( _mm256_setr_pd( 0, 3, 4, 10 ) ), _mm256_setr_pd( 0, 0.6, 0.8, 2 ), 1E-15 );
+
+		const Matrix4x4 viewProj = testViewProj();
+		const Frustum frustum = frustumFromMatrix( viewProj );
+		// The camera is inside the frustum behind the near plane
+		assert( vectorGetX( planeDotCoord( loadDouble4( frustum.planes[ 4 ] ), _mm256_setr_pd( 1, 2, 3, 0 ) ) ) < 0 );
+
+		// Points, as spheres of zero radius: the planes must agree with the clip space coordinates
+		Random rng;
+		constexpr size_t count = 1001;
+		std::vector<double> spheres, boxes;
+		for( size_t i = 0; i < count; i++ )
+		{
+			const __m256d pos = _mm256_add_pd( _mm256_mul_pd( rng.next3(), _mm256_set1_pd( 12 ) ), _mm256_setr_pd( 1, 2, 12, 0 ) );
+			spheres.insert( spheres.end(), { vectorGetX( pos ), vectorGetY( pos ), vectorGetZ( pos ), 0.0 } );
+		}
+		std::vector<uint32_t> visible( count );
+		visible.resize( frustumCullSpheres( frustum, spheres.data(), count, visible.data() ) );
+		assert( std::is_sorted( visible.begin(), visible.end() ) );
+		std::vector<bool> flags( count, false );
+		for( uint32_t i : visible )
+			flags[ i ] = true;
+		size_t inside = 0;
+		for( size_t i = 0; i < count; i++ )
+		{
+			alignas( 32 ) double clip[ 4 ];
+			_mm256_store_pd( clip, vector4Transform( vector3Homogeneous( loadDouble3( &spheres[ i * 4 ] ) ), viewProj ) );
+			const double w = clip[ 3 ];
+			const double margin = std::min( { w - std::abs( clip[ 0 ] ), w - std::abs( clip[ 1 ] ), clip[ 2 ], w - clip[ 2 ] } );
+			if( std::abs( margin ) < 1E-9 )
+				continue;
+			assert( flags[ i ] == ( margin > 0 ) );
+			inside += flags[ i ] ? 1 : 0;
+		}
+		assert( inside > 50 && inside < count - 50 );
+
+		// Boxes: culled when all 8 corners are outside of one plane
+		for( size_t i = 0; i < count; i++ )
+		{
+			const __m256d a = _mm256_add_pd( _mm256_mul_pd( rng.next3(), _mm256_set1_pd( 12 ) ), _mm256_setr_pd( 1, 2, 12, 0 ) );
+			const __m256d b = _mm256_add_pd( a, _mm256_mul_pd( vectorAbs( rng.next3() ), _mm256_set1_pd( 3 ) ) );
+			boxes.insert( boxes.end(), { vectorGetX( a ), vectorGetY( a ), vectorGetZ( a ), vectorGetX( b ), vectorGetY( b ), vectorGetZ( b ) } );
+		}
+		boxes[ 6 * 5 + 4 ] = g_misc.quietNaN;
+		visible.resize( count );
+		visible.resize( frustumCullBoxes( frustum, boxes.data(), count, visible.data() ) );
+		assert( std::is_sorted( visible.begin(), visible.end() ) );
+		flags.assign( count, false );
+		for( uint32_t i : visible )
+			flags[ i ] = true;
+		assert( flags[ 5 ] );
+		inside = 0;
+		for( size_t i = 0; i < count; i++ )
+		{
+			if( i == 5 )
+				continue;
+			double margin = g_misc.infinity;
+			for( size_t p = 0; p < 6; p++ )
+			{
+				double maxDist = -g_misc.infinity;
+				for( int corner = 0; corner < 8; corner++ )
+				{
+					const __m256d pt = _mm256_setr_pd( boxes[ i * 6 + ( ( corner & 1 ) ? 3 : 0 ) ], boxes[ i * 6 + ( ( corner & 2 ) ? 4 : 1 ) ], boxes[ i * 6 + ( ( corner & 4 ) ? 5 : 2 ) ], 0 );
+					maxDist = std::max( maxDist, vectorGetX( planeDotCoord( loadDouble4( frustum.planes[ p ] ), pt ) ) );
+				}
+				margin = std::min( margin, maxDist );
+			}
+			if( std::abs( margin ) < 1E-9 )
+				continue;
+			assert( flags[ i ] == ( margin > 0 ) );
+			inside += flags[ i ] ? 1 : 0;
+		}
+		assert( inside > 50 && inside < count - 50 );
+
+		// Every count of objects, to cover the incomplete batches
+		for( size_t n = 0; n <= 8; n++ )
+		{
+			const size_t expected = std::count_if( flags.begin(), flags.begin() + n, []( bool b ) { return b; } );
+			assert( frustumCullBoxes( frustum, boxes.data(), n, visible.data() ) == expected );
+		}
+	}
+}
+
+namespace
+{
+	void testPolyline()
+	{
+		// Random walk, with duplicate points, and a few segments which are much longer than the rest
+		Random rng;
+		constexpr size_t count = 300001;
+		std::vector<double> xyz( count * 3 );
+		double pos[ 3 ] = { 1, 2, 3 };
+		for( size_t i = 0; i < count; i++ )
+		{
+			if( 0 != i % 97 )
+			{
+				const double scale = ( 0 == i % 1001 ) ? 50.0 : 1.0;
+				for( int c = 0; c < 3; c++ )
+					pos[ c ] += rng.next() * scale;
+			}
+			memcpy( &xyz[ i * 3 ], pos, sizeof( pos ) );
+		}
+
+		// Scalar references
+		std::vector<double> lengthsRef( count - 1 ), arcRef( count ), curvatureRef( count, 0.0 );
+		arcRef[ 0 ] = 0;
+		for( size_t i = 0; i + 1 < count; i++ )
+		{
+			const double* a = &xyz[ i * 3 ];
+			const double dx = a[ 3 ] - a[ 0 ], dy = a[ 4 ] - a[ 1 ], dz = a[ 5 ] - a[ 2 ];
+			lengthsRef[ i ] = std::sqrt( dx * dx + dy * dy + dz * dz );
+			arcRef[ i + 1 ] = arcRef[ i ] + lengthsRef[ i ];
+		}
+		for( size_t i = 1; i + 1 < count; i++ )
+		{
+			const __m256d a = loadDouble3( &xyz[ i * 3 - 3 ] ), b = loadDouble3( &xyz[ i * 3 ] ), c = loadDouble3( &xyz[ i * 3 + 3 ] );
+			const __m256d cross = vector3Cross( _mm256_sub_pd( b, a ), _mm256_sub_pd( c, a ) );
+			const __m256d ac = _mm256_sub_pd( c, a );
+			const double area2 = std::sqrt( vectorGetX( vector3Dot( cross, cross ) ) );
+			const double den = lengthsRef[ i - 1 ] * lengthsRef[ i ] * std::sqrt( vectorGetX( vector3Dot( ac, ac ) ) );
+			curvatureRef[ i ] = den > 0 ? 2 * area2 / den : 0;
+		}
+
+		for( bool parallel : { false, true } )
+		{
+			std::vector<double> lengths( count - 1 ), arc( count ), curvature( count );
+			polylineSegmentLengths( xyz.data(), count, lengths.data(), parallel );
+			for( size_t i = 0; i + 1 < count; i++ )
+				assert( std::abs( lengths[ i ] - lengthsRef[ i ] ) <= lengthsRef[ i ] * 1E-15 );
+
+			const double total = polylineArcLength( xyz.data(), count, arc.data(), parallel );
+			assert( total == arc[ count - 1 ] );
+			assert( 0 == arc[ 0 ] );
+			for( size_t i = 0; i < count; i++ )
+				assert( std::abs( arc[ i ] - arcRef[ i ] ) <= arcRef[ count - 1 ] * 1E-12 );
+			for( size_t i = 0; i + 1 < count; i++ )
+				assert( arc[ i ] <= arc[ i + 1 ] );
+
+			polylineCurvature( xyz.data(), count, curvature.data(), parallel );
+			for( size_t i = 0; i < count; i++ )
+				assert( std::abs( curvature[ i ] - curvatureRef[ i ] ) <= 1E-9 * std::max( 1.0, curvatureRef[ i ] ) );
+
+			// Resample, every sample must be on the polyline at the expected arc length
+			constexpr size_t samples = 100003;
+			std::vector<double> result( samples * 3 );
+			polylineResample( xyz.data(), arc.data(), count, result.data(), samples, parallel );
+			assert( 0 == memcmp( result.data(), xyz.data(), 3 * sizeof( double ) ) );
+			assert( 0 == memcmp( &result[ samples * 3 - 3 ], &xyz[ count * 3 - 3 ], 3 * sizeof( double ) ) );
+			size_t j = 0;
+			for( size_t k = 1; k + 1 < samples; k++ )
+			{
+				const double s = (double)k * total / (double)( samples - 1 );
+				while( arc[ j + 1 ] < s )
+					j++;
+				const double len = arc[ j + 1 ] - arc[ j ];
+				const double t = ( s - arc[ j ] ) / len;
+				for( int c = 0; c < 3; c++ )
+				{
+					const double expected = xyz[ j * 3 + c ] + ( xyz[ j * 3 + 3 + c ] - xyz[ j * 3 + c ] ) * t;
+					assert( std::abs( result[ k * 3 + c ] - expected ) < 1E-9 );
+				}
+			}
+		}
+
+		// Helix of radius r and pitch h has curvature r / ( r^2 + c^2 ) where c = h / 2pi; the discrete one converges to it with small steps
+		constexpr size_t helixCount = 1003;
+		const double r = 3, c = 0.5, step = 0.001;
+		std::vector<double> helix;
+		for( size_t i = 0; i < helixCount; i++ )
+		{
+			const double a = (double)i * step;
+			helix.insert( helix.end(), { r * std::cos( a ), r * std::sin( a ), c * a } );
+		}
+		std::vector<double> curvature( helixCount );
+		polylineCurvature( helix.data(), helixCount, curvature.data() );
+		assert( 0 == curvature[ 0 ] && 0 == curvature[ helixCount - 1 ] );
+		for( size_t i = 1; i + 1 < helixCount; i++ )
+			assert( std::abs( curvature[ i ] - r / ( r * r + c * c ) ) < 1E-6 );
+
+		// Short polylines, to cover the incomplete batches
+		for( size_t n = 0; n <= 9; n++ )
+		{
+			std::vector<double> arc( n + 1, -1.0 ), curvature( n + 1, -1.0 );
+			const double total = polylineArcLength( xyz.data(), n, arc.data() );
+			assert( total == ( n > 0 ? arc[ n - 1 ] : 0.0 ) );
+			for( size_t i = 0; i < n; i++ )
+				assert( std::abs( arc[ i ] - arcRef[ i ] ) < 1E-12 );
+			assert( -1.0 == arc[ n ] );
+			polylineCurvature( xyz.data(), n, curvature.data() );
+			for( size_t i = 0; i < n; i++ )
+				assert( std::abs( curvature[ i ] - ( i + 1 < n ? curvatureRef[ i ] : 0.0 ) ) < 1E-9 );
+			assert( -1.0 == curvature[ n ] );
+		}
+	}
+}
+
+namespace
+{
+	void testMeshNormals()
+	{
+		std::vector<double> xyz;
+		std::vector<uint32_t> indices;
+		makeSphere( 2.5, 150, 301, xyz, indices );
+		// An extra vertex which isn't referenced by any triangle, and a degenerate triangle
+		xyz.insert( xyz.end(), { 1, 2, 3 } );
+		indices.insert( indices.end(), { 5, 5, 6 } );
+		const size_t vertices = xyz.size() / 3;
+		const size_t triangles = indices.size() / 3;
+
+		// Scalar reference: scatter-add of the cross products, then normalize
+		std::vector<double> expected( vertices * 3, 0.0 );
+		for( size_t t = 0; t < triangles; t++ )
+		{
+			const uint32_t* tri = &indices[ t * 3 ];
+			const __m256d a = loadDouble3( &xyz[ tri[ 0 ] * 3 ] ), b = loadDouble3( &xyz[ tri[ 1 ] * 3 ] ), c = loadDouble3( &xyz[ tri[ 2 ] * 3 ] );
+			const __m256d n = vector3Cross( _mm256_sub_pd( b, a ), _mm256_sub_pd( c, a ) );
+			for( int v = 0; v < 3; v++ )
+				storeDouble3( &expected[ tri[ v ] * 3 ], _mm256_add_pd( loadDouble3( &expected[ tri[ v ] * 3 ] ), n ) );
+		}
+
+		MeshNormals mn;
+		mn.build( indices.data(), triangles, vertices );
+		assert( mn.vertexCount() == vertices && mn.triangleCount() == triangles );
+		std::vector<double> serial( vertices * 3 ), parallel( vertices * 3 );
+		mn.compute( xyz.data(), serial.data(), false );
+		mn.compute( xyz.data(), parallel.data(), true );
+		assert( serial == parallel );
+
+		for( size_t i = 0; i + 1 < vertices; i++ )
+		{
+			const __m256d n = loadDouble3( &serial[ i * 3 ] );
+			assertEqual( n, vector3Normalize( loadDouble3( &expected[ i * 3 ] ) ), 1E-14 );
+			// On the sphere, the normals are close to the direction from the center
+			const double cosine = vectorGetX( vector3Dot( n, vector3Normalize( loadDouble3( &xyz[ i * 3 ] ) ) ) );
+			assert( cosine > 0.9999 );
+		}
+		assertEqual( loadDouble3( &serial[ vertices * 3 - 3 ] ), _mm256_setzero_pd() );
+
+		// The one-shot function, and small meshes to cover the incomplete batches
+		std::vector<double> normals( vertices * 3 );
+		meshVertexNormals( xyz.data(), vertices, indices.data(), triangles, normals.data() );
+		assert( normals == serial );
+		// Strip of n triangles in XY plane, all of them facing -Z
+		for( size_t n = 0; n <= 9; n++ )
+		{
+			std::vector<double> strip;
+			std::vector<uint32_t> stripIndices;
+			for( uint32_t i = 0; i < n + 2; i++ )
+				strip.insert( strip.end(), { (double)( i / 2 ), (double)( i % 2 ), 0 } );
+			for( uint32_t t = 0; t < n; t++ )
+			{
+				if( 0 == t % 2 )
+					stripIndices.insert( stripIndices.end(), { t, t + 1, t + 2 } );
+				else
+					stripIndices.insert( stripIndices.end(), { t + 1, t, t + 2 } );
+			}
+			normals.assign( ( n + 3 ) * 3, 7.0 );
+			meshVertexNormals( strip.data(), n + 2, stripIndices.data(), n, normals.data() );
+			for( size_t i = 0; i < n + 2; i++ )
+				assertEqual( loadDouble3( &normals[ i * 3 ] ), n > 0 ? _mm256_setr_pd( 0, 0, -1, 0 ) : _mm256_setzero_pd(), 0 );
+			assert( 7.0 == normals[ ( n + 2 ) * 3 ] );
+		}
+	}
+}
+namespace
+{
+	int sign( double x )
+	{
+		return ( x > 0 ) - ( x < 0 );
+	}
+
+	// Array of 2D or 3D points, 4 doubles per point
+	struct Points
+	{
+		std::vector<double> data;
+
+		void push( __m128d p )
+		{
+			push( _mm256_setr_pd( _mm_cvtsd_f64( p ), vectorGetY( p ), 0, 0 ) );
+		}
+		void push( __m256d p )
+		{
+			data.resize( data.size() + 4 );
+			_mm256_storeu_pd( &data[ data.size() - 4 ], p );
+		}
+		__m128d point2( size_t i ) const
+		{
+			return _mm_loadu_pd( &data[ i * 4 ] );
+		}
+		__m256d point3( size_t i ) const
+		{
+			return _mm256_loadu_pd( &data[ i * 4 ] );
+		}
+
+		// SoA vectors from the points [ i .. i + 3 ]
+		Vector2x4 soa2( size_t i ) const
+		{
+			const Vector3x4 v = soa3( i );
+			return Vector2x4{ v.x, v.y };
+		}
+		Vector3x4 soa3( size_t i ) const
+		{
+			const double* p = &data[ i * 4 ];
+			return Vector3x4{ _mm256_setr_pd( p[ 0 ], p[ 4 ], p[ 8 ], p[ 12 ] ), _mm256_setr_pd( p[ 1 ], p[ 5 ], p[ 9 ], p[ 13 ] ), _mm256_setr_pd( p[ 2 ], p[ 6 ], p[ 10 ], p[ 14 ] ) };
+		}
+	};
+
+	// Queries of the 2D predicates, verify the batch versions produce the same results as the single ones
+	struct Queries2
+	{
+		Points a, b, c, d;
+		std::vector<int> expected;
+
+		void add( __m128d pa, __m128d pb, __m128d pc, __m128d pd, int sign )
+		{
+			a.push( pa );
+			b.push( pb );
+			c.push( pc );
+			d.push( pd );
+			expected.push_back( sign );
+		}
+
+		// For orient2d, d is not used
+		void test( bool circle ) const
+		{
+			for( size_t i = 0; i < expected.size(); i++ )
+			{
+				const double res = circle ? incircle( a.point2( i ), b.point2( i ), c.point2( i ), d.point2( i ) ) : orient2d( a.point2( i ), b.point2( i ), c.point2( i ) );
+				assert( sign( res ) == expected[ i ] );
+				if( 0 != i % 4 || i + 4 > expected.size() )
+					continue;
+				const Vector2x4 va = a.soa2( i ), vb = b.soa2( i ), vc = c.soa2( i ), vd = d.soa2( i );
+				const __m256d batch = circle ? incircle4( va, vb, vc, vd ) : orient2d4( va, vb, vc );
+				for( size_t j = 0; j < 4; j++ )
+					assert( sign( lane( batch, j ) ) == expected[ i + j ] );
+			}
+		}
+	};
+
+	struct Queries3
+	{
+		Points a, b, c, d, e;
+		std::vector<int> expected;
+
+		void add( __m256d pa, __m256d pb, __m256d pc, __m256d pd, __m256d pe, int sign )
+		{
+			a.push( pa );
+			b.push( pb );
+			c.push( pc );
+			d.push( pd );
+			e.push( pe );
+			expected.push_back( sign );
+		}
+
+		// For orient3d, e is not used
+		void test( bool sphere ) const
+		{
+			for( size_t i = 0; i < expected.size(); i++ )
+			{
+				const double res = sphere ? insphere( a.point3( i ), b.point3( i ), c.point3( i ), d.point3( i ), e.point3( i ) ) :
+					orient3d( a.point3( i ), b.point3( i ), c.point3( i ), d.point3( i ) );
+				assert( sign( res ) == expected[ i ] );
+				if( 0 != i % 4 || i + 4 > expected.size() )
+					continue;
+				const Vector3x4 va = a.soa3( i ), vb = b.soa3( i ), vc = c.soa3( i ), vd = d.soa3( i ), ve = e.soa3( i );
+				const __m256d batch = sphere ? insphere4( va, vb, vc, vd, ve ) : orient3d4( va, vb, vc, vd );
+				for( size_t j = 0; j < 4; j++ )
+					assert( sign( lane( batch, j ) ) == expected[ i + j ] );
+			}
+		}
+	};
+
+	// Random integer coordinates in [ -range .. +range ], lots of degenerate configurations
+	int64_t randomInt( Random& rng, int range )
+	{
+		return (int64_t)std::floor( ( rng.next() + 1.0 ) * 0.5 * ( 2 * range + 1 ) ) - range;
+	}
+
+	// Exact determinants of integer matrices, with cofactor expansion along the first row
+	int64_t det2( int64_t a, int64_t b, int64_t c, int64_t d )
+	{
+		return a * d - b * c;
+	}
+	int64_t det3( const int64_t* m )
+	{
+		return m[ 0 ] * det2( m[ 4 ], m[ 5 ], m[ 7 ], m[ 8 ] ) - m[ 1 ] * det2( m[ 3 ], m[ 5 ], m[ 6 ], m[ 8 ] ) + m[ 2 ] * det2( m[ 3 ], m[ 4 ], m[ 6 ], m[ 7 ] );
+	}
+	int64_t det4( const int64_t* m )
+	{
+		int64_t res = 0;
+		for( int col = 0; col < 4; col++ )
+		{
+			int64_t minor[ 9 ];
+			int k = 0;
+			for( int r = 1; r < 4; r++ )
+				for( int c = 0; c < 4; c++ )
+					if( c != col )
+						minor[ k++ ] = m[ r * 4 + c ];
+			const int64_t term = m[ col ] * det3( minor );
+			res += ( 0 == col % 2 ) ? term : -term;
+		}
+		return res;
+	}
+
+	void testRobustRandom()
+	{
+		Random rng;
+		Queries2 q2, qc;
+		Queries3 q3, qs;
+		for( size_t i = 0; i < 4000; i++ )
+		{
+			int64_t p[ 5 ][ 3 ];
+			for( auto& pt : p )
+				for( int64_t& c : pt )
+					c = randomInt( rng, 0 == i % 2 ? 2 : 100 );
+			__m128d p2[ 5 ];
+			__m256d p3[ 5 ];
+			for( int j = 0; j < 5; j++ )
+			{
+				p2[ j ] = _mm_setr_pd( (double)p[ j ][ 0 ], (double)p[ j ][ 1 ] );
+				p3[ j ] = _mm256_setr_pd( (double)p[ j ][ 0 ], (double)p[ j ][ 1 ], (double)p[ j ][ 2 ], 0 );
+			}
+
+			// Subtract the last point from the others, same as the formulas in the paper
+			const int64_t o2 = det2( p[ 0 ][ 0 ] - p[ 2 ][ 0 ], p[ 0 ][ 1 ] - p[ 2 ][ 1 ], p[ 1 ][ 0 ] - p[ 2 ][ 0 ], p[ 1 ][ 1 ] - p[ 2 ][ 1 ] );
+			q2.add( p2[ 0 ], p2[ 1 ], p2[ 2 ], p2[ 3 ], sign( (double)o2 ) );
+
+			int64_t lifted[ 9 ];
+			for( int r = 0; r < 3; r++ )
+			{
+				const int64_t x = p[ r ][ 0 ] - p[ 3 ][ 0 ], y = p[ r ][ 1 ] - p[ 3 ][ 1 ];
+				lifted[ r * 3 ] = x;
+				lifted[ r * 3 + 1 ] = y;
+				lifted[ r * 3 + 2 ] = x * x + y * y;
+			}
+			qc.add( p2[ 0 ], p2[ 1 ], p2[ 2 ], p2[ 3 ], sign( (double)det3( lifted ) ) );
+
+			int64_t m33[ 9 ];
+			for( int r = 0; r < 3; r++ )
+				for( int c = 0; c < 3; c++ )
+					m33[ r * 3 + c ] = p[ r ][ c ] - p[ 3 ][ c ];
+			q3.add( p3[ 0 ], p3[ 1 ], p3[ 2 ], p3[ 3 ], p3[ 4 ], sign( (double)det3( m33 ) ) );
+
+			int64_t m3[ 16 ];
+			for( int r = 0; r < 4; r++ )
+			{
+				int64_t lift = 0;
+				for( int c = 0; c < 3; c++ )
+				{
+					m3[ r * 4 + c ] = p[ r ][ c ] - p[ 4 ][ c ];
+					lift += m3[ r * 4 + c ] * m3[ r * 4 + c ];
+				}
+				m3[ r * 4 + 3 ] = lift;
+			}
+			qs.add( p3[ 0 ], p3[ 1 ], p3[ 2 ], p3[ 3 ], p3[ 4 ], sign( (double)det4( m3 ) ) );
+		}
+		q2.test( false );
+		qc.test( true );
+		q3.test( false );
+		qs.test( true );
+	}
+
+	// Points within a few ULPs of degenerate configurations, where the floating-point determinants have wrong signs
+	void testRobustDegenerate()
+	{
+		// Kettner et al, "Classroom examples of robustness problems in geometric computations": p is near the line through q and r
+		Queries2 q2;
+		size_t wrongSigns = 0;
+		for( int i = 0; i < 64; i++ )
+		{
+			for( int j = 0; j < 64; j++ )
+			{
+				const __m128d p = _mm_setr_pd( 0.5 + i * 0x1p-53, 0.5 + j * 0x1p-53 );
+				const __m128d q = _mm_set1_pd( 12 ), r = _mm_set1_pd( 24 );
+				// The exact value is 12 * ( py - px )
+				const int expected = ( j > i ) - ( j < i );
+				q2.add( p, q, r, p, expected );
+				const double naive = ( 0.5 + i * 0x1p-53 - 24 ) * ( 12 - 24 ) - ( 0.5 + j * 0x1p-53 - 24 ) * ( 12 - 24 );
+				if( sign( naive ) != expected )
+					wrongSigns++;
+			}
+		}
+		q2.test( false );
+		printf( "orient2d near a line, %zu wrong signs of %zu in the naive determinant\n", wrongSigns, q2.expected.size() );
+
+		// Points near the plane z = x + y, the triangle a, b, c is clockwise when viewed from +Z
+		Queries3 q3;
+		const __m256d a = _mm256_setr_pd( 3, 5, 8, 0 ), b = _mm256_setr_pd( 7, -2, 5, 0 ), c = _mm256_setr_pd( -4, 6, 2, 0 );
+		for( int i = -6; i <= 6; i++ )
+			for( int j = -6; j <= 6; j++ )
+				for( int k = -6; k <= 6; k++ )
+				{
+					// The exact value is 45 * ( dz - dx - dy ) = 45 * ( 2k - i - j ) * 2^-53
+					const __m256d d = _mm256_setr_pd( 0.5 + i * 0x1p-53, 0.5 + j * 0x1p-53, 1 + k * 0x1p-52, 0 );
+					const int v = 2 * k - i - j;
+					q3.add( a, b, c, d, d, ( v > 0 ) - ( v < 0 ) );
+				}
+		q3.test( false );
+
+		// Circle x^2 + y^2 = 25, d is near ( 3, 4 ) point on the circle
+		Queries2 qc;
+		const __m128d ca = _mm_setr_pd( 5, 0 ), cb = _mm_setr_pd( 0, 5 ), cc = _mm_setr_pd( -5, 0 );
+		for( int i = -8; i <= 8; i++ )
+			for( int j = -8; j <= 8; j++ )
+			{
+				// 25 - |d|^2 = -( 6i + 8j ) * u - ( i^2 + j^2 ) * u^2, the second term decides the sign when 6i + 8j = 0
+				const __m128d d = _mm_setr_pd( 3 + i * 0x1p-50, 4 + j * 0x1p-50 );
+				const int first = 6 * i + 8 * j;
+				const int expected = 0 != first ? ( first < 0 ) - ( first > 0 ) : -( 0 != i || 0 != j );
+				qc.add( ca, cb, cc, d, expected );
+			}
+		qc.test( true );
+
+		// Sphere x^2 + y^2 + z^2 = 9, e is near ( 1, 2, 2 ) point on the sphere
+		Queries3 qs;
+		__m256d sa = _mm256_setr_pd( 3, 0, 0, 0 ), sb = _mm256_setr_pd( 0, 3, 0, 0 ), sc = _mm256_setr_pd( 0, 0, 3, 0 ), sd = _mm256_setr_pd( -3, 0, 0, 0 );
+		if( orient3d( sa, sb, sc, sd ) < 0 )
+			std::swap( sa, sb );
+		assert( orient3d( sa, sb, sc, sd ) > 0 );
+		for( int i = -4; i <= 4; i++ )
+			for( int j = -4; j <= 4; j++ )
+				for( int k = -4; k <= 4; k++ )
+				{
+					const __m256d e = _mm256_setr_pd( 1 + i * 0x1p-52, 2 + j * 0x1p-51, 2 + k * 0x1p-51, 0 );
+					// 9 - |e|^2 = -( 2i + 8j + 8k ) * 2^-52 - ( i^2 + 4 j^2 + 4 k^2 ) * 2^-104
+					const int first = 2 * i + 8 * j + 8 * k;
+					const int expected = 0 != first ? ( first < 0 ) - ( first > 0 ) : -( 0 != i || 0 != j || 0 != k );
+					qs.add( sa, sb, sc, sd, e, expected );
+				}
+		qs.test( true );
+	}
+
+	void testRobust()
+	{
+		// Sign conventions
+		assert( orient2d( _mm_setr_pd( 0, 0 ), _mm_setr_pd( 1, 0 ), _mm_setr_pd( 0, 1 ) ) > 0 );
+		assert( orient3d( _mm256_setr_pd( 0, 0, 0, 0 ), _mm256_setr_pd( 1, 0, 0, 0 ), _mm256_setr_pd( 0, 1, 0, 0 ), _mm256_setr_pd( 0, 0, -1, 0 ) ) > 0 );
+		assert( incircle( _mm_setr_pd( 1, 0 ), _mm_setr_pd( 0, 1 ), _mm_setr_pd( -1, 0 ), _mm_setr_pd( 0, 0 ) ) > 0 );
+		assert( 0 == incircle( _mm_setr_pd( 1, 0 ), _mm_setr_pd( 0, 1 ), _mm_setr_pd( -1, 0 ), _mm_setr_pd( 0, -1 ) ) );
+		// Exact determinant of the unit triangle
+		assert( 1.0 == orient2dExact( _mm_setr_pd( 0, 0 ), _mm_setr_pd( 1, 0 ), _mm_setr_pd( 0, 1 ) ) );
+
+		testRobustRandom();
+		testRobustDegenerate();
+	}
+
+	// Random points on a grid with the step 1/8, the squared distances are exact and many of them are equal
+	std::vector<double> kdTreePoints( Random& rng, size_t count )
+	{
+		std::vector<double> xyz( count * 3 );
+		for( double& v : xyz )
+			v = std::round( rng.next() * 24 ) / 8;
+		return xyz;
+	}
+
+	double distanceSquared( const double* a, const double* b )
+	{
+		const double dx = a[ 0 ] - b[ 0 ], dy = a[ 1 ] - b[ 1 ], dz = a[ 2 ] - b[ 2 ];
+		return dx * dx + dy * dy + dz * dz;
+	}
+
+	// Compare k nearest neighbours with brute force, the results must have the same distances; indices may differ for equal distances
+	void testKdTreeNearest( const std::vector<double>& points, const double* query, size_t k, double maxDistance, size_t found, const uint32_t* indices, const double* distances )
+	{
+		const size_t count = points.size() / 3;
+		std::vector<double> expected;
+		for( size_t i = 0; i < count; i++ )
+		{
+			const double d = distanceSquared( &points[ i * 3 ], query );
+			if( d <= maxDistance * maxDistance )
+				expected.push_back( d );
+		}
+		std::sort( expected.begin(), expected.end() );
+		assert( found == std::min( k, expected.size() ) );
+		for( size_t i = 0; i < found; i++ )
+		{
+			assert( distances[ i ] == expected[ i ] );
+			assert( indices[ i ] < count );
+			assert( distanceSquared( &points[ indices[ i ] * 3 ], query ) == distances[ i ] );
+			for( size_t j = 0; j < i; j++ )
+				assert( indices[ i ] != indices[ j ] );
+		}
+	}
+
+	void testKdTreeRadius( const std::vector<double>& points, const double* query, double radius, std::vector<uint32_t> indices )
+	{
+		std::vector<uint32_t> expected;
+		for( size_t i = 0; i < points.size() / 3; i++ )
+			if( distanceSquared( &points[ i * 3 ], query ) <= radius * radius )
+				expected.push_back( (uint32_t)i );
+		std::sort( indices.begin(), indices.end() );
+		assert( indices == expected );
+	}
+
+	// Compare every checkStep-th query with brute force
+	void testKdTree( size_t count, size_t queriesCount, Random& rng, size_t checkStep = 1 )
+	{
+		const std::vector<double> points = kdTreePoints( rng, count );
+		const std::vector<double> queries = kdTreePoints( rng, queriesCount );
+		KdTree tree;
+		tree.build( points.data(), count, true );
+		assert( tree.size() == count );
+
+		constexpr size_t k = 7;
+		constexpr double radius = 0.5;
+		for( double maxDistance : { g_misc.infinity, 0.375 } )
+		{
+			std::vector<uint32_t> indices( queriesCount * k );
+			std::vector<double> distances( queriesCount * k );
+			for( size_t i = 0; i < queriesCount; i += checkStep )
+			{
+				const double* q = &queries[ i * 3 ];
+				const size_t found = tree.nearest( loadDouble3( q ), k, indices.data(), distances.data(), maxDistance );
+				testKdTreeNearest( points, q, k, maxDistance, found, indices.data(), distances.data() );
+			}
+
+			for( bool parallel : { false, true } )
+			{
+				tree.nearest( queries.data(), queriesCount, k, indices.data(), distances.data(), maxDistance, parallel );
+				for( size_t i = 0; i < queriesCount; i += checkStep )
+				{
+					const uint32_t* idx = &indices[ i * k ];
+					const size_t found = std::find( idx, idx + k, UINT32_MAX ) - idx;
+					testKdTreeNearest( points, &queries[ i * 3 ], k, maxDistance, found, idx, &distances[ i * k ] );
+					for( size_t j = found; j < k; j++ )
+						assert( UINT32_MAX == idx[ j ] && distances[ i * k + j ] == g_misc.infinity );
+				}
+			}
+		}
+
+		std::vector<uint32_t> indices;
+		std::vector<double> distances;
+		for( size_t i = 0; i < queriesCount; i += checkStep )
+		{
+			const double* q = &queries[ i * 3 ];
+			indices.clear();
+			distances.clear();
+			const size_t found = tree.radiusSearch( loadDouble3( q ), radius, indices, &distances );
+			assert( found == indices.size() && found == distances.size() );
+			for( size_t j = 0; j < found; j++ )
+				assert( distances[ j ] == distanceSquared( &points[ indices[ j ] * 3 ], q ) );
+			testKdTreeRadius( points, q, radius, indices );
+		}
+
+		for( bool parallel : { false, true } )
+		{
+			std::vector<size_t> offsets;
+			tree.radiusSearch( queries.data(), queriesCount, radius, offsets, indices, parallel );
+			assert( offsets.size() == queriesCount + 1 && offsets[ queriesCount ] == indices.size() );
+			for( size_t i = 0; i < queriesCount; i += checkStep )
+				testKdTreeRadius( points, &queries[ i * 3 ], radius, std::vector<uint32_t>( indices.begin() + offsets[ i ], indices.begin() + offsets[ i + 1 ] ) );
+		}
+	}
+
+	void testKdTree()
+	{
+		Random rng;
+		// Small trees including the empty one and a single leaf
+		for( size_t count = 0; count <= 40; count++ )
+			testKdTree( count, 20, rng );
+		testKdTree( 3000, 200, rng );
+		// Larger than the minimum for the parallel build, on a coarse grid with many duplicate points
+		testKdTree( 140000, 2048, rng, 64 );
+
+		// All points at the same position
+		const std::vector<double> same( 100 * 3, 0.25 );
+		KdTree tree;
+		tree.build( same.data(), 100 );
+		uint32_t indices[ 5 ];
+		double distances[ 5 ];
+		assert( 5 == tree.nearest( _mm256_setr_pd( 0.25, 0.25, 1.25, 0 ), 5, indices, distances ) );
+		assert( 1.0 == distances[ 4 ] );
+		assert( 0 == tree.nearest( _mm256_setr_pd( 0.25, 0.25, 1.25, 0 ), 5, indices, distances, 0.5 ) );
+	}
+
+	// Basis function N[ i ] of degree p by the definition, Cox-de Boor recursion with 0 / 0 = 0
+	double basisReference( const double* knots, size_t i, uint32_t p, double t )
+	{
+		if( 0 == p )
+			return ( knots[ i ] <= t && t < knots[ i + 1 ] ) ? 1.0 : 0.0;
+		double res = 0;
+		if( knots[ i + p ] > knots[ i ] )
+			res += ( t - knots[ i ] ) / ( knots[ i + p ] - knots[ i ] ) * basisReference( knots, i, p - 1, t );
+		if( knots[ i + p + 1 ] > knots[ i + 1 ] )
+			res += ( knots[ i + p + 1 ] - t ) / ( knots[ i + p + 1 ] - knots[ i + 1 ] ) * basisReference( knots, i + 1, p - 1, t );
+		return res;
+	}
+
+	// Random clamped knot vector with count + degree + 1 elements on [ 0 .. 1 ] domain, with a few double knots
+	std::vector<double> randomKnots( Random& rng, size_t count, uint32_t degree )
+	{
+		std::vector<double> knots( count + degree + 1 );
+		for( size_t i = 0; i <= degree; i++ )
+		{
+			knots[ i ] = 0;
+			knots[ count + i ] = 1;
+		}
+		for( size_t i = degree + 1; i < count; i++ )
+			knots[ i ] = ( i > degree + 1 && rng.next() > 0.6 ) ? knots[ i - 1 ] : rng.next() * 0.5 + 0.5;
+		std::sort( knots.begin() + degree + 1, knots.begin() + count );
+		return knots;
+	}
+
+	std::vector<double> randomWeights( Random& rng, size_t count )
+	{
+		std::vector<double> weights( count );
+		for( double& w : weights )
+			w = rng.next() * 0.75 + 1.25;
+		return weights;
+	}
+
+	void assertEqual3( const double* a, const double* b, double tolerance )
+	{
+		for( size_t i = 0; i < 3; i++ )
+			assert( std::abs( a[ i ] - b[ i ] ) <= tolerance * ( 1 + std::abs( b[ i ] ) ) );
+	}
+
+	// The finite differences are not accurate across the knots, where the derivatives may jump
+	bool nearKnot( const std::vector<double>& knots, double t, double h )
+	{
+		for( double k : knots )
+			if( std::abs( k - t ) <= h * 2 )
+				return true;
+		return false;
+	}
+
+	// Random parameters in the domain, sorted
+	std::vector<double> randomParameters( Random& rng, size_t count )
+	{
+		std::vector<double> t( count );
+		for( double& x : t )
+			x = rng.next() * 0.5 + 0.5;
+		std::sort( t.begin(), t.end() );
+		return t;
+	}
+
+	void testNurbsCurve( Random& rng, uint32_t degree, size_t count, bool rational )
+	{
+		std::vector<double> points( count * 3 );
+		for( double& v : points )
+			v = rng.next();
+		const std::vector<double> weights = randomWeights( rng, count );
+		const std::vector<double> knots = randomKnots( rng, count, degree );
+		const NurbsCurve curve{ points.data(), rational ? weights.data() : nullptr, knots.data(), count, degree };
+
+		// 1 extra point for the incomplete batch, then the finite differences
+		constexpr size_t length = 37;
+		constexpr double h = 1E-6;
+		std::vector<double> t = randomParameters( rng, length );
+		for( size_t i = 0; i < length; i++ )
+		{
+			t.push_back( t[ i ] - h );
+			t.push_back( t[ i ] + h );
+		}
+		std::vector<double> pos( t.size() * 3 ), d1( t.size() * 3 ), d2( t.size() * 3 );
+		nurbsEvaluate( curve, t.data(), t.size(), pos.data(), d1.data(), d2.data() );
+
+		for( size_t i = 0; i < length; i++ )
+		{
+			double expected[ 3 ] = { 0, 0, 0 }, w = 0;
+			for( size_t j = 0; j < count; j++ )
+			{
+				const double n = basisReference( knots.data(), j, degree, t[ i ] ) * ( rational ? weights[ j ] : 1.0 );
+				w += n;
+				for( size_t c = 0; c < 3; c++ )
+					expected[ c ] += n * points[ j * 3 + c ];
+			}
+			for( double& e : expected )
+				e /= w;
+			assertEqual3( &pos[ i * 3 ], expected, 1E-13 );
+
+			// Central differences
+			if( nearKnot( knots, t[ i ], h ) )
+				continue;
+			const size_t lo = ( length + i * 2 ) * 3, hi = lo + 3;
+			double fd1[ 3 ], fd2[ 3 ];
+			for( size_t c = 0; c < 3; c++ )
+			{
+				fd1[ c ] = ( pos[ hi + c ] - pos[ lo + c ] ) / ( 2 * h );
+				fd2[ c ] = ( d1[ hi + c ] - d1[ lo + c ] ) / ( 2 * h );
+			}
+			assertEqual3( &d1[ i * 3 ], fd1, 1E-5 );
+			assertEqual3( &d2[ i * 3 ], fd2, 1E-4 );
+		}
+
+		// Without the optional outputs, and in parallel
+		std::vector<double> pos2( t.size() * 3 );
+		nurbsEvaluate( curve, t.data(), t.size(), pos2.data(), nullptr, nullptr, true );
+		assert( pos == pos2 );
+	}
+
+	void testNurbsCircle()
+	{
+		// Full circle of radius 2 from 4 rational quadratic arcs
+		const double r = std::sqrt( 0.5 );
+		const double points[ 27 ] = { 2, 0, 0, 2, 2, 0, 0, 2, 0, -2, 2, 0, -2, 0, 0, -2, -2, 0, 0, -2, 0, 2, -2, 0, 2, 0, 0 };
+		const double weights[ 9 ] = { 1, r, 1, r, 1, r, 1, r, 1 };
+		const double knots[ 12 ] = { 0, 0, 0, 0.25, 0.25, 0.5, 0.5, 0.75, 0.75, 1, 1, 1 };
+		const NurbsCurve circle{ points, weights, knots, 9, 2 };
+
+		constexpr size_t length = 101;
+		double t[ length ], pos[ length * 3 ], d1[ length * 3 ], d2[ length * 3 ];
+		for( size_t i = 0; i < length; i++ )
+			t[ i ] = (double)i / ( length - 1 );
+		nurbsEvaluate( circle, t, length, pos, d1, d2 );
+		for( size_t i = 0; i < length; i++ )
+		{
+			const double* p = &pos[ i * 3 ];
+			const double* v = &d1[ i * 3 ];
+			const double* a = &d2[ i * 3 ];
+			assert( std::abs( std::sqrt( p[ 0 ] * p[ 0 ] + p[ 1 ] * p[ 1 ] ) - 2 ) < 1E-14 );
+			// The velocity is tangent, the acceleration of a circular motion has a centripetal component v^2 / r
+			assert( std::abs( p[ 0 ] * v[ 0 ] + p[ 1 ] * v[ 1 ] ) < 1E-12 );
+			const double speedSq = v[ 0 ] * v[ 0 ] + v[ 1 ] * v[ 1 ];
+			assert( std::abs( ( p[ 0 ] * a[ 0 ] + p[ 1 ] * a[ 1 ] ) / 2 + speedSq / 2 ) < 1E-11 * speedSq );
+		}
+		assert( pos[ 0 ] == 2 && pos[ 1 ] == 0 );
+		assert( std::abs( pos[ ( length - 1 ) * 3 ] - 2 ) < 1E-15 );
+	}
+
+	void testBezier( Random& rng )
+	{
+		for( size_t count = 1; count <= nurbsMaxDegree + 1; count++ )
+		{
+			std::vector<double> points( count * 3 );
+			for( double& v : points )
+				v = rng.next();
+			const std::vector<double> weights = randomWeights( rng, count );
+			const uint32_t degree = (uint32_t)count - 1;
+			std::vector<double> knots( count * 2, 0.0 );
+			std::fill( knots.begin() + count, knots.end(), 1.0 );
+
+			const std::vector<double> t = randomParameters( rng, 23 );
+			for( bool rational : { false, true } )
+			{
+				std::vector<double> pos( t.size() * 3 ), d1( t.size() * 3 ), d2( t.size() * 3 );
+				std::vector<double> pos2( t.size() * 3 ), d1b( t.size() * 3 ), d2b( t.size() * 3 );
+				const double* w = rational ? weights.data() : nullptr;
+				bezierEvaluate( points.data(), w, count, t.data(), t.size(), pos.data(), d1.data(), d2.data() );
+				const NurbsCurve curve{ points.data(), w, knots.data(), count, degree };
+				nurbsEvaluate( curve, t.data(), t.size(), pos2.data(), d1b.data(), d2b.data() );
+				// Higher degrees have larger derivatives
+				const double scale = (double)( count * count );
+				for( size_t i = 0; i < t.size(); i++ )
+				{
+					assertEqual3( &pos[ i * 3 ], &pos2[ i * 3 ], 1E-13 );
+					assertEqual3( &d1[ i * 3 ], &d1b[ i * 3 ], 1E-13 * scale );
+					assertEqual3( &d2[ i * 3 ], &d2b[ i * 3 ], 1E-12 * scale * scale );
+				}
+			}
+		}
+	}
+
+	void testNurbsSurface( Random& rng, uint32_t degreeU, uint32_t degreeV, size_t countU, size_t countV )
+	{
+		std::vector<double> points( countU * countV * 3 );
+		for( double& v : points )
+			v = rng.next();
+		const std::vector<double> weights = randomWeights( rng, countU * countV );
+		const std::vector<double> knotsU = randomKnots( rng, countU, degreeU );
+		const std::vector<double> knotsV = randomKnots( rng, countV, degreeV );
+		const NurbsSurface surface{ points.data(), weights.data(), knotsU.data(), knotsV.data(), countU, countV, degreeU, degreeV };
+
+		constexpr double h = 1E-6;
+		const std::vector<double> u = randomParameters( rng, 7 ), v = randomParameters( rng, 5 );
+		const size_t count = u.size() * v.size();
+		std::vector<double> pos( count * 3 ), du( count * 3 ), dv( count * 3 ), duu( count * 3 ), duv( count * 3 ), dvv( count * 3 );
+		SurfaceGrid grid;
+		grid.position = pos.data();
+		grid.du = du.data();
+		grid.dv = dv.data();
+		grid.duu = duu.data();
+		grid.duv = duv.data();
+		grid.dvv = dvv.data();
+		nurbsEvaluateGrid( surface, u.data(), u.size(), v.data(), v.size(), grid );
+
+		// The same grid, shifted by h along U or V
+		const auto shifted = [ & ]( double su, double sv, std::vector<double>& p, std::vector<double>& pu, std::vector<double>& pv )
+		{
+			std::vector<double> u2 = u, v2 = v;
+			for( double& x : u2 )
+				x += su;
+			for( double& x : v2 )
+				x += sv;
+			p.resize( count * 3 );
+			pu.resize( count * 3 );
+			pv.resize( count * 3 );
+			SurfaceGrid g;
+			g.position = p.data();
+			g.du = pu.data();
+			g.dv = pv.data();
+			nurbsEvaluateGrid( surface, u2.data(), u2.size(), v2.data(), v2.size(), g, true );
+		};
+		std::vector<double> pu0, duu0, dvu0, pu1, duu1, dvu1, pv0, duv0, dvv0, pv1, duv1, dvv1;
+		shifted( -h, 0, pu0, duu0, dvu0 );
+		shifted( h, 0, pu1, duu1, dvu1 );
+		shifted( 0, -h, pv0, duv0, dvv0 );
+		shifted( 0, h, pv1, duv1, dvv1 );
+
+		for( size_t j = 0; j < v.size(); j++ )
+			for( size_t i = 0; i < u.size(); i++ )
+			{
+				double expected[ 3 ] = { 0, 0, 0 }, w = 0;
+				for( size_t b = 0; b < countV; b++ )
+					for( size_t a = 0; a < countU; a++ )
+					{
+						const size_t idx = b * countU + a;
+						const double n = basisReference( knotsU.data(), a, degreeU, u[ i ] ) * basisReference( knotsV.data(), b, degreeV, v[ j ] ) * weights[ idx ];
+						w += n;
+						for( size_t c = 0; c < 3; c++ )
+							expected[ c ] += n * points[ idx * 3 + c ];
+					}
+				for( double& e : expected )
+					e /= w;
+				const size_t o = ( j * u.size() + i ) * 3;
+				assertEqual3( &pos[ o ], expected, 1E-13 );
+				if( nearKnot( knotsU, u[ i ], h ) || nearKnot( knotsV, v[ j ], h ) )
+					continue;
+
+				double fd[ 5 ][ 3 ];
+				for( size_t c = 0; c < 3; c++ )
+				{
+					fd[ 0 ][ c ] = ( pu1[ o + c ] - pu0[ o + c ] ) / ( 2 * h );
+					fd[ 1 ][ c ] = ( pv1[ o + c ] - pv0[ o + c ] ) / ( 2 * h );
+					fd[ 2 ][ c ] = ( duu1[ o + c ] - duu0[ o + c ] ) / ( 2 * h );
+					fd[ 3 ][ c ] = ( duv1[ o + c ] - duv0[ o + c ] ) / ( 2 * h );
+					fd[ 4 ][ c ] = ( dvv1[ o + c ] - dvv0[ o + c ] ) / ( 2 * h );
+				}
+				assertEqual3( &du[ o ], fd[ 0 ], 1E-5 );
+				assertEqual3( &dv[ o ], fd[ 1 ], 1E-5 );
+				assertEqual3( &duu[ o ], fd[ 2 ], 1E-4 );
+				assertEqual3( &duv[ o ], fd[ 3 ], 1E-4 );
+				assertEqual3( &dvv[ o ], fd[ 4 ], 1E-4 );
+			}
+	}
+
+	void testNurbsTessellate()
+	{
+		// Cylinder of radius 2 and height 3: the circle along U, extruded along V
+		const double r = std::sqrt( 0.5 );
+		const double circle[ 27 ] = { 2, 0, 0, 2, 2, 0, 0, 2, 0, -2, 2, 0, -2, 0, 0, -2, -2, 0, 0, -2, 0, 2, -2, 0, 2, 0, 0 };
+		const double circleWeights[ 9 ] = { 1, r, 1, r, 1, r, 1, r, 1 };
+		const double knotsU[ 12 ] = { 0, 0, 0, 0.25, 0.25, 0.5, 0.5, 0.75, 0.75, 1, 1, 1 };
+		const double knotsV[ 4 ] = { 0, 0, 1, 1 };
+		double points[ 54 ], weights[ 18 ];
+		for( size_t j = 0; j < 2; j++ )
+			for( size_t i = 0; i < 9; i++ )
+			{
+				points[ ( j * 9 + i ) * 3 ] = circle[ i * 3 ];
+				points[ ( j * 9 + i ) * 3 + 1 ] = circle[ i * 3 + 1 ];
+				points[ ( j * 9 + i ) * 3 + 2 ] = 3.0 * j;
+				weights[ j * 9 + i ] = circleWeights[ i ];
+			}
+		const NurbsSurface cylinder{ points, weights, knotsU, knotsV, 9, 2, 2, 1 };
+
+		constexpr size_t su = 33, sv = 5;
+		std::vector<double> pos( su * sv * 3 ), normals( su * sv * 3 );
+		std::vector<uint32_t> indices( ( su - 1 ) * ( sv - 1 ) * 6 );
+		for( bool parallel : { false, true } )
+		{
+			nurbsTessellate( cylinder, su, sv, pos.data(), normals.data(), indices.data(), parallel );
+			for( size_t i = 0; i < su * sv; i++ )
+			{
+				const double* p = &pos[ i * 3 ];
+				const double* n = &normals[ i * 3 ];
+				assert( std::abs( std::sqrt( p[ 0 ] * p[ 0 ] + p[ 1 ] * p[ 1 ] ) - 2 ) < 1E-14 );
+				assert( std::abs( p[ 2 ] - 3.0 * (double)( i / su ) / ( sv - 1 ) ) < 1E-14 );
+				// du is counter-clockwise around Z, dv is along +Z, the normals point outwards
+				assert( std::abs( n[ 0 ] - p[ 0 ] / 2 ) < 1E-13 && std::abs( n[ 1 ] - p[ 1 ] / 2 ) < 1E-13 && 0 == n[ 2 ] );
+			}
+			// The triangles are counter-clockwise when looking from outside
+			for( size_t t = 0; t < indices.size(); t += 3 )
+			{
+				const __m256d a = loadDouble3( &pos[ indices[ t ] * 3 ] );
+				const __m256d b = loadDouble3( &pos[ indices[ t + 1 ] * 3 ] );
+				const __m256d c = loadDouble3( &pos[ indices[ t + 2 ] * 3 ] );
+				const __m256d n = vector3Cross( _mm256_sub_pd( b, a ), _mm256_sub_pd( c, a ) );
+				assert( vectorGetX( vector3Dot( n, a ) ) > 0 );
+			}
+		}
+		assert( 0 == indices[ 0 ] && 1 == indices[ 1 ] && su + 1 == indices[ 2 ] && su == indices[ 5 ] );
+	}
+
+	void testNurbs()
+	{
+		Random rng;
+		for( uint32_t degree = 1; degree <= 5; degree++ )
+			for( bool rational : { false, true } )
+				testNurbsCurve( rng, degree, degree + 1 + 9, rational );
+		// Bezier knot vector
+		testNurbsCurve( rng, 3, 4, true );
+		testNurbsCircle();
+		testBezier( rng );
+		testNurbsSurface( rng, 3, 2, 8, 6 );
+		testNurbsSurface( rng, 1, 4, 5, 7 );
+		testNurbsTessellate();
+	}
+
+	// Signed area of the contour projected to the XY plane
+	double contourArea( const SliceContours& c, size_t i )
+	{
+		double area = 0;
+		const size_t begin = c.offsets[ i ], end = c.offsets[ i + 1 ];
+		for( size_t j = begin; j < end; j++ )
+		{
+			const double* a = &c.xyz[ j * 3 ];
+			const double* b = &c.xyz[ ( j + 1 < end ? j + 1 : begin ) * 3 ];
+			area += a[ 0 ] * b[ 1 ] - a[ 1 ] * b[ 0 ];
+		}
+		return area * 0.5;
+	}
+
+	// Unit cube with the min corner at the offset, the vertex index bits are X, Y, Z
+	void appendCube( std::vector<double>& xyz, std::vector<uint32_t>& indices, double offset )
+	{
+		const uint32_t base = (uint32_t)( xyz.size() / 3 );
+		for( uint32_t i = 0; i < 8; i++ )
+		{
+			xyz.push_back( offset + ( i & 1 ) );
+			xyz.push_back( ( i >> 1 ) & 1 );
+			xyz.push_back( ( i >> 2 ) & 1 );
+		}
+		const uint32_t tris[ 36 ] = { 0, 2, 3, 0, 3, 1, 4, 5, 7, 4, 7, 6, 0, 4, 6, 0, 6, 2, 1, 3, 7, 1, 7, 5, 0, 1, 5, 0, 5, 4, 2, 6, 7, 2, 7, 3 };
+		for( uint32_t i : tris )
+			indices.push_back( base + i );
+	}
+
+	void testSlice()
+	{
+		std::vector<double> xyz;
+		std::vector<uint32_t> indices;
+		std::vector<SliceContours> slices;
+		const __m256d up = _mm256_setr_pd( 0, 0, 1, 0 );
+		appendCube( xyz, indices, 0 );
+
+		// The plane through the middle, the normal doesn't need to be unit length
+		for( double scale : { 1.0, 5.0 } )
+		{
+			meshSlice( xyz.data(), 8, indices.data(), 12, _mm256_mul_pd( up, _mm256_set1_pd( scale ) ), 0.5, 1, 1, slices );
+			assert( slices.size() == 1 && slices[ 0 ].size() == 1 && slices[ 0 ].closed[ 0 ] == 1 );
+			assert( std::abs( contourArea( slices[ 0 ], 0 ) - 1 ) < 1E-12 );
+		}
+
+		// The vertices on the plane are above it: nothing at the bottom face, a square without duplicate points at the top one
+		meshSlice( xyz.data(), 8, indices.data(), 12, up, 0, 0.25, 5, slices );
+		assert( slices.size() == 5 && slices[ 0 ].size() == 0 );
+		for( size_t k = 1; k < 5; k++ )
+			assert( slices[ k ].size() == 1 && slices[ k ].closed[ 0 ] == 1 && std::abs( contourArea( slices[ k ], 0 ) - 1 ) < 1E-12 );
+		assert( slices[ 4 ].offsets[ 1 ] == 4 );
+
+		// Two disjoint cubes produce two contours
+		appendCube( xyz, indices, 3 );
+		meshSlice( xyz.data(), 16, indices.data(), 24, up, 0.5, 1, 1, slices );
+		assert( slices[ 0 ].size() == 2 && slices[ 0 ].offsets.size() == 3 );
+		for( size_t i = 0; i < 2; i++ )
+			assert( slices[ 0 ].closed[ i ] == 1 && std::abs( contourArea( slices[ 0 ], i ) - 1 ) < 1E-12 );
+
+		// A hole in the mesh opens the contour, the chain goes from one end to the other
+		meshSlice( xyz.data(), 8, indices.data(), 11, up, 0.5, 1, 1, slices );
+		assert( slices[ 0 ].size() == 1 && slices[ 0 ].closed[ 0 ] == 0 );
+
+		// Sphere: one counter-clockwise contour per plane, the area approaches the circle
+		makeSphere( 1.0, 64, 96, xyz, indices );
+		const size_t vertices = xyz.size() / 3, triangles = indices.size() / 3;
+		meshSlice( xyz.data(), vertices, indices.data(), triangles, up, -0.9, 0.05, 37, slices );
+		for( size_t k = 0; k < 37; k++ )
+		{
+			const double z = -0.9 + 0.05 * (double)k;
+			assert( slices[ k ].size() == 1 && slices[ k ].closed[ 0 ] == 1 );
+			const double circle = 3.14159265358979323846 * ( 1 - z * z );
+			const double area = contourArea( slices[ k ], 0 );
+			assert( area < circle && area > circle * 0.99 );
+			for( size_t i = 0; i < slices[ k ].offsets[ 1 ]; i++ )
+				assert( std::abs( slices[ k ].xyz[ i * 3 + 2 ] - z ) < 1E-12 );
+		}
+
+		// Tilted planes: every point is on its plane, the parallel version produces the same contours
+		const __m256d tilted = _mm256_setr_pd( 1, 2, 3, 0 );
+		const __m256d unit = _mm256_div_pd( tilted, _mm256_sqrt_pd( vector3Dot( tilted, tilted ) ) );
+		std::vector<SliceContours> parallel;
+		meshSlice( xyz.data(), vertices, indices.data(), triangles, tilted, -1.05, 0.1, 22, slices );
+		meshSlice( xyz.data(), vertices, indices.data(), triangles, tilted, -1.05, 0.1, 22, parallel, true );
+		for( size_t k = 0; k < 22; k++ )
+		{
+			const SliceContours& c = slices[ k ];
+			assert( c.xyz == parallel[ k ].xyz && c.offsets == parallel[ k ].offsets && c.closed == parallel[ k ].closed );
+			assert( c.size() == ( ( k == 0 || k == 21 ) ? 0 : 1 ) );
+			for( size_t i = 0; i < c.size(); i++ )
+				assert( c.closed[ i ] == 1 );
+			for( size_t i = 0; i * 3 < c.xyz.size(); i++ )
+			{
+				const double h = vectorGetX( vector3Dot( unit, loadDouble3( &c.xyz[ i * 3 ] ) ) );
+				assert( std::abs( h - ( -1.05 + 0.1 * (double)k ) ) < 1E-12 );
+			}
+		}
+	}
+}
+
+bool testGeometry()
+{
+	testSoa();
+	testPipeline();
+	testRandomTriangles();
+	testWatertight();
+	testClosestPoint();
+	testBvh();
+	testCulling();
+	testPolyline();
+	testMeshNormals();
+	testRobust();
+	testKdTree();
+	testNurbs();
+	testSlice();
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,5 @@
+#pragma once
+#include "testsMisc.h"
+
+// Test the geometry queries: ray / triangle intersections, closest points, BVH, frustum culling, polylines, mesh normals, robust predicates, k-d tree, NURBS, mesh slicing
+bool testGeometry();
\ No newline at end of file
@@ -0,0 +1,207 @@
+#include "testHash.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// The tests are similar to SMHasher https://github.com/aappleby/smhasher, adapted for the short fixed-size keys these functions are hashing
+namespace
+{
+	using namespace AvxMath;
+
+	struct HashFunction
+	{
+		const char* name;
+		// Count of doubles in the key, 2, 3 or 4
+		size_t lanes;
+		// Count of bits in the hash
+		size_t bits;
+		uint64_t( *hash )( const double* rsi );
+	};
+
+	const HashFunction s_functions[] =
+	{
+		{ "vectorHash64 2D", 2, 64, []( const double* rsi ) { return vectorHash64( _mm_loadu_pd( rsi ) ); } },
+		{ "vector3Hash64", 3, 64, []( const double* rsi ) { return vector3Hash64( loadDouble3( rsi ) ); } },
+		{ "vectorHash64 4D", 4, 64, []( const double* rsi ) { return vectorHash64( loadDouble4( rsi ) ); } },
+		{ "vectorHash32 2D", 2, 32, []( const double* rsi ) { return (uint64_t)vectorHash32( _mm_loadu_pd( rsi ) ); } },
+		{ "vector3Hash32", 3, 32, []( const double* rsi ) { return (uint64_t)vector3Hash32( loadDouble3( rsi ) ); } },
+		{ "vectorHash32 4D", 4, 32, []( const double* rsi ) { return (uint64_t)vectorHash32( loadDouble4( rsi ) ); } },
+	};
+
+	// Flip every bit of random keys, return the worst bias of the output bits, i.e. maximum of | 2 * P( flip ) - 1 |
+	double avalanche( const HashFunction& f, size_t keys )
+	{
+		const size_t inputBits = f.lanes * 64;
+		std::vector<uint32_t> counts( inputBits * f.bits, 0 );
+		Random rng;
+		double key[ 4 ];
+		for( size_t k = 0; k < keys; k++ )
+		{
+			for( size_t i = 0; i < f.lanes; i++ )
+			{
+				const uint64_t r = rng.nextBits();
+				memcpy( &key[ i ], &r, 8 );
+			}
+			const uint64_t h = f.hash( key );
+
+			for( size_t bit = 0; bit < inputBits; bit++ )
+			{
+				uint64_t* const word = (uint64_t*)&key[ bit / 64 ];
+				const uint64_t mask = (uint64_t)1 << ( bit % 64 );
+				*word ^= mask;
+				uint64_t diff = f.hash( key ) ^ h;
+				*word ^= mask;
+
+				uint32_t* const row = &counts[ bit * f.bits ];
+				for( ; 0 != diff; diff &= diff - 1 )
+					row[ lowestBit( diff ) ]++;
+			}
+		}
+
+		double worst = 0;
+		for( uint32_t c : counts )
+			worst = std::max( worst, std::abs( 2.0 * (double)c / (double)keys - 1.0 ) );
+		return worst;
+	}
+
+	size_t countCollisions( std::vector<uint64_t>& hashes )
+	{
+		std::sort( hashes.begin(), hashes.end() );
+		size_t res = 0;
+		for( size_t i = 1; i < hashes.size(); i++ )
+			if( hashes[ i ] == hashes[ i - 1 ] )
+				res++;
+		return res;
+	}
+
+	double expectedCollisions( size_t keys, size_t bits )
+	{
+		const double n = (double)keys;
+		return n * ( n - 1 ) * 0.5 * std::ldexp( 1.0, -(int)bits );
+	}
+
+	// Keys with integer coordinates on a grid, like the vertices of a mesh; 4D keys have W = 1
+	std::vector<uint64_t> hashGrid( const HashFunction& f, size_t& keys )
+	{
+		const size_t side = ( f.lanes == 2 ) ? 1448 : 128;
+		keys = ( f.lanes == 2 ) ? side * side : side * side * side;
+		std::vector<uint64_t> res;
+		res.reserve( keys );
+		for( size_t i = 0; i < keys; i++ )
+		{
+			const double key[ 4 ] = { (double)( i % side ), (double)( ( i / side ) % side ), (double)( i / side / side ), 1 };
+			res.push_back( f.hash( key ) );
+		}
+		return res;
+	}
+
+	// Keys with 1 or 2 bits set, the rest of them zeros
+	std::vector<uint64_t> hashSparse( const HashFunction& f )
+	{
+		const size_t inputBits = f.lanes * 64;
+		std::vector<uint64_t> res;
+		const auto add = [ & ]( size_t b1, size_t b2 )
+		{
+			uint64_t key[ 4 ] = {};
+			key[ b1 / 64 ] |= (uint64_t)1 << ( b1 % 64 );
+			key[ b2 / 64 ] |= (uint64_t)1 << ( b2 % 64 );
+			double dbl[ 4 ];
+			memcpy( dbl, key, sizeof( key ) );
+			res.push_back( f.hash( dbl ) );
+		};
+		for( size_t b1 = 0; b1 < inputBits; b1++ )
+			for( size_t b2 = b1; b2 < inputBits; b2++ )
+				add( b1, b2 );
+		return res;
+	}
+
+	// Split the hashes into 2^16 buckets using 16-bit windows of the hash, return the worst z-score of the chi-square statistics
+	double distribution( const std::vector<uint64_t>& hashes, size_t bits )
+	{
+		constexpr size_t bucketBits = 16;
+		constexpr size_t buckets = (size_t)1 << bucketBits;
+		const double expected = (double)hashes.size() / (double)buckets;
+		std::vector<uint32_t> counts( buckets );
+		double worst = 0;
+		for( size_t shift = 0; shift + bucketBits <= bits; shift += 8 )
+		{
+			std::fill( counts.begin(), counts.end(), 0 );
+			for( uint64_t h : hashes )
+				counts[ ( h >> shift ) & ( buckets - 1 ) ]++;
+			double chi2 = 0;
+			for( uint32_t c : counts )
+				chi2 += ( (double)c - expected ) * ( (double)c - expected ) / expected;
+			const double df = (double)( buckets - 1 );
+			worst = std::max( worst, ( chi2 - df ) / std::sqrt( 2 * df ) );
+		}
+		return worst;
+	}
+
+	// Verify the array versions of the hash functions produce the same results as the vector ones
+	void testArrayHashes()
+	{
+		Random rng;
+		std::vector<double> data( 1003 * 4 );
+		for( size_t i = 0; i < data.size(); i++ )
+			data[ i ] = (double)(int64_t)rng.nextBits() * 1E-9;
+		data[ 5 ] = -0.0;
+		data[ 7 ] = std::numeric_limits<double>::quiet_NaN();
+
+		std::vector<uint64_t> h64( 1003 );
+		std::vector<uint32_t> h32( 1003 );
+		for( size_t length : { (size_t)0, (size_t)1, (size_t)5, (size_t)8, (size_t)1003 } )
+		{
+			arrayHash64( data.data(), length, h64.data() );
+			arrayHash32( data.data(), length, h32.data() );
+			for( size_t i = 0; i < length; i++ )
+			{
+				assert( h64[ i ] == vectorHash64( loadDouble4( &data[ i * 4 ] ) ) );
+				assert( h32[ i ] == vectorHash32( loadDouble4( &data[ i * 4 ] ) ) );
+			}
+
+			array3Hash64( data.data(), length, h64.data() );
+			array3Hash32( data.data(), length, h32.data() );
+			for( size_t i = 0; i < length; i++ )
+			{
+				assert( h64[ i ] == vector3Hash64( loadDouble3( &data[ i * 3 ] ) ) );
+				assert( h32[ i ] == vector3Hash32( loadDouble3( &data[ i * 3 ] ) ) );
+			}
+		}
+	}
+}
+
+bool testHash()
+{
+	testArrayHashes();
+
+	printf( "%-16s %10s %18s %18s %14s\n", "hash", "avalanche", "grid collisions", "sparse collisions", "distribution" );
+	for( const HashFunction& f : s_functions )
+	{
+		// SMHasher fails avalanche above 1% bias with 300k keys; 20k keys have about 3% noise in the worst of the bits
+		const double bias = avalanche( f, 20000 );
+		assert( bias < 0.05 );
+
+		size_t keys;
+		std::vector<uint64_t> hashes = hashGrid( f, keys );
+		const double dist = distribution( hashes, f.bits );
+		// The z-score is normally distributed for a good hash; the windows of a bad hash have z-scores in thousands
+		assert( dist < 6 );
+		const size_t gridCollisions = countCollisions( hashes );
+		const double gridExpected = expectedCollisions( keys, f.bits );
+		// SMHasher fails above 2x expected collisions. The 32-bit hash of 4D vectors has 2.6x on the grid, see the comment in AvxMathPredicates.h
+		assert( (double)gridCollisions <= gridExpected * ( f.bits == 32 && f.lanes == 4 ? 3 : 2 ) + 2 );
+
+		hashes = hashSparse( f );
+		const size_t sparseCollisions = countCollisions( hashes );
+		const double sparseExpected = expectedCollisions( hashes.size(), f.bits );
+		assert( (double)sparseCollisions <= sparseExpected * 2 + 2 );
+
+		printf( "%-16s %9.2f%% %8zu / %7.1f %8zu / %7.1f %14.2f\n", f.name, bias * 100, gridCollisions, gridExpected, sparseCollisions, sparseExpected, dist );
+	}
+	return true;
+}
\ No newline at end of file
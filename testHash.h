@@ -0,0 +1,5 @@
+#pragma once
+#include "testsMisc.h"
+
+// Test quality of the hash functions: avalanche, collisions and distribution, also verify the array versions of the hash functions
+bool testHash();
\ No newline at end of file
@@ -1,6 +1,16 @@
 #include "testStdlib.h"
+#include "AvxMath/AvxMathParallel.h"
 #include <cmath>
 #include <stdio.h>
+#include <vector>
+#include <map>
+#include <array>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <functional>
 
 inline __m256d stdSin( __m256d v )
 {
@@ -57,7 +67,6 @@ static void computeSinCosError()
 
 	__m128d errors = _mm_setzero_pd();
 
-	constexpr double mul = g_pi * 2.0 / 0x100000;
 	for( int i = 0; i <= 0x100000; i++ )
 	{
 		__m128d my = scalarSinCos( i );
@@ -83,12 +92,725 @@ static void computeSinCosError()
 	printf( "Maximum errors for sin/cos: %g / %g\n", vectorGetY( errors ), vectorGetX( errors ) );
 }
 
+// Compare with the mixed error, relative for large values, absolute for values less than 1.0
+static void assertEqualMixed( __m256d a, __m256d ref, double tolerance )
+{
+	using namespace AvxMath;
+	const __m256d one = _mm256_set1_pd( 1 );
+	const __m256d div = _mm256_max_pd( vectorAbs( ref ), one );
+	assertEqual( _mm256_div_pd( _mm256_sub_pd( a, ref ), div ), _mm256_setzero_pd(), tolerance );
+}
+
+// Test the accuracy tiers of the vector trigonometric functions
+template<AvxMath::eTrigPrecision precision>
+static void testTrigPrecision( double tolerance, double tanTolerance )
+{
+	using namespace AvxMath;
+
+	for( int i = -50; i <= 50; i++ )
+	{
+		const __m256d a = _mm256_setr_pd( i + 0.125, i + 0.375, i + 0.625, i + 0.875 );
+		__m256d s, c;
+		vectorSinCos<precision>( s, c, a );
+		assertEqual( s, stdSin( a ), tolerance );
+		assertEqual( c, stdCos( a ), tolerance );
+		assertEqual( vectorSin<precision>( a ), s, 0 );
+		assertEqual( vectorCos<precision>( a ), c, 0 );
+
+		const __m256d t = stdTan( a );
+		assertEqualMixed( vectorTan<precision>( a ), t, tanTolerance );
+		assertEqualMixed( vectorCot<precision>( a ), _mm256_div_pd( _mm256_set1_pd( 1 ), t ), tanTolerance );
+	}
+}
+
+template<class F>
+inline __m256d stdApply( __m256d v, F f )
+{
+	using namespace AvxMath;
+	return _mm256_setr_pd( f( vectorGetX( v ) ), f( vectorGetY( v ) ), f( vectorGetZ( v ) ), f( vectorGetW( v ) ) );
+}
+
+// Compare the exponent-based functions with the standard library
+static void testExp()
+{
+	using namespace AvxMath;
+
+	const auto sigmoid = []( double x ) { return 1.0 / ( 1.0 + std::exp( -x ) ); };
+	const auto softplus = []( double x ) { return std::log1p( std::exp( x ) ); };
+	const auto tanh = []( double x ) { return std::tanh( x ); };
+
+	for( int i = -40; i <= 40; i++ )
+	{
+		const __m256d a = _mm256_setr_pd( i, i + 0.25, i + 0.5, i + 0.75 );
+		const __m256d e = stdApply( a, []( double x ) { return std::exp( x ); } );
+		assertEqual( _mm256_div_pd( vectorExp( a ), e ), _mm256_set1_pd( 1 ), 1E-15 );
+
+		assertEqual( vectorTanH( a ), stdApply( a, tanh ), 1E-15 );
+		assertEqual( vectorTanHFast( a ), stdApply( a, tanh ), 3.6E-4 );
+		assertEqual( vectorSigmoid( a ), stdApply( a, sigmoid ), 1E-15 );
+		assertEqual( vectorSigmoidFast( a ), stdApply( a, sigmoid ), 1.8E-4 );
+		assertEqualMixed( vectorSoftplus( a ), stdApply( a, softplus ), 1E-15 );
+		assertEqualMixed( vectorSoftplusFast( a ), stdApply( a, softplus ), 1E-6 );
+	}
+
+	// Both versions of tanh should saturate correctly
+	const __m256d big = _mm256_setr_pd( 30, -30, 1E+6, -1E+300 );
+	const __m256d sat = _mm256_setr_pd( 1, -1, 1, -1 );
+	assertEqual( vectorTanH( big ), sat, 0 );
+	assertEqual( vectorTanHFast( big ), sat, 0 );
+	assertEqual( vectorTanHFast( _mm256_setr_pd( 4.65, -4.65, 20, -INFINITY ) ), sat, 0 );
+	assertEqual( vectorTanH( _mm256_setr_pd( 20, -20, INFINITY, -INFINITY ) ), sat, 0 );
+	assert( std::isnan( vectorGetX( vectorTanHFast( _mm256_set1_pd( NAN ) ) ) ) );
+}
+
+// Verify the array versions of the trigonometric functions produce the same results as the vector ones, including the partial vectors in the end
+template<AvxMath::eTrigPrecision precision>
+static void testTrigArrays()
+{
+	using namespace AvxMath;
+
+	std::vector<double> angles( 0x20000 + 3 ), sin( angles.size() ), cos( angles.size() ), tan( angles.size() );
+	for( size_t i = 0; i < angles.size(); i++ )
+		angles[ i ] = (double)i * 0.37 - 100;
+
+	for( size_t length : { (size_t)0, (size_t)1, (size_t)3, (size_t)4, (size_t)15, (size_t)16, (size_t)37, angles.size() } )
+	{
+		const bool parallel = length > 100;
+		arraySinCos<precision>( angles.data(), sin.data(), cos.data(), length, parallel );
+		arrayTan<precision>( angles.data(), tan.data(), length, parallel );
+
+		for( size_t i = 0; i < length; i++ )
+		{
+			const __m256d a = _mm256_set1_pd( angles[ i ] );
+			__m256d s, c;
+			vectorSinCos<precision>( s, c, a );
+			const __m256d t = vectorTan<precision>( a );
+			assertEqual( _mm256_setr_pd( sin[ i ], cos[ i ], tan[ i ], 0 ), _mm256_setr_pd( vectorGetX( s ), vectorGetX( c ), vectorGetX( t ), 0 ), 0 );
+		}
+	}
+
+	// In-place computation
+	std::vector<double> copy = angles;
+	arraySin<precision>( copy.data(), copy.data(), copy.size() );
+	arraySinCos<precision>( angles.data(), sin.data(), cos.data(), angles.size() );
+	assertEqual( _mm256_loadu_pd( &copy[ 1000 ] ), _mm256_loadu_pd( &sin[ 1000 ] ), 0 );
+	arrayCos<precision>( copy.data(), copy.data(), copy.size() );
+	arrayCos<precision>( sin.data(), sin.data(), sin.size() );
+	assertEqual( _mm256_loadu_pd( &copy[ 2000 ] ), _mm256_loadu_pd( &sin[ 2000 ] ), 0 );
+}
+
+// Compare vertex welding with the std::map, including the negative zeros and the growth of the hash table
+static void testWeld()
+{
+	using namespace AvxMath;
+
+	std::vector<double> xyz;
+	for( uint32_t i = 0; i < 100000; i++ )
+	{
+		const uint32_t v = ( i * 7919u ) % 20011u;
+		xyz.push_back( ( v % 3 ) ? (double)( v % 37 ) : -0.0 );
+		xyz.push_back( (double)v * 0.125 );
+		xyz.push_back( ( v % 5 ) ? -1.5 : 0.0 );
+	}
+	const size_t length = xyz.size() / 3;
+
+	std::map<std::array<double, 3>, uint32_t> map;
+	std::vector<uint32_t> expected( length );
+	for( size_t i = 0; i < length; i++ )
+	{
+		const std::array<double, 3> key = { xyz[ i * 3 ] + 0.0, xyz[ i * 3 + 1 ] + 0.0, xyz[ i * 3 + 2 ] + 0.0 };
+		expected[ i ] = map.emplace( key, (uint32_t)map.size() ).first->second;
+	}
+
+	std::vector<uint32_t> indices( length );
+	std::vector<double> unique = xyz;
+	const size_t count = weldVertices( unique.data(), length, unique.data(), indices.data() );
+	assert( count == map.size() );
+	for( size_t i = 0; i < length; i++ )
+	{
+		assert( indices[ i ] == expected[ i ] );
+		assertEqual( loadDouble3( &unique[ indices[ i ] * 3 ] ), loadDouble3( &xyz[ i * 3 ] ), 0 );
+	}
+
+	Vector3HashMap<int> hashMap;
+	for( int i = 0; i < 1000; i++ )
+		hashMap[ _mm256_setr_pd( i, -i, 0, i ) ] += i;
+	for( int i = 0; i < 1000; i++ )
+		hashMap[ _mm256_setr_pd( i, -i, -0.0, 5 ) ] += 1;
+	assert( hashMap.size() == 1000 );
+	for( int i = 0; i < 1000; i++ )
+		assert( *hashMap.find( _mm256_setr_pd( i, -i, 0, 0 ) ) == i + 1 );
+	assert( nullptr == hashMap.find( _mm256_setr_pd( 0.5, 0, 0, 0 ) ) );
+}
+
+// Compare the spatial hash grid with brute force search
+static void testSpatialHash()
+{
+	using namespace AvxMath;
+
+	// Random points in [ -8 .. +8 ] cube, each one repeated with 3 small offsets
+	std::vector<double> xyz;
+	Random rng;
+	const auto random = [ &rng ]() { return rng.nextUnit() * 16.0 - 8.0; };
+	for( int i = 0; i < 3000; i++ )
+	{
+		const double x = random(), y = random(), z = random();
+		for( double offset : { 0.0, 1E-12, -3E-12, 2E-9 } )
+		{
+			xyz.push_back( x + offset );
+			xyz.push_back( y - offset );
+			xyz.push_back( z );
+		}
+	}
+	const size_t length = xyz.size() / 3;
+
+	SpatialHashGrid grid{ 0.5 };
+	grid.insert( xyz.data(), length );
+	assert( grid.size() == length );
+	std::vector<uint32_t> found;
+	for( size_t q = 0; q < 200; q++ )
+	{
+		const __m256d center = _mm256_setr_pd( random(), random(), random(), 0 );
+		const double radius = ( q % 2 ) ? 0.2 : 1.3;
+		found.clear();
+		const size_t count = grid.queryRadius( center, radius, found );
+		assert( count == found.size() );
+
+		size_t expected = 0;
+		for( size_t i = 0; i < length; i++ )
+		{
+			const __m256d d = _mm256_sub_pd( loadDouble3( &xyz[ i * 3 ] ), center );
+			if( vectorGetX( vector3Dot2( d, d ) ) <= radius * radius )
+				expected++;
+		}
+		assert( count == expected );
+	}
+
+	// Epsilon 1E-10 merges the first 3 copies of every point, but not the 4-th one
+	std::vector<double> unique( xyz.size() );
+	std::vector<uint32_t> indices( length );
+	const size_t merged = mergeVertices( xyz.data(), length, 1E-10, unique.data(), indices.data() );
+	assert( merged == length / 2 );
+	for( size_t i = 0; i < length; i += 4 )
+	{
+		assert( indices[ i ] == indices[ i + 1 ] && indices[ i ] == indices[ i + 2 ] && indices[ i ] != indices[ i + 3 ] );
+		assertEqual( loadDouble3( &unique[ indices[ i ] * 3 ] ), loadDouble3( &xyz[ i * 3 ] ), 0 );
+	}
+
+	// Infinite radius finds everything, NAN finds nothing
+	found.clear();
+	assert( grid.queryRadius( _mm256_setzero_pd(), INFINITY, found ) == length );
+	assert( grid.queryRadius( _mm256_setzero_pd(), NAN, found ) == 0 );
+
+	// Cell coordinates way above 2^52, the queries fall back to testing every point
+	SpatialHashGrid tiny{ 1E-13 };
+	tiny.insert( _mm256_setr_pd( 1E5, 2E5, 3E5, 0 ) );
+	tiny.insert( _mm256_setr_pd( 1E5, 2E5 + 1E-10, 3E5, 0 ) );
+	found.clear();
+	assert( tiny.queryRadius( _mm256_setr_pd( 1E5, 2E5, 3E5, 0 ), 1E-13, found ) == 1 && found[ 0 ] == 0 );
+
+	// Epsilon tiny compared to the coordinates
+	const double far[ 9 ] = { 1E5, 2E5, 3E5, 1E5, 2E5, 3E5, 1E5, 2E5 + 1E-10, 3E5 };
+	double farUnique[ 9 ];
+	uint32_t farIndices[ 3 ];
+	assert( mergeVertices( far, 3, 1E-13, farUnique, farIndices ) == 2 );
+	assert( farIndices[ 0 ] == 0 && farIndices[ 1 ] == 0 && farIndices[ 2 ] == 1 );
+}
+
+// Compare the radix sort with std::stable_sort using vectorLess functions
+template<size_t lanes>
+static void testSortLanes( size_t length, bool parallel )
+{
+	using namespace AvxMath;
+
+	// Small integers to have many equal lanes, scaled to have both positive and negative numbers, also some special values.
+	// No negative zeros here, the radix sort places them before the positive zeros, vectorLess says they're equal.
+	std::vector<double> data( length * lanes );
+	Random rng{ 7 };
+	for( double& d : data )
+	{
+		const int r = (int)( rng.nextBits() >> 58 );
+		d = ( r - 32 ) * 0.75;
+		if( r == 0 )
+			d = -std::numeric_limits<double>::infinity();
+		else if( r == 63 )
+			d = 1E-310;
+	}
+
+	const auto load = [ & ]( uint32_t i )
+	{
+		if constexpr( lanes == 4 )
+			return loadDouble4( &data[ i * 4 ] );
+		else if constexpr( lanes == 3 )
+			return loadDouble3( &data[ i * 3 ] );
+		else
+			return _mm_loadu_pd( &data[ i * 2 ] );
+	};
+	std::vector<uint32_t> expected( length );
+	for( uint32_t i = 0; i < length; i++ )
+		expected[ i ] = i;
+	std::stable_sort( expected.begin(), expected.end(), [ & ]( uint32_t a, uint32_t b )
+	{
+		if constexpr( lanes == 3 )
+			return vector3Less( load( a ), load( b ) );
+		else
+			return vectorLess( load( a ), load( b ) );
+	} );
+
+	std::vector<uint32_t> indices( length );
+	std::vector<double> sorted = data;
+	if constexpr( lanes == 4 )
+	{
+		arraySortIndices( data.data(), length, indices.data(), parallel );
+		arraySort( sorted.data(), length, parallel );
+	}
+	else if constexpr( lanes == 3 )
+	{
+		array3SortIndices( data.data(), length, indices.data(), parallel );
+		array3Sort( sorted.data(), length, parallel );
+	}
+	else
+	{
+		array2SortIndices( data.data(), length, indices.data(), parallel );
+		array2Sort( sorted.data(), length, parallel );
+	}
+
+	assert( indices == expected );
+	for( size_t i = 0; i < length; i++ )
+		for( size_t j = 0; j < lanes; j++ )
+			assert( sorted[ i * lanes + j ] == data[ expected[ i ] * lanes + j ] );
+}
+
+static void testSort()
+{
+	using namespace AvxMath;
+	for( size_t length : { (size_t)0, (size_t)1, (size_t)7, (size_t)1000, (size_t)200000 } )
+	{
+		const bool parallel = length > 100000;
+		testSortLanes<2>( length, parallel );
+		testSortLanes<3>( length, parallel );
+		testSortLanes<4>( length, parallel );
+	}
+
+	// Negative zeros go before positive ones
+	double zeros[ 6 ] = { 0.0, 1, -0.0, 1, -1E-300, 1 };
+	array2Sort( zeros, 3 );
+	assert( zeros[ 0 ] == -1E-300 && std::signbit( zeros[ 2 ] ) && !std::signbit( zeros[ 4 ] ) );
+}
+
+// Nested parallelInvoke calls with the fanout, the leaves should run on all the threads even though the pool threads are busy with the outer calls.
+// Every leaf waits for the other threads to arrive, up to 2 seconds, so no thread can run all the leaves.
+static void testNestedThreads( size_t fanout, size_t levels )
+{
+	using namespace AvxMath;
+
+	size_t leaves = 1;
+	for( size_t i = 0; i < levels; i++ )
+		leaves *= fanout;
+	const size_t expected = std::min( parallelThreadsLimit(), leaves );
+
+	std::mutex mutex;
+	std::vector<std::thread::id> threads;
+	const auto leaf = [ & ]()
+	{
+		std::unique_lock<std::mutex> lock{ mutex };
+		if( std::find( threads.begin(), threads.end(), std::this_thread::get_id() ) == threads.end() )
+			threads.push_back( std::this_thread::get_id() );
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds( 2 );
+		while( threads.size() < expected && std::chrono::steady_clock::now() < deadline )
+		{
+			lock.unlock();
+			std::this_thread::yield();
+			lock.lock();
+		}
+	};
+	std::function<void( size_t )> node = [ & ]( size_t level )
+	{
+		if( level == levels )
+			leaf();
+		else
+			parallelInvoke( fanout, [ & ]( size_t ) { node( level + 1 ); } );
+	};
+	node( 0 );
+	assert( threads.size() == expected );
+}
+
+// The thread pool: every index of parallelFor is processed exactly once, with the chunks aligned by 16 elements; also the nested loops and the thread limit
+static void testParallel()
+{
+	using namespace AvxMath;
+
+	constexpr size_t length = 100003;
+	std::vector<std::atomic<uint32_t>> counters( length );
+	const auto check = [ & ]( uint32_t expected )
+	{
+		for( const auto& c : counters )
+			assert( c.load() == expected );
+	};
+	const auto increment = [ & ]( size_t begin, size_t end )
+	{
+		assert( begin % 16 == 0 && begin < end && end <= length );
+		for( size_t i = begin; i < end; i++ )
+			counters[ i ]++;
+	};
+	parallelFor( length, 1000, increment );
+	check( 1 );
+	parallelFor( length, length, increment );
+	check( 2 );
+
+	// Outer invocations run the inner loops over the same array, offset by the invocation index
+	parallelInvoke( 3, [ & ]( size_t i )
+	{
+		parallelFor( length, 100, [ & ]( size_t begin, size_t end )
+		{
+			for( size_t j = begin; j < end; j++ )
+				counters[ ( j + i ) % length ]++;
+		} );
+	} );
+	check( 5 );
+
+	std::atomic<uint32_t> calls{ 0 };
+	parallelInvoke( 7, [ & ]( size_t i ) { calls += 1u << ( i * 4 ); } );
+	assert( calls.load() == 0x1111111 );
+
+	// A single thread makes a single call
+	const size_t limit = parallelThreadsLimit();
+	setParallelThreads( 1 );
+	assert( parallelThreadsLimit() == 1 );
+	calls = 0;
+	parallelFor( length, 1, [ & ]( size_t begin, size_t end )
+	{
+		assert( begin == 0 && end == length );
+		calls++;
+	} );
+	assert( calls.load() == 1 );
+	setParallelThreads( limit );
+
+	// The recursion of the tree builders: KdTree splits the nodes in 2, the BVH in up to 4
+	testNestedThreads( 2, 3 );
+	testNestedThreads( 4, 2 );
+}
+
+// The counters of the slow and degenerate paths, all zeros when they are disabled
+static void testCounters()
+{
+	using namespace AvxMath;
+	countersReset();
+
+	const double inf = std::numeric_limits<double>::infinity(), nan = std::numeric_limits<double>::quiet_NaN();
+	vector2Normalize( _mm_setzero_pd() );
+	vector3Normalize( _mm256_setr_pd( 0, 0, 0, 1 ) );
+	vector4Normalize( _mm256_setr_pd( 1, inf, 0, 0 ) );
+	vectorSin( _mm256_setr_pd( 1, 1E+7, -inf, nan ) );
+	scalarSin( 1E+300 );
+	// 2E+6 is above 2^19 * pi, where n * part of pi/2 is no longer exact
+	vectorTan( _mm256_setr_pd( 1, 2, 2E+6, -1E+7 ) );
+	// Collinear points, the filter can't tell the sign
+	orient2d( _mm_setr_pd( 0, 0 ), _mm_setr_pd( 1, 1 ), _mm_setr_pd( 2, 2 ) );
+
+	// The counters of the exited threads are included in the totals
+	std::thread thread( []() { vector3Normalize( _mm256_setzero_pd() ); } );
+	thread.join();
+
+	const CounterValues mine = threadCountersSnapshot(), all = countersSnapshot();
+	const uint64_t expectedMine[ countersCount ] = { 2, 1, 6, 1 };
+	for( size_t i = 0; i < countersCount; i++ )
+	{
+		assert( mine.values[ i ] == ( countersEnabled ? expectedMine[ i ] : 0 ) );
+		assert( all.values[ i ] == ( countersEnabled ? expectedMine[ i ] + ( i == 0 ? 1 : 0 ) : 0 ) );
+	}
+
+	countersReset();
+	for( uint64_t v : countersSnapshot().values )
+		assert( v == 0 );
+
+	// The parallel array functions count on the threads of the pool, the totals include these threads as well
+	std::vector<double> angles( 4 << 16, 1E+300 );
+	arraySin( angles.data(), angles.data(), angles.size(), true );
+	assert( countersSnapshot()[ eCounter::AngleOutOfRange ] == ( countersEnabled ? angles.size() : 0 ) );
+	countersReset();
+}
+
+// FP32 and FP16 conversions, arrays of all remainders, and the vector loads and stores
+static void testConvert()
+{
+	using namespace AvxMath;
+	for( size_t length = 0; length < 40; length++ )
+	{
+		std::vector<double> source( length ), dest( length );
+		std::vector<float> floats( length );
+		for( size_t i = 0; i < length; i++ )
+			source[ i ] = std::sin( (double)i ) * std::exp( (double)i - 20 );
+		arrayDoubleToFloat( source.data(), floats.data(), length );
+		arrayFloatToDouble( floats.data(), dest.data(), length );
+		for( size_t i = 0; i < length; i++ )
+		{
+			assert( floats[ i ] == (float)source[ i ] );
+			assert( dest[ i ] == (double)floats[ i ] );
+		}
+	}
+
+	const float f[ 4 ] = { 1.5f, -2.25f, 1E+30f, 7 };
+	float fd[ 4 ] = { 0, 0, 0, -1 };
+	assertEqual( loadFloat3( f ), _mm256_setr_pd( 1.5, -2.25, 1E+30f, 0 ), 0 );
+	assertEqual( loadFloat4( f ), _mm256_setr_pd( 1.5, -2.25, 1E+30f, 7 ), 0 );
+	storeFloat3( fd, _mm256_setr_pd( 1.5, -2.25, 1E+30, 8 ) );
+	assert( fd[ 0 ] == 1.5f && fd[ 1 ] == -2.25f && fd[ 2 ] == 1E+30f && fd[ 3 ] == -1 );
+	storeFloat4( fd, _mm256_setr_pd( 1, 2, 3, 1E+300 ) );
+	assert( fd[ 3 ] == std::numeric_limits<float>::infinity() );
+
+#if _AM_F16C_INTRINSICS_
+	// All 63488 FP16 numbers which are not NaN survive the round trip through FP64
+	std::vector<uint16_t> halves, back;
+	for( uint32_t i = 0; i < 0x10000; i++ )
+		if( ( i & 0x7C00 ) != 0x7C00 || ( i & 0x3FF ) == 0 )
+			halves.push_back( (uint16_t)i );
+	std::vector<double> wide( halves.size() );
+	back.resize( halves.size() );
+	arrayHalfToDouble( halves.data(), wide.data(), halves.size() );
+	arrayDoubleToHalf( wide.data(), back.data(), wide.size() );
+	assert( halves == back );
+	assert( wide[ 0x3C00 ] == 1.0 && wide[ 0x7BFF ] == 65504.0 && wide[ 0xC000 - 0x3FF ] == -2.0 );
+
+	const double rounding[ 4 ] = { 1 + 0x1p-11, 1 + 0x1p-10 + 0x1p-11, 65520, 1E-9 };
+	uint16_t h[ 4 ];
+	arrayDoubleToHalf( rounding, h, 4 );
+	assert( h[ 0 ] == 0x3C00 && h[ 1 ] == 0x3C02 && h[ 2 ] == 0x7C00 && h[ 3 ] == 0 );
+	storeHalf4( h, _mm256_setr_pd( 1, -2, 0.5, 65504 ) );
+	assert( h[ 0 ] == 0x3C00 && h[ 1 ] == 0xC000 && h[ 2 ] == 0x3800 && h[ 3 ] == 0x7BFF );
+	assertEqual( loadHalf4( h ), _mm256_setr_pd( 1, -2, 0.5, 65504 ), 0 );
+#endif
+}
+
+// Scalar version of the quantization, sets the overflow flag when the component doesn't fit
+template<class I>
+static I quantizeScalar( double v, double origin, double scale, bool& overflow )
+{
+	const double r = AvxMath::round( ( v - origin ) * scale );
+	const double lower = (double)std::numeric_limits<I>::min();
+	if( r >= lower && r < -lower )
+		return (I)r;
+	overflow = true;
+	if( r != r )
+		return 0;
+	return ( r < 0 ) ? std::numeric_limits<I>::min() : std::numeric_limits<I>::max();
+}
+
+template<size_t dims, class I>
+static void testQuantize( size_t count, bool parallel )
+{
+	using namespace AvxMath;
+	const double origin[ 3 ] = { 100, -2000, 0.5 };
+	const double scale = 1E+3;
+	std::vector<double> source( count * dims );
+	for( size_t i = 0; i < source.size(); i++ )
+		source[ i ] = std::sin( (double)i * 0.37 ) * 1E+5;
+	const double special[] = { std::numeric_limits<double>::quiet_NaN(), 1E+30, -1E+30, 2147483.6474, -2147483.6485, 9.3E+15, -0x1p53 };
+	for( size_t i = 0; i < std::min( source.size(), std::size( special ) ); i++ )
+		source[ i * 5 % source.size() ] = special[ i ];
+
+	std::vector<I> quantized( count * dims );
+	std::vector<uint8_t> overflow( count );
+	const size_t overflowed = ( 2 == dims ) ?
+		array2Quantize( source.data(), count, _mm_loadu_pd( origin ), scale, quantized.data(), overflow.data(), parallel ) :
+		array3Quantize( source.data(), count, loadDouble3( origin ), scale, quantized.data(), overflow.data(), parallel );
+	assert( overflowed == ( ( 2 == dims ) ?
+		array2Quantize( source.data(), count, _mm_loadu_pd( origin ), scale, quantized.data(), nullptr, parallel ) :
+		array3Quantize( source.data(), count, loadDouble3( origin ), scale, quantized.data(), nullptr, parallel ) ) );
+
+	size_t expectedOverflowed = 0;
+	for( size_t i = 0; i < count; i++ )
+	{
+		uint8_t expectedMask = 0;
+		for( size_t j = 0; j < dims; j++ )
+		{
+			bool of = false;
+			assert( quantized[ i * dims + j ] == quantizeScalar<I>( source[ i * dims + j ], origin[ j ], scale, of ) );
+			if( of )
+				expectedMask |= (uint8_t)( 1 << j );
+		}
+		assert( overflow[ i ] == expectedMask );
+		if( 0 != expectedMask )
+			expectedOverflowed++;
+	}
+	assert( overflowed == expectedOverflowed );
+
+	// Round trip of the components which were in range
+	std::vector<double> back( count * dims );
+	if( 2 == dims )
+		array2Dequantize( quantized.data(), count, _mm_loadu_pd( origin ), scale, back.data(), parallel );
+	else
+		array3Dequantize( quantized.data(), count, loadDouble3( origin ), scale, back.data(), parallel );
+	for( size_t i = 0; i < back.size(); i++ )
+	{
+		const double expected = (double)quantized[ i ] / scale + origin[ i % dims ];
+		const double tolerance = ( std::abs( (double)quantized[ i ] / scale ) + std::abs( origin[ i % dims ] ) ) * 1E-15;
+		assert( std::abs( back[ i ] - expected ) <= tolerance );
+		if( 0 == ( overflow[ i / dims ] & ( 1 << ( i % dims ) ) ) )
+			assert( std::abs( back[ i ] - source[ i ] ) <= 0.5 / scale + tolerance );
+	}
+}
+
+static void testQuantize()
+{
+	for( size_t count = 0; count < 30; count++ )
+	{
+		testQuantize<2, int32_t>( count, false );
+		testQuantize<2, int64_t>( count, false );
+		testQuantize<3, int32_t>( count, false );
+		testQuantize<3, int64_t>( count, false );
+	}
+	testQuantize<2, int32_t>( 300001, true );
+	testQuantize<3, int64_t>( 300001, true );
+
+	// The limits of int64, and the conversion of the numbers above 2^52
+	using namespace AvxMath;
+	const double huge[ 6 ] = { -0x1p63, 0x1p63, 0x1p63 - 1024, -0x1p62 - 2048, 0x1p52 + 3, -1.5 };
+	int64_t q[ 6 ];
+	uint8_t overflow[ 2 ];
+	assert( 1 == array3Quantize( huge, 2, _mm256_setzero_pd(), 1, q, overflow ) );
+	assert( q[ 0 ] == INT64_MIN && q[ 1 ] == INT64_MAX && q[ 2 ] == INT64_MAX - 1023 );
+	assert( q[ 3 ] == -( 1ll << 62 ) - 2048 && q[ 4 ] == ( 1ll << 52 ) + 3 && q[ 5 ] == -2 );
+	assert( overflow[ 0 ] == 0b010 && overflow[ 1 ] == 0 );
+	double back[ 6 ];
+	array3Dequantize( q, 2, _mm256_setzero_pd(), 1, back );
+	assert( back[ 0 ] == -0x1p63 && back[ 1 ] == 0x1p63 && back[ 2 ] == 0x1p63 - 1024 && back[ 3 ] == -0x1p62 - 2048 && back[ 4 ] == 0x1p52 + 3 && back[ 5 ] == -2 );
+}
+
+// Double-double arithmetic: identities with known results, and comparison with __float128 when the compiler supports it
+static void testDoubleDouble()
+{
+	using namespace AvxMath;
+
+	// The rounding error of the product ( 1 + 2^-30 )^2 is 2^-60
+	__m256d err;
+	const __m256d p = twoProduct( _mm256_set1_pd( 1 + 0x1p-30 ), _mm256_set1_pd( 1 + 0x1p-30 ), err );
+	assertEqual( p, _mm256_set1_pd( 1 + 0x1p-29 ), 0 );
+	assertEqual( err, _mm256_set1_pd( 0x1p-60 ), 0 );
+
+	const __m256d one = _mm256_set1_pd( 1 );
+	const __m256d values = _mm256_setr_pd( 3, 7, 1E-10, -12345.678 );
+	const DoubleDouble4 a = ddFromDouble( values );
+
+	// ( 1 / x ) * x = 1, the error is about 2^-104
+	DoubleDouble4 r = ddSubtract( ddMultiply( ddDivide( ddFromDouble( one ), a ), a ), one );
+	assertEqual( ddToDouble( r ), _mm256_setzero_pd(), 1E-31 );
+
+	// sqrt( x )^2 = x
+	const DoubleDouble4 sq = ddSqrt( ddAbs( a ) );
+	r = ddSubtract( ddMultiply( sq, sq ), vectorAbs( values ) );
+	assertEqual( _mm256_div_pd( ddToDouble( r ), vectorAbs( values ) ), _mm256_setzero_pd(), 1E-31 );
+	// sqrt( 2 ) = 1.4142135623730951 - 9.6672933134529135E-17, with the relative error about 2^-106
+	r = ddSqrt( ddFromDouble( _mm256_set1_pd( 2 ) ) );
+	assertEqual( r.hi, _mm256_set1_pd( 1.4142135623730951 ), 0 );
+	assertEqual( r.lo, _mm256_set1_pd( -9.6672933134529135E-17 ), 4E-32 );
+	// Special cases of the square root
+	r = ddSqrt( ddFromDouble( _mm256_setr_pd( 0, 4, std::numeric_limits<double>::infinity(), -1 ) ) );
+	assert( vectorGetX( r.hi ) == 0 && vectorGetY( r.hi ) == 2 && std::isinf( vectorGetZ( r.hi ) ) && std::isnan( vectorGetW( r.hi ) ) );
+	assertEqual( _mm256_blend_pd( r.lo, _mm256_setzero_pd(), 0b1000 ), _mm256_setzero_pd(), 0 );
+
+	// ( 1 + 2^-80 ) - 1 = 2^-80, lost in FP64 arithmetic
+	r = ddSubtract( ddAdd( ddFromDouble( one ), _mm256_set1_pd( 0x1p-80 ) ), ddFromDouble( one ) );
+	assertEqual( r.hi, _mm256_set1_pd( 0x1p-80 ), 0 );
+	assertEqual( r.lo, _mm256_setzero_pd(), 0 );
+
+	// Sum with catastrophic cancellations, the small terms are lost in the FP64 sum
+	std::vector<double> arr;
+	for( int i = 0; i < 37; i++ )
+		arr.insert( arr.end(), { 1E+20, 0.25, -1E+20 } );
+	r = ddSum( arr.data(), arr.size() );
+	assertEqual( r.hi, _mm256_set1_pd( 0.25 * 37 ), 0 );
+	assertEqual( r.lo, _mm256_setzero_pd(), 0 );
+	assert( 0 == vectorGetX( ddSum( arr.data(), 0 ).hi ) );
+
+	// Dot product where the sum is in the low parts of the products: ( 1 + 2^-30 )^2 - ( 1 + 2^-29 ) = 2^-60
+	std::vector<double> x, y;
+	for( int i = 0; i < 37; i++ )
+	{
+		x.insert( x.end(), { 1 + 0x1p-30, -1 - 0x1p-29 } );
+		y.insert( y.end(), { 1 + 0x1p-30, 1 } );
+	}
+	r = ddDot( x.data(), y.data(), x.size() );
+	assertEqual( r.hi, _mm256_set1_pd( 37 * 0x1p-60 ), 0 );
+	assertEqual( r.lo, _mm256_setzero_pd(), 0 );
+
+	// Lanes of SoA dot product, x^2 + 1 + 2^-120 is representable when x^2 is small enough
+	const DoubleDouble4 ints = ddFromDouble( _mm256_setr_pd( 3, 7, 0.5, -12 ) );
+	const DoubleDouble4 v0[ 3 ] = { ints, ddFromDouble( one ), ddFromDouble( _mm256_set1_pd( 0x1p-60 ) ) };
+	r = ddDot3( v0, v0 );
+	r = ddSubtract( ddSubtract( r, ddMultiply( ints, ints ) ), one );
+	assertEqual( r.hi, _mm256_set1_pd( 0x1p-120 ), 0 );
+
+#ifdef __SIZEOF_FLOAT128__
+	// Random numbers, compare with the quad precision
+	Random rng;
+	const auto random = [ &rng ]() { return rng.next(); };
+	const auto quad = []( const DoubleDouble4& dd, int i )
+	{
+		alignas( 32 ) double hi[ 4 ], lo[ 4 ];
+		_mm256_store_pd( hi, dd.hi );
+		_mm256_store_pd( lo, dd.lo );
+		return (__float128)hi[ i ] + (__float128)lo[ i ];
+	};
+	const auto relativeError = []( __float128 a, __float128 b )
+	{
+		const double diff = (double)( a - b );
+		return std::abs( diff / (double)b );
+	};
+	double maxError = 0;
+	for( int i = 0; i < 10000; i++ )
+	{
+		// Random double-double numbers with exponents in [ -20 .. +20 ]
+		const auto make = [ & ]()
+		{
+			const __m256d e = _mm256_setr_pd( std::exp2( std::floor( random() * 20 ) ), std::exp2( std::floor( random() * 20 ) ),
+				std::exp2( std::floor( random() * 20 ) ), std::exp2( std::floor( random() * 20 ) ) );
+			const __m256d hi = _mm256_mul_pd( _mm256_setr_pd( random(), random(), random(), random() ), e );
+			const __m256d lo = _mm256_mul_pd( _mm256_setr_pd( random(), random(), random(), random() ), _mm256_mul_pd( e, _mm256_set1_pd( 0x1p-54 ) ) );
+			return ddFromSum( hi, lo );
+		};
+		const DoubleDouble4 x = make(), y = make(), z = make();
+		const DoubleDouble4 sum = ddAdd( x, y ), prod = ddMultiply( x, y ), quot = ddDivide( x, y ), fma = ddMultiplyAdd( x, y, z );
+		const DoubleDouble4 root = ddSqrt( ddAbs( x ) );
+		for( int j = 0; j < 4; j++ )
+		{
+			const __float128 qx = quad( x, j ), qy = quad( y, j ), qz = quad( z, j );
+			// The sum has no relative error bound after cancellation, compare with the magnitude of the inputs
+			const double sumError = (double)( quad( sum, j ) - ( qx + qy ) ) / std::max( std::abs( (double)qx ), std::abs( (double)qy ) );
+			maxError = std::max( maxError, std::abs( sumError ) );
+			maxError = std::max( maxError, relativeError( quad( prod, j ), qx * qy ) );
+			maxError = std::max( maxError, relativeError( quad( quot, j ), qx / qy ) );
+			const double fmaScale = std::abs( (double)( qx * qy ) ) + std::abs( (double)qz );
+			maxError = std::max( maxError, std::abs( (double)( quad( fma, j ) - ( qx * qy + qz ) ) ) / fmaScale );
+			const __float128 qr = quad( root, j );
+			maxError = std::max( maxError, relativeError( qr * qr, qx < 0 ? -qx : qx ) / 2 );
+		}
+	}
+	printf( "Double-double arithmetic, max. relative error %g\n", maxError );
+	assert( maxError < 1E-30 );
+
+	// Dot product of random vectors, the error is relative to the sum of absolute values of the products
+	x.resize( 1001 );
+	y.resize( x.size() );
+	__float128 exact = 0;
+	double absSum = 0;
+	for( size_t i = 0; i < x.size(); i++ )
+	{
+		x[ i ] = random() * 1E+6;
+		y[ i ] = random();
+		exact += (__float128)x[ i ] * (__float128)y[ i ];
+		absSum += std::abs( x[ i ] * y[ i ] );
+	}
+	r = ddDot( x.data(), y.data(), x.size() );
+	assert( std::abs( (double)( quad( r, 0 ) - exact ) ) < absSum * 1E-28 );
+#endif
+}
+
 bool testStdlib()
 {
 	using namespace AvxMath;
 
 	const __m256d a = _mm256_setr_pd( 1, 2, 3, 4 );
-	const __m256d b = _mm256_setr_pd( 5, 6, 7, 8 );
 
 	__m256d x, y;
 	vectorSinCos( x, y, a );
@@ -111,6 +833,23 @@ bool testStdlib()
 		assertEqual( std, my2 );
 	}
 
+	testTrigPrecision<eTrigPrecision::Fast>( 1E-5, 1E-7 );
+	testTrigPrecision<eTrigPrecision::Default>( 1E-9, 1E-5 );
+	testTrigPrecision<eTrigPrecision::Precise>( 1E-15, 1E-15 );
+
+	testTrigArrays<eTrigPrecision::Fast>();
+	testTrigArrays<eTrigPrecision::Default>();
+	testTrigArrays<eTrigPrecision::Precise>();
+
+	testExp();
+	testWeld();
+	testSpatialHash();
+	testParallel();
+	testCounters();
+	testConvert();
+	testQuantize();
+	testSort();
+	testDoubleDouble();
 	computeSinCosError();
 	return true;
 }
\ No newline at end of file
@@ -1,13 +1,14 @@
 #pragma once
 #include "AvxMath/AvxMath.h"
 #include <assert.h>
+#include <vector>
+#include <cmath>
 
-static void assertEqual( __m256d a, __m256d b )
+inline void assertEqual( __m256d a, __m256d b, double tolerance )
 {
 	__m256d diff = _mm256_sub_pd( a, b );
 	using namespace AvxMath;
 	diff = vectorAbs( diff );
-	constexpr double tolerance = 1E-6;
 	if( vector4InBounds( diff, _mm256_set1_pd( tolerance ) ) )
 		return;
 #ifdef _MSC_VER
@@ -17,8 +18,84 @@ static void assertEqual( __m256d a, __m256d b )
 #endif
 }
 
-static void assertEqual( __m128d a, __m128d b )
+inline void assertEqual( __m256d a, __m256d b )
+{
+	assertEqual( a, b, 1E-6 );
+}
+
+inline void assertEqual( __m128d a, __m128d b )
 {
 	using namespace AvxMath;
 	assertEqual( dup2( a ), dup2( b ) );
+}
+
+// Deterministic pseudo-random numbers for the tests and benchmarks, 64-bit LCG with Knuth's MMIX constants
+struct Random
+{
+	uint64_t state = 1;
+
+	// 64 random bits; the low bits of the LCG state are weak, they're mixed with the high ones
+	uint64_t nextBits()
+	{
+		step();
+		return state ^ ( state >> 29 );
+	}
+
+	// Random number in [ 0 .. 1 ) interval
+	double nextUnit()
+	{
+		step();
+		return (double)( state >> 11 ) * 0x1p-53;
+	}
+
+	// Random number in [ -1 .. +1 ) interval
+	double next()
+	{
+		step();
+		return (double)( state >> 11 ) * 0x1p-52 - 1.0;
+	}
+
+	// Random 3D vector in [ -1 .. +1 ) cube, W = 0
+	__m256d next3()
+	{
+		const double x = next(), y = next(), z = next();
+		return _mm256_setr_pd( x, y, z, 0 );
+	}
+
+private:
+	void step()
+	{
+		state = state * 6364136223846793005ull + 1442695040888963407ull;
+	}
+};
+
+// UV sphere of radius r centered at the origin, 2 * segments * ( rings - 1 ) triangles, counter-clockwise when looking from outside; the poles are single vertices
+inline void makeSphere( double r, size_t rings, size_t segments, std::vector<double>& xyz, std::vector<uint32_t>& indices )
+{
+	const double pi = 3.14159265358979323846;
+	xyz = { 0, 0, r };
+	for( size_t i = 1; i < rings; i++ )
+	{
+		const double theta = pi * (double)i / (double)rings;
+		for( size_t j = 0; j < segments; j++ )
+		{
+			const double phi = 2 * pi * (double)j / (double)segments;
+			xyz.insert( xyz.end(), { r * std::sin( theta ) * std::cos( phi ), r * std::sin( theta ) * std::sin( phi ), r * std::cos( theta ) } );
+		}
+	}
+	xyz.insert( xyz.end(), { 0, 0, -r } );
+
+	const uint32_t south = (uint32_t)( xyz.size() / 3 - 1 );
+	const auto ring = [ segments ]( size_t i, size_t j ) { return (uint32_t)( 1 + ( i - 1 ) * segments + j % segments ); };
+	indices.clear();
+	for( size_t j = 0; j < segments; j++ )
+	{
+		indices.insert( indices.end(), { 0, ring( 1, j ), ring( 1, j + 1 ) } );
+		indices.insert( indices.end(), { south, ring( rings - 1, j + 1 ), ring( rings - 1, j ) } );
+		for( size_t i = 1; i + 1 < rings; i++ )
+		{
+			indices.insert( indices.end(), { ring( i, j ), ring( i + 1, j ), ring( i + 1, j + 1 ) } );
+			indices.insert( indices.end(), { ring( i, j ), ring( i + 1, j + 1 ), ring( i, j + 1 ) } );
+		}
+	}
 }
\ No newline at end of file